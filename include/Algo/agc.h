@@ -18,6 +18,12 @@ ________________________________________________________________________
 
 /*!
 \brief Computes an AGC over a ValueSeries.
+
+  The mean energy in the gate is maintained as a running sum, so the cost does
+  not depend on the gate length. Undefined samples do not contribute to the
+  mean; optionally, neither do samples that are exactly zero, as within a mute.
+  The static functions apply the same algorithm to plain arrays, for callers
+  that process many traces, such as prestack gathers or volumes.
 */
 
 template <class T>
@@ -37,9 +43,30 @@ public:
     void		setMuteFraction(float lvmf)	{ mutefraction_ = lvmf;}
 			//!<The lowest fraction will be muted
     float		getMuteFraction() const		{ return mutefraction_;}
+    void		setIgnoreZeros(bool yn)		{ ignorezeros_ = yn; }
+			//!<Exact zeros, e.g. muted samples, are left out
+    bool		ignoreZeros() const		{ return ignorezeros_; }
 
     bool		doPrepare(int nrthreads) override;
 
+    static void		getEnergies(const T* inp,od_int64 sz,
+				    T* energies);
+			//!<Undefined input gives undefined energy
+    static T		getEnergyMute(const T* energies,od_int64 sz,
+				      float mutefraction);
+    static void		getMeanEnergies(const T* energies,od_int64 sz,
+					od_int64 start,od_int64 stop,
+					const Interval<int>& samplegate,
+					bool ignorezeros,T* means);
+			/*!<Sets means[0] to means[stop-start], for the
+			    samples start to stop, from a running sum over
+			    the gate; 0 where no energies are found */
+    static void		applyToTrace(const T* inp,T* outp,od_int64 sz,
+				     const Interval<int>& samplegate,
+				     float mutefraction,bool ignorezeros,
+				     T* workbuf);
+			/*!<workbuf must hold 2*sz values. outp may be inp */
+
 protected:
 
     void		computeEnergyMute();
@@ -52,6 +79,7 @@ protected:
     ValueSeries<T>*		output_;
     Interval<int>		samplerg_;
     float			mutefraction_;
+    bool			ignorezeros_		= false;
     TypeSet<T>			energies_;
     T				energymute_;
 
@@ -118,22 +146,98 @@ bool AGC<T>::doPrepare( int nrthreads )
 }
 
 
+template <class T> inline
+void AGC<T>::getEnergies( const T* inp, od_int64 sz, T* energies )
+{
+    for ( od_int64 idx=0; idx<sz; idx++ )
+    {
+	const T value = inp[idx];
+	energies[idx] = mIsUdf( value ) ? mUdf(T) : value*value;
+    }
+}
+
+
+template <class T> inline
+T AGC<T>::getEnergyMute( const T* energies, od_int64 sz, float mutefraction )
+{
+    if ( mIsUdf(mutefraction) || mIsZero(mutefraction,1e-5) )
+	return 0;
+
+    const od_int64 sample = mNINT64(sz*mutefraction);
+    if ( sample<0 || sample>=sz )
+	return 0;
+
+    mAllocLargeVarLenArr( T, sorted, sz );
+    if ( !mIsVarLenArrOK(sorted) )
+	return 0;
+
+    OD::sysMemCopy( sorted.ptr(), energies, sz*sizeof(T) );
+    sortFor( sorted.ptr(), sz, sample );
+    return sorted[sample];
+}
+
+
+template <class T> inline
+void AGC<T>::getMeanEnergies( const T* energies, od_int64 sz,
+			      od_int64 start, od_int64 stop,
+			      const Interval<int>& gate, bool ignorezeros,
+			      T* means )
+{
+#define mAddEnergy( eidx, fac ) \
+    if ( eidx>=0 && eidx<sz ) \
+    { \
+	const T energy = energies[eidx]; \
+	if ( !mIsUdf(energy) && (!ignorezeros || energy!=0) ) \
+	{ energysum += fac*energy; nrenergies += fac; } \
+    }
+
+    double energysum = 0.;
+    int nrenergies = 0;
+    for ( od_int64 eidx=start+gate.start_; eidx<=start+gate.stop_; eidx++ )
+	mAddEnergy( eidx, 1 )
+
+    for ( od_int64 idx=start; idx<=stop; idx++ )
+    {
+	if ( idx > start )
+	{
+	    const od_int64 addidx = idx + gate.stop_;
+	    mAddEnergy( addidx, 1 )
+	    const od_int64 remidx = idx + gate.start_ - 1;
+	    mAddEnergy( remidx, -1 )
+	}
+
+	means[idx-start] = nrenergies>0 ? mCast(T,energysum/nrenergies) : 0;
+    }
+
+#undef mAddEnergy
+}
+
+
+template <class T> inline
+void AGC<T>::applyToTrace( const T* inp, T* outp, od_int64 sz,
+			   const Interval<int>& gate, float mutefraction,
+			   bool ignorezeros, T* workbuf )
+{
+    T* energies = workbuf;
+    T* means = workbuf + sz;
+    getEnergies( inp, sz, energies );
+    const T energymute = getEnergyMute( energies, sz, mutefraction );
+    getMeanEnergies( energies, sz, 0, sz-1, gate, ignorezeros, means );
+    for ( od_int64 idx=0; idx<sz; idx++ )
+    {
+	const T energy = means[idx];
+	const T inpval = inp[idx];
+	outp[idx] = energy>=energymute && energy>0
+		  ? (mIsUdf(inpval) ? inpval : inpval/Math::Sqrt(energy))
+		  : 0;
+    }
+}
+
+
 template <class T> inline
 void AGC<T>::computeEnergyMute()
 {
-    energymute_ = 0;
-    if ( mIsUdf(mutefraction_) ||
-	 mIsZero(mutefraction_,1e-5) )
-	return;
-
-    const od_int64 sample = mNINT64(size_*mutefraction_);
-    if ( sample<0 || sample>=size_ )
-	return;
-
-    mAllocLargeVarLenArr( T, energies, size_ );
-    OD::sysMemCopy( energies.ptr(), energies_.arr(), size_*sizeof(T) );
-    sortFor( energies.ptr(), size_, sample );
-    energymute_ = energies[sample];
+    energymute_ = getEnergyMute( energies_.arr(), size_, mutefraction_ );
 }
 
 
@@ -171,34 +275,21 @@ bool AGC<T>::doWork( od_int64 start, od_int64 stop, int threadidx )
 	computeEnergyMute();
     }
 
-    for ( int idx=mCast(int,start); idx<=stop; idx++ )
-    {
-	int nrenergies = 0;
-	float energysum = 0;
-	for ( int energyidx=idx+samplerg_.start_;
-	      energyidx<=idx+samplerg_.stop_;
-		  energyidx++ )
-	{
-	    if ( energyidx<0 || energyidx>=size_ )
-		continue;
-
-	    const T energy = energies_[energyidx];
-	    if ( mIsUdf(energy) )
-		continue;
-
-	    energysum += energy;
-	    nrenergies++;
-	}
-
-	if ( nrenergies != 0 )
-	    energysum /= nrenergies;
+    mAllocLargeVarLenArr( T, means, stop-start+1 );
+    if ( !mIsVarLenArrOK(means) )
+	return false;
 
-	float outputval = 0;
-	if ( energysum>=energymute_ && energysum>0 )
+    getMeanEnergies( energies_.arr(), size_, start, stop, samplerg_,
+		     ignorezeros_, mVarLenArr(means) );
+    for ( od_int64 idx=start; idx<=stop; idx++ )
+    {
+	const T energy = means[idx-start];
+	T outputval = 0;
+	if ( energy>=energymute_ && energy>0 )
 	{
 	    const T inpval = input_->value(idx);
 	    outputval = mIsUdf( inpval )
-		? inpval : inpval/Math::Sqrt( energysum );
+		? inpval : inpval/Math::Sqrt( energy );
 	}
 
 	output_->setValue( idx, outputval );
@@ -426,6 +426,36 @@ public:
 };
 
 
+/*!\brief The properties of an ElasticModel as contiguous arrays
+  Meant for the inner loops of the ray tracers and reflectivity computations,
+  which then do not need to go through the layer objects.
+  Values that are not available for the type of layer are undefined.
+ */
+
+mExpClass(Algo) ElasticModelArrays
+{
+public:
+			ElasticModelArrays();
+			ElasticModelArrays(const ElasticModel&);
+			~ElasticModelArrays();
+
+    void		set(const ElasticModel&);
+    int			size() const		{ return thickness_.size(); }
+    bool		isElastic() const	{ return iselastic_; }
+			//!< All layers have an S-wave velocity
+
+    TypeSet<float>	thickness_;
+    TypeSet<float>	pvel_;
+    TypeSet<float>	svel_;
+    TypeSet<float>	den_;
+    TypeSet<float>	ai_;
+
+private:
+
+    bool		iselastic_ = false;
+};
+
+
 inline const Interval<float> validThicknessRange()
 {
     return Interval<float> ( cMinLayerThickness(), mUdf(float) );
@@ -0,0 +1,76 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "algomod.h"
+
+#include "odcomplex.h"
+#include "typeset.h"
+
+namespace Fourier
+{
+
+class FFTCC1D;
+
+/*!
+\brief Cross-correlates traces with a reference trace in the frequency domain.
+
+  The spectrum of the reference is computed once. The traces are transformed
+  two at a time, one as the real and one as the imaginary part of a complex
+  FFT, so a batch of n traces takes n/2 forward and n/2 inverse transforms.
+  All lags up to maxlag are obtained at once; the transforms are long enough
+  for the correlation not to wrap around.
+
+  The correlation at lag k is the sum over t of ref[t]*trc[t+k]: a positive
+  lag means the trace is later than the reference. Undefined values are taken
+  as zero. An object can only be used from one thread at a time.
+*/
+
+mExpClass(Algo) CrossCorrelator
+{
+public:
+			CrossCorrelator();
+			~CrossCorrelator();
+			mOD_DisableCopy(CrossCorrelator)
+
+    bool		setSize(int nrsamples,int maxlag);
+    int			nrSamples() const	{ return nrsamples_; }
+    int			maxLag() const		{ return maxlag_; }
+    int			nrLags() const		{ return 2*maxlag_+1; }
+
+    bool		setReference(const float*);
+    bool		correlate(const float* trc,float* xcorr);
+			/*!<xcorr gets nrLags() values, the first one for lag
+			    -maxlag. Needs a reference. */
+    bool		correlate(int nrtrcs,const float* const* trcs,
+				  float* xcorrs);
+			//!<xcorrs gets nrLags() values per trace
+
+    static float	findPeak(const float* xcorr,int maxlag,
+				 float* peakval=nullptr);
+			/*!<Lag of the maximum in samples, refined by a
+			    parabola through the neighbours. udf if the
+			    correlation is flat or undefined */
+
+protected:
+
+    int			nrsamples_		= 0;
+    int			maxlag_			= 0;
+    int			fftsz_			= 0;
+    FFTCC1D*		fft_;
+    FFTCC1D*		ifft_;
+    TypeSet<float_complex> refspec_;
+    TypeSet<float_complex> buf_;
+    bool		hasref_			= false;
+
+    void		getCorrelation(int part,float* xcorr) const;
+
+};
+
+} // namespace Fourier
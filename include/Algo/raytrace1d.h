@@ -17,6 +17,7 @@ ________________________________________________________________________
 #include "reflectivitymodel.h"
 
 class ElasticModel;
+class ElasticModelArrays;
 
 
 /*!
@@ -100,6 +101,11 @@ protected:
     bool		doPrepare(int) override;
     bool		doFinish(bool) override;
     virtual bool	compute(int layer,int offidx,float rayparam);
+    bool		computeReflectivities(int layer,int firstoffidx,
+					      int nroffsets,
+					      const float* rayparams);
+			/*!< Full Zoeppritz for a range of offsets, with one
+			     ray parameter per offset */
 
 			//Setup variables
     ElasticModel&	model_; // model top depth must be TWT = 0ms
@@ -108,6 +114,7 @@ protected:
 
 			//Runtime variables
     TypeSet<int>	offsetpermutation_;
+    ElasticModelArrays&	layers_;
     float*		velmax_ = nullptr;
     float*		depths_ = nullptr;
     float*		zerooffstwt_ = nullptr;
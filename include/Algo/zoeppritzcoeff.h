@@ -25,6 +25,12 @@ public:
 
     void		setInterface(float p,const ElasticLayer& el_layer1,
 				     const ElasticLayer& el_layer2);
+    void		setInterface(float p,float pvel1,float svel1,
+				     float den1,float pvel2,float svel2,
+				     float den2);
+			/*!< Same, from the values of the layers. Avoids
+			     going through the layer objects when
+			     evaluating many ray parameters */
 
     float_complex       getCoeff(bool down_in,bool down_out,
 				 bool p_in,bool p_out) const;
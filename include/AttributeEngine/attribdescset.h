@@ -51,6 +51,11 @@ public:
     void		updateInputs();
 			/*!< Updates inputs for all descs in descset.
 			     Necessary after cloning */
+    int			mergeIdenticalDescs(const TypeSet<DescID>& keep);
+			/*!< Lets all descs use a single instance of
+			     structurally identical inputs, and removes the
+			     duplicates that are no longer used, unless
+			     they are in 'keep'. Returns nr of duplicates */
 
     DescID		addDesc(Desc*,DescID newid=DescID());
 			/*!< returns id of the attrib */
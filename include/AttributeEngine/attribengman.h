@@ -31,6 +31,7 @@ namespace Attrib
 {
 class Desc;
 class DescSet;
+class IntermediateResult;
 class Processor;
 class Data2DHolder;
 
@@ -47,6 +48,10 @@ public:
 
     Processor*		usePar(const IOPar&,DescSet&,
 			       const char* linename,uiString&);
+			/*!< When several Output.N have their own Seismic.ID,
+			     each of them gets a SeisTrcStorOutput with the
+			     outputs of its own attributes, and all are
+			     computed in a single pass. */
 
     static Processor*	createProcessor(const DescSet&,const Pos::GeomID&,
 					const DescID&,uiString& errmsg);
@@ -57,7 +62,7 @@ public:
 				   const NLAModel*,uiString&);
 
     RefMan<SeisTrcStorOutput> createOutput(const IOPar&,const Pos::GeomID&,
-					   uiString&);
+					   uiString&,int outputidx=-1);
 
     const DescSet*	attribSet() const	{ return inpattrset_; }
     const NLAModel*	nlaModel() const	{ return nlamodel_; }
@@ -82,6 +87,9 @@ public:
 				      const RegularSeisDataPack* cached_data=0);
 			//!< Give the previous calculated data in cached data
 			//!< and some parts may not be recalculated.
+			//!< Without it, the persistent ResultCache is used.
+    bool		storeInResultCache(const RegularSeisDataPack&) const;
+			//!< Call after successful execution only
 
     RefMan<RegularSeisDataPack> getDataPackOutput(const Processor&);
     RefMan<RegularSeisDataPack> getDataPackOutput(
@@ -130,12 +138,20 @@ protected:
     DataPackMgr&	dpm_;
 
     ConstRefMan<RegularSeisDataPack>	cache_;
+    BufferString			resultcachekey_;
 
     DescSet*		procattrset_ = nullptr;
     int			curattridx_ = 0;
     TypeSet<SelSpec>	attrspecs_;
 
     Processor*		getProcessor(uiString& err);
+    void		useIntermediateResults(const DescID& outid,
+					const TypeSet<DescID>& outattribs);
+    void		captureIntermediateResults(Processor&);
+    void		storeIntermediateResults();
+
+    bool		useintermediates_ = false;
+    RefObjectSet<IntermediateResult> intermresults_;
     void		setExecutorName(Executor*);
 
 private:
@@ -0,0 +1,134 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "attributeenginemod.h"
+
+#include "binidvalset.h"
+#include "callback.h"
+#include "manobjectset.h"
+#include "multiid.h"
+#include "refcount.h"
+#include "threadlock.h"
+#include "trckeyzsampling.h"
+
+class SeisTrcBuf;
+class SeisTrcBufDataPack;
+template <class T> class ValueSeries;
+
+namespace Attrib
+{
+
+class Desc;
+class IntermediateCache;
+
+mGlobal(AttributeEngine) IntermediateCache& AIC();
+
+
+/*!\brief Output of one provider output, collected while it is computed.
+
+  The traces may be added by several threads at once. */
+
+mExpClass(AttributeEngine) IntermediateResult : public ReferencedObject
+{
+public:
+			IntermediateResult(const char* key);
+
+    const char*		key() const		{ return key_.buf(); }
+    bool		isOK() const;
+    od_int64		memSize() const;
+
+    void		add(const BinID&,const ValueSeries<float>&,int z0,
+			    int nrsamples,float zstep,float extraz);
+			/*!< z0 is in number of zsteps, as in DataHolder.
+			     Positions that are present already are ignored */
+
+protected:
+			~IntermediateResult();
+
+    friend class	IntermediateCache;
+
+    const BufferString	key_;
+    SeisTrcBuf*		trcs_;
+    BinIDValueSet	positions_;
+    od_int64		memsize_	= 0;
+    bool		overflow_	= false;
+    mutable Threads::Lock lock_;
+
+};
+
+
+/*!
+\brief In-memory cache of the outputs of intermediate attribute providers.
+
+  The entries are the outputs of the providers for a displayed volume, keyed by
+  the definition of the attribute and all its inputs, including the
+  modification time and size of the stored inputs. Thus when one parameter
+  changes, only the changed attribute and the attributes using it get other
+  keys; EngineMan replaces the unchanged inputs by the cached data.
+
+  The entries are kept in memory as in-memory stored data, up to a maximum
+  size; the least recently used ones are removed first. Rewriting any stored
+  data, or changing survey, clears the cache.
+*/
+
+mExpClass(AttributeEngine) IntermediateCache : public CallBacker
+{
+public:
+
+    static BufferString	getKey(const Desc&,int output);
+			//!< Empty if the output cannot be cached
+
+    bool		isEnabled() const	{ return maxsize_ > 0; }
+    bool		isEmpty() const;
+    od_int64		maxSize() const		{ return maxsize_; }
+    void		setMaxSize(od_int64 nrbytes,bool writesettings);
+    od_int64		usedSize() const;
+
+    bool		covers(const char* key,const TrcKeyZSampling&) const;
+    MultiID		getDataPackKey(const char* key);
+			//!< Key to use in a stored Desc; udf if not present
+    BufferString	keyOf(const MultiID& dpkey) const;
+
+    bool		add(IntermediateResult&,const BinID& step);
+			//!< Positions must cover a full box with this step
+    void		clear();
+
+    static const char*	sKeyMaxSizeMB();
+
+protected:
+
+    struct Entry
+    {
+			Entry(const char* key,SeisTrcBufDataPack&);
+			~Entry();
+
+	BufferString			key_;
+	RefMan<SeisTrcBufDataPack>	pack_;
+	TrcKeyZSampling			covered_;
+	od_int64			memsize_	= 0;
+	od_int64			stamp_		= 0;
+    };
+
+    ManagedObjectSet<Entry>	entries_;
+    od_int64			maxsize_;
+    od_int64			usedsize_	= 0;
+    od_int64			curstamp_	= 0;
+    mutable Threads::Lock	lock_;
+
+    int				indexOf(const char* key) const;
+    void			limitSize();
+    void			clearCB(CallBacker*);
+
+public:
+				IntermediateCache();
+				~IntermediateCache();
+};
+
+} // namespace Attrib
@@ -20,6 +20,9 @@ class DataHolder;
 
 /*!
 \brief Attribute DataHolder Line Buffer.
+
+  The DataHolders that are removed are kept in a pool, and are re-used for
+  the next positions with the same number of samples.
 */
 
 mExpClass(AttributeEngine) DataHolderLineBuffer
@@ -40,10 +43,13 @@ public:
 
 protected:
     void		removeInline( int lineidx );
+    DataHolder*		getFromPool(int z0,int nrsamples);
+    void		addToPool(DataHolder*);
 
     TypeSet<int>			inlines_;
     ObjectSet<ObjectSet<DataHolder> >	inlinedata_;
     ObjectSet<TypeSet<int> >		crossliness_;
+    ObjectSet<DataHolder>		pool_;
     DataHolder*		gtDataHolder(const BinID&) const;
 };
 
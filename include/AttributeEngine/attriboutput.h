@@ -167,7 +167,8 @@ public:
     void			setGeometry( const TrcKeyZSampling& cs )
 				{ doSetGeometry(cs); }
 
-    bool			doUsePar(const IOPar&);
+    bool			doUsePar(const IOPar&,int outputidx=-1);
+				/*!< outputidx=-1: Output.0, or else Output.1 */
     bool			finishWrite() override;
     void			collectData(const DataHolder&,float step,
 					    const SeisTrcInfo&) override;
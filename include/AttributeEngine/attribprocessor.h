@@ -25,6 +25,7 @@ namespace Attrib
 class DataHolder;
 class Desc;
 class Provider;
+class ProviderStats;
 
 /*!
 \brief Attribute Processor
@@ -69,6 +70,13 @@ public:
 					    const TypeSet<BinID>& snappedpath);
 				//for directional attributes
 
+    void			enableStatistics(bool yn);
+    void			getStatistics(BufferStringSet& providernms,
+					      TypeSet<ProviderStats>&) const;
+				//!< Of every provider in the tree, once
+    void			reportStatistics(od_ostream&) const;
+    static const char*		sKeyStatistics()	{ return "Statistics"; }
+
 protected:
     void		useFullProcess(int&);
     void		useSCProcess(int&);
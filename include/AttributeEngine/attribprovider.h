@@ -10,9 +10,11 @@ ________________________________________________________________________
 
 #include "attributeenginemod.h"
 
+#include "atomic.h"
 #include "attribdesc.h"
 #include "posinfo2dsurv.h"
 #include "ranges.h"
+#include "threadlock.h"
 #include "uistring.h"
 
 class BinDataDesc;
@@ -31,8 +33,36 @@ namespace Attrib
 
 class DataHolder;
 class DataHolderLineBuffer;
+class InputDataTask;
+class IntermediateResult;
 class ProviderTask;
 
+/*!
+\brief Counters of a Provider, collected when enabled.
+
+  Times are in microseconds. The compute time excludes the time spent in the
+  inputs, the total time includes it. The counters are atomic, as the inputs
+  of a provider may be computed concurrently.
+*/
+
+mExpClass(AttributeEngine) ProviderStats
+{
+public:
+    void			reset()		{ *this = ProviderStats(); }
+    void			fillPar(IOPar&) const;
+    bool			operator==(const ProviderStats&) const;
+
+    Threads::Atomic<od_int64>	computetime_			= 0;
+    Threads::Atomic<od_int64>	totaltime_			= 0;
+    Threads::Atomic<od_int64>	nrcomputed_			= 0;
+    Threads::Atomic<od_int64>	nrsamples_			= 0;
+    Threads::Atomic<od_int64>	nrbufferhits_			= 0;
+    Threads::Atomic<od_int64>	nrbuffermisses_			= 0;
+    Threads::Atomic<od_int64>	nrtrcsread_			= 0;
+    Threads::Atomic<od_int64>	bytesread_			= 0;
+};
+
+
 /*!
 \brief Provides the actual output to ...
 */
@@ -58,6 +88,16 @@ public:
     const DataHolder*		getData(const BinID& relpos=BinID::noStepout(),
 					int idx=0);
     const DataHolder*		getDataDontCompute(const BinID& relpos) const;
+    void			setIntermediateResult(int output,
+						      IntermediateResult*);
+				/*!< Collects the computed data of the output,
+				     see IntermediateCache */
+
+    void			enableStatistics(bool yn);
+				//!< Also for all inputs; resets the counters
+    bool			statisticsEnabled() const
+				{ return statsenabled_; }
+    const ProviderStats&	getStatistics() const	{ return stats_; }
 
     int				nrOutputs() const
 				{ return outputinterest_.size(); }
@@ -196,9 +236,15 @@ protected:
 				/*!<Specifies the outputs needed for calculation
 				among all those provided by the input data;
 				very usefull when steering used as input data*/
+    const DataHolder*		computeOutData(const BinID& relpos,int idx);
     virtual bool		getInputData(const BinID& relpos,int idx);
 				/*!<Gets all imput data,
 				including data for which a stepout is required*/
+    void			prepareInputData(const BinID& relpos,int idx);
+				/*!<Computes the data of the independent input
+				subtrees concurrently, at the same position*/
+    void			addToIntermediateResults(const BinID& relpos,
+							 const DataHolder&);
     virtual bool		preProcCommonToAllThreads(const DataHolder& out,
 							  const BinID& relpos)
 				{ return true; }
@@ -233,6 +279,11 @@ protected:
 				{ return false; }
     virtual bool		setNrThreads( int idx ) { return true; }
     virtual int			minTaskSize() const		{ return 25; }
+    float*			getScratchBuffer(int threadidx,int bufidx,
+						 int nrvals) const;
+				/*!<Temporary memory for computeData, kept per
+				thread and re-used for all positions. Contents
+				are undefined */
     virtual bool		finalizeCalculation(bool scs)	{ return scs; }
 				/*!<Called one all computeData have returned.
 				    \param scs is true if all computeData
@@ -376,7 +427,13 @@ protected:
 				// at sample locations
 
     ProviderTask*		providertask_			= nullptr;
+    InputDataTask*		inputdatatask_			= nullptr;
+    RefObjectSet<IntermediateResult> intermresults_;
+    bool			inputdatataskdone_		= false;
     DataHolderLineBuffer*	linebuffer_			= nullptr;
+    mutable ObjectSet<TypeSet<float> > scratchbufs_;
+    mutable TypeSet<od_int64>	scratchkeys_;
+    mutable Threads::Lock	scratchlock_;
     BinID			currentbid_			= BinID::udf();
     int				prevtrcnr_			= 0;
     Pos::GeomID			geomid_;
@@ -395,6 +452,8 @@ protected:
     bool			needinterp_			= false;
     uiString			errmsg_;
     bool			dataunavailableflag_		= false;
+    bool			statsenabled_			= false;
+    mutable ProviderStats	stats_;
 
 public:
     void			setDataUnavailableFlag(bool yn);
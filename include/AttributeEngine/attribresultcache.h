@@ -0,0 +1,79 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "attributeenginemod.h"
+
+#include "attribsel.h"
+#include "bufstring.h"
+#include "refcount.h"
+#include "threadlock.h"
+
+class RegularSeisDataPack;
+class TrcKeyZSampling;
+
+namespace Attrib
+{
+
+class Desc;
+class DescSet;
+class ResultCache;
+
+mGlobal(AttributeEngine) ResultCache& ARC();
+
+/*!
+\brief Persistent cache of computed attribute volumes.
+
+  The entries are stored in the Proc directory of the survey. They are keyed
+  by a hash of the full definition of the attributes (including all their
+  inputs), the versions of the stored input data and the Z domain. A key can
+  have several entries, each covering a different sub-volume.
+
+  get() returns the cached part with the largest overlap with the requested
+  volume. EngineMan computes only the remaining parts. When the total size
+  exceeds the limit, the least recently used entries are removed. A limit of
+  zero disables the cache.
+*/
+
+mExpClass(AttributeEngine) ResultCache
+{
+public:
+
+    static BufferString	getKey(const DescSet&,const TypeSet<SelSpec>&);
+			//!< Empty if the attributes cannot be cached
+
+    RefMan<RegularSeisDataPack> get(const char* key,
+				    const TrcKeyZSampling&) const;
+			//!< Only the part overlapping the requested volume
+    bool		store(const char* key,const RegularSeisDataPack&);
+
+    bool		isEnabled() const	{ return maxsize_ > 0; }
+    od_int64		maxSize() const		{ return maxsize_; }
+    void		setMaxSize(od_int64 nrbytes,bool writesettings);
+    od_int64		usedSize() const;
+    void		clear();
+
+    static const char*	sKeyMaxSizeMB();
+    static const char*	sKeyLastUsed()		{ return "Last used"; }
+
+protected:
+
+    od_int64		maxsize_;
+    mutable Threads::Lock lock_;
+
+    BufferString	cacheDir() const;
+    void		touch(const char* parfnm) const;
+    void		limitSize();
+
+public:
+			ResultCache();
+			~ResultCache();
+};
+
+} // namespace Attrib
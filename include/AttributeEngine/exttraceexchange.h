@@ -0,0 +1,135 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "attributeenginemod.h"
+
+#include "bufstring.h"
+#include "uistring.h"
+
+class SeisTrcBuf;
+
+
+namespace Attrib
+{
+
+/*!
+\brief Shared memory ring buffer, to hand batches of traces to an external
+process such as a Python attribute, without serializing them.
+
+  The segment starts with a Header, followed by a SlotHeader for each slot,
+  followed by the data of each slot. The data of a slot has the line and
+  trace numbers (int32, maxnrtrcs each), the input samples (float32,
+  [nrinpcomps][maxnrtrcs][maxnrsamples]) and the output samples (float32,
+  [nroutcomps][maxnrtrcs][maxnrsamples]). Hence the external process can use
+  the arrays as numpy views; see odbind/exttraces.py.
+
+  A slot goes from Free to Input (batch written by OpendTect), to Busy (taken
+  by the external process), to Output (results written), and back to Free
+  when the results have been read. The slots are filled in ring order; the
+  external process takes the Input slot with the lowest sequence number, and
+  sets doneseqnr_ to the sequence number of the batch before setting Output.
+
+  When the external process fails to respond, all slots are reset to Free,
+  and the generation of the exchange is incremented. Each slot is tagged with
+  the generation it was filled in. A late result for a batch that was reset
+  is recognized by its sequence number, and ignored: a slot of an earlier
+  generation is reused whatever its state, and a pending batch that was
+  marked Output by a late writer is handed over again.
+*/
+
+mExpClass(AttributeEngine) ExtTraceExchange
+{ mODTextTranslationClass(ExtTraceExchange)
+public:
+
+    enum SlotState	{ Free=0, Input, Busy, Output };
+
+    struct Header
+    {
+	char		magic_[8];
+	od_int32	version_;
+	od_int32	nrslots_;
+	od_int32	maxnrtrcs_;
+	od_int32	maxnrsamples_;
+	od_int32	nrinpcomps_;
+	od_int32	nroutcomps_;
+	od_int32	shutdown_;
+	od_int32	generation_;
+    };
+
+    struct SlotHeader
+    {
+	od_int32	state_;
+	od_int32	nrtrcs_;
+	od_int32	nrsamples_;
+	od_int32	seqnr_;
+	float		z0_;
+	float		zstep_;
+	od_int32	doneseqnr_;
+	od_int32	generation_;
+    };
+
+			ExtTraceExchange(const char* nm,int nrslots,
+					 int maxnrtrcs,int maxnrsamples,
+					 int nrinpcomps=1,int nroutcomps=1);
+			~ExtTraceExchange();
+			//!< Removes the segment
+			mOD_DisableCopy(ExtTraceExchange)
+
+    bool		isOK() const		{ return data_; }
+    const char*		name() const		{ return name_.buf(); }
+    const uiString&	errMsg() const		{ return errmsg_; }
+    od_int64		totalSize() const	{ return totsz_; }
+    int			nrSlots() const;
+    int			maxNrTraces() const;
+
+    int			putBatch(const SeisTrcBuf&,int firsttrc,int& nrput);
+			/*!< Writes the traces from firsttrc on in the next
+			     slot, if that is free. Returns the slot or -1 */
+    bool		isDone(int slot) const;
+    bool		getBatch(int slot,const SeisTrcBuf& inp,int firsttrc,
+				 SeisTrcBuf& outp);
+			/*!< Adds the output traces to outp, with the trace
+			     info of the input, and frees the slot */
+    bool		process(const SeisTrcBuf& inp,SeisTrcBuf& outp,
+				double timeout=60);
+			/*!< Keeps all slots busy until all traces are done.
+			     Fails if the external process does not finish
+			     any batch within timeout seconds; the slots are
+			     reset then */
+    void		reset();
+			//!< Frees all slots, dropping the pending batches
+    void		setShutdown();
+			//!< Tells the external process to stop
+
+    static const char*	sMagic()		{ return "ODTRCSHM"; }
+    static int		version()		{ return 2; }
+
+protected:
+
+    BufferString	name_;
+    uiString		errmsg_;
+    char*		data_			= nullptr;
+    od_int64		totsz_			= 0;
+    void*		maphandle_		= nullptr;
+    int			putslot_		= 0;
+    int			seqnr_			= 0;
+
+    Header&		header() const;
+    SlotHeader&		slotHeader(int) const;
+    od_int64		slotDataSize() const;
+    od_int32*		posData(int slot,bool trcnrs) const;
+    float*		sampleData(int slot,bool output,int comp) const;
+    SlotState		getState(int slot) const;
+    void		setState(int slot,SlotState);
+    bool		isStale(int slot) const;
+
+};
+
+} // namespace Attrib
@@ -11,6 +11,7 @@ ________________________________________________________________________
 #include "attributesmod.h"
 #include "attribprovider.h"
 #include "arrayndimpl.h"
+#include "odcomplex.h"
 
 namespace Attrib
 {
@@ -34,9 +35,18 @@ namespace Attrib
 
   The azimuthrange is tapered in the same way as bandpass.
 
+  Method selects how the kernel is applied. Direct convolves the non-zero
+  kernel taps with every stepout trace. Separable first stacks the stepout
+  traces and then filters along z, which is only possible if the kernel is
+  the product of a spatial and a z kernel. FFT applies the kernel in the
+  Fourier domain, in blocks of samples, which pays off for large kernels.
+  Auto picks the fastest one. Positions with undefined input values always
+  use Direct, so all methods give the same result.
+
 <pre>
 %DipFilter size= minvel= maxvel= type=LowPass|HighPass|BandPass
 	   filterazi=Y/N minazi= maxazi= taperlen=
+	   method=Auto|Direct|Separable|FFT
 
 type = HighPass
 	  x	x minvel > 0
@@ -87,7 +97,9 @@ public:
     static const char*	minaziStr()	{ return "minazi"; }
     static const char*	maxaziStr()	{ return "maxazi"; }
     static const char*	taperlenStr()	{ return "taperlen"; }
+    static const char*	methodStr()	{ return "method"; }
     static const char*	filterTypeNamesStr(int);
+    static const char*	methodNamesStr(int);
 
 protected:
 			~DipFilter();
@@ -106,6 +118,15 @@ protected:
     bool		initKernel();
     void		prepareForComputeData() override { initKernel(); }
     float		taper(float) const;
+    void		initMethod();
+    bool		getTrace(const DataHolder&,int z0,int nrsamples,
+				 float*) const;
+    void		computeDirect(const float* trcvals,int nrsamples,
+				      float* sums,float* wsums) const;
+    void		computeSeparable(const float* trcvals,int nrsamples,
+					 float* stack,float* sums) const;
+    bool		computeFFT(const float* trcvals,int nrsamples,
+				   float* sums) const;
 
     const BinID*		desStepout(int input,int output) const override;
     const Interval<int>*	desZSampMargin(int,int) const override;
@@ -120,8 +141,19 @@ protected:
     float			maxazi_;
     float			taperlen_;
     bool			isinited_;
+    int				method_;
+    int				usemethod_;
 
     Array3DImpl<float>		kernel_;
+    TypeSet<int>		firsttap_;
+    TypeSet<int>		taps_;
+    TypeSet<float>		tapweights_;
+    TypeSet<float>		trcweights_;
+				// Per stepout trace, index inl*size+crl
+    TypeSet<float>		spatialfactors_;
+    TypeSet<float>		zfactors_;
+    TypeSet<float_complex>	kernelspectra_;
+    int				fftsz_				= 0;
     Interval<float>		valrange_;
     float			azi_;
     float			aziaperture_;
@@ -52,6 +52,9 @@ protected:
 
     int				getInl() const;
     int				getCrl() const;
+    bool			computeAllSamples(const DataHolder&,int z0,
+						  int nrsamples,
+						  int threadidx) const;
 
 private:
     ObjectSet<const DataHolder>	inputdata_;
@@ -18,7 +18,7 @@ ________________________________________________________________________
 class SeisPSReader;
 class IOObj;
 
-namespace PreStack { class ProcessManager; }
+namespace PreStack { class GatherWindow; class ProcessManager; }
 
 
 namespace Attrib
@@ -118,6 +118,7 @@ protected:
     MultiID			psid_;
     IOObj*			psioobj_ = nullptr;
     SeisPSReader*		psrdr_ = nullptr;
+    PreStack::GatherWindow*	gatherwindow_ = nullptr;
     int				component_ = 0;
     PreStack::ProcessManager*	preprocessor_ = nullptr;
     PreStack::PropCalc*		propcalc_ = nullptr;
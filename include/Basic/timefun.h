@@ -28,6 +28,7 @@ namespace Time
 	void		start();
 	int		restart();		//!< Returns elapsed time in ms
 	int		elapsed() const;	//!< Returns elapsed time in ms
+	od_int64	elapsedUs() const;	//!< Returns elapsed time in us
 
     protected:
 
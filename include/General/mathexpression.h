@@ -10,6 +10,7 @@ ________________________________________________________________________
 
 #include "generalmod.h"
 #include "bufstringset.h"
+#include "typeset.h"
 #include "uistring.h"
 
 
@@ -79,6 +80,7 @@ protected:
     bool		isrecursive_ = false;
 
     friend class	ExpressionParser;
+    friend class	ExpressionProgram;
 
     void		doDump(BufferString&,int nrtabs) const;
     virtual void	dumpSpecifics(BufferString&,int nrtabs) const	{}
@@ -86,6 +88,72 @@ protected:
 };
 
 
+/*!
+\brief Expression lowered to a flat register program on arrays of values.
+
+  Each instruction processes complete arrays (e.g. a trace or a log), so the
+  tree of Expression nodes is walked only once, at compilation. Values are
+  evaluated in float precision, undefined values propagate as they do in
+  Expression::getValue(). The variable indices are those of the source
+  Expression. Expressions using random numbers cannot be compiled.
+-*/
+
+mExpClass(General) ExpressionProgram
+{
+public:
+
+    static ExpressionProgram* compile(const Expression&);
+			//!< returns null if the expression is not supported
+			~ExpressionProgram();
+
+    int			nrVariables() const	{ return nrvars_; }
+    int			nrInstructions() const
+			{ return instrs_.size(); }
+
+    void		execute(const float* const* vararrs,
+				const float* varvals,float* out,int sz) const;
+			/*!< For each variable, vararrs[ivar] points to sz
+			     values, or is null: then varvals[ivar] is used for
+			     all samples. vararrs may be null if all values
+			     are fixed. out must not overlap the input
+			     arrays. Thread-safe. */
+
+protected:
+
+			ExpressionProgram(int nrvars);
+
+    enum OpCode		{ Copy, Plus, Minus, Multiply, Divide, IntDivide,
+			  IntDivRest, Abs, Power, Condition, LessOrEqual, Less,
+			  MoreOrEqual, More, Equal, NotEqual, OR, AND, Sine,
+			  ArcSine, Cosine, ArcCosine, Tangent, ArcTangent,
+			  Log, NatLog, Exp, Sqrt, Min, Max, Sum, Median,
+			  Average, Variance };
+
+    struct Instruction
+    {
+	OpCode		opcode_;
+	int		dest_;
+	TypeSet<int>	srcs_;
+
+	bool		operator==( const Instruction& oth ) const
+			{ return opcode_==oth.opcode_ && dest_==oth.dest_
+			      && srcs_==oth.srcs_; }
+    };
+
+			/* Registers: variables, then constants. Temporaries
+			   get negative numbers: -1 is the first one. */
+    const int		nrvars_;
+    TypeSet<float>	constvals_;
+    int			nrtemps_	= 0;
+    TypeSet<Instruction> instrs_;
+    int			outreg_		= -1;
+
+    int			addNode(const Expression&,const Expression& root,
+				TypeSet<int>& freetemps);
+
+};
+
+
 /*!
 \brief Parses a string with a mathematical expression.
 
@@ -24,6 +24,7 @@ namespace Math
 {
 
 class Expression;
+class ExpressionProgram;
 class SpecVarSet;
 
 class Formula;
@@ -186,6 +187,15 @@ public:
     double		getValue(const double*) const;
 			/*!< You may annotate the units of incoming values,
 			     and require the conversion of the output value */
+    bool		getValues(const float* const* valarrs,
+				  const float* vals,float* out,int sz) const;
+			/*!< Evaluates sz samples at once, using a compiled
+			     version of the expression. For each of the
+			     nrValues2Provide() values, either valarrs[idx]
+			     points to sz values, or it is null and vals[idx]
+			     is used for all samples. Returns false if the
+			     formula cannot be compiled (e.g. when recursive):
+			     use getValue() for each sample then. */
 
 		// 5. store/retrieve to/from IOPar
 
@@ -253,6 +263,8 @@ protected:
     const bool		inputsareseries_;
 
     Expression*		expr_ = nullptr;
+    mutable ExpressionProgram* prog_ = nullptr;
+    mutable bool	progdone_ = false;
 
 			// length: expr_->nrVariables()
     TypeSet<int>	inpidxs_;
@@ -114,6 +114,13 @@ public:
 					  double t0=0.) const;
 			/*!< Converts velocities between compatible types
 			     May also switch the units if different */
+    bool		convertVelocities(double* vels,int nrtrcs,
+					  const ZValueSeries& zvals,
+					  const VelocityDesc& newdesc,
+					  double t0=0.) const;
+			/*!< Same, in place, for nrtrcs traces of zvals.size()
+			     samples stored one after the other. The Z values
+			     and the unit scalers are only evaluated once */
 
     bool		sampleVelocities(const ValueSeries<double>& Vin,
 					 const ZValueSeries& zvals_in,
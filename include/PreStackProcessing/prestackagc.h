@@ -38,12 +38,17 @@ public:
 
     void			setLowEnergyMute(float fraction);
     float			getLowEnergyMute() const;
+    void			setIgnoreZeros(bool yn);
+				//!< Leaves exact zeros, e.g. muted samples,
+				//!< out of the energy in the window
+    bool			ignoreZeros() const;
 
     void			fillPar(IOPar&) const override;
     bool			usePar(const IOPar&) override;
 
     static const char*		sKeyWindow();
     static const char*		sKeyMuteFraction();
+    static const char*		sKeyIgnoreZeros();
 
 protected:
     bool			doWork(od_int64,od_int64,int) override;
@@ -52,6 +57,7 @@ protected:
     Interval<float>		window_;
     Interval<int>		samplewindow_;
     float			mutefraction_ = 0.f;
+    bool			ignorezeros_ = false;
     int				totalnr_ = -1;
 };
 
@@ -0,0 +1,104 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackprocessingmod.h"
+
+#include "bufstringset.h"
+#include "manobjectset.h"
+#include "raytrace1d.h"
+#include "reflectivitymodel.h"
+#include "threadlock.h"
+
+class ElasticModel;
+
+namespace PreStack
+{
+
+class AngleModelCache;
+
+mGlobal(PreStackProcessing) AngleModelCache& AMC();
+
+
+/*!
+\brief Cache of ray traced models, shared by the angle computers and the
+angle mutes.
+
+  Neighbouring CDPs often have the same velocity profile. The models are
+  therefore keyed by a hash of their layers, the offsets and the ray tracer
+  parameters; on a hash match the layers and parameters are compared before
+  the stored model is used. Only the models that are not in the cache are
+  ray traced, all in one parallel run over models and layers. The least
+  recently used models are removed first.
+
+  By default the layers must match exactly. With setQuanta, layers that
+  differ less than a quantum may share a model, which trades accuracy for
+  more reuse.
+*/
+
+mExpClass(PreStackProcessing) AngleModelCache
+{ mODTextTranslationClass(AngleModelCache)
+public:
+
+    bool		getRefModels(const ObjectSet<const ElasticModel>&,
+				     const TypeSet<float>& offsets,
+				     Seis::OffsetType,const IOPar& raypars,
+				     const RayTracer1D::Setup&,
+			RefObjectSet<const OffsetReflectivityModel>&,
+				     uiString& errmsg,bool parallel=true);
+			/*!< Gets one model per input model. Can be used
+			     from several threads at a time */
+    ConstRefMan<OffsetReflectivityModel> getRefModel(const ElasticModel&,
+				     const TypeSet<float>& offsets,
+				     Seis::OffsetType,const IOPar& raypars,
+				     const RayTracer1D::Setup&,
+				     uiString& errmsg,bool parallel=true);
+
+    void		setQuanta(float thickness,float vel,float den);
+			/*!< In m, m/s and kg/m3: layer properties are rounded
+			     to these before matching. 0 (the default) only
+			     matches exact values */
+    void		setMaxNrModels(int);
+    int			maxNrModels() const	{ return maxnrmodels_; }
+    int			nrModels() const;
+    void		clear();
+
+    static const char*	sKeyMaxNrModels();
+
+protected:
+
+    od_uint64		getKey(const ElasticModel&,od_uint64 parskey) const;
+    static BufferString	getParsString(const TypeSet<float>& offsets,
+				      Seis::OffsetType,const IOPar& raypars,
+				      const RayTracer1D::Setup&);
+    bool		isSame(const ElasticModel&,
+			       const ElasticModel&) const;
+    int			indexOf(od_uint64,const ElasticModel&,
+				const char* parsstr) const;
+    void		limitSize();
+    void		removeAll();
+
+    TypeSet<od_uint64>	keys_;
+    ManagedObjectSet<ElasticModel> emodels_;
+    BufferStringSet	parsstrs_;
+    RefObjectSet<const OffsetReflectivityModel> models_;
+    TypeSet<od_int64>	stamps_;
+    od_int64		curstamp_		= 0;
+    int			maxnrmodels_		= 128;
+    float		thicknessquantum_	= 0.f;
+    float		velquantum_		= 0.f;
+    float		denquantum_		= 0.f;
+    mutable Threads::Lock lock_;
+
+public:
+			AngleModelCache();
+			~AngleModelCache();
+};
+
+} // namespace PreStack
@@ -17,7 +17,6 @@ ________________________________________________________________________
 
 class ElasticModel;
 class Muter;
-class RayTracerRunner;
 class ReflectivityModelBase;
 
 namespace PreStack
@@ -70,7 +69,6 @@ protected:
 
     AngleCompParams*	params_ = nullptr;
     RefMan<Vel::VolumeFunctionSource>	velsource_;
-    ObjectSet<RayTracerRunner>	rtrunners_;
 };
 
 
@@ -119,6 +117,12 @@ private:
 
     bool		doPrepare(int nrthreads) override;
     bool		doWork(od_int64,od_int64,int) override;
+    bool		muteBatch(const TypeSet<int>& idxs,
+				  const ObjectSet<const ElasticModel>&,
+				  const TypeSet<float>& offsets,
+				  Seis::OffsetType,Muter&);
+    void		applyMute(int idx,const ReflectivityModelBase&,
+				  const TypeSet<float>& offsets,Muter&);
 
     bool		raytraceparallel_;
     ObjectSet<Muter>	muters_;
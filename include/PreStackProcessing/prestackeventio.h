@@ -27,6 +27,7 @@ namespace PreStack
 
 class EventManager;
 class EventPatchReader;
+class EventStore;
 class EventPatchWriter;
 
 /*!
@@ -93,6 +94,7 @@ protected:
     const TrcKeySampling*			horsel_ = nullptr;
 
     ObjectSet<EventPatchReader>			patchreaders_;
+    EventStore*					store_ = nullptr;
 
     uiString					errmsg_;
     bool					trigger_;
@@ -114,16 +116,24 @@ public:
     uiString		uiMessage() const override
 			{ return tr("Storing events"); }
 
+    void		setIndexedStore( bool yn )	{ indexedstore_ = yn; }
+			/*!<Whether new event sets go to an EventStore.
+			    Existing sets keep their format. The default is
+			    taken from the settings. */
+    static const char*	sKeyIndexedStore();
 
 protected:
 
     bool			writeAuxData(const char* fnm);
+    bool			useIndexedStore(const char* dirnm) const;
+    bool			writeStore(const char* dirnm);
 
     ObjectSet<EventPatchWriter> patchwriters_;
     IOObj*			ioobj_;
     IOPar			auxinfo_;
     EventManager&		eventmanager_;
     uiString			errmsg_;
+    bool			indexedstore_	= true;
 };
 
 
@@ -0,0 +1,100 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackprocessingmod.h"
+
+#include "bufstring.h"
+#include "position.h"
+#include "uistring.h"
+
+class BinIDValueSet;
+class TrcKeySampling;
+
+namespace PreStack
+{
+
+class Event;
+class EventManager;
+class EventStoreColumns;
+
+/*!
+\brief Binary, indexed storage of all PreStack events of an EventManager in
+one file.
+
+  The file starts with a header, followed by the positions sorted on in-line
+  and cross-line, each with the index of its first event. Then follow the
+  columns of the events (first pick, horizon id, quality and type), and the
+  columns of the picks (depth, quality, offset and azimuth). All sections are
+  8 byte aligned, in native byte order.
+
+  The file is memory-mapped when read: the events of a position are found by
+  a binary search on the positions, without reading the rest of the file.
+  The file is written in parallel over the positions, directly into a
+  mapping of the new file.
+*/
+
+mExpClass(PreStackProcessing) EventStore
+{ mODTextTranslationClass(EventStore)
+public:
+			EventStore(const char* fnm);
+			~EventStore();
+			mOD_DisableCopy(EventStore)
+
+    bool		isOK() const		{ return data_; }
+    const uiString&	errMsg() const		{ return errmsg_; }
+    const char*		fileName() const	{ return filename_.buf(); }
+
+    od_int64		nrPositions() const	{ return nrpos_; }
+    od_int64		nrEvents() const	{ return nrevents_; }
+    od_int64		nrPicks() const		{ return nrpicks_; }
+
+    BinID		getBinID(od_int64 posidx) const;
+    od_int64		indexOf(const BinID&) const;
+			//!<Binary search, -1 if not present
+    void		getPositions(BinIDValueSet&) const;
+    bool		getRange(TrcKeySampling&) const;
+
+    int			nrEvents(od_int64 posidx) const;
+    od_int64		nrPicks(od_int64 posidx) const;
+    bool		getEvents(od_int64 posidx,ObjectSet<Event>&) const;
+			//!<Can be used from several threads at a time
+    bool		load(EventManager&,const BinIDValueSet* =nullptr,
+			     const TrcKeySampling* =nullptr) const;
+			/*!<Loads the selected positions, all if there is
+			    no selection, in parallel. Positions with changed
+			    events in the manager are skipped. */
+
+    static bool		write(const char* fnm,EventManager&,EventStore* prev,
+			      uiString& errmsg);
+			/*!<Writes all events with picks of the manager. At
+			    the positions where the manager has no changed
+			    events, the events of prev are kept. prev becomes
+			    mine, and is closed before the new file replaces
+			    the old one. If that fails, the old file is kept
+			    or restored. */
+
+    static const char*	sFileName()		{ return "events.psstore"; }
+
+protected:
+
+    friend class	EventStoreWriter;
+
+    BufferString	filename_;
+    char*		data_			= nullptr;
+    od_int64		datasize_		= 0;
+    void*		maphandle_		= nullptr;
+    od_int64		nrpos_			= 0;
+    od_int64		nrevents_		= 0;
+    od_int64		nrpicks_		= 0;
+    EventStoreColumns&	columns_;
+    uiString		errmsg_;
+};
+
+} // namespace PreStack
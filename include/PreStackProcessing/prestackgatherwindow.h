@@ -0,0 +1,66 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackprocessingmod.h"
+
+#include "position.h"
+#include "refcount.h"
+#include "typeset.h"
+
+class IOObj;
+class SeisPSReader;
+
+namespace PreStack
+{
+
+class Gather;
+
+/*!
+\brief Keeps the gathers around a position that moves through a data store.
+
+  The gathers within the stepout of the current center are kept. When the
+  center moves to the next cross-line or in-line, only the gathers of the new
+  column or row are read, and the ones that left the window are released.
+  Positions without a gather are remembered, and are not read again.
+*/
+
+mExpClass(PreStackProcessing) GatherWindow
+{
+public:
+			GatherWindow(const IOObj&,SeisPSReader&,int comp=0);
+			~GatherWindow();
+			mOD_DisableCopy(GatherWindow)
+
+    void		setStepout(const BinID& stepout,const BinID& step);
+			//!<In nr of positions, and the step between them
+    void		setCenter(const BinID&);
+			//!<Releases the gathers outside the new window
+
+    ConstRefMan<Gather>	getGather(const BinID&);
+			//!<Reads the gather if not yet present
+    int			nrGathers() const	{ return gathers_.size(); }
+    void		clear();
+
+protected:
+
+    bool		isInWindow(const BinID&) const;
+
+    const IOObj&	ioobj_;
+    SeisPSReader&	reader_;
+    int			comp_;
+    BinID		stepout_;
+    BinID		step_;
+    BinID		center_;
+
+    TypeSet<BinID>	bids_;
+    RefObjectSet<Gather> gathers_;
+};
+
+} // namespace PreStack
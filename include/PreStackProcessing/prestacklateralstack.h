@@ -10,6 +10,7 @@ ________________________________________________________________________
 
 #include "prestackprocessingmod.h"
 
+#include "manobjectset.h"
 #include "multiid.h"
 #include "offsetazimuth.h"
 #include "prestackprocessor.h"
@@ -19,6 +20,11 @@ namespace PreStack
 
 /*!
 \brief Lateral stack
+
+  For a rectangular pattern around a single output, the sums of each column
+  of the pattern are kept. When the inputs are those of the previous output
+  shifted by one cross-line, as when processing along an in-line with a
+  sliding GatherWindow, only the new column is stacked.
 */
 
 mExpClass(PreStackProcessing) LateralStack : public Processor
@@ -52,6 +58,10 @@ public:
 protected:
     bool		isInPattern(const BinID&) const;
     bool		processOutput( const OffsetAzimuth&,const BinID&);
+    void		prepareRunningStack(const Gather& center);
+    bool		processRunningStack(int offsetidx);
+    void		stackColumn(int col,int offsetidx);
+    void		clearRunningStack();
     static const char*	sKeyStepout()		{ return "Stepout"; }
     static const char*	sKeyCross()		{ return "Is cross"; }
 
@@ -65,6 +75,16 @@ protected:
     bool		iscross_ = true;
 
     TypeSet<OffsetAzimuth>	offsetazi_;
+
+    RefObjectSet<Gather>	stackgathers_;
+    TypeSet<OffsetAzimuth>	stackoffsetazi_;
+    ManagedObjectSet<TypeSet<double> >	colsums_;
+    ManagedObjectSet<TypeSet<int> >	colcounts_;
+    TypeSet<double>		totsums_;
+    TypeSet<int>		totcounts_;
+    int				nrz_ = 0;
+    bool			userunningstack_ = false;
+    bool			shiftstack_ = false;
 };
 
 } // namespace PreStack
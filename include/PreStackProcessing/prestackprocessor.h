@@ -192,6 +192,10 @@ public:
     static const char*		sKeyCDPRange(){ return "CDP Range"; }
     static const char*		sKeyInputData() { return "Input"; }
     static const char*		sKeyOutputData(){ return "Output"; }
+    static const char*		sKeyNrParallelGathers()
+				{ return "Nr parallel gathers"; }
+				/*!<Output positions processed concurrently,
+				    each with its own copy of the chain */
 
 
 protected:
@@ -68,6 +68,8 @@ protected:
     TypeSet<Iteration>		iterations_;
     int				output_ = 2;
     ObjectSet<Array1D<float> >	pilottrcs_;
+    TypeSet<float>		shifts_;
+    TypeSet<float>		shiftedtrcs_;
 
     od_int64			nrIterations() const override;
     bool			doWork(od_int64,od_int64,int) override;
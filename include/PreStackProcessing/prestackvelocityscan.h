@@ -0,0 +1,133 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackprocessingmod.h"
+
+#include "executor.h"
+#include "ranges.h"
+#include "refcount.h"
+#include "trckeysampling.h"
+
+class IOObj;
+class SeisPS3DReader;
+class SeisTrcWriter;
+template <class T> class Array2D;
+
+namespace PreStack
+{
+
+class Gather;
+
+/*!
+\brief Computes velocity-by-time semblance panels of uncorrected gathers.
+
+  All trial velocities of a gather are scanned in one call. The gather is
+  converted once to contiguous traces and the squared zero-offset times are
+  tabulated, so each trial curve only needs the moveout of the offsets. For
+  each offset, the range of output samples within the data and within the
+  stretch limit is determined beforehand, which leaves inner loops over the
+  time samples without branches.
+
+  The semblance at t0 is the sum over the window of the squared stack, divided
+  by the sum over the window of the number of contributing traces times the
+  sum of squares.
+*/
+
+mExpClass(PreStackProcessing) VelocityScanner
+{ mODTextTranslationClass(VelocityScanner)
+public:
+			VelocityScanner();
+			~VelocityScanner();
+
+    void		setVelocityRange( const StepInterval<float>& rg )
+			{ velrg_ = rg; }
+    const StepInterval<float>& velocityRange() const { return velrg_; }
+    int			nrVelocities() const;
+
+    void		setWindowSize( int nrsamples )
+			{ winsz_ = nrsamples; }
+			//!< Number of samples around t0, odd
+    int			windowSize() const	{ return winsz_; }
+    void		setMaxStretch( float maxstretch )
+			{ maxstretch_ = maxstretch; }
+			/*!< Relative NMO stretch beyond which samples are
+			     left out; udf for no limit */
+    float		maxStretch() const	{ return maxstretch_; }
+
+    bool		computePanel(const Gather&,Array2D<float>& panel,
+				     bool parallel=true) const;
+			/*!< panel must be sized nrVelocities() by the number
+			     of samples of the gather. Can be used from several
+			     threads at a time. */
+    float		pickVelocity(const Array2D<float>& panel,
+				     int zidx) const;
+			/*!< The velocity with the highest semblance at this
+			     sample; udf if the semblance is zero */
+
+    void		fillPar(IOPar&) const;
+    bool		usePar(const IOPar&);
+
+    static const char*	sKeyVelocityRange()	{ return "Velocity range"; }
+    static const char*	sKeyWindowSize()	{ return "Window size"; }
+    static const char*	sKeyMaxStretch()	{ return "Max stretch"; }
+
+protected:
+
+    StepInterval<float> velrg_;
+    int			winsz_			= 5;
+    float		maxstretch_		= 0.5f;
+
+};
+
+
+/*!
+\brief Computes the semblance cube of a prestack volume.
+
+  The output is a post-stack volume with one component per trial velocity,
+  named after the velocity: component iv holds the semblance of velocity iv
+  at every position and time. The gathers are read in batches, and the panels
+  of a batch are computed concurrently. Used by od_process_velscan.
+*/
+
+mExpClass(PreStackProcessing) VelocityScanVolume : public Executor
+{ mODTextTranslationClass(VelocityScanVolume)
+public:
+			VelocityScanVolume(const VelocityScanner&,
+					   const IOObj& input,
+					   const IOObj& output,
+					   const TrcKeySampling&);
+			~VelocityScanVolume();
+
+    bool		isOK() const;
+
+    od_int64		nrDone() const override		{ return nrdone_; }
+    od_int64		totalNr() const override	{ return totalnr_; }
+    uiString		uiMessage() const override	{ return msg_; }
+    uiString		uiNrDoneText() const override;
+
+protected:
+
+    int			nextStep() override;
+    bool		writePanel(const Gather&,const Array2D<float>&);
+
+    const VelocityScanner& scanner_;
+    IOObj*		inputioobj_;
+    SeisPS3DReader*	reader_			= nullptr;
+    SeisTrcWriter*	writer_			= nullptr;
+    TrcKeySampling	tks_;
+    TrcKeySamplingIterator iter_;
+    int			batchsize_;
+    od_int64		nrdone_			= 0;
+    od_int64		totalnr_;
+    uiString		msg_;
+
+};
+
+} // namespace PreStack
@@ -18,4 +18,7 @@ struct ProcessTime2Depth
     static const char*	sKeyOutputVolume()	{ return "Output volume"; }
     static const char*	sKeyZTransPar()		{ return "ZTrans"; }
     static const char*	sKeyIsTimeToDepth()	{ return "Time to depth"; }
+    static const char*	sKeyBatchSize()		{ return "Trace batch size"; }
+			//!< See SeisZAxisStretcher::setBatchSize()
+    static int		defBatchSize()		{ return 64; }
 };
@@ -27,6 +27,7 @@ namespace IO
     inline const char* sKeyIndex3DVol()	{ return "Index 3D Volume"; }
     inline const char* sKeyIs2D()	{ return "Is 2D"; }
     inline const char* sKeyNullTrcPol()	{ return "Null trace policy"; }
+    inline const char* sKeySortInput()	{ return "Sort input"; }
     inline const char* sKeyTask()	{ return "Task"; }
 
 } // namespace IO
@@ -12,6 +12,7 @@ ________________________________________________________________________
 
 #include "bufstring.h"
 #include "executor.h"
+#include "manobjectset.h"
 #include "seisstor.h"
 
 class IOObj;
@@ -67,9 +68,22 @@ public:
 
     int			nextStep() override;
 
+    void		setPipelined( bool yn )		{ pipelined_ = yn; }
+			/*!< Fetch the traces in a separate thread, ahead of
+			     the sorting checks and the writing. Reading,
+			     decoding and resampling then run concurrently with
+			     the output. Set before the first nextStep(). */
+    void		setSortInput(bool yn,int maxnrtrcsinmem=-1);
+			/*!< Accept 3D post-stack input in any order, and write
+			     it inline/crossline sorted. Input that does not
+			     fit in maxnrtrcsinmem traces is sorted in runs that
+			     are spilled to temporary files, and merged at the
+			     end. The default limit depends on the free
+			     memory. */
+
 protected:
 
-    enum State			{ ReadBuf, WriteBuf, ReadWrite };
+    enum State			{ ReadBuf, WriteBuf, ReadWrite, MergeRuns };
 
     Reader*			rdr_;
     SeisTrcWriter&		wrr_;
@@ -89,13 +103,38 @@ protected:
     int				nrwritten_ = 0;
     int				nrskipped_ = 0;
 
+    bool			pipelined_ = false;
+    int				readqueueid_ = -1;
+    Threads::ConditionVar&	readlock_;
+    SeisTrcBuf&			readbuf_;
+    bool			readdone_ = false;
+    bool			stopreading_ = false;
+
+    bool			sortinput_ = false;
+    int				maxnrtrcsinmem_ = -1;
+    int				nrsamepos_ = 0;
+    BufferString		rundirnm_;
+    ManagedObjectSet<IOObj>	runioobjs_;
+    ObjectSet<SeisTrcReader>	runrdrs_;
+    ObjectSet<SeisTrc>		runtrcs_;
+
     bool			goImpl(od_ostream*,bool,bool,int) override;
 
     bool			sortingOk(const SeisTrc&);
+    bool			sortedTrcOk(const SeisTrc&);
     int				doWrite(SeisTrc&);
     int				readIntoBuf();
+    bool			fetch(SeisTrc&);
+    void			startReading();
+    void			stopReading();
+    void			readAhead();
+    bool			spillRun();
+    bool			openRuns();
+    int				writeFromRuns();
+    void			removeRuns();
 
     friend			class SeisImporterWriterTask;
+    friend			class SeisImporterReaderTask;
     void			reportWrite(const uiString&);
 
     mutable uiString		errmsg_;
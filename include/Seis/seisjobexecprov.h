@@ -16,6 +16,7 @@ ________________________________________________________________________
 #include "sets.h"
 #include "uistring.h"
 #include <iosfwd>
+class BufferStringSet;
 class IOObj;
 class Executor;
 class CtxtIOObj;
@@ -92,6 +93,7 @@ protected:
     JobDescProv*	mk2DJobProv();
     JobDescProv*	mk3DJobProv(int ninlperjob);
     void		getMissingLines(TypeSet<int>&) const;
+    void		getTempFiles(BufferStringSet&) const;
     MultiID		tempStorID() const;
 
 };
@@ -13,7 +13,10 @@ ________________________________________________________________________
 #include "binid.h"
 #include "samplingdata.h"
 
+class BufferStringSet;
+class IOObj;
 class Scaler;
+class SeisSequentialWriter;
 class SeisTrc;
 class SeisTrcBuf;
 class SeisTrcReader;
@@ -66,3 +69,66 @@ protected:
     int				writeFromBuf();
 
 };
+
+
+/*!\brief Merges 3D post-stack data using multiple threads.
+
+  All inputs are read concurrently into look-ahead buffers. The positions are
+  then merged in inline/crossline order (a k-way merge: every input must be
+  sorted as a regular 3D cube). Overlapping traces are stacked or selected in
+  parallel, and the results are written through a SeisSequentialWriter.
+*/
+
+mExpClass(Seis) SeisParallelMerger : public Executor
+{ mODTextTranslationClass(SeisParallelMerger);
+public:
+
+			SeisParallelMerger(const ObjectSet<IOPar>& in,
+					   const IOPar& out);
+			SeisParallelMerger(const BufferStringSet& infnms,
+					   const IOObj& out,
+					   const IOPar* outpars=nullptr);
+			//!< For post-processing of temporary storage files
+			~SeisParallelMerger();
+
+    uiString		uiMessage() const override;
+    od_int64		nrDone() const override		{ return nrpos_; }
+    od_int64		totalNr() const override	{ return totnrpos_; }
+    uiString		uiNrDoneText() const override
+			{ return tr("Positions handled"); }
+    int			nextStep() override;
+
+    void		setScaler(Scaler*);
+    void		setLookAhead(int nrtrcs);
+			//!< Traces buffered per input, default 64
+
+    bool		stacktrcs_	= true;
+			//!< If not, first non-null trace will be used
+
+protected:
+
+    ObjectSet<SeisTrcReader>	rdrs_;
+    ObjectSet<SeisTrcBuf>	bufs_;
+    BoolTypeSet			atend_;
+    SeisTrcWriter*		wrr_		= nullptr;
+    SeisSequentialWriter*	seqwrr_		= nullptr;
+    Scaler*			scaler_		= nullptr;
+    int				lookahead_	= 64;
+    int				nrsamps_	= -1;
+    SamplingData<float>		sd_;
+    od_int64			nrpos_		= 0;
+    od_int64			totnrpos_	= -1;
+    uiString			errmsg_;
+
+    bool			addReader(SeisTrcReader*);
+    void			setTotalNr();
+    void			setOutput(const IOObj&,const IOPar*);
+    bool			fillBuffers();
+    void			getNextBatch(ObjectSet<SeisTrcBuf>&);
+    bool			writeBatch(ObjectSet<SeisTrcBuf>&);
+    int				finish();
+
+    friend class		SeisParallelMergerReader;
+    friend class		SeisParallelMergerStacker;
+
+};
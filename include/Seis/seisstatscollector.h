@@ -11,8 +11,12 @@ ________________________________________________________________________
 #include "seiscommon.h"
 #include "trckeyzsampling.h"
 #include "datadistribution.h"
+#include "paralleltask.h"
+#include "posinfo.h"
 
+class IOObj;
 class SeisTrc;
+class SeisTrcReader;
 namespace Stats { class RandGen; }
 
 namespace Seis
@@ -31,7 +35,9 @@ public:
     void		setEmpty();
 
     void		useTrace(const SeisTrc&);
+    void		merge(const StatsCollector&);
     od_int64		nrSamplesUsed() const	{ return nrvalshandled_; }
+    od_int64		nrTracesUsed() const	{ return nrtrcshandled_; }
 
     const TrcKeyZSampling& trcKeyZSampling() const	{ return tkzs_; }
     DistribType&	distribution();
@@ -65,4 +71,63 @@ protected:
 
 };
 
+
+/*!\brief Collects the statistics of a stored 3D seismic data set in
+  parallel.
+
+  A stratified random subset of the traces is used: the positions are split
+  in equally sized strata, with one random trace from each. Null traces are
+  skipped. Each thread uses its own reader; the translator must support
+  goTo(). The result is written to the .stats file of the data set, as a
+  partial scan.
+*/
+
+mExpClass(Seis) ParallelStatsCollector : public ParallelTask
+{ mODTextTranslationClass(ParallelStatsCollector);
+public:
+
+			ParallelStatsCollector(const IOObj&,int icomp=-1);
+			~ParallelStatsCollector();
+
+    void		setNrSampledTraces( int nr )	{ nrsampled_ = nr; }
+			//!< Default (-1) depends on the trace length
+
+    bool		executeParallel(bool) override;
+
+    const StatsCollector& result() const	{ return *result_; }
+    StatsCollector&	result()		{ return *result_; }
+
+    uiString		uiMessage() const override	{ return msg_; }
+    uiString		uiNrDoneText() const override
+			{ return sTrcFinished(); }
+
+    static const char*	sKeyPartialScan()	{ return "Partial Scan"; }
+
+protected:
+
+    od_int64		nrIterations() const override;
+    bool		doPrepare(int) override;
+    bool		doWork(od_int64,od_int64,int) override;
+    bool		doFinish(bool) override;
+
+    bool		init();
+    BinID		getBinID(od_int64 globalidx) const;
+    bool		writeStats() const;
+
+    IOObj*		ioobj_;
+    const int		icomp_;
+    int			nrsampled_	= -1;
+
+    PosInfo::CubeData	cd_;
+    TypeSet<od_int64>	linestarts_;
+    od_int64		totalnrpos_	= 0;
+    TypeSet<od_int64>	sampledidxs_;
+
+    ObjectSet<SeisTrcReader>	rdrs_;
+    ObjectSet<StatsCollector>	collectors_;
+    StatsCollector*	result_;
+    uiString		msg_;
+
+};
+
 } // namespace Seis
@@ -0,0 +1,167 @@
+#pragma once
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "seismod.h"
+
+#include "binid.h"
+#include "callback.h"
+#include "manobjectset.h"
+#include "multiid.h"
+#include "paralleltask.h"
+#include "ranges.h"
+#include "refcount.h"
+#include "thread.h"
+#include "trckeysampling.h"
+
+class IOObj;
+class SeisTrc;
+class SeisTrcBuf;
+class SeisTrcReader;
+
+namespace Seis
+{
+
+/*!\brief A rectangular tile of stored 3D traces, for one component. */
+
+mExpClass(Seis) TraceTile : public ReferencedObject
+{
+public:
+			TraceTile(const MultiID&,const BinID& tileidx,
+				  int comp);
+
+    const MultiID&	dbKey() const		{ return key_; }
+    const BinID&	tileIdx() const		{ return tileidx_; }
+    int			component() const	{ return comp_; }
+
+    const SeisTrc*	get(const BinID&) const;
+    void		add(SeisTrc*);		//!< becomes mine
+    od_int64		memSize() const		{ return memsize_; }
+
+protected:
+			~TraceTile();
+
+    const MultiID	key_;
+    const BinID		tileidx_;
+    const int		comp_;
+    SeisTrcBuf&		trcs_;
+    od_int64		memsize_	= 0;
+
+};
+
+
+/*!\brief Memory-capped cache of stored 3D traces, grouped in tiles.
+
+  Entries are keyed by data set, tile and component. When the memory limit is
+  exceeded, the least recently used tiles are dropped. Tiles of a data set
+  are dropped as well when it is rewritten. Thread-safe; use Seis::TTC().
+*/
+
+mExpClass(Seis) TraceTileCache : public CallBacker
+{
+public:
+
+    static int		tileSize()		{ return 8; }
+			//!< In inlines and crosslines
+    static BinID	tileIdxOf(const BinID&);
+    static TrcKeySampling tileSampling(const BinID& tileidx,
+				       const BinID& step);
+
+    void		setMaxMemory(od_int64 nrbytes);
+    od_int64		maxMemory() const	{ return maxmem_; }
+    od_int64		memoryUsage() const;
+
+    RefMan<TraceTile>	get(const MultiID&,const BinID& tileidx,int comp);
+			//!< returns null if not present
+    void		add(TraceTile&);
+    void		remove(const MultiID&);
+    void		clear();
+
+protected:
+
+    struct Entry
+    {
+			Entry(TraceTile&,od_int64 stamp);
+			~Entry();
+
+	RefMan<TraceTile>	tile_;
+	od_int64		stamp_;
+    };
+
+    ManagedObjectSet<Entry>	entries_;
+    od_int64			maxmem_;
+    od_int64			memusage_	= 0;
+    od_int64			curstamp_	= 0;
+    mutable Threads::Lock	lock_;
+
+    int				indexOf(const MultiID&,const BinID&,
+					int comp) const;
+    void			limitMemory();
+    void			implUpdatedCB(CallBacker*);
+    void			surveyChangeCB(CallBacker*);
+
+public:
+				TraceTileCache();
+				~TraceTileCache();
+};
+
+mGlobal(Seis) TraceTileCache& TTC();
+
+
+/*!\brief Reads the traces along an arbitrary path, through the tile cache.
+
+  The requested positions are grouped in tiles; the tiles that are not
+  cached are read in parallel, in inline/crossline order, with one reader per
+  thread; the data store must support reading at random positions. The
+  output buffer gets a copy of the trace at each path position (or nothing
+  if not present), optionally restricted to a Z range.
+*/
+
+mExpClass(Seis) PathTraceReader : public ParallelTask
+{ mODTextTranslationClass(PathTraceReader);
+public:
+			PathTraceReader(const IOObj&,const TrcKeySet& path,
+					SeisTrcBuf& output,int comp=-1);
+			~PathTraceReader();
+
+    void		setZRange( const Interval<float>& zrg )
+			{ zrg_ = zrg; }
+
+    uiString		uiMessage() const override	{ return msg_; }
+    uiString		uiNrDoneText() const override;
+
+protected:
+
+    od_int64		nrIterations() const override
+			{ return tilestoread_.size(); }
+    bool		doPrepare(int) override;
+    bool		doWork(od_int64,od_int64,int) override;
+    bool		doFinish(bool) override;
+
+    SeisTrcReader*	createReader();
+    SeisTrcReader*	getReader();
+    void		releaseReader(SeisTrcReader*);
+
+    IOObj*		ioobj_;
+    const TrcKeySet&	path_;
+    SeisTrcBuf&		output_;
+    const int		comp_;
+    Interval<float>	zrg_;
+    BinID		step_;
+    uiString		msg_;
+
+    TypeSet<BinID>		tilestoread_;
+    RefObjectSet<TraceTile>	tiles_;
+    ObjectSet<SeisTrcReader>	rdrs_;
+    Threads::Lock		tileslock_;
+    Threads::Lock		rdrslock_;
+
+};
+
+} // namespace Seis
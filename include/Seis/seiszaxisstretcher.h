@@ -19,13 +19,12 @@ ________________________________________________________________________
 
 class IOObj;
 class SeisTrc;
+class SeisTrcBuf;
 class SeisTrcReader;
 class SeisTrcWriter;
 class SeisSequentialWriter;
 class VelocityDesc;
-class ZAxisTransformSampler;
 namespace Vel { class Worker; }
-template <class yT,class xT> class MathFunction;
 
 
 /*!
@@ -54,6 +53,12 @@ public:
     uiString		uiNrDoneText() const override;
 
     void		setUdfVal(float val);
+    void		setBatchSize(int nrtrcs);
+			/*!< Each thread reads tiles of nrtrcs traces and
+			     computes the z mapping of the whole tile before
+			     resampling it. The output is the same as with one
+			     trace at a time, which is the default (0). Only
+			     for non-velocity data. */
 
     mDeprecated("GeomID is read from outcs in constructor")
     void		setGeomID(Pos::GeomID);
@@ -74,10 +79,10 @@ private:
     bool		doFinish(bool) override;
 
     bool		getInputTrace(SeisTrc&);
+    bool		getInputTraces(SeisTrcBuf&,int maxnrtrcs);
+    bool		doWorkBatched();
     bool		loadTransformChunk(int firstinl);
-    void		stretch(const SeisTrc&,int icomp,
-				const MathFunction<float,float>& intrcfunc,
-				ZAxisTransformSampler&,float* tmpptr,
+    void		stretch(SeisTrc&,const float* zvals,float* tmpptr,
 				SeisTrc&) const;
     bool		selfStretchVelocity(const SeisTrc&,int icomp,
 					    SeisTrc&) const;
@@ -106,6 +111,8 @@ private:
     const bool				ist2d_;
     Seis::GeomType			geomtype_;
     float				udfval_		= mUdf(float);
+    int					batchsize_	= 0;
+    SeisTrc*				pendingtrc_	= nullptr;
 
     Vel::Worker*			worker_		= nullptr;
     Vel::Worker*			vintworker_	= nullptr;
@@ -11,6 +11,7 @@ ________________________________________________________________________
 #include "velocitymod.h"
 
 #include "binidvalset.h"
+#include "manobjectset.h"
 #include "thread.h"
 #include "velocityfunction.h"
 
@@ -24,7 +25,9 @@ namespace Vel
 class GriddedSource;
 
 /*!A velocity funcion where the velocity is computed from
-   Residual Moveout picks. */
+   Residual Moveout picks. Unless the gridder weights depend on the values,
+   the weights are taken from the source, and the gridder of the function
+   does not need the input points. */
 
 mExpClass(Velocity) GriddedFunction : public Function
 {
@@ -51,9 +54,12 @@ protected:
 
     ConstRefMan<Function>	getInputFunction(const BinID& bid,int& source);
     void			fetchPerfectFit(const BinID&);
+    bool			needsGridderPoints() const;
 
     ObjectSet<const Function>	velocityfunctions_;
     TypeSet<int>		sources_;
+    TypeSet<double>		weights_;
+    TypeSet<int>		usedpoints_;
     const Function*		directsource_			= nullptr;
 
     Gridder2D*			gridder_			= nullptr;
@@ -93,9 +99,25 @@ public:
 
     GriddedFunction*		createFunction();
 
+    bool			getWeights(const BinID&,TypeSet<double>&,
+					   TypeSet<int>& usedpoints);
+				/*!<Weights of the gridder at the trace, kept
+				    per trace. Can be used from several threads
+				    at a time */
+
+    void			setMaxNrCachedFunctions(int);
+    int				maxNrCachedFunctions() const
+				{ return maxnrcached_; }
+    void			clearCache();
+				/*!<Removes the weights and evaluated
+				    functions. Done on any change of the
+				    gridder, sources or layer model */
+
     void			fillPar(IOPar&) const override;
     bool			usePar(const IOPar&) override;
 
+    static const char*		sKeyMaxNrCachedFunctions();
+
 protected:
 				~GriddedSource();
 
@@ -104,6 +126,12 @@ protected:
     bool			initGridder();
     static const char*		sKeyGridder() { return "Gridder"; }
 
+    bool			getCachedVelocity(const BinID&,float z0,
+						  float dz,int sz,float* res);
+    void			addToCache(const BinID&,float z0,float dz,
+					   int sz,const float*);
+    void			limitCacheSize();
+
     void			sourceChangeCB(CallBacker*);
 
     ObjectSet<FunctionSource>	datasources_;
@@ -119,6 +147,30 @@ protected:
 
     TypeSet<BinID>		gridsourcebids_;	//Filtered
     TypeSet<Coord>		gridsourcecoords_;	//Filtered
+
+    struct CellWeights
+    {
+	TypeSet<double>		weights_;
+	TypeSet<int>		usedpoints_;
+    };
+
+    BinIDValueSet		weightcells_;	//Index in cellweights_
+    ManagedObjectSet<CellWeights> cellweights_;
+    Threads::Lock		weightslock_;
+
+    struct EvaluatedFunction
+    {
+	BinID			bid_;
+	float			z0_;
+	float			dz_;
+	TypeSet<float>		vels_;
+    };
+
+    ManagedObjectSet<EvaluatedFunction> evaluated_;
+    TypeSet<od_int64>		stamps_;
+    od_int64			curstamp_		= 0;
+    int				maxnrcached_		= 256;
+    Threads::Lock		cachelock_;
 };
 
 } // namespace Vel
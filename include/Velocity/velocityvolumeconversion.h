@@ -17,6 +17,7 @@ ________________________________________________________________________
 
 class IOObj;
 class SeisTrc;
+class SeisTrcBuf;
 class SeisTrcReader;
 class SeisTrcWriter;
 class SeisSequentialWriter;
@@ -27,8 +28,12 @@ namespace ZDomain { class Info; }
 namespace Vel
 {
 
+class Worker;
+
 /*!Reads in a volume with either Vrms or Vint, and writes out a volume
-   with either Vrms or Vint. */
+   with either Vrms or Vint.
+   The traces are read in bricks, and the traces of a brick with the same
+   sampling are converted together, sharing their Z values. */
 
 mExpClass(Velocity) VolumeConverter : public ParallelTask
 { mODTextTranslationClass(VolumeConverter);
@@ -44,8 +49,14 @@ public:
     uiString			uiMessage() const override;
     uiString			uiNrDoneText() const override;
 
+    void			setBrickSize( int nrtrcs )
+				{ bricksize_ = nrtrcs; }
+    int				brickSize() const
+				{ return bricksize_; }
+
     static const char*		sKeyInput();
     static const char*		sKeyOutput();
+    static const char*		sKeyBrickSize();
 
 private:
     od_int64			nrIterations() const override;
@@ -56,6 +67,9 @@ private:
 
     void			setRanges();
     char			getNewTrace(SeisTrc&,int threadidx);
+    char			getNewTraces(SeisTrcBuf&,int threadidx);
+    void			convertTraces(SeisTrcBuf&,
+					      TypeSet<double>& buf) const;
 
     uiString			msg_;
     od_int64			totalnr_ = -1;
@@ -68,6 +82,8 @@ private:
     double			srd_;
     const UnitOfMeasure*	srduom_;
     TrcKeySampling		tks_;
+    int				bricksize_	    = 64;
+    Worker*			worker_		    = nullptr;
 
     SeisTrcReader*		reader_		    = nullptr;
     SeisTrcWriter*		writer_		    = nullptr;
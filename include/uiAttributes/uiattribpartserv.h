@@ -299,6 +299,9 @@ public:
 protected:
     void		snapToValidRandomTraces(TrcKeySet& path,
 						const Attrib::Desc*);
+    bool		readStoredTraces(const Attrib::Desc&,
+					 const Interval<float>& zrg,
+					 const TrcKeySet& path,SeisTrcBuf&);
 
 public:
 
@@ -32,6 +32,7 @@ protected:
     AGC*		processor_;
     uiGenInput*		windowfld_;
     uiGenInput*		lowenergymute_;
+    uiGenInput*		ignorezerosfld_;
 };
 
 } // namespace PreStack
@@ -0,0 +1,175 @@
+"""Python side of the OpendTect shared memory trace exchange
+
+Copyright (C) dGB Beheer B.V.; (LICENSE) http://opendtect.org/OpendTect_license.txt
+
+Module Summary
+###############
+
+OpendTect (Attrib::ExtTraceExchange) writes batches of traces to a shared
+memory ring buffer. An external attribute attaches to the buffer by name,
+computes its output directly in the numpy views of each batch and hands the
+batch back, without any serialization or copying of the trace data.
+
+Examples
+--------
+>>> from odbind.exttraces import TraceExchange
+>>> with TraceExchange('od_myattrib') as exch:
+...     for batch in exch.batches():
+...         batch.output[0] = batch.input[0] ** 2
+...         exch.done(batch)
+
+"""
+import time
+from collections import namedtuple
+from multiprocessing import shared_memory
+import numpy as np
+
+_MAGIC = b'ODTRCSHM'
+_VERSION = 2
+_HEADER = np.dtype([('magic', 'S8'), ('version', '<i4'), ('nrslots', '<i4'),
+                    ('maxnrtrcs', '<i4'), ('maxnrsamples', '<i4'),
+                    ('nrinpcomps', '<i4'), ('nroutcomps', '<i4'),
+                    ('shutdown', '<i4'), ('generation', '<i4')])
+_SLOTHEADER = np.dtype([('state', '<i4'), ('nrtrcs', '<i4'),
+                        ('nrsamples', '<i4'), ('seqnr', '<i4'),
+                        ('z0', '<f4'), ('zstep', '<f4'),
+                        ('doneseqnr', '<i4'), ('generation', '<i4')])
+
+FREE, INPUT, BUSY, OUTPUT = range(4)
+
+Batch = namedtuple('Batch', ['slot', 'seqnr', 'line', 'trace', 'z0',
+                             'zstep', 'input', 'output'])
+Batch.__doc__ = """A batch of traces; input and output are views of
+shape (nrcomponents, nrtraces, nrsamples) in the shared memory"""
+
+
+class TraceExchange:
+    """Attaches to a shared memory trace exchange created by OpendTect"""
+
+    def __init__(self, name: str, timeout: float=60):
+        """
+        Parameters
+        ----------
+        name : str
+            name of the shared memory segment, as given to OpendTect
+        timeout : float
+            seconds to wait for the segment to be initialised
+
+        """
+        self._shm = _attach(name)
+        self._buf = self._shm.buf
+        self._hdr = np.ndarray((), dtype=_HEADER, buffer=self._buf)
+        start = time.monotonic()
+        while self._hdr['magic'] != _MAGIC:
+            if time.monotonic()-start > timeout:
+                self.close()
+                raise TimeoutError(f'Shared memory {name} not initialised')
+            time.sleep(0.001)
+
+        if self._hdr['version'] != _VERSION:
+            self.close()
+            raise ValueError(f'Unsupported trace exchange version {self._hdr["version"]}')
+
+        nrslots = int(self._hdr['nrslots'])
+        self._slothdrs = np.ndarray((nrslots,), dtype=_SLOTHEADER,
+                                    buffer=self._buf, offset=_HEADER.itemsize)
+        maxnrtrcs = int(self._hdr['maxnrtrcs'])
+        maxnrsamples = int(self._hdr['maxnrsamples'])
+        nrinp = int(self._hdr['nrinpcomps'])
+        nrout = int(self._hdr['nroutcomps'])
+        slotsz = 8*maxnrtrcs + 4*(nrinp+nrout)*maxnrtrcs*maxnrsamples
+        dataoffs = _HEADER.itemsize + nrslots*_SLOTHEADER.itemsize
+        self._slots = []
+        for slot in range(nrslots):
+            offs = dataoffs + slot*slotsz
+            pos = np.ndarray((2, maxnrtrcs), dtype='<i4', buffer=self._buf,
+                             offset=offs)
+            offs += pos.nbytes
+            inp = np.ndarray((nrinp, maxnrtrcs, maxnrsamples), dtype='<f4',
+                             buffer=self._buf, offset=offs)
+            offs += inp.nbytes
+            out = np.ndarray((nrout, maxnrtrcs, maxnrsamples), dtype='<f4',
+                             buffer=self._buf, offset=offs)
+            self._slots.append((pos, inp, out))
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        """Detaches from the shared memory; OpendTect removes it"""
+        self._slots = None
+        self._slothdrs = None
+        self._hdr = None
+        self._buf = None
+        if self._shm:
+            self._shm.close()
+            self._shm = None
+
+    @property
+    def shutdown(self) -> bool:
+        """bool : True when OpendTect has no more batches to hand over"""
+        return bool(self._hdr['shutdown'])
+
+    def next_batch(self, timeout: float=None) -> Batch:
+        """Returns the oldest waiting batch, or None on shutdown or timeout"""
+        start = time.monotonic()
+        while True:
+            slot = self._oldest_input()
+            if slot is not None:
+                break
+            if self.shutdown:
+                return None
+            if timeout is not None and time.monotonic()-start > timeout:
+                return None
+            time.sleep(0.0001)
+
+        self._slothdrs[slot]['state'] = BUSY
+        hdr = self._slothdrs[slot]
+        nrtrcs = int(hdr['nrtrcs'])
+        nrsamples = int(hdr['nrsamples'])
+        pos, inp, out = self._slots[slot]
+        return Batch(slot, int(hdr['seqnr']), pos[0, :nrtrcs],
+                     pos[1, :nrtrcs], float(hdr['z0']), float(hdr['zstep']),
+                     inp[:, :nrtrcs, :nrsamples], out[:, :nrtrcs, :nrsamples])
+
+    def _oldest_input(self):
+        waiting = np.flatnonzero(self._slothdrs['state'] == INPUT)
+        if waiting.size == 0:
+            return None
+        return int(waiting[np.argmin(self._slothdrs['seqnr'][waiting])])
+
+    def batches(self):
+        """Yields the batches until OpendTect shuts the exchange down"""
+        while True:
+            batch = self.next_batch()
+            if batch is None:
+                return
+            yield batch
+
+    def done(self, batch: Batch):
+        """Hands the output of a batch back to OpendTect
+
+        The output is dropped when OpendTect gave up on the batch
+        """
+        hdr = self._slothdrs[batch.slot]
+        if hdr['seqnr'] != batch.seqnr or hdr['state'] != BUSY:
+            return
+        hdr['doneseqnr'] = batch.seqnr
+        hdr['state'] = OUTPUT
+
+
+def _attach(name: str):
+    try:
+        return shared_memory.SharedMemory(name=name, track=False)
+    except TypeError:
+        # Before Python 3.13: keep the resource tracker from removing it
+        shm = shared_memory.SharedMemory(name=name)
+        try:
+            from multiprocessing import resource_tracker
+            resource_tracker.unregister(shm._name, 'shared_memory')
+        except Exception:
+            pass
+        return shm
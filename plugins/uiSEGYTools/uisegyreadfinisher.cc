@@ -148,6 +148,14 @@ void uiSEGYReadFinisher::crSeisFields()
     uiGroup* attgrp = transffld_;
     if ( is2d )
 	cr2DCoordSrcFields( attgrp, ismulti );
+    else if ( !Seis::isPS(gt) )
+    {
+	sortinpfld_ = new uiGenInput( this, tr("Input sorting"),
+		BoolInpSpec(false,tr("Any, sort on import"),
+			    tr("In-line sorted")) );
+	sortinpfld_->attach( alignedBelow, transffld_ );
+	attgrp = sortinpfld_;
+    }
 
     const BufferStringSet trnotallowed( "SEGYDirect" );
     uiSeisSel::Setup copysu( gt );
@@ -328,6 +336,8 @@ void uiSEGYReadFinisher::doScanChg( CallBacker* )
 	transffld_->display( copy && zdomain_->def_.isSI() );
     if ( remnullfld_ )
 	remnullfld_->display( !copy );
+    if ( sortinpfld_ )
+	sortinpfld_->display( copy );
     if ( lnmfld_ )
 	lnmfld_->display( !copy );
 }
@@ -454,6 +464,8 @@ bool uiSEGYReadFinisher::do3D( const IOObj& inioobj, const IOObj& outioobj,
 	imp = new SeisImporter(
 			getImpReader(inioobj,*wrr,Survey::default3DGeomID()),
 			*wrr, gt );
+	imp->setPipelined( true );
+	imp->setSortInput( sortinpfld_ && sortinpfld_->getBoolValue() );
 	exec = imp.ptr();
     }
     else
@@ -594,6 +606,10 @@ bool uiSEGYReadFinisher::doBatch( bool doimp )
     if ( seisselfld )
 	seisselfld->fillPar( outpars );
 
+    if ( doimp && sortinpfld_ )
+	outpars.setYN( SEGY::IO::sKeySortInput(),
+		       sortinpfld_->getBoolValue() );
+
     jobpars.mergeComp( outpars, sKey::Output() );
 
     return batchfld_->start();
@@ -65,6 +65,7 @@ private:
     uiSeisSel*		outscanfld_		= nullptr;
     uiSeisTransfer*	transffld_		= nullptr;
     uiGenInput*		remnullfld_		= nullptr;
+    uiGenInput*		sortinpfld_		= nullptr;
     uiSeis2DLineNameSel* lnmfld_		= nullptr;
     uiGenInput*		docopyfld_		= nullptr;
     uiComboBox*		coordsfromfld_		= nullptr;
@@ -1667,3 +1667,43 @@ bool ElasticModelSet::getTimeSampling( Interval<float>& timerg,
 
     return !timerg.isUdf();
 }
+
+
+// ElasticModelArrays
+
+ElasticModelArrays::ElasticModelArrays()
+{
+}
+
+
+ElasticModelArrays::ElasticModelArrays( const ElasticModel& emodel )
+{
+    set( emodel );
+}
+
+
+ElasticModelArrays::~ElasticModelArrays()
+{
+}
+
+
+void ElasticModelArrays::set( const ElasticModel& emodel )
+{
+    const int sz = emodel.size();
+    thickness_.setSize( sz );
+    pvel_.setSize( sz );
+    svel_.setSize( sz );
+    den_.setSize( sz );
+    ai_.setSize( sz );
+    iselastic_ = !emodel.isEmpty() &&
+		 emodel.getMinType() >= RefLayer::Elastic;
+    for ( int idx=0; idx<sz; idx++ )
+    {
+	const RefLayer& layer = *emodel.get( idx );
+	thickness_[idx] = layer.getThickness();
+	pvel_[idx] = layer.getPVel();
+	svel_[idx] = layer.getSVel();
+	den_[idx] = layer.getDen();
+	ai_[idx] = layer.getAI();
+    }
+}
@@ -0,0 +1,177 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "crosscorrelator.h"
+
+#include "fourier.h"
+#include "undefval.h"
+
+namespace Fourier
+{
+
+CrossCorrelator::CrossCorrelator()
+    : fft_(new FFTCC1D)
+    , ifft_(new FFTCC1D)
+{
+    ifft_->setDir( false );
+    ifft_->setNormalization( true );
+}
+
+
+CrossCorrelator::~CrossCorrelator()
+{
+    delete fft_;
+    delete ifft_;
+}
+
+
+bool CrossCorrelator::setSize( int nrsamples, int maxlag )
+{
+    hasref_ = false;
+    nrsamples_ = nrsamples;
+    maxlag_ = maxlag;
+    fftsz_ = 0;
+    if ( nrsamples<1 || maxlag<0 )
+	return false;
+
+    const int fftsz = FFTCC1D::getFastSize( nrsamples+maxlag );
+    if ( !fft_->setSize(fftsz) || !ifft_->setSize(fftsz) )
+	return false;
+
+    fftsz_ = fftsz;
+    refspec_.setSize( fftsz_ );
+    buf_.setSize( fftsz_ );
+    return true;
+}
+
+
+#define mSample( arr, idx ) \
+    (arr && !mIsUdf(arr[idx]) ? arr[idx] : 0.f)
+
+bool CrossCorrelator::setReference( const float* ref )
+{
+    hasref_ = false;
+    if ( !fftsz_ || !ref )
+	return false;
+
+    float_complex* spec = refspec_.arr();
+    for ( int idx=0; idx<nrsamples_; idx++ )
+	spec[idx] = float_complex( mSample(ref,idx), 0.f );
+    for ( int idx=nrsamples_; idx<fftsz_; idx++ )
+	spec[idx] = float_complex( 0.f, 0.f );
+
+    if ( !fft_->run(spec) )
+	return false;
+
+    // Conjugated once, to be multiplied with the trace spectra
+    for ( int idx=0; idx<fftsz_; idx++ )
+	spec[idx] = std::conj( spec[idx] );
+
+    hasref_ = true;
+    return true;
+}
+
+
+bool CrossCorrelator::correlate( const float* trc, float* xcorr )
+{
+    return correlate( 1, &trc, xcorr );
+}
+
+
+bool CrossCorrelator::correlate( int nrtrcs, const float* const* trcs,
+				 float* xcorrs )
+{
+    if ( !hasref_ )
+	return false;
+
+    const int nrlags = nrLags();
+    float_complex* buf = buf_.arr();
+    const float_complex* refspec = refspec_.arr();
+    for ( int itrc=0; itrc<nrtrcs; itrc+=2 )
+    {
+	const float* trc0 = trcs[itrc];
+	const float* trc1 = itrc+1<nrtrcs ? trcs[itrc+1] : nullptr;
+	for ( int idx=0; idx<nrsamples_; idx++ )
+	    buf[idx] = float_complex( mSample(trc0,idx), mSample(trc1,idx) );
+	for ( int idx=nrsamples_; idx<fftsz_; idx++ )
+	    buf[idx] = float_complex( 0.f, 0.f );
+
+	if ( !fft_->run(buf) )
+	    return false;
+
+	// The reference is real: the parts stay separated
+	for ( int idx=0; idx<fftsz_; idx++ )
+	    buf[idx] *= refspec[idx];
+
+	if ( !ifft_->run(buf) )
+	    return false;
+
+	getCorrelation( 0, xcorrs + od_int64(itrc)*nrlags );
+	if ( trc1 )
+	    getCorrelation( 1, xcorrs + od_int64(itrc+1)*nrlags );
+    }
+
+    return true;
+}
+
+#undef mSample
+
+
+void CrossCorrelator::getCorrelation( int part, float* xcorr ) const
+{
+    const float_complex* buf = buf_.arr();
+    for ( int lag=-maxlag_; lag<=maxlag_; lag++ )
+    {
+	const float_complex& val = buf[ lag<0 ? fftsz_+lag : lag ];
+	xcorr[lag+maxlag_] = part ? val.imag() : val.real();
+    }
+}
+
+
+float CrossCorrelator::findPeak( const float* xcorr, int maxlag,
+				 float* peakval )
+{
+    const int nrlags = 2*maxlag + 1;
+    int peakidx = -1;
+    for ( int idx=0; idx<nrlags; idx++ )
+    {
+	if ( !mIsUdf(xcorr[idx]) &&
+	     (peakidx<0 || xcorr[idx]>xcorr[peakidx]) )
+	    peakidx = idx;
+    }
+
+    if ( peakidx<0 )
+	return mUdf(float);
+
+    if ( peakval )
+	*peakval = xcorr[peakidx];
+
+    float lag = mCast(float,peakidx-maxlag);
+    if ( peakidx>0 && peakidx<nrlags-1 &&
+	 !mIsUdf(xcorr[peakidx-1]) && !mIsUdf(xcorr[peakidx+1]) )
+    {
+	const float ym = xcorr[peakidx-1];
+	const float y0 = xcorr[peakidx];
+	const float yp = xcorr[peakidx+1];
+	const float denom = ym - 2.f*y0 + yp;
+	if ( denom < 0.f )
+	{
+	    const float dlag = 0.5f * (ym-yp) / denom;
+	    lag += dlag;
+	    if ( peakval )
+		*peakval = y0 - 0.25f * (ym-yp) * dlag;
+	}
+	else if ( ym==y0 && y0==yp )
+	    return mUdf(float);
+    }
+
+    return lag;
+}
+
+} // namespace Fourier
@@ -87,6 +87,7 @@ bool RayTracer1D::Setup::areDepthsInFeet() const
 
 RayTracer1D::RayTracer1D()
     : model_(*new ElasticModel())
+    , layers_(*new ElasticModelArrays())
 {}
 
 
@@ -95,6 +96,7 @@ RayTracer1D::~RayTracer1D()
     delete [] velmax_;
     delete [] twt_;
     delete [] reflectivities_;
+    delete &layers_;
     delete &model_;
 }
 
@@ -292,6 +294,7 @@ bool RayTracer1D::doPrepare( int nrthreads )
     if ( !msg_.isEmpty() )
 	return false;
 
+    layers_.set( model_ );
     const int layersize = mCast( int, nrIterations() );
     delete [] velmax_;
     mTryAlloc( velmax_, float[layersize] );
@@ -353,10 +356,9 @@ bool RayTracer1D::doFinish( bool success )
 
 bool RayTracer1D::compute( int layer, int offsetidx, float rayparam )
 {
-    const RefLayer& reflayer0 = *model_.get( layer );
     const bool pdown = setup().pdown_;
-    const bool pup = setup().pup_;
-    const float downvel = pdown ? reflayer0.getPVel() : reflayer0.getSVel();
+    const float downvel = pdown ? layers_.pvel_[layer]
+				: layers_.svel_[layer];
 
     if ( mIsUdf(downvel) || mIsUdf(rayparam) ||
 	 !Math::IsNormalNumber(downvel) || !Math::IsNormalNumber(rayparam) )
@@ -374,68 +376,90 @@ bool RayTracer1D::compute( int layer, int offsetidx, float rayparam )
 
     sinarr_[offsetidx][layer] = sini;
 
-    if ( !reflectivities_ || layer>=model_.size()-1 )
-	return true;
+    return computeReflectivities( layer, offsetidx, 1, &rayparam );
+}
 
-    const float off = offsets_[offsetidx];
-    float_complex reflectivity = 0;
-    const int nrinterfaces = layer+1;
-    const RefLayer& reflayer1 = *model_.get( nrinterfaces );
 
-    if ( mIsZero(off,mDefEps) )
-    {
-	const float ai0 = reflayer0.getAI();
-	const float ai1 = reflayer1.getAI();
-	const float real = mIsUdf(ai0) || mIsUdf(ai1) ||
-			   (mIsZero(ai1,mDefEpsF) && mIsZero(ai0,mDefEpsF))
-			 ? mUdf(float) : (ai1-ai0)/(ai1+ai0);
-	reflectivity = float_complex( real, 0.f );
-    }
-    else
+bool RayTracer1D::computeReflectivities( int layer, int firstoffidx,
+					 int nroffsets, const float* rayparams )
+{
+    if ( !reflectivities_ || layer>=layers_.size()-1 )
+	return true;
+
+    const float* pvels = layers_.pvel_.arr();
+    const float* svels = layers_.svel_.arr();
+    const float* dens = layers_.den_.arr();
+    const float ai0 = layers_.ai_[layer];
+    const float ai1 = layers_.ai_[layer+1];
+    const float zerooffsref = mIsUdf(ai0) || mIsUdf(ai1) ||
+			      (mIsZero(ai1,mDefEpsF) && mIsZero(ai0,mDefEpsF))
+			    ? mUdf(float) : (ai1-ai0)/(ai1+ai0);
+
+    mAllocLargeVarLenArr( bool, dozoeppritz, nroffsets );
+    int nrzoeppritz = 0;
+    for ( int idx=0; idx<nroffsets; idx++ )
     {
-						 // critical angle reached
-	if ( rayparam*reflayer0.getPVel() > 1 ||
-	     rayparam*reflayer1.getPVel() > 1 )  // no reflection
+	const int offidx = firstoffidx + idx;
+	float_complex& reflectivity = reflectivities_[offidx][layer];
+	dozoeppritz[idx] = false;
+	if ( mIsZero(offsets_[offidx],mDefEps) )
 	{
-	    reflectivities_[offsetidx][layer] = reflectivity;
-	    return true;
+	    reflectivity = float_complex( zerooffsref, 0.f );
+	    continue;
 	}
 
-	mAllocLargeVarLenArr( ZoeppritzCoeff, coefs, nrinterfaces );
-        for ( int iidx=0; iidx<nrinterfaces; iidx++ )
+	const float rayparam = rayparams[idx];
+						 // critical angle reached
+	if ( rayparam*pvels[layer] > 1 ||
+	     rayparam*pvels[layer+1] > 1 )	 // no reflection
 	{
-	    const ElasticLayer* elay0 = model_.get( iidx )->asElastic();
-	    const ElasticLayer* elay1 = model_.get( iidx+1 )->asElastic();
-	    if ( !elay0 || !elay1 )
-		return false;
-
-	    coefs[iidx].setInterface( rayparam, *elay0, *elay1 );
+	    reflectivity = float_complex( 0.f, 0.f );
+	    continue;
 	}
 
-	reflectivity = coefs[0].getCoeff( true, layer!=0, pdown,
-					  layer==0 ? pup : pdown );
+	reflectivity = float_complex( 1.f, 0.f );
+	dozoeppritz[idx] = true;
+	nrzoeppritz++;
+    }
 
-	if ( layer == 0 )
-	{
-	    reflectivities_[offsetidx][layer] = reflectivity;
-	    return true;
-	}
+    if ( nrzoeppritz < 1 )
+	return true;
 
-	for ( int iidx=1; iidx<nrinterfaces; iidx++ )
-	{
-	    reflectivity *= coefs[iidx].getCoeff( true, iidx!=layer,
-						  pdown, iidx==layer ?
-						  pup : pdown);
-	}
+    if ( !layers_.isElastic() )
+	return false;
 
-	for ( int iidx=nrinterfaces-2; iidx>=0; iidx--)
+    // Interfaces in the outer loop: their properties are read once for all
+    // offsets. The reflection at the target layer is multiplied with the
+    // transmissions through all interfaces above it, down and up.
+    const bool pdown = setup().pdown_;
+    const bool pup = setup().pup_;
+    ZoeppritzCoeff coefs;
+    for ( int iidx=0; iidx<=layer; iidx++ )
+    {
+	const float pvel0 = pvels[iidx];
+	const float svel0 = svels[iidx];
+	const float den0 = dens[iidx];
+	const float pvel1 = pvels[iidx+1];
+	const float svel1 = svels[iidx+1];
+	const float den1 = dens[iidx+1];
+	const bool isreflection = iidx == layer;
+	for ( int idx=0; idx<nroffsets; idx++ )
 	{
-	    reflectivity *= coefs[iidx].getCoeff( false, false, pup, pup );
+	    if ( !dozoeppritz[idx] )
+		continue;
+
+	    coefs.setInterface( rayparams[idx], pvel0, svel0, den0,
+				pvel1, svel1, den1 );
+	    float_complex& reflectivity =
+				reflectivities_[firstoffidx+idx][layer];
+	    if ( isreflection )
+		reflectivity *= coefs.getCoeff( true, false, pdown, pup );
+	    else
+		reflectivity *= coefs.getCoeff( true, true, pdown, pdown ) *
+				coefs.getCoeff( false, false, pup, pup );
 	}
     }
 
-    reflectivities_[offsetidx][layer] = reflectivity;
-
     return true;
 }
 
@@ -466,35 +490,56 @@ bool VrmsRayTracer1D::doWork( od_int64 start, od_int64 stop, int nrthreads )
 
     const bool pdown = setup().pdown_;
     const float startdepth = setup().startdepth_;
-    const bool offsetsinfeet = areOffsetsInFeet();
     const bool depthsinfeet = areDepthsInFeet();
-    for ( int layer=mCast(int,start); layer<=stop; layer++, addToNrDone(1) )
+    TypeSet<float> offsets( offsets_ );
+    if ( areOffsetsInFeet() )
     {
-	const RefLayer& ellayer = *model_.get( layer );
-	if ( !pdown && !ellayer.isElastic() )
-	    return false;
+	for ( auto& offset : offsets )
+	    offset *= mFromFeetFactorF;
+    }
 
+    if ( !pdown && !layers_.isElastic() )
+	return false;
+
+    const float* vels = pdown ? layers_.pvel_.arr() : layers_.svel_.arr();
+    mAllocLargeVarLenArr( float, rayparams, offsz );
+    for ( int layer=mCast(int,start); layer<=stop; layer++, addToNrDone(1) )
+    {
 	float depth = 2.f * (depths_[layer] - startdepth);
 	if ( depthsinfeet )
 	    depth *= mFromFeetFactorF;
 
-	const float vel = pdown ? ellayer.getPVel() : ellayer.getSVel();
-	for ( int osidx=0; osidx<offsz; osidx++ )
+	const float vel = vels[layer];
+	float vrms = velmax_[layer];
+	if ( depthsinfeet )
+	    vrms *= mFromFeetFactorF;
+
+	const float tnmo = zerooffstwt_[layer];
+	const bool domoveout = vrms && !mIsUdf(tnmo);
+	const float tnmo2 = domoveout ? tnmo*tnmo : 0.f;
+	const float vrms2 = domoveout ? vrms*vrms : 1.f;
+	const float depth2 = depth*depth;
+	bool isok = !mIsUdf(vel) && Math::IsNormalNumber(vel);
+	for ( int osidx=0; osidx<offsz && isok; osidx++ )
+	{
+	    // sin( atan(offset/depth) ), without the trigonometry
+	    const float offset = offsets[osidx];
+	    const float dist = Math::Sqrt( offset*offset + depth2 );
+	    const float sini = depth ? offset / (depth>0.f ? dist : -dist)
+				     : 0.f;
+	    sinarr_[osidx][layer] = sini;
+	    rayparams[osidx] = sini / vel;
+	    twt_[osidx][layer] = domoveout
+		    ? Math::Sqrt( offset*offset/vrms2 + tnmo2 ) : tnmo;
+	    isok = Math::IsNormalNumber( rayparams[osidx] );
+	}
+
+	if ( !isok || !computeReflectivities(layer,0,offsz,rayparams.ptr()) )
 	{
-	    float offset = offsets_[osidx];
-	    if ( offsetsinfeet )
-		offset *= mFromFeetFactorF;
-
-	    const float angle = depth ? atan( offset / depth ) : 0.f;
-	    const float rayparam = sin(angle) / vel;
-
-	    if ( !compute(layer,osidx,rayparam) )
-	    {
-		msg_ = tr( "Can not compute layer %1"
-			      "\n most probably the velocity is not correct" )
-			.arg( layer );
-		return false;
-	    }
+	    msg_ = tr( "Can not compute layer %1"
+			  "\n most probably the velocity is not correct" )
+		    .arg( layer );
+	    return false;
 	}
     }
 
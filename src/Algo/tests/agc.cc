@@ -0,0 +1,177 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "agc.h"
+
+#include "testprog.h"
+#include "valseriesimpl.h"
+
+#include <algorithm>
+#include <math.h>
+
+static const int cNrSamples = 2000;
+static const int cNrMuted = 150;
+
+
+/* A top mute of zeros, some undefined samples and a varying amplitude */
+
+static void fillTrace( TypeSet<float>& trc )
+{
+    trc.setSize( cNrSamples );
+    for ( int idx=0; idx<cNrSamples; idx++ )
+    {
+	if ( idx < cNrMuted )
+	    trc[idx] = 0.f;
+	else if ( idx % 97 == 0 )
+	    trc[idx] = mUdf(float);
+	else
+	    trc[idx] = (1.f + 0.002f*idx) * sinf( 0.13f*idx );
+    }
+}
+
+
+// The gate is summed again at every sample
+
+static void getReference( const TypeSet<float>& inp, const Interval<int>& gate,
+			  float mutefraction, bool ignorezeros,
+			  TypeSet<float>& outp )
+{
+    const int sz = inp.size();
+    TypeSet<float> energies( sz, mUdf(float) );
+    for ( int idx=0; idx<sz; idx++ )
+    {
+	if ( !mIsUdf(inp[idx]) )
+	    energies[idx] = inp[idx] * inp[idx];
+    }
+
+    TypeSet<float> sorted( energies );
+    std::sort( sorted.arr(), sorted.arr()+sz );
+    const float energymute = mutefraction > 0.f
+			   ? sorted[mNINT32(sz*mutefraction)] : 0.f;
+
+    outp.setSize( sz );
+    for ( int idx=0; idx<sz; idx++ )
+    {
+	double energysum = 0.;
+	int nrenergies = 0;
+	for ( int eidx=idx+gate.start_; eidx<=idx+gate.stop_; eidx++ )
+	{
+	    if ( eidx<0 || eidx>=sz || mIsUdf(energies[eidx]) ||
+		 (ignorezeros && energies[eidx]==0.f) )
+		continue;
+
+	    energysum += energies[eidx];
+	    nrenergies++;
+	}
+
+	const float mean = nrenergies>0 ? float(energysum/nrenergies) : 0.f;
+	outp[idx] = mean>=energymute && mean>0.f
+		  ? (mIsUdf(inp[idx]) ? inp[idx] : inp[idx]/sqrtf(mean))
+		  : 0.f;
+    }
+}
+
+
+static bool isSame( const TypeSet<float>& vals, const TypeSet<float>& exp )
+{
+    if ( vals.size() != exp.size() )
+	return false;
+
+    for ( int idx=0; idx<vals.size(); idx++ )
+    {
+	if ( mIsUdf(exp[idx]) ? !mIsUdf(vals[idx])
+			      : !mIsEqual(vals[idx],exp[idx],1e-4f) )
+	    return false;
+    }
+
+    return true;
+}
+
+
+static bool testAgainstReference( const Interval<int>& gate,
+				  float mutefraction, bool ignorezeros )
+{
+    TypeSet<float> inp, exp;
+    fillTrace( inp );
+    getReference( inp, gate, mutefraction, ignorezeros, exp );
+
+    BufferString desc( "Gate ", gate.start_, " to " );
+    desc.add( gate.stop_ ).add( ", mute " ).add( mutefraction )
+	.add( ignorezeros ? ", zeros ignored" : "" );
+
+    TypeSet<float> outp( cNrSamples, 0.f );
+    ArrayValueSeries<float,float> inpvs( inp.arr(), false, cNrSamples );
+    ArrayValueSeries<float,float> outpvs( outp.arr(), false, cNrSamples );
+    AGC<float> agc;
+    agc.setInput( inpvs, cNrSamples );
+    agc.setOutput( outpvs );
+    agc.setSampleGate( gate );
+    agc.setMuteFraction( mutefraction );
+    agc.setIgnoreZeros( ignorezeros );
+    mRunStandardTest( agc.execute() && isSame(outp,exp),
+		      BufferString(desc,": value series") );
+
+    // The static function, in place
+    TypeSet<float> trc( inp );
+    TypeSet<float> workbuf( 2*cNrSamples, 0.f );
+    AGC<float>::applyToTrace( trc.arr(), trc.arr(), cNrSamples, gate,
+			      mutefraction, ignorezeros, workbuf.arr() );
+    mRunStandardTest( isSame(trc,exp), BufferString(desc,": plain array") );
+    return true;
+}
+
+
+/* Constant amplitude below a mute: with the zeros ignored, the samples next
+   to the mute get the same gain as the others */
+
+static bool testIgnoreZeros()
+{
+    TypeSet<float> trc( cNrSamples, 2.f );
+    for ( int idx=0; idx<cNrMuted; idx++ )
+	trc[idx] = 0.f;
+
+    const Interval<int> gate( -20, 20 );
+    TypeSet<float> withzeros( trc ), withoutzeros( trc );
+    TypeSet<float> workbuf( 2*cNrSamples, 0.f );
+    AGC<float>::applyToTrace( withzeros.arr(), withzeros.arr(), cNrSamples,
+			      gate, 0.f, false, workbuf.arr() );
+    AGC<float>::applyToTrace( withoutzeros.arr(), withoutzeros.arr(),
+			      cNrSamples, gate, 0.f, true, workbuf.arr() );
+
+    bool flat = true;
+    for ( int idx=cNrMuted; idx<cNrSamples; idx++ )
+    {
+	if ( !mIsEqual(withoutzeros[idx],1.f,1e-5f) )
+	    flat = false;
+    }
+
+    mRunStandardTest( flat, "Zeros ignored: same gain next to the mute" );
+    mRunStandardTest( withzeros[cNrMuted] > 1.1f &&
+		      mIsEqual(withzeros[cNrMuted+gate.stop_-gate.start_],
+			       1.f,1e-5f),
+		      "Zeros included: higher gain next to the mute" );
+    mRunStandardTest( withoutzeros[0] == 0.f && withzeros[0] == 0.f,
+		      "Muted samples stay zero" );
+    return true;
+}
+
+
+int mTestMainFnName( int argc, char** argv )
+{
+    mInitTestProg();
+
+    if ( !testAgainstReference(Interval<int>(-5,5),0.f,false) ||
+	 !testAgainstReference(Interval<int>(-40,25),0.f,true) ||
+	 !testAgainstReference(Interval<int>(-40,25),0.2f,false) ||
+	 !testAgainstReference(Interval<int>(-250,250),0.1f,true) ||
+	 !testIgnoreZeros() )
+	return 1;
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "crosscorrelator.h"
+
+#include "genericnumer.h"
+#include "testprog.h"
+
+#include <math.h>
+
+static const int cNrTrcs = 3;
+
+
+static void fillTrace( TypeSet<float>& trc, int nrsamples, int seed )
+{
+    trc.setSize( nrsamples );
+    for ( int idx=0; idx<nrsamples; idx++ )
+	trc[idx] = sinf( 0.37f*idx*(seed+1) + seed ) +
+		   0.5f * cosf( 0.11f*idx*idx + 2.f*seed );
+}
+
+
+/* An odd number of traces, so the last batch has only the real part */
+
+static bool testAgainstDirect( int nrsamples, int maxlag )
+{
+    TypeSet<float> ref;
+    fillTrace( ref, nrsamples, 0 );
+    TypeSet<float> trcs[cNrTrcs];
+    const float* trcptrs[cNrTrcs];
+    for ( int itrc=0; itrc<cNrTrcs; itrc++ )
+    {
+	fillTrace( trcs[itrc], nrsamples, itrc+1 );
+	trcptrs[itrc] = trcs[itrc].arr();
+    }
+
+    BufferString desc( "Size ", nrsamples, ", maximum lag " );
+    desc.add( maxlag );
+    Fourier::CrossCorrelator correlator;
+    mRunStandardTest( correlator.setSize(nrsamples,maxlag) &&
+		      correlator.setReference(ref.arr()),
+		      BufferString(desc,": set the reference") );
+
+    const int nrlags = correlator.nrLags();
+    TypeSet<float> xcorrs( cNrTrcs*nrlags, mUdf(float) );
+    mRunStandardTest( correlator.correlate(cNrTrcs,trcptrs,xcorrs.arr()),
+		      BufferString(desc,": correlate") );
+
+    TypeSet<float> exp( nrlags, 0.f );
+    float* expvals = exp.arr();
+    const float eps = 1e-4f * nrsamples;
+    for ( int itrc=0; itrc<cNrTrcs; itrc++ )
+    {
+	genericCrossCorrelation( nrsamples, 0, ref.arr(),
+				 nrsamples, 0, trcs[itrc].arr(),
+				 nrlags, -maxlag, expvals );
+	const float* xcorr = xcorrs.arr() + itrc*nrlags;
+	bool same = true;
+	for ( int idx=0; idx<nrlags; idx++ )
+	{
+	    if ( !mIsEqual(xcorr[idx],exp[idx],eps) )
+		same = false;
+	}
+
+	BufferString trcdesc( desc, ": trace " );
+	trcdesc.add( itrc );
+	mRunStandardTest( same, trcdesc );
+    }
+
+    return true;
+}
+
+
+static bool testPeak()
+{
+    const int nrsamples = 200;
+    const int shift = 7;
+    TypeSet<float> ref, trc( nrsamples, 0.f );
+    fillTrace( ref, nrsamples, 0 );
+    for ( int idx=shift; idx<nrsamples; idx++ )
+	trc[idx] = ref[idx-shift];
+
+    Fourier::CrossCorrelator correlator;
+    const int maxlag = 20;
+    TypeSet<float> xcorr( 2*maxlag+1, 0.f );
+    mRunStandardTest( correlator.setSize(nrsamples,maxlag) &&
+		      correlator.setReference(ref.arr()) &&
+		      correlator.correlate(trc.arr(),xcorr.arr()),
+		      "Correlate a shifted trace" );
+
+    const float lag =
+		Fourier::CrossCorrelator::findPeak( xcorr.arr(), maxlag );
+    mRunStandardTest( !mIsUdf(lag) && fabs(lag-shift)<0.5f,
+		      "Peak at the shift" );
+    return true;
+}
+
+
+int mTestMainFnName( int argc, char** argv )
+{
+    mInitTestProg();
+
+    const int sizes[] = { 1, 2, 17, 64, 250 };
+    const int lags[] = { 0, 1, 5, 63, 300 };
+    for ( const int nrsamples : sizes )
+    {
+	for ( const int maxlag : lags )
+	{
+	    if ( !testAgainstDirect(nrsamples,maxlag) )
+		return 1;
+	}
+    }
+
+    if ( !testPeak() )
+	return 1;
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "testprog.h"
+
+#include "ailayer.h"
+#include "raytrace1d.h"
+#include "reflectivitymodel.h"
+
+
+/* Recomputes the reflectivities of each offset on its own, through the
+   single-offset RayTracer1D::compute() */
+
+class PerOffsetRayTracer : public VrmsRayTracer1D
+{
+protected:
+
+bool doWork( od_int64 start, od_int64 stop, int threadidx ) override
+{
+    if ( !VrmsRayTracer1D::doWork(start,stop,threadidx) )
+	return false;
+
+    const bool pdown = setup().pdown_;
+    for ( int layer=mCast(int,start); layer<=stop; layer++ )
+    {
+	const float vel = pdown ? layers_.pvel_[layer] : layers_.svel_[layer];
+	for ( int osidx=0; osidx<offsets_.size(); osidx++ )
+	{
+	    const float rayparam = sinarr_[osidx][layer] / vel;
+	    if ( !compute(layer,osidx,rayparam) )
+		return false;
+	}
+    }
+
+    return true;
+}
+
+};
+
+
+static ElasticModel getModel()
+{
+    ElasticModel emdl;
+    emdl += new ElasticLayer( 48.f, 2000.f, 1000.f, 2500.f );
+    emdl += new ElasticLayer( 520.f, 2600.f, 1400.f, 2300.f );
+    emdl += new ElasticLayer( 385.f, 3500.f, 1900.f, 2200.f );
+    emdl += new ElasticLayer( 350.f, 2800.f, 1500.f, 2400.f );
+    emdl += new ElasticLayer( 400.f, 4000.f, 2300.f, 2800.f );
+    return emdl;
+}
+
+
+/* Includes the zero offset, and offsets beyond the critical angle */
+
+static TypeSet<float> getOffsets()
+{
+    TypeSet<float> offsets;
+    for ( int idx=0; idx<12; idx++ )
+	offsets += 250.f * idx;
+
+    return offsets;
+}
+
+
+static bool runRayTracer( RayTracer1D& raytracer,
+			  const RayTracer1D::Setup& rtsu, const char* desc )
+{
+    raytracer.setup() = rtsu;
+    raytracer.setup().doreflectivity( true );
+    raytracer.setOffsets( getOffsets(), Seis::OffsetType::OffsetMeter );
+    mRunStandardTestWithError( raytracer.setModel(getModel()) &&
+			       raytracer.execute(), desc,
+			       toString(raytracer.uiMessage()) );
+    mRunStandardTest( raytracer.getRefModel() &&
+		      raytracer.getRefModel()->hasReflectivities(),
+		      BufferString(desc,": reflectivities") );
+    return true;
+}
+
+
+static bool testBatched( const RayTracer1D::Setup& rtsu, const char* desc )
+{
+    VrmsRayTracer1D batched;
+    PerOffsetRayTracer peroffset;
+    if ( !runRayTracer(batched,rtsu,BufferString(desc,", batched")) ||
+	 !runRayTracer(peroffset,rtsu,BufferString(desc,", per offset")) )
+	return false;
+
+    const ReflectivityModelBase& batchedmdl = *batched.getRefModel();
+    const ReflectivityModelBase& peroffsetmdl = *peroffset.getRefModel();
+    mRunStandardTest( batchedmdl.nrRefModels() == peroffsetmdl.nrRefModels(),
+		      BufferString(desc,": number of offsets") );
+
+    bool same = true;
+    for ( int ioff=0; ioff<batchedmdl.nrRefModels(); ioff++ )
+    {
+	const ReflectivityModelTrace& batchedrefs =
+				*batchedmdl.getReflectivities( ioff );
+	const ReflectivityModelTrace& peroffsetrefs =
+				*peroffsetmdl.getReflectivities( ioff );
+	if ( batchedrefs.size() != peroffsetrefs.size() )
+	    { same = false; break; }
+
+	for ( int idx=0; idx<batchedrefs.size(); idx++ )
+	{
+	    const float_complex diff =
+			batchedrefs.arr()[idx] - peroffsetrefs.arr()[idx];
+	    if ( std::abs(diff) > 1e-6f )
+		same = false;
+	}
+    }
+
+    mRunStandardTest( same, BufferString(desc,": same reflectivities") );
+    return true;
+}
+
+
+int mTestMainFnName( int argc, char** argv )
+{
+    mInitTestProg();
+
+    RayTracer1D::Setup ppsu;
+    RayTracer1D::Setup pssu;
+    pssu.pup( false );
+    RayTracer1D::Setup sssu;
+    sssu.pdown( false ).pup( false );
+    if ( !testBatched(ppsu,"P-P") || !testBatched(pssu,"P-S") ||
+	 !testBatched(sssu,"S-S") )
+	return 1;
+
+    return 0;
+}
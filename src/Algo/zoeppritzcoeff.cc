@@ -24,14 +24,17 @@ ZoeppritzCoeff::~ZoeppritzCoeff()
 
 void ZoeppritzCoeff::setInterface( float p, const ElasticLayer& el1,
 					    const ElasticLayer& el2 )
+{
+    setInterface( p, el1.getPVel(), el1.getSVel(), el1.getDen(),
+		     el2.getPVel(), el2.getSVel(), el2.getDen() );
+}
+
+
+void ZoeppritzCoeff::setInterface( float p, float pvel1, float svel1,
+				   float den1, float pvel2, float svel2,
+				   float den2 )
 {
     const float p2 = p * p;
-    const float den1 = el1.getDen();
-    const float den2 = el2.getDen();
-    const float pvel1 = el1.getPVel();
-    const float pvel2 = el2.getPVel();
-    float svel1 = el1.getSVel();
-    float svel2 = el2.getSVel();
 
     const bool waterabove = mIsZero(svel1,mDefEps);	//Detect water
     const bool waterbelow = mIsZero(svel2,mDefEps);
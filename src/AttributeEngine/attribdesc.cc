@@ -473,7 +473,8 @@ bool Desc::isIdenticalTo( const Desc& desc, bool cmpoutput ) const
     if ( this==&desc )
 	return true;
 
-    if ( params_.size() != desc.params_.size()
+    if ( attribname_ != desc.attribname_
+      || params_.size() != desc.params_.size()
       || inputs_.size() != desc.inputs_.size() )
 	return false;
 
@@ -1146,6 +1146,80 @@ DescSet* DescSet::optimizeClone( const BufferStringSet& targetsstr ) const
 }
 
 
+int DescSet::mergeIdenticalDescs( const TypeSet<DescID>& keep )
+{
+    TypeSet<DescID> merged;
+    while ( true )
+    {
+	BufferStringSet keys;
+	ObjectSet<Desc> reps, dups, dupreps;
+	for ( int idx=0; idx<descs_.size(); idx++ )
+	{
+	    Desc& dsc = *descs_[idx];
+	    if ( merged.isPresent(ids_[idx]) )
+		continue;
+
+	    // The inputs have been merged already, so comparing their IDs
+	    // is enough to compare the complete input graphs
+	    BufferString key;
+	    dsc.getDefStr( key );
+	    if ( dsc.isSteering() )
+		key.add( " steering" );
+
+	    bool foreigninput = false;
+	    for ( int inp=0; inp<dsc.nrInputs(); inp++ )
+	    {
+		ConstRefMan<Desc> inpdesc = dsc.getInput( inp );
+		const DescID inpid = inpdesc ? getID( *inpdesc )
+					     : DescID::undef();
+		if ( inpdesc && !inpid.isValid() )
+		    { foreigninput = true; break; }
+
+		key.add( " input" ).add( inp ).add( "=" ).add( inpid.asInt() );
+	    }
+
+	    if ( foreigninput )
+		continue;
+
+	    const int keyidx = keys.indexOf( key );
+	    if ( keyidx < 0 )
+	    {
+		keys.add( key );
+		reps += &dsc;
+	    }
+	    else
+	    {
+		dups += &dsc;
+		dupreps += reps[keyidx];
+		merged += ids_[idx];
+	    }
+	}
+
+	if ( dups.isEmpty() )
+	    break;
+
+	for ( auto* dsc : descs_ )
+	{
+	    for ( int inp=0; inp<dsc->nrInputs(); inp++ )
+	    {
+		ConstRefMan<Desc> inpdesc = dsc->getInput( inp );
+		const int dupidx = inpdesc ? dups.indexOf( inpdesc.ptr() ) : -1;
+		if ( dupidx >= 0 )
+		    dsc->setInput( inp, dupreps[dupidx] );
+	    }
+	}
+    }
+
+    for ( const auto& id : merged )
+    {
+	if ( !keep.isPresent(id) )
+	    removeDesc( id );
+    }
+
+    return merged.size();
+}
+
+
 bool DescSet::isAttribUsed( const DescID& id ) const
 {
     BufferString tmpstr;
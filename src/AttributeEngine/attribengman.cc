@@ -13,8 +13,10 @@ ________________________________________________________________________
 #include "attribdesc.h"
 #include "attribdescset.h"
 #include "attribfactory.h"
+#include "attribintermediatecache.h"
 #include "attribprocessor.h"
 #include "attribprovider.h"
+#include "attribresultcache.h"
 #include "attribstorprovider.h"
 #include "attribparambase.h"
 
@@ -78,6 +80,7 @@ Processor* EngineMan::usePar( const IOPar& iopar, DescSet& attribset,
 {
     int outputidx = 0;
     TypeSet<DescID> ids;
+    TypeSet<int> storoutputidxs, storfirstids;
     while ( true )
     {
 	BufferString outpstr = IOPar::compKey( sKey::Output(), outputidx );
@@ -90,6 +93,12 @@ Processor* EngineMan::usePar( const IOPar& iopar, DescSet& attribset,
 		break;
 	}
 
+	if ( outputpar->hasKey(SeisTrcStorOutput::seisidkey()) )
+	{
+	    storoutputidxs += outputidx;
+	    storfirstids += ids.size();
+	}
+
 	int attribidx = 0;
 	while ( true )
 	{
@@ -106,6 +115,7 @@ Processor* EngineMan::usePar( const IOPar& iopar, DescSet& attribset,
 	outputidx++;
     }
 
+    attribset.mergeIdenticalDescs( ids );
     DescID evalid = createEvaluateADS( attribset, ids, errmsg );
     Processor* proc = createProcessor( attribset, geomid_, evalid, errmsg );
     if ( !proc )
@@ -148,31 +158,62 @@ Processor* EngineMan::usePar( const IOPar& iopar, DescSet& attribset,
     }
 
     const Pos::GeomID geomid = Survey::GM().getGeomID( linename );
-    RefMan<SeisTrcStorOutput> storeoutp =
-				createOutput( iopar, geomid, errmsg );
-    if ( !storeoutp )
-	return nullptr;
-
-    bool exttrctosi;
-    BufferString basekey = IOPar::compKey( "Output",0 );
-    if ( iopar.getYN( IOPar::compKey( basekey,SeisTrc::sKeyExtTrcToSI() ),
-		      exttrctosi) )
-	storeoutp->setTrcGrow( exttrctosi );
+    if ( storoutputidxs.size() < 2 )
+    {
+	storoutputidxs.setEmpty();
+	storoutputidxs += -1;
+	storfirstids.setEmpty();
+	storfirstids += 0;
+    }
 
-    if ( storeoutp->getOutpNames().isEmpty() )
+    // Each target cube gets the evaluate outputs of its own attributes
+    for ( int idx=0; idx<storoutputidxs.size(); idx++ )
     {
-	BufferStringSet outnms;
-	for ( int idx=0; idx<ids.size(); idx++ )
+	const int storoutidx = storoutputidxs[idx];
+	RefMan<SeisTrcStorOutput> storeoutp =
+			createOutput( iopar, geomid, errmsg, storoutidx );
+	if ( !storeoutp )
 	{
-	    const StringPair userref( attribset.getDesc(ids[idx])->userRef() );
-	    outnms.add(
-		userref.hasSecond() ? userref.second().buf() : userref.buf() );
+	    delete proc;
+	    return nullptr;
 	}
 
-	storeoutp->setOutpNames( outnms );
+	bool exttrctosi;
+	BufferString basekey =
+		IOPar::compKey( "Output", storoutidx<0 ? 0 : storoutidx );
+	if ( iopar.getYN( IOPar::compKey( basekey,SeisTrc::sKeyExtTrcToSI() ),
+			  exttrctosi) )
+	    storeoutp->setTrcGrow( exttrctosi );
+
+	const int firstid = storfirstids[idx];
+	const int lastid = idx<storfirstids.size()-1 ? storfirstids[idx+1]-1
+						      : ids.size()-1;
+	if ( storoutidx >= 0 )
+	{
+	    TypeSet<int> desoutputs;
+	    for ( int idy=firstid; idy<=lastid; idy++ )
+		desoutputs += idy;
+
+	    storeoutp->setDesiredOutputs( desoutputs );
+	}
+
+	if ( storeoutp->getOutpNames().isEmpty() )
+	{
+	    BufferStringSet outnms;
+	    for ( int idy=firstid; idy<=lastid; idy++ )
+	    {
+		const StringPair userref(
+				attribset.getDesc(ids[idy])->userRef() );
+		outnms.add( userref.hasSecond() ? userref.second().buf()
+						: userref.buf() );
+	    }
+
+	    storeoutp->setOutpNames( outnms );
+	}
+
+	proc->addOutput( storeoutp.ptr() );
     }
 
-    proc->addOutput( storeoutp.ptr() );
     return proc;
 }
 
@@ -237,7 +278,8 @@ void EngineMan::setExecutorName( Executor* ex )
 
 RefMan<SeisTrcStorOutput> EngineMan::createOutput( const IOPar& pars,
 						   const Pos::GeomID& geomid,
-						   uiString& errmsg )
+						   uiString& errmsg,
+						   int outputidx )
 {
     const BufferString typestr =
 		pars.find( IOPar::compKey(sKey::Output(),sKey::Type()) );
@@ -246,7 +288,7 @@ RefMan<SeisTrcStorOutput> EngineMan::createOutput( const IOPar& pars,
 
     RefMan<SeisTrcStorOutput> outp = new SeisTrcStorOutput( tkzs_, geomid );
     outp->setGeometry( tkzs_ );
-    const bool res = outp->doUsePar( pars );
+    const bool res = outp->doUsePar( pars, outputidx );
     if ( !res )
     {
 	errmsg = outp->errMsg();
@@ -295,6 +337,7 @@ const char* EngineMan::getCurUserRef() const
 
 RefMan<RegularSeisDataPack> EngineMan::getDataPackOutput(const Processor& proc)
 {
+    storeIntermediateResults();
     RefMan<RegularSeisDataPack> output;
     if ( proc.outputs_.size()==1 && !cache_ )
     {
@@ -348,6 +391,13 @@ RefMan<RegularSeisDataPack> EngineMan::getDataPackOutput(const Processor& proc)
 
 
 
+bool EngineMan::storeInResultCache( const RegularSeisDataPack& dp ) const
+{
+    return !resultcachekey_.isEmpty() && ARC().store( resultcachekey_, dp );
+}
+
+
+
 class DataPackCopier : public ParallelTask
 {
 public:
@@ -709,6 +759,9 @@ DescSet* EngineMan::createNLAADS( DescID& nladescid, uiString& errmsg,
 
     DescSet* cleanset = descset->optimizeClone( nladescid );
     delete descset;
+    if ( cleanset )
+	cleanset->mergeIdenticalDescs( TypeSet<DescID>(1,nladescid) );
+
     return cleanset;
 }
 
@@ -869,6 +922,23 @@ Processor* EngineMan::createDataPackOutput( uiString& errmsg,
 					    const RegularSeisDataPack* prev )
 {
     cache_ = nullptr;
+    resultcachekey_.setEmpty();
+    if ( !tkzs_.isEmpty() && !nlamodel_ && inpattrset_ && ARC().isEnabled() )
+	resultcachekey_ = ResultCache::getKey( *inpattrset_, attrspecs_ );
+
+    RefMan<RegularSeisDataPack> stored;
+    if ( !prev && !resultcachekey_.isEmpty() )
+    {
+	stored = ARC().get( resultcachekey_, tkzs_ );
+	if ( stored && stored->nrComponents() == attrspecs_.size() )
+	{
+	    for ( int idx=0; idx<attrspecs_.size(); idx++ )
+		stored->setComponentName( attrspecs_[idx].userRef(), idx );
+
+	    prev = stored.ptr();
+	}
+    }
+
     if ( tkzs_.isEmpty() )
 	prev = nullptr;
     else if ( prev )
@@ -898,10 +968,17 @@ Processor* EngineMan::createDataPackOutput( uiString& errmsg,
     proc->addOutput( attrout ); \
 }
 
+    useintermediates_ = AIC().isEnabled() && !nlamodel_ &&
+			!tkzs_.isEmpty() && !tkzs_.is2D();
     Processor* proc = getProcessor(errmsg);
+    useintermediates_ = false;
     if ( !proc )
 	return nullptr;
 
+    intermresults_.erase();
+    if ( AIC().isEnabled() && !nlamodel_ && !tkzs_.is2D() )
+	captureIntermediateResults( *proc );
+
     if ( !cache_ )
 	mAddAttrOut( tkzs_ )
     else
@@ -1304,11 +1381,15 @@ Processor* EngineMan::getProcessor( uiString& errmsg )
 	procattrset_ = inpattrset_->optimizeClone( outattribs );
 	if ( !procattrset_ ) mErrRet(tr("Attribute set not valid"));
 
+	procattrset_->mergeIdenticalDescs( outattribs );
 	if ( outattribs.size() > 1 )
 	{
 	    doeval = true;
 	    outid = createEvaluateADS( *procattrset_, outattribs, errmsg);
 	}
+
+	if ( useintermediates_ && !AIC().isEmpty() )
+	    useIntermediateResults( outid, outattribs );
     }
     else
     {
@@ -1337,6 +1418,131 @@ Processor* EngineMan::getProcessor( uiString& errmsg )
 }
 
 
+static void getIntermediateProviders( Provider& prov,
+				      ObjectSet<Provider>& res )
+{
+    for ( auto* inp : prov.getInputs() )
+    {
+	if ( !inp || res.isPresent(inp) || inp->getDesc().isStored() )
+	    continue;
+
+	res += inp;
+	getIntermediateProviders( *inp, res );
+    }
+}
+
+
+void EngineMan::useIntermediateResults( const DescID& outid,
+					const TypeSet<DescID>& outattribs )
+{
+    // Initialize a processor to find the volume needed from each input
+    uiString errmsg;
+    PtrMan<Processor> probe = createProcessor( *procattrset_, geomid_,
+					       outid, errmsg );
+    if ( !probe || !probe->getProvider() )
+	return;
+
+    for ( int idx=1; idx<outattribs.size(); idx++ )
+	probe->addOutputInterest( idx );
+
+    auto* probeout = new DataPackOutput( tkzs_ );
+    probeout->setGeometry( tkzs_ );
+    probe->addOutput( probeout );
+    probe->init();
+
+    ObjectSet<Provider> provs;
+    getIntermediateProviders( *probe->getProvider(), provs );
+    BufferStringSet coveredkeys;
+    for ( const auto* prov : provs )
+    {
+	const TrcKeyZSampling* desvol = prov->getDesiredVolume();
+	if ( !desvol )
+	    continue;
+
+	for ( int iout=0; iout<prov->nrOutputs(); iout++ )
+	{
+	    if ( !prov->isOutputEnabled(iout) )
+		continue;
+
+	    const BufferString key =
+			IntermediateCache::getKey( prov->getDesc(), iout );
+	    if ( !key.isEmpty() && AIC().covers(key,*desvol) )
+		coveredkeys.addIfNew( key );
+	}
+    }
+
+    probe = nullptr;
+    if ( coveredkeys.isEmpty() )
+	return;
+
+    // Replace the inputs that are cached by the cached data
+    const int nrdescs = procattrset_->size();
+    for ( int idx=0; idx<nrdescs; idx++ )
+    {
+	RefMan<Desc> desc = procattrset_->desc( idx );
+	if ( !desc || desc->isStored() )
+	    continue;
+
+	for ( int inpidx=0; inpidx<desc->nrInputs(); inpidx++ )
+	{
+	    ConstRefMan<Desc> inp = desc->getInput( inpidx );
+	    if ( !inp || inp->isStored() )
+		continue;
+
+	    const BufferString key = IntermediateCache::getKey( *inp,
+					mMAX(inp->selectedOutput(),0) );
+	    if ( !coveredkeys.isPresent(key) )
+		continue;
+
+	    const MultiID dpkey = AIC().getDataPackKey( key );
+	    if ( dpkey.isUdf() )
+		continue;
+
+	    const DescID storedid = procattrset_->getStoredID( dpkey, 0, true );
+	    ConstRefMan<Desc> storeddesc = procattrset_->getDesc( storedid );
+	    if ( storeddesc )
+		desc->setInput( inpidx, storeddesc.ptr() );
+	}
+    }
+}
+
+
+void EngineMan::captureIntermediateResults( Processor& proc )
+{
+    if ( !proc.getProvider() )
+	return;
+
+    ObjectSet<Provider> provs;
+    getIntermediateProviders( *proc.getProvider(), provs );
+    for ( auto* prov : provs )
+    {
+	for ( int iout=0; iout<prov->nrOutputs(); iout++ )
+	{
+	    if ( !prov->isOutputEnabled(iout) )
+		continue;
+
+	    const BufferString key =
+			IntermediateCache::getKey( prov->getDesc(), iout );
+	    if ( key.isEmpty() )
+		continue;
+
+	    auto* res = new IntermediateResult( key );
+	    prov->setIntermediateResult( iout, res );
+	    intermresults_ += res;
+	}
+    }
+}
+
+
+void EngineMan::storeIntermediateResults()
+{
+    for ( auto* res : intermresults_ )
+	AIC().add( *res, tkzs_.hsamp_.step_ );
+
+    intermresults_.erase();
+}
+
+
 Processor* EngineMan::createTrcSelOutput( uiString& errmsg,
 					  const BinIDValueSet& bidvalset,
 					  SeisTrcBuf& output, float outval,
@@ -0,0 +1,362 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "attribintermediatecache.h"
+
+#include "attribdesc.h"
+#include "file.h"
+#include "ioman.h"
+#include "ioobj.h"
+#include "odcommonenums.h"
+#include "odsysmem.h"
+#include "ptrman.h"
+#include "seisbuf.h"
+#include "seisbufadapters.h"
+#include "seistrc.h"
+#include "settings.h"
+#include "survinfo.h"
+#include "valseries.h"
+
+namespace Attrib
+{
+
+static const char* sDataPackCategory()	{ return "Intermediate attribute"; }
+
+
+// IntermediateResult
+IntermediateResult::IntermediateResult( const char* key )
+    : key_(key)
+    , trcs_(new SeisTrcBuf(true))
+    , positions_(0,false)
+{
+}
+
+
+IntermediateResult::~IntermediateResult()
+{
+    delete trcs_;
+}
+
+
+void IntermediateResult::add( const BinID& bid, const ValueSeries<float>& vals,
+			      int z0, int nrsamples, float zstep, float extraz )
+{
+    Threads::Locker locker( lock_ );
+    if ( overflow_ || !trcs_ || positions_.includes(bid) )
+	return;
+
+    memsize_ += sizeof(SeisTrc) + sizeof(float) * nrsamples;
+    if ( memsize_ > AIC().maxSize() )
+    {
+	// Will not fit anyway, stop collecting
+	overflow_ = true;
+	trcs_->deepErase();
+	positions_.setEmpty();
+	return;
+    }
+
+    auto* trc = new SeisTrc( nrsamples );
+    trc->info().setPos( bid );
+    trc->info().sampling_.start_ = z0*zstep + extraz;
+    trc->info().sampling_.step_ = zstep;
+    for ( int idx=0; idx<nrsamples; idx++ )
+	trc->set( idx, vals.value(idx), 0 );
+
+    trcs_->add( trc );
+    positions_.add( bid );
+}
+
+
+bool IntermediateResult::isOK() const
+{
+    Threads::Locker locker( lock_ );
+    return !overflow_;
+}
+
+
+od_int64 IntermediateResult::memSize() const
+{
+    Threads::Locker locker( lock_ );
+    return memsize_;
+}
+
+
+// IntermediateCache::Entry
+IntermediateCache::Entry::Entry( const char* key, SeisTrcBufDataPack& pack )
+    : key_(key)
+    , pack_(&pack)
+{
+}
+
+
+IntermediateCache::Entry::~Entry()
+{
+}
+
+
+// IntermediateCache
+IntermediateCache::IntermediateCache()
+{
+    od_int64 totmem, freemem;
+    OD::getSystemMemory( totmem, freemem );
+    int maxsizemb = mCast(int,totmem / 16 / 1024 / 1024);
+    Settings::common().get( sKeyMaxSizeMB(), maxsizemb );
+    maxsize_ = od_int64(maxsizemb) * 1024 * 1024;
+    mAttachCB( IOM().implUpdated, IntermediateCache::clearCB );
+    mAttachCB( IOM().surveyToBeChanged, IntermediateCache::clearCB );
+}
+
+
+IntermediateCache::~IntermediateCache()
+{
+    detachAllNotifiers();
+}
+
+
+const char* IntermediateCache::sKeyMaxSizeMB()
+{
+    return "dTect.Attribute intermediate cache.Max size MB";
+}
+
+
+static bool addKeyStr( const Desc& desc, int output, BufferString& str )
+{
+    if ( desc.isStoredInMem() )
+    {
+	// Our own cached data stand for the attribute they came from
+	const BufferString key = AIC().keyOf( desc.getStoredID() );
+	if ( key.isEmpty() )
+	    return false;
+
+	str.add( key );
+	return true;
+    }
+
+    RefMan<Desc> outdesc = new Desc( desc );
+    outdesc->selectOutput( output );
+    BufferString defstr;
+    outdesc->getDefStr( defstr );
+    str.add( defstr );
+    if ( desc.isSteering() )
+	str.add( " steering" );
+
+    if ( desc.isStored() )
+    {
+	// Output from an earlier version of the stored data is not reused
+	PtrMan<IOObj> ioobj = IOM().get( desc.getStoredID() );
+	if ( !ioobj )
+	    return false;
+
+	const BufferString fnm = ioobj->mainFileName();
+	str.add( " version=" ).add( File::getTimeInSeconds(fnm.buf()) )
+	   .add( "/" ).add( File::getFileSize(fnm.buf()) );
+    }
+
+    for ( int idx=0; idx<desc.nrInputs(); idx++ )
+    {
+	ConstRefMan<Desc> inp = desc.getInput( idx );
+	str.add( " [" );
+	if ( inp && !addKeyStr(*inp,mMAX(inp->selectedOutput(),0),str) )
+	    return false;
+
+	str.add( "]" );
+    }
+
+    return true;
+}
+
+
+BufferString IntermediateCache::getKey( const Desc& desc, int output )
+{
+    BufferString defstr;
+    if ( desc.is2D() || !addKeyStr(desc,output,defstr) )
+	return BufferString();
+
+    return BufferString( defstr.getHash(Crypto::Algorithm::Sha3_256) );
+}
+
+
+bool IntermediateCache::isEmpty() const
+{
+    Threads::Locker locker( lock_ );
+    return entries_.isEmpty();
+}
+
+
+void IntermediateCache::setMaxSize( od_int64 nrbytes, bool writesettings )
+{
+    Threads::Locker locker( lock_ );
+    maxsize_ = nrbytes;
+    limitSize();
+    locker.unlockNow();
+
+    if ( writesettings )
+    {
+	Settings::common().set( sKeyMaxSizeMB(),
+				mCast(int,nrbytes / 1024 / 1024) );
+	Settings::common().write();
+    }
+}
+
+
+od_int64 IntermediateCache::usedSize() const
+{
+    Threads::Locker locker( lock_ );
+    return usedsize_;
+}
+
+
+int IntermediateCache::indexOf( const char* key ) const
+{
+    for ( int idx=0; idx<entries_.size(); idx++ )
+    {
+	if ( entries_[idx]->key_ == key )
+	    return idx;
+    }
+
+    return -1;
+}
+
+
+bool IntermediateCache::covers( const char* key,
+				const TrcKeyZSampling& tkzs ) const
+{
+    Threads::Locker locker( lock_ );
+    const int idx = indexOf( key );
+    if ( idx < 0 )
+	return false;
+
+    const TrcKeyZSampling& covered = entries_[idx]->covered_;
+    const float zeps = 1e-3f * covered.zsamp_.step_;
+    return covered.hsamp_.includes( tkzs.hsamp_, true ) &&
+	   covered.zsamp_.start_ <= tkzs.zsamp_.start_ + zeps &&
+	   covered.zsamp_.stop_ >= tkzs.zsamp_.stop_ - zeps;
+}
+
+
+MultiID IntermediateCache::getDataPackKey( const char* key )
+{
+    Threads::Locker locker( lock_ );
+    const int idx = indexOf( key );
+    if ( idx < 0 )
+	return MultiID::udf();
+
+    Entry& entry = *entries_[idx];
+    entry.stamp_ = ++curstamp_;
+    return entry.pack_->fullID( DataPackMgr::FlatID() ).asMultiID();
+}
+
+
+BufferString IntermediateCache::keyOf( const MultiID& dpkey ) const
+{
+    Threads::Locker locker( lock_ );
+    for ( const auto* entry : entries_ )
+    {
+	if ( entry->pack_->fullID(DataPackMgr::FlatID()).asMultiID() == dpkey )
+	    return entry->key_;
+    }
+
+    return BufferString();
+}
+
+
+bool IntermediateCache::add( IntermediateResult& res, const BinID& step )
+{
+    Threads::Locker reslocker( res.lock_ );
+    if ( res.overflow_ || !res.trcs_ || res.trcs_->isEmpty() ||
+	 res.memsize_ > maxsize_ )
+	return false;
+
+    // Only a full box can stand in for the computation
+    const BinIDValueSet& positions = res.positions_;
+    TrcKeyZSampling covered( false );
+    covered.hsamp_.set( StepInterval<int>(positions.inlRange(),step.inl()),
+		StepInterval<int>(positions.secondRange(-1),step.crl()) );
+    if ( covered.hsamp_.totalNr() != positions.totalSize() )
+	return false;
+
+    SeisTrcBuf& trcs = *res.trcs_;
+    covered.zsamp_ = trcs.get(0)->zRange();
+    for ( int idx=1; idx<trcs.size(); idx++ )
+    {
+	const StepInterval<float> zrg = trcs.get(idx)->zRange();
+	covered.zsamp_.limitTo( zrg );
+    }
+
+    if ( covered.zsamp_.isRev() )
+	return false;
+
+    trcs.sortForWrite( false );
+    auto* pack = new SeisTrcBufDataPack( res.trcs_, Seis::Vol,
+				SeisTrcInfo::BinIDCrl, sDataPackCategory(),
+				SI().zDomainInfo() );
+    res.trcs_ = nullptr;
+    pack->setName( res.key() );
+    DPM(DataPackMgr::FlatID()).add( pack );
+
+    auto* entry = new Entry( res.key(), *pack );
+    entry->covered_ = covered;
+    entry->memsize_ = res.memsize_;
+    reslocker.unlockNow();
+
+    Threads::Locker locker( lock_ );
+    const int idx = indexOf( res.key() );
+    if ( idx >= 0 )
+    {
+	usedsize_ -= entries_[idx]->memsize_;
+	entries_.removeSingle( idx );
+    }
+
+    entry->stamp_ = ++curstamp_;
+    entries_ += entry;
+    usedsize_ += entry->memsize_;
+    limitSize();
+    return true;
+}
+
+
+void IntermediateCache::limitSize()
+{
+    while ( usedsize_ > maxsize_ && !entries_.isEmpty() )
+    {
+	int oldestidx = 0;
+	for ( int idx=1; idx<entries_.size(); idx++ )
+	{
+	    if ( entries_[idx]->stamp_ < entries_[oldestidx]->stamp_ )
+		oldestidx = idx;
+	}
+
+	usedsize_ -= entries_[oldestidx]->memsize_;
+	entries_.removeSingle( oldestidx );
+    }
+}
+
+
+void IntermediateCache::clear()
+{
+    Threads::Locker locker( lock_ );
+    entries_.setEmpty();
+    usedsize_ = 0;
+}
+
+
+void IntermediateCache::clearCB( CallBacker* )
+{
+    clear();
+}
+
+
+IntermediateCache& AIC()
+{
+    mDefineStaticLocalObject(PtrMan<IntermediateCache>,aic,
+			     = new IntermediateCache() );
+    return *aic;
+}
+
+} // namespace Attrib
@@ -24,6 +24,7 @@ DataHolderLineBuffer::~DataHolderLineBuffer()
 
     deepErase( inlinedata_ );
     deepErase( crossliness_ );
+    deepErase( pool_ );
 }
 
 
@@ -42,7 +43,7 @@ DataHolder* DataHolderLineBuffer::createDataHolder( const BinID& bid,
     const int traceidx = crossliness_[lineidx]->indexOf(bid.crl());
     if ( traceidx==-1 )
     {
-	DataHolder* res = new DataHolder( z0, nrsamples );
+	DataHolder* res = getFromPool( z0, nrsamples );
 	(*inlinedata_[lineidx]) += res;
 	(*crossliness_[lineidx]) += bid.crl();
 	return res;
@@ -79,8 +80,7 @@ void DataHolderLineBuffer::removeDataHolder( const BinID& bid )
     const int traceidx = crossliness_[lineidx]->indexOf(bid.crl());
     if ( traceidx==-1 ) return;
 
-    delete (*inlinedata_[lineidx])[traceidx];
-    inlinedata_[lineidx]->removeSingle( traceidx );
+    addToPool( inlinedata_[lineidx]->removeSingle(traceidx) );
     crossliness_[lineidx]->removeSingle(traceidx);
 
     if ( !inlinedata_[lineidx]->size() )
@@ -102,7 +102,7 @@ void DataHolderLineBuffer::removeDataHolder( const BinID& bid )
 	    {\
 		if ( direction.crl()*crosslines[idy] op direction.crl()*bid.crl() )\
 		{ \
-		    delete inlinedata_[idx]->removeSingle(idy);\
+		    addToPool( inlinedata_[idx]->removeSingle(idy) );\
 		    crosslines.removeSingle(idy);\
 		}\
 	    }\
@@ -135,7 +135,11 @@ void DataHolderLineBuffer::removeAllExcept( const BinID& bid )
 
 void DataHolderLineBuffer::removeInline( int lineidx )
 {
-    deepErase( *inlinedata_[lineidx] );
+    ObjectSet<DataHolder>& linedata = *inlinedata_[lineidx];
+    for ( int idx=0; idx<linedata.size(); idx++ )
+	addToPool( linedata[idx] );
+
+    linedata.erase();
     delete inlinedata_.removeSingle( lineidx );
     delete crossliness_.removeSingle( lineidx );
 
@@ -143,4 +147,39 @@ void DataHolderLineBuffer::removeInline( int lineidx )
 }
 
 
+DataHolder* DataHolderLineBuffer::getFromPool( int z0, int nrsamples )
+{
+    for ( int idx=pool_.size()-1; idx>=0; idx-- )
+    {
+	if ( pool_[idx]->nrsamples_ != nrsamples )
+	    continue;
+
+	DataHolder* res = pool_.removeSingle( idx );
+	res->z0_ = z0;
+	res->extrazfromsamppos_ = 0;
+	for ( int iser=0; iser<res->nrSeries(); iser++ )
+	{
+	    res->classstatus_[iser] = -1;
+	    if ( res->series(iser) )
+		res->series(iser)->setAll( mUdf(float) );
+	}
+
+	return res;
+    }
+
+    // The size has changed: the pool would only keep growing
+    if ( !pool_.isEmpty() )
+	delete pool_.removeSingle( 0 );
+
+    return new DataHolder( z0, nrsamples );
+}
+
+
+void DataHolderLineBuffer::addToPool( DataHolder* dh )
+{
+    if ( dh )
+	pool_ += dh;
+}
+
+
 } // namespace Attrib
@@ -333,11 +333,12 @@ static bool isDataType( const char* reqtp )
 }
 
 
-bool SeisTrcStorOutput::doUsePar( const IOPar& pars )
+bool SeisTrcStorOutput::doUsePar( const IOPar& pars, int outputidx )
 {
     errmsg_ = uiString::emptyString();
-    PtrMan<IOPar> outppar = pars.subselect( IOPar::compKey(sKey::Output(),0) );
-    if ( !outppar )
+    PtrMan<IOPar> outppar = pars.subselect(
+		IOPar::compKey(sKey::Output(),outputidx<0 ? 0 : outputidx) );
+    if ( !outppar && outputidx<0 )
 	outppar = pars.subselect( IOPar::compKey(sKey::Output(),1) );
 
     if ( !outppar )
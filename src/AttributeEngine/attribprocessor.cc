@@ -12,6 +12,7 @@ ________________________________________________________________________
 #include "attribdesc.h"
 #include "attribprovider.h"
 #include "binidvalset.h"
+#include "od_ostream.h"
 #include "seisinfo.h"
 #include "seisselectionimpl.h"
 #include "survgeom2d.h"
@@ -340,17 +341,22 @@ void Processor::defineGlobalOutputSpecs( TypeSet<int>& globaloutputinterest,
 	    if ( !globaloutputinterest.isPresent(outpinterest_[idy]) )
 		globaloutputinterest += outpinterest_[idy];
 	}
-	outputs_[idx]->setDesiredOutputs( outpinterest_ );
+	TypeSet<int> desoutputs;
+	outputs_[idx]->getDesiredOutputs( desoutputs );
+	if ( desoutputs.isEmpty() )
+	{
+	    desoutputs = outpinterest_;
+	    outputs_[idx]->setDesiredOutputs( desoutputs );
+	}
 
-	mDynamicCastGet( SeisTrcStorOutput*, storoutp, outputs_[0] );
+	mDynamicCastGet( SeisTrcStorOutput*, storoutp, outputs_[idx] );
 	if ( storoutp )
 	{
 	    TypeSet<Seis::DataType> outptypes;
-	    for ( int ido=0; ido<outpinterest_.size(); ido++ )
-		outptypes += provider_->getDesc().dataType(outpinterest_[ido]);
+	    for ( int ido=0; ido<desoutputs.size(); ido++ )
+		outptypes += provider_->getDesc().dataType(desoutputs[ido]);
 
-	    for ( int idoutp=0; idoutp<outputs_.size(); idoutp++ )
-		((SeisTrcStorOutput*)outputs_[idoutp])->setOutpTypes(outptypes);
+	    storoutp->setOutpTypes( outptypes );
 	}
     }
 }
@@ -561,6 +567,82 @@ void Processor::setRdmPaths( const TypeSet<BinID>& truepath,
 }
 
 
+void Processor::enableStatistics( bool yn )
+{
+    if ( provider_ )
+	provider_->enableStatistics( yn );
+}
+
+
+static void getProviderTree( Provider& prov, ObjectSet<Provider>& provs )
+{
+    if ( provs.isPresent(&prov) )
+	return;
+
+    provs += &prov;
+    for ( auto* inp : prov.getInputs() )
+    {
+	if ( inp )
+	    getProviderTree( *inp, provs );
+    }
+}
+
+
+void Processor::getStatistics( BufferStringSet& providernms,
+			       TypeSet<ProviderStats>& stats ) const
+{
+    providernms.setEmpty();
+    stats.setEmpty();
+    if ( !provider_ )
+	return;
+
+    ObjectSet<Provider> provs;
+    getProviderTree( *const_cast<Provider*>(provider_.ptr()), provs );
+    for ( const auto* prov : provs )
+    {
+	const Desc& desc = prov->getDesc();
+	BufferString nm( desc.userRef() );
+	if ( nm.isEmpty() || desc.isStored() )
+	    nm.add( nm.isEmpty() ? "" : " " ).add( "[" )
+	      .add( desc.attribName() ).add( "]" );
+	else
+	    nm.add( " (" ).add( desc.attribName() ).add( ")" );
+
+	providernms.add( nm );
+	stats += prov->getStatistics();
+    }
+}
+
+
+void Processor::reportStatistics( od_ostream& strm ) const
+{
+    BufferStringSet nms;
+    TypeSet<ProviderStats> stats;
+    getStatistics( nms, stats );
+    if ( stats.isEmpty() )
+	return;
+
+    strm << "\nAttribute provider statistics:\n";
+    for ( int idx=0; idx<stats.size(); idx++ )
+    {
+	const ProviderStats& st = stats[idx];
+	strm << "\n" << nms.get(idx) << ":\n";
+	strm << "  Compute time: " << st.computetime_.load()/1000 << " ms"
+	     << " (including inputs: " << st.totaltime_.load()/1000
+	     << " ms)\n";
+	strm << "  Positions computed: " << st.nrcomputed_.load()
+	     << ", samples: " << st.nrsamples_.load() << "\n";
+	strm << "  Buffer hits: " << st.nrbufferhits_.load()
+	     << ", misses: " << st.nrbuffermisses_.load() << "\n";
+	if ( st.nrtrcsread_.load() > 0 )
+	    strm << "  Traces read: " << st.nrtrcsread_.load()
+		 << ", bytes: " << st.bytesread_.load() << "\n";
+    }
+
+    strm << od_endl;
+}
+
+
 void Processor::showDataAvailabilityErrors( bool yn )
 { showdataavailabilityerrors_ = yn; }
 
@@ -14,10 +14,12 @@ ________________________________________________________________________
 #include "attribdataholder.h"
 #include "attribdescset.h"
 #include "attribfactory.h"
+#include "attribintermediatecache.h"
 #include "attriblinebuffer.h"
 
 #include "binidvalset.h"
 #include "convmemvalseries.h"
+#include "manobjectset.h"
 #include "trckeyzsampling.h"
 #include "ioman.h"
 #include "ptrman.h"
@@ -25,6 +27,7 @@ ________________________________________________________________________
 #include "seisselectionimpl.h"
 #include "survinfo.h"
 #include "survgeom2d.h"
+#include "timefun.h"
 #include "valseriesinterpol.h"
 
 
@@ -81,6 +84,72 @@ protected:
 };
 
 
+/*!\brief Computes the data of several input providers concurrently.
+
+  Each group of inputs heads a subtree that shares no provider with the
+  subtrees of the other groups, hence the line buffers are never accessed by
+  two threads.
+*/
+
+class InputDataTask : public ParallelTask
+{
+public:
+
+InputDataTask( ManagedObjectSet<ObjectSet<Provider> >& groups )
+{
+    // Takes over the groups, appending would delete them in 'groups'
+    while ( !groups.isEmpty() )
+	groups_ += groups.removeAndTake( 0 );
+}
+
+
+int minThreadSize() const override { return 1; }
+
+
+void setVars( const BinID& relpos, int idx )
+{
+    relpos_ = relpos;
+    idx_ = idx;
+}
+
+
+od_int64 nrIterations() const override { return groups_.size(); }
+
+
+bool doWork( od_int64 start, od_int64 stop, int ) override
+{
+    // Failures are reported when the provider asks for the data itself
+    for ( int idx=mCast(int,start); idx<=stop; idx++ )
+    {
+	for ( auto* inp : *groups_[idx] )
+	    inp->getData( relpos_, idx_ );
+    }
+
+    return true;
+}
+
+protected:
+
+    ManagedObjectSet<ObjectSet<Provider> >	groups_;
+    BinID			relpos_;
+    int				idx_	= 0;
+};
+
+
+static void getSubTree( Provider& prov, ObjectSet<Provider>& res )
+{
+    if ( res.isPresent(&prov) )
+	return;
+
+    res += &prov;
+    for ( auto* inp : prov.getInputs() )
+    {
+	if ( inp )
+	    getSubTree( *inp, res );
+    }
+}
+
+
 RefMan<Provider> Provider::create( Desc& desc, uiString& errstr )
 {
     RefObjectSet<Provider> existing;
@@ -233,9 +302,11 @@ Provider::Provider( Desc& nd )
 Provider::~Provider()
 {
     delete providertask_;
+    delete inputdatatask_;
     delete linebuffer_;
     delete possiblevolume_;
     delete desiredvolume_;
+    deepErase( scratchbufs_ );
 }
 
 
@@ -1011,7 +1082,34 @@ const DataHolder* Provider::getData( const BinID& relpos, int idi )
     Interval<int> loczinterval( localcomputezintervals_[idi] );
     if ( constres && constres->z0_ == loczinterval.start_
 	    && constres->nrsamples_ == loczinterval.width()+1 )
+    {
+	if ( statsenabled_ )
+	    stats_.nrbufferhits_++;
+
 	return constres;
+    }
+
+    if ( !statsenabled_ )
+	return computeOutData( relpos, idi );
+
+    stats_.nrbuffermisses_++;
+    Time::Counter counter;
+    counter.start();
+    const DataHolder* res = computeOutData( relpos, idi );
+    stats_.totaltime_ += counter.elapsedUs();
+    if ( res )
+    {
+	stats_.nrcomputed_++;
+	stats_.nrsamples_ += res->nrsamples_;
+    }
+
+    return res;
+}
+
+
+const DataHolder* Provider::computeOutData( const BinID& relpos, int idi )
+{
+    const Interval<int> loczinterval( localcomputezintervals_[idi] );
 
     if ( !linebuffer_ )
 	linebuffer_ = new DataHolderLineBuffer;
@@ -1019,6 +1117,9 @@ const DataHolder* Provider::getData( const BinID& relpos, int idi )
     DataHolder* outdata =
 	linebuffer_->createDataHolder( currentbid_+relpos, loczinterval.start_,
 				      loczinterval.width()+1 );
+    if ( parallel_ )
+	prepareInputData( relpos, idi );
+
     if ( !outdata || !getInputData(relpos, idi) )
     {
 	if ( outdata ) linebuffer_->removeDataHolder( currentbid_+relpos );
@@ -1070,6 +1171,13 @@ const DataHolder* Provider::getData( const BinID& relpos, int idi )
     if ( needinterp_ )
 	outdata->extrazfromsamppos_ = getExtraZFromSampInterval( z0, nrsamples);
 
+    PtrMan<Time::Counter> counter;
+    if ( statsenabled_ )
+    {
+	counter = new Time::Counter;
+	counter->start();
+    }
+
     bool success = false;
     if ( !parallel_ || !allowParallelComputation() )
     {
@@ -1087,16 +1195,154 @@ const DataHolder* Provider::getData( const BinID& relpos, int idi )
 	success = providertask_->execute();
     }
 
+    if ( counter )
+	stats_.computetime_ += counter->elapsedUs();
+
     if ( !success )
     {
 	linebuffer_->removeDataHolder( currentbid_+relpos );
 	return 0;
     }
 
+    if ( !intermresults_.isEmpty() && localcomputezintervals_.size() == 1 )
+	addToIntermediateResults( relpos, *outdata );
+
     return outdata;
 }
 
 
+void Provider::enableStatistics( bool yn )
+{
+    statsenabled_ = yn;
+    stats_.reset();
+    for ( auto* inp : inputs_ )
+    {
+	if ( inp && inp->statsenabled_ != yn )
+	    inp->enableStatistics( yn );
+    }
+}
+
+
+float* Provider::getScratchBuffer( int threadidx, int bufidx,
+				   int nrvals ) const
+{
+    if ( threadidx < 0 || bufidx < 0 || nrvals < 1 )
+	return nullptr;
+
+    const od_int64 key = (od_int64(threadidx) << 32) + bufidx;
+    Threads::Locker locker( scratchlock_ );
+    int idx = scratchkeys_.indexOf( key );
+    if ( idx < 0 )
+    {
+	scratchbufs_ += new TypeSet<float>;
+	scratchkeys_ += key;
+	idx = scratchkeys_.size()-1;
+    }
+
+    TypeSet<float>& buf = *scratchbufs_[idx];
+    if ( buf.size() < nrvals )
+	buf.setSize( nrvals );
+
+    return buf.arr();
+}
+
+
+void Provider::setIntermediateResult( int output, IntermediateResult* res )
+{
+    if ( output < 0 )
+	return;
+
+    intermresults_.setNullAllowed();
+    while ( intermresults_.size() <= output )
+	intermresults_ += nullptr;
+
+    intermresults_.replace( output, res );
+}
+
+
+void Provider::addToIntermediateResults( const BinID& relpos,
+					 const DataHolder& data )
+{
+    for ( int idx=0; idx<intermresults_.size(); idx++ )
+    {
+	const ValueSeries<float>* vals = data.series( idx );
+	if ( intermresults_[idx] && vals )
+	    intermresults_[idx]->add( currentbid_+relpos, *vals, data.z0_,
+			data.nrsamples_, refstep_, data.extrazfromsamppos_ );
+    }
+}
+
+
+void Provider::prepareInputData( const BinID& relpos, int idi )
+{
+    if ( !inputdatataskdone_ )
+    {
+	inputdatataskdone_ = true;
+	ManagedObjectSet<ObjectSet<Provider> > subtrees, groups;
+	for ( auto* inp : inputs_ )
+	{
+	    if ( !inp )
+		continue;
+
+	    auto* subtree = new ObjectSet<Provider>;
+	    auto* group = new ObjectSet<Provider>;
+	    *group += inp;
+	    getSubTree( *inp, *subtree );
+	    for ( int idx=subtrees.size()-1; idx>=0; idx-- )
+	    {
+		bool overlaps = false;
+		for ( const auto* prov : *subtrees[idx] )
+		{
+		    if ( subtree->isPresent(prov) )
+			{ overlaps = true; break; }
+		}
+
+		if ( !overlaps )
+		    continue;
+
+		// Dependent subtrees have to be computed by the same thread
+		for ( auto* prov : *subtrees[idx] )
+		{
+		    if ( !subtree->isPresent(prov) )
+			*subtree += prov;
+		}
+
+		groups[idx]->append( *group );
+		*group = *groups[idx];
+		subtrees.removeSingle( idx );
+		groups.removeSingle( idx );
+	    }
+
+	    subtrees += subtree;
+	    groups += group;
+	}
+
+	// Reading from the stored data buffers is not worth a thread
+	for ( int idx=subtrees.size()-1; idx>=0; idx-- )
+	{
+	    bool needscomputing = false;
+	    for ( const auto* prov : *subtrees[idx] )
+	    {
+		if ( !prov->getDesc().isStored() )
+		    { needscomputing = true; break; }
+	    }
+
+	    if ( !needscomputing )
+		groups.removeSingle( idx );
+	}
+
+	if ( groups.size() > 1 )
+	    inputdatatask_ = new InputDataTask( groups );
+    }
+
+    if ( !inputdatatask_ )
+	return;
+
+    inputdatatask_->setVars( relpos, idi );
+    inputdatatask_->execute();
+}
+
+
 const DataHolder* Provider::getDataDontCompute( const BinID& relpos ) const
 {
     return linebuffer_ ? linebuffer_->getDataHolder(currentbid_+relpos) : 0;
@@ -1218,6 +1464,8 @@ void Provider::setInput( int inp, Provider* np )
     }
 
     inputs_.replace( inp, np );
+    deleteAndNullPtr( inputdatatask_ );
+    inputdatataskdone_ = false;
     if ( !inputs_[inp] )
 	return;
 
@@ -1828,4 +2076,30 @@ bool Provider::getDataUnavailableFlag() const
 }
 
 
+// ProviderStats
+bool ProviderStats::operator==( const ProviderStats& oth ) const
+{
+    return computetime_.load() == oth.computetime_.load() &&
+	   totaltime_.load() == oth.totaltime_.load() &&
+	   nrcomputed_.load() == oth.nrcomputed_.load() &&
+	   nrsamples_.load() == oth.nrsamples_.load() &&
+	   nrbufferhits_.load() == oth.nrbufferhits_.load() &&
+	   nrbuffermisses_.load() == oth.nrbuffermisses_.load() &&
+	   nrtrcsread_.load() == oth.nrtrcsread_.load() &&
+	   bytesread_.load() == oth.bytesread_.load();
+}
+
+
+void ProviderStats::fillPar( IOPar& par ) const
+{
+    par.set( "Compute time (us)", computetime_.load() );
+    par.set( "Total time (us)", totaltime_.load() );
+    par.set( "Positions computed", nrcomputed_.load() );
+    par.set( "Samples computed", nrsamples_.load() );
+    par.set( "Buffer hits", nrbufferhits_.load() );
+    par.set( "Buffer misses", nrbuffermisses_.load() );
+    par.set( "Traces read", nrtrcsread_.load() );
+    par.set( "Bytes read", bytesread_.load() );
+}
+
 } // namespace Attrib
@@ -0,0 +1,438 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "attribresultcache.h"
+
+#include "attribdesc.h"
+#include "attribdescset.h"
+#include "dirlist.h"
+#include "file.h"
+#include "filepath.h"
+#include "ioman.h"
+#include "ioobj.h"
+#include "iopar.h"
+#include "od_istream.h"
+#include "od_ostream.h"
+#include "odcommonenums.h"
+#include "oddirs.h"
+#include "seisdatapack.h"
+#include "settings.h"
+#include "sorting.h"
+#include "timefun.h"
+
+namespace Attrib
+{
+
+static const char* sKeyFileType()	{ return "Attribute cache entry"; }
+static const char* sKeyComponents()	{ return "Components"; }
+static const char* sKeyCacheDir()	{ return "AttribCache"; }
+static const char* sParExt()		{ return "par"; }
+static const char* sBinExt()		{ return "bin"; }
+
+
+static bool addDefStr( const Desc& desc, BufferString& str )
+{
+    if ( desc.isStoredInMem() )
+	return false;
+
+    BufferString defstr;
+    desc.getDefStr( defstr );
+    str.add( defstr );
+    if ( desc.isStored() )
+    {
+	PtrMan<IOObj> ioobj = IOM().get( desc.getStoredID() );
+	if ( !ioobj )
+	    return false;
+
+	const BufferString fnm = ioobj->mainFileName();
+	str.add( " version=" ).add( File::getTimeInSeconds(fnm.buf()) )
+	   .add( "/" ).add( File::getFileSize(fnm.buf()) );
+    }
+
+    for ( int idx=0; idx<desc.nrInputs(); idx++ )
+    {
+	ConstRefMan<Desc> inp = desc.getInput( idx );
+	str.add( " [" );
+	if ( inp && !addDefStr(*inp,str) )
+	    return false;
+
+	str.add( "]" );
+    }
+
+    return true;
+}
+
+
+static bool isAligned( const TrcKeyZSampling& cs1, const TrcKeyZSampling& cs2 )
+{
+    const TrcKeySampling& hs1 = cs1.hsamp_;
+    const TrcKeySampling& hs2 = cs2.hsamp_;
+    if ( hs1.step_ != hs2.step_ ||
+	 (hs1.start_.inl() - hs2.start_.inl()) % hs2.step_.inl() ||
+	 (hs1.start_.crl() - hs2.start_.crl()) % hs2.step_.crl() )
+	return false;
+
+    const float zstep = cs2.zsamp_.step_;
+    if ( !mIsEqual(cs1.zsamp_.step_,zstep,mDefEps) )
+	return false;
+
+    const float zoffs = (cs1.zsamp_.start_ - cs2.zsamp_.start_) / zstep;
+    return mIsEqual(zoffs,mNINT32(zoffs),1e-3f);
+}
+
+
+static BufferString binFileName( const char* parfnm )
+{
+    FilePath fp( parfnm );
+    fp.setExtension( sBinExt() );
+    return fp.fullPath();
+}
+
+
+static void removeEntry( const char* parfnm )
+{
+    File::remove( binFileName(parfnm) );
+    File::remove( parfnm );
+}
+
+
+ResultCache& ARC()
+{
+    mDefineStaticLocalObject(PtrMan<ResultCache>,arc,= new ResultCache() );
+    return *arc;
+}
+
+
+ResultCache::ResultCache()
+{
+    int maxsizemb = 2048;
+    Settings::common().get( sKeyMaxSizeMB(), maxsizemb );
+    maxsize_ = od_int64(maxsizemb) * 1024 * 1024;
+}
+
+
+ResultCache::~ResultCache()
+{
+}
+
+
+const char* ResultCache::sKeyMaxSizeMB()
+{
+    return "dTect.Attribute cache.Max size MB";
+}
+
+
+void ResultCache::setMaxSize( od_int64 nrbytes, bool writesettings )
+{
+    Threads::Locker locker( lock_ );
+    maxsize_ = nrbytes;
+    if ( writesettings )
+    {
+	const int maxsizemb = int( nrbytes / 1024 / 1024 );
+	Settings::common().set( sKeyMaxSizeMB(), maxsizemb );
+	Settings::common().write();
+    }
+
+    limitSize();
+}
+
+
+BufferString ResultCache::cacheDir() const
+{
+    return BufferString( GetProcFileName(sKeyCacheDir()) );
+}
+
+
+BufferString ResultCache::getKey( const DescSet& ds,
+				  const TypeSet<SelSpec>& specs )
+{
+    if ( specs.isEmpty() || ds.is2D() )
+	return BufferString();
+
+    BufferString defstr;
+    bool allstored = true;
+    for ( const auto& spec : specs )
+    {
+	if ( spec.isNLA() )
+	    return BufferString();
+
+	ConstRefMan<Desc> desc = ds.getDesc( spec.id() );
+	if ( !desc || !addDefStr(*desc,defstr) )
+	    return BufferString();
+
+	if ( !desc->isStored() )
+	    allstored = false;
+
+	defstr.add( " zdomain=" ).add( spec.zDomainKey() ).addNewLine();
+    }
+
+    // Stored data are read faster from their own files
+    if ( allstored )
+	return BufferString();
+
+    return BufferString( defstr.getHash(Crypto::Algorithm::Sha3_256) );
+}
+
+
+void ResultCache::touch( const char* parfnm ) const
+{
+    IOPar par;
+    if ( !par.read(parfnm,sKeyFileType()) )
+	return;
+
+    par.set( sKeyLastUsed(), Time::getMilliSeconds() );
+    par.write( parfnm, sKeyFileType() );
+}
+
+
+RefMan<RegularSeisDataPack> ResultCache::get( const char* key,
+					const TrcKeyZSampling& tkzs ) const
+{
+    Threads::Locker locker( lock_ );
+    if ( !isEnabled() || !key || !*key )
+	return nullptr;
+
+    const BufferString mask( key, "_*.", sParExt() );
+    const DirList dl( cacheDir(), File::DirListType::FilesInDir, mask );
+    BufferString bestfnm;
+    IOPar bestpar;
+    TrcKeyZSampling bestcs( false ), bestintersect( false );
+    od_int64 bestnr = 0;
+    for ( int idx=0; idx<dl.size(); idx++ )
+    {
+	IOPar par;
+	TrcKeyZSampling cs( false ), intersect( false );
+	if ( !par.read(dl.fullPath(idx),sKeyFileType()) || !cs.usePar(par) ||
+	     !isAligned(cs,tkzs) || !cs.getIntersection(tkzs,intersect) )
+	    continue;
+
+	const od_int64 nr = intersect.totalNr();
+	if ( nr <= bestnr )
+	    continue;
+
+	bestnr = nr;
+	bestfnm = dl.fullPath( idx );
+	bestpar = par;
+	bestcs = cs;
+	bestintersect = intersect;
+    }
+
+    if ( bestfnm.isEmpty() )
+	return nullptr;
+
+    BufferStringSet compnms;
+    bestpar.get( sKeyComponents(), compnms );
+    od_istream strm( binFileName(bestfnm) );
+    if ( compnms.isEmpty() || !strm.isOK() )
+	return nullptr;
+
+    RefMan<RegularSeisDataPack> dp = new RegularSeisDataPack(
+				VolumeDataPack::categoryStr(bestintersect) );
+    dp->setSampling( bestintersect );
+    for ( const auto* compnm : compnms )
+    {
+	if ( !dp->addComponent(compnm->buf()) )
+	    return nullptr;
+    }
+
+    const TrcKeySampling& hs = bestintersect.hsamp_;
+    const int nrinl = bestcs.nrInl();
+    const int nrcrl = bestcs.nrCrl();
+    const int nrz = bestcs.nrZ();
+    const int outnrz = bestintersect.nrZ();
+    const int z0 = bestcs.zsamp_.nearestIndex( bestintersect.zsamp_.start_ );
+    TypeSet<float> trc( outnrz, mUdf(float) );
+    for ( int icomp=0; icomp<compnms.size(); icomp++ )
+    {
+	Array3D<float>& arr = dp->data( icomp );
+	float* arrptr = arr.getData();
+	for ( int iinl=0; iinl<hs.nrInl(); iinl++ )
+	{
+	    const int inl = hs.inlRange().atIndex( iinl );
+	    const int inlidx = bestcs.hsamp_.inlIdx( inl );
+	    for ( int icrl=0; icrl<hs.nrCrl(); icrl++ )
+	    {
+		const int crl = hs.crlRange().atIndex( icrl );
+		const int crlidx = bestcs.hsamp_.crlIdx( crl );
+		const od_int64 offs =
+		    ( (od_int64(icomp)*nrinl + inlidx) * nrcrl + crlidx )
+		    * nrz + z0;
+		strm.setReadPosition( offs * sizeof(float) );
+		float* outptr = trc.arr();
+		if ( arrptr )
+		    outptr = arrptr + arr.info().getOffset( iinl, icrl, 0 );
+		if ( !strm.getBin(outptr,outnrz*sizeof(float)) )
+		    return nullptr;
+
+		if ( arrptr )
+		    continue;
+
+		for ( int iz=0; iz<outnrz; iz++ )
+		    arr.set( iinl, icrl, iz, trc[iz] );
+	    }
+	}
+    }
+
+    touch( bestfnm );
+    return dp;
+}
+
+
+bool ResultCache::store( const char* key, const RegularSeisDataPack& dp )
+{
+    Threads::Locker locker( lock_ );
+    const TrcKeyZSampling& tkzs = dp.sampling();
+    if ( !isEnabled() || !key || !*key || dp.isEmpty() || dp.is2D() ||
+	 !tkzs.isDefined() )
+	return false;
+
+    const od_int64 nrbytes = tkzs.totalNr() * dp.nrComponents()
+			   * sizeof(float);
+    if ( nrbytes > maxsize_ )
+	return false;
+
+    const BufferString dir = cacheDir();
+    if ( !File::exists(dir) && !File::createDir(dir) )
+	return false;
+
+    const BufferString mask( key, "_*.", sParExt() );
+    const DirList dl( dir, File::DirListType::FilesInDir, mask );
+    for ( int idx=0; idx<dl.size(); idx++ )
+    {
+	const BufferString parfnm = dl.fullPath( idx );
+	IOPar par;
+	TrcKeyZSampling cs( false );
+	if ( !par.read(parfnm,sKeyFileType()) || !cs.usePar(par) ||
+	     !isAligned(cs,tkzs) )
+	    continue;
+
+	if ( cs.includes(tkzs) )
+	    { touch( parfnm ); return true; }
+
+	if ( tkzs.includes(cs) )
+	    removeEntry( parfnm );
+    }
+
+    BufferString parfnm;
+    for ( int nr=0; ; nr++ )
+    {
+	FilePath fp( dir, BufferString(key,"_").add(nr) );
+	fp.setExtension( sParExt() );
+	parfnm = fp.fullPath();
+	if ( !File::exists(parfnm) )
+	    break;
+    }
+
+    const BufferString binfnm = binFileName( parfnm );
+    od_ostream strm( binfnm );
+    const TrcKeySampling& hs = tkzs.hsamp_;
+    const int nrz = tkzs.nrZ();
+    TypeSet<float> trc( nrz, mUdf(float) );
+    BufferStringSet compnms;
+    for ( int icomp=0; icomp<dp.nrComponents() && strm.isOK(); icomp++ )
+    {
+	compnms.add( dp.getComponentName(icomp) );
+	const Array3D<float>& arr = dp.data( icomp );
+	const float* arrptr = arr.getData();
+	for ( int iinl=0; iinl<hs.nrInl(); iinl++ )
+	{
+	    for ( int icrl=0; icrl<hs.nrCrl(); icrl++ )
+	    {
+		const float* trcptr = trc.arr();
+		if ( arrptr )
+		    trcptr = arrptr + arr.info().getOffset( iinl, icrl, 0 );
+		else
+		{
+		    for ( int iz=0; iz<nrz; iz++ )
+			trc[iz] = arr.get( iinl, icrl, iz );
+		}
+
+		strm.addBin( trcptr, nrz*sizeof(float) );
+	    }
+	}
+    }
+
+    if ( !strm.isOK() )
+    {
+	strm.close();
+	File::remove( binfnm );
+	return false;
+    }
+
+    strm.close();
+    IOPar par;
+    tkzs.fillPar( par );
+    par.set( sKeyComponents(), compnms );
+    par.set( sKeyLastUsed(), Time::getMilliSeconds() );
+    if ( !par.write(parfnm,sKeyFileType()) )
+    {
+	File::remove( binfnm );
+	return false;
+    }
+
+    limitSize();
+    return true;
+}
+
+
+od_int64 ResultCache::usedSize() const
+{
+    Threads::Locker locker( lock_ );
+    const BufferString mask( "*.", sBinExt() );
+    const DirList dl( cacheDir(), File::DirListType::FilesInDir, mask );
+    od_int64 totsz = 0;
+    for ( int idx=0; idx<dl.size(); idx++ )
+	totsz += File::getFileSize( dl.fullPath(idx) );
+
+    return totsz;
+}
+
+
+void ResultCache::limitSize()
+{
+    const BufferString mask( "*.", sParExt() );
+    const DirList dl( cacheDir(), File::DirListType::FilesInDir, mask );
+    const int sz = dl.size();
+    TypeSet<od_int64> lastused( sz, 0 );
+    TypeSet<od_int64> sizes( sz, 0 );
+    TypeSet<int> idxs( sz, 0 );
+    od_int64 totsz = 0;
+    for ( int idx=0; idx<sz; idx++ )
+    {
+	IOPar par;
+	if ( par.read(dl.fullPath(idx),sKeyFileType()) )
+	    par.get( sKeyLastUsed(), lastused[idx] );
+
+	sizes[idx] = File::getFileSize( binFileName(dl.fullPath(idx)) );
+	totsz += sizes[idx];
+	idxs[idx] = idx;
+    }
+
+    if ( totsz <= maxsize_ )
+	return;
+
+    sort_coupled( lastused.arr(), idxs.arr(), sz );
+    for ( int idx=0; idx<sz && totsz>maxsize_; idx++ )
+    {
+	const int entryidx = idxs[idx];
+	removeEntry( dl.fullPath(entryidx) );
+	totsz -= sizes[entryidx];
+    }
+}
+
+
+void ResultCache::clear()
+{
+    Threads::Locker locker( lock_ );
+    const DirList dl( cacheDir(), File::DirListType::FilesInDir );
+    for ( int idx=0; idx<dl.size(); idx++ )
+	File::remove( dl.fullPath(idx) );
+}
+
+} // namespace Attrib
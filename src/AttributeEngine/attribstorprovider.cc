@@ -323,6 +323,15 @@ int StorageProvider::moveToNextTrace( BinID startpos, bool firstcheck )
 		    SeisTrc* trc = mscprov_->get( 0, 0 );
 		    if ( !trc ) continue; // should not happen
 
+		    if ( statsenabled_ )
+		    {
+			stats_.nrtrcsread_++;
+			const TraceData& td = trc->data();
+			for ( int icomp=0; icomp<td.nrComponents(); icomp++ )
+			    stats_.bytesread_ += td.size( icomp ) *
+				    (od_int64)td.bytesPerSample( icomp );
+		    }
+
 		    registerNewPosInfo( trc, startpos, firstcheck,
 					advancefurther );
 		}
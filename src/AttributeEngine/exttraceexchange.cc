@@ -0,0 +1,405 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "exttraceexchange.h"
+
+#include "seisbuf.h"
+#include "seistrc.h"
+#include "thread.h"
+#include "timefun.h"
+
+#include <atomic>
+#include <string.h>
+
+#ifdef __win__
+# include "winutils.h"
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+namespace Attrib
+{
+
+ExtTraceExchange::ExtTraceExchange( const char* nm, int nrslots,
+				    int maxnrtrcs, int maxnrsamples,
+				    int nrinpcomps, int nroutcomps )
+    : name_(nm)
+{
+    if ( name_.isEmpty() || nrslots<1 || maxnrtrcs<1 || maxnrsamples<1 ||
+	 nrinpcomps<1 || nroutcomps<1 )
+    {
+	errmsg_ = tr("Invalid shared memory layout");
+	return;
+    }
+
+    const od_int64 slotsz = sizeof(od_int32) * 2 * maxnrtrcs +
+		sizeof(float) * (nrinpcomps+nroutcomps) * maxnrtrcs *
+		(od_int64)maxnrsamples;
+    totsz_ = sizeof(Header) + sizeof(SlotHeader) * nrslots + slotsz * nrslots;
+
+#ifdef __win__
+    const DWORD szhigh = mCast(DWORD,totsz_ >> 32);
+    const DWORD szlow = mCast(DWORD,totsz_ & 0xFFFFFFFF);
+    HANDLE handle = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL,
+				PAGE_READWRITE, szhigh, szlow, name_.buf() );
+    if ( !handle )
+    {
+	errmsg_ = tr("Cannot create shared memory '%1'").arg( name_ );
+	return;
+    }
+
+    data_ = (char*)MapViewOfFile( handle, FILE_MAP_ALL_ACCESS, 0, 0, 0 );
+    if ( !data_ )
+    {
+	CloseHandle( handle );
+	errmsg_ = tr("Cannot map shared memory '%1'").arg( name_ );
+	return;
+    }
+
+    maphandle_ = handle;
+#else
+    const BufferString shmnm( "/", name_ );
+    const int fd = shm_open( shmnm.buf(), O_CREAT | O_RDWR, 0600 );
+    if ( fd < 0 )
+    {
+	errmsg_ = tr("Cannot create shared memory '%1'").arg( name_ );
+	return;
+    }
+
+    if ( ftruncate(fd,totsz_) != 0 )
+    {
+	close( fd );
+	shm_unlink( shmnm.buf() );
+	errmsg_ = tr("Cannot allocate %1 bytes of shared memory")
+		    .arg( totsz_ );
+	return;
+    }
+
+    void* ptr = mmap( nullptr, totsz_, PROT_READ | PROT_WRITE, MAP_SHARED,
+		      fd, 0 );
+    close( fd );
+    if ( ptr == MAP_FAILED )
+    {
+	shm_unlink( shmnm.buf() );
+	errmsg_ = tr("Cannot map shared memory '%1'").arg( name_ );
+	return;
+    }
+
+    data_ = (char*)ptr;
+#endif
+
+    memset( data_, 0, sizeof(Header) + sizeof(SlotHeader) * nrslots );
+    Header& hdr = header();
+    hdr.version_ = version();
+    hdr.nrslots_ = nrslots;
+    hdr.maxnrtrcs_ = maxnrtrcs;
+    hdr.maxnrsamples_ = maxnrsamples;
+    hdr.nrinpcomps_ = nrinpcomps;
+    hdr.nroutcomps_ = nroutcomps;
+    // The magic goes last: it tells the other side the header is complete
+    std::atomic_thread_fence( std::memory_order_release );
+    memcpy( hdr.magic_, sMagic(), sizeof(hdr.magic_) );
+}
+
+
+ExtTraceExchange::~ExtTraceExchange()
+{
+    if ( !data_ )
+	return;
+
+    setShutdown();
+#ifdef __win__
+    UnmapViewOfFile( data_ );
+    CloseHandle( (HANDLE)maphandle_ );
+#else
+    munmap( data_, totsz_ );
+    const BufferString shmnm( "/", name_ );
+    shm_unlink( shmnm.buf() );
+#endif
+}
+
+
+ExtTraceExchange::Header& ExtTraceExchange::header() const
+{
+    return *reinterpret_cast<Header*>( data_ );
+}
+
+
+ExtTraceExchange::SlotHeader& ExtTraceExchange::slotHeader( int slot ) const
+{
+    auto* slothdrs = reinterpret_cast<SlotHeader*>( data_ + sizeof(Header) );
+    return slothdrs[slot];
+}
+
+
+int ExtTraceExchange::nrSlots() const
+{
+    return data_ ? header().nrslots_ : 0;
+}
+
+
+int ExtTraceExchange::maxNrTraces() const
+{
+    return data_ ? header().maxnrtrcs_ : 0;
+}
+
+
+od_int64 ExtTraceExchange::slotDataSize() const
+{
+    const Header& hdr = header();
+    return sizeof(od_int32) * 2 * hdr.maxnrtrcs_ +
+	   sizeof(float) * (hdr.nrinpcomps_+hdr.nroutcomps_) * hdr.maxnrtrcs_ *
+	   (od_int64)hdr.maxnrsamples_;
+}
+
+
+od_int32* ExtTraceExchange::posData( int slot, bool trcnrs ) const
+{
+    char* slotdata = data_ + sizeof(Header) +
+		     sizeof(SlotHeader) * header().nrslots_ +
+		     slotDataSize() * slot;
+    auto* res = reinterpret_cast<od_int32*>( slotdata );
+    return trcnrs ? res + header().maxnrtrcs_ : res;
+}
+
+
+float* ExtTraceExchange::sampleData( int slot, bool output, int comp ) const
+{
+    const Header& hdr = header();
+    const od_int64 compsz = hdr.maxnrtrcs_ * (od_int64)hdr.maxnrsamples_;
+    auto* res = reinterpret_cast<float*>( posData(slot,true) +
+					  hdr.maxnrtrcs_ );
+    if ( output )
+	res += hdr.nrinpcomps_ * compsz;
+
+    return res + comp * compsz;
+}
+
+
+ExtTraceExchange::SlotState ExtTraceExchange::getState( int slot ) const
+{
+    const volatile od_int32& state = slotHeader( slot ).state_;
+    const SlotState res = (SlotState)state;
+    std::atomic_thread_fence( std::memory_order_acquire );
+    return res;
+}
+
+
+void ExtTraceExchange::setState( int slot, SlotState state )
+{
+    std::atomic_thread_fence( std::memory_order_release );
+    volatile od_int32& slotstate = slotHeader( slot ).state_;
+    slotstate = (od_int32)state;
+}
+
+
+void ExtTraceExchange::setShutdown()
+{
+    if ( !data_ )
+	return;
+
+    std::atomic_thread_fence( std::memory_order_release );
+    volatile od_int32& shutdown = header().shutdown_;
+    shutdown = 1;
+}
+
+
+int ExtTraceExchange::putBatch( const SeisTrcBuf& inp, int firsttrc,
+				int& nrput )
+{
+    nrput = 0;
+    if ( !data_ || !inp.validIdx(firsttrc) )
+	return -1;
+
+    // A slot of an earlier generation was reset: only late writes can have
+    // changed its state since
+    const Header& hdr = header();
+    const int slot = putslot_;
+    if ( getState(slot) != Free &&
+	 slotHeader(slot).generation_ == hdr.generation_ )
+	return -1;
+
+    nrput = mMIN( hdr.maxnrtrcs_, inp.size()-firsttrc );
+    int nrsamples = 0;
+    for ( int itrc=0; itrc<nrput; itrc++ )
+    {
+	const int trcsz = inp.get(firsttrc+itrc)->size();
+	if ( trcsz > nrsamples )
+	    nrsamples = trcsz;
+    }
+
+    if ( nrsamples > hdr.maxnrsamples_ )
+	nrsamples = hdr.maxnrsamples_;
+
+    od_int32* linenrs = posData( slot, false );
+    od_int32* trcnrs = posData( slot, true );
+    for ( int itrc=0; itrc<nrput; itrc++ )
+    {
+	const SeisTrc& trc = *inp.get( firsttrc+itrc );
+	linenrs[itrc] = trc.info().trcKey().lineNr();
+	trcnrs[itrc] = trc.info().trcKey().trcNr();
+	const int trcsz = mMIN( trc.size(), nrsamples );
+	const int nrcomps = mMIN( trc.nrComponents(), hdr.nrinpcomps_ );
+	for ( int icomp=0; icomp<hdr.nrinpcomps_; icomp++ )
+	{
+	    float* vals = sampleData( slot, false, icomp ) +
+			  itrc * (od_int64)hdr.maxnrsamples_;
+	    const int nrcompsamps = icomp < nrcomps ? trcsz : 0;
+	    for ( int isamp=0; isamp<nrcompsamps; isamp++ )
+		vals[isamp] = trc.get( isamp, icomp );
+	    for ( int isamp=nrcompsamps; isamp<nrsamples; isamp++ )
+		vals[isamp] = mUdf(float);
+	}
+    }
+
+    const SeisTrc& firsttrcobj = *inp.get( firsttrc );
+    SlotHeader& slothdr = slotHeader( slot );
+    slothdr.nrtrcs_ = nrput;
+    slothdr.nrsamples_ = nrsamples;
+    slothdr.seqnr_ = seqnr_++;
+    slothdr.doneseqnr_ = -1;
+    slothdr.generation_ = hdr.generation_;
+    slothdr.z0_ = firsttrcobj.info().sampling_.start_;
+    slothdr.zstep_ = firsttrcobj.info().sampling_.step_;
+    setState( slot, Input );
+
+    putslot_ = (putslot_+1) % hdr.nrslots_;
+    return slot;
+}
+
+
+bool ExtTraceExchange::isStale( int slot ) const
+{
+    const SlotHeader& slothdr = slotHeader( slot );
+    return getState(slot) == Output && slothdr.doneseqnr_ != slothdr.seqnr_;
+}
+
+
+bool ExtTraceExchange::isDone( int slot ) const
+{
+    if ( !data_ || slot<0 || slot>=header().nrslots_ ||
+	 getState(slot) != Output )
+	return false;
+
+    const SlotHeader& slothdr = slotHeader( slot );
+    return slothdr.doneseqnr_ == slothdr.seqnr_;
+}
+
+
+void ExtTraceExchange::reset()
+{
+    if ( !data_ )
+	return;
+
+    Header& hdr = header();
+    hdr.generation_++;
+    for ( int slot=0; slot<hdr.nrslots_; slot++ )
+    {
+	// A batch of a reset slot must never match a later sequence number
+	slotHeader( slot ).seqnr_ = -1;
+	setState( slot, Free );
+    }
+}
+
+
+bool ExtTraceExchange::getBatch( int slot, const SeisTrcBuf& inp,
+				 int firsttrc, SeisTrcBuf& outp )
+{
+    if ( !isDone(slot) )
+	return false;
+
+    const Header& hdr = header();
+    const SlotHeader& slothdr = slotHeader( slot );
+    const int nrsamples = slothdr.nrsamples_;
+    for ( int itrc=0; itrc<slothdr.nrtrcs_; itrc++ )
+    {
+	if ( !inp.validIdx(firsttrc+itrc) )
+	    break;
+
+	auto* trc = new SeisTrc( nrsamples );
+	trc->info() = inp.get( firsttrc+itrc )->info();
+	trc->setNrComponents( hdr.nroutcomps_ );
+	for ( int icomp=0; icomp<hdr.nroutcomps_; icomp++ )
+	{
+	    const float* vals = sampleData( slot, true, icomp ) +
+				itrc * (od_int64)hdr.maxnrsamples_;
+	    for ( int isamp=0; isamp<nrsamples; isamp++ )
+		trc->set( isamp, vals[isamp], icomp );
+	}
+
+	outp.add( trc );
+    }
+
+    setState( slot, Free );
+    return true;
+}
+
+
+bool ExtTraceExchange::process( const SeisTrcBuf& inp, SeisTrcBuf& outp,
+				double timeout )
+{
+    if ( !data_ )
+	return false;
+
+    const int nrslots = header().nrslots_;
+    TypeSet<int> firsttrcs( nrslots, -1 );
+    int nextinp = 0;
+    int getslot = putslot_;
+    od_int64 lastprogress = Time::getMilliSeconds();
+    while ( true )
+    {
+	bool progress = false;
+	while ( nextinp < inp.size() )
+	{
+	    int nrput = 0;
+	    const int slot = putBatch( inp, nextinp, nrput );
+	    if ( slot < 0 )
+		break;
+
+	    firsttrcs[slot] = nextinp;
+	    nextinp += nrput;
+	    progress = true;
+	}
+
+	for ( int slot=0; slot<nrslots; slot++ )
+	{
+	    // A late writer marked a pending batch as done: hand it over again
+	    if ( firsttrcs[slot] >= 0 && isStale(slot) )
+		setState( slot, Input );
+	}
+
+	while ( firsttrcs[getslot] >= 0 && isDone(getslot) )
+	{
+	    getBatch( getslot, inp, firsttrcs[getslot], outp );
+	    firsttrcs[getslot] = -1;
+	    getslot = (getslot+1) % nrslots;
+	    progress = true;
+	}
+
+	if ( nextinp >= inp.size() && firsttrcs[getslot] < 0 )
+	    break;
+
+	if ( progress )
+	    lastprogress = Time::getMilliSeconds();
+	else if ( Time::passedSince(lastprogress) > timeout*1000 )
+	{
+	    errmsg_ = tr("No response from the external process");
+	    reset();
+	    return false;
+	}
+	else
+	    Threads::sleep( 0.0005 );
+    }
+
+    return true;
+}
+
+} // namespace Attrib
@@ -0,0 +1,151 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "attribdesc.h"
+#include "attribdescset.h"
+#include "attribintermediatecache.h"
+#include "ctxtioobj.h"
+#include "ioman.h"
+#include "moddepmgr.h"
+#include "seiscbvs.h"
+#include "seistrc.h"
+#include "seistrctr.h"
+#include "seiswrite.h"
+#include "survinfo.h"
+#include "testprog.h"
+#include "valseriesimpl.h"
+
+using namespace Attrib;
+
+static const int cNrInl = 3;
+static const int cNrCrl = 4;
+static const int cNrSamples = 10;
+
+
+static TrcKeyZSampling getSampling( int nrcrl )
+{
+    TrcKeyZSampling tkzs( true );
+    const BinID start = tkzs.hsamp_.start_;
+    const BinID step = tkzs.hsamp_.step_;
+    tkzs.hsamp_.setInlRange( StepInterval<int>( start.inl(),
+			start.inl()+(cNrInl-1)*step.inl(), step.inl() ) );
+    tkzs.hsamp_.setCrlRange( StepInterval<int>( start.crl(),
+			start.crl()+(nrcrl-1)*step.crl(), step.crl() ) );
+    tkzs.zsamp_.stop_ = tkzs.zsamp_.atIndex( cNrSamples-1 );
+    return tkzs;
+}
+
+
+static bool writeCube( const IOObj& ioobj, int nrcrl )
+{
+    const TrcKeyZSampling tkzs = getSampling( nrcrl );
+    SeisTrcWriter wrr( ioobj );
+    SeisTrc trc( cNrSamples );
+    trc.info().sampling_.start_ = tkzs.zsamp_.start_;
+    trc.info().sampling_.step_ = tkzs.zsamp_.step_;
+    TrcKeySamplingIterator iter( tkzs.hsamp_ );
+    BinID bid;
+    while ( iter.next(bid) )
+    {
+	trc.info().setPos( bid );
+	for ( int isamp=0; isamp<cNrSamples; isamp++ )
+	    trc.set( isamp, float(bid.inl() + bid.crl() + isamp), 0 );
+
+	mRunStandardTestWithError( wrr.put(trc), "Write a trace",
+				   wrr.errMsg().getString() );
+    }
+
+    mRunStandardTest( wrr.close(), "Close the writer" );
+    return true;
+}
+
+
+static bool addToCache( const char* key, const TrcKeyZSampling& tkzs )
+{
+    RefMan<IntermediateResult> res = new IntermediateResult( key );
+    ArrayValueSeries<float,float> vals( cNrSamples );
+    for ( int isamp=0; isamp<cNrSamples; isamp++ )
+	vals.setValue( isamp, float(isamp) );
+
+    const float zstep = tkzs.zsamp_.step_;
+    const int z0 = mNINT32( tkzs.zsamp_.start_ / zstep );
+    TrcKeySamplingIterator iter( tkzs.hsamp_ );
+    BinID bid;
+    while ( iter.next(bid) )
+	res->add( bid, vals, z0, cNrSamples, zstep, 0.f );
+
+    mRunStandardTest( AIC().add(*res,tkzs.hsamp_.step_), "Add to the cache" );
+    return true;
+}
+
+
+static bool testKey( const MultiID& storedkey, const IOObj& ioobj )
+{
+    DescSet ds( false );
+    const DescID storedid = ds.getStoredID( storedkey, 0, true );
+    ConstRefMan<Desc> stored = ds.getDesc( storedid );
+    mRunStandardTest( stored, "Create the stored attribute" );
+
+    const BufferString key = IntermediateCache::getKey( *stored, 0 );
+    mRunStandardTest( !key.isEmpty(), "Stored input has a key" );
+    mRunStandardTest( key == IntermediateCache::getKey(*stored,0),
+		      "Same key for unchanged stored data" );
+
+    const TrcKeyZSampling tkzs = getSampling( cNrCrl );
+    if ( !addToCache(key,tkzs) )
+	return false;
+
+    mRunStandardTest( AIC().covers(key,tkzs), "Cache hit" );
+    const MultiID dpkey = AIC().getDataPackKey( key );
+    mRunStandardTest( !dpkey.isUdf(), "Cached data pack" );
+    mRunStandardTest( AIC().keyOf(dpkey) == key, "Key of the data pack" );
+
+    // Rewriting the stored data changes its size: the old entry, even when
+    // still present, is not found anymore
+    if ( !writeCube(ioobj,cNrCrl+2) || !addToCache(key,tkzs) )
+	return false;
+
+    const BufferString newkey = IntermediateCache::getKey( *stored, 0 );
+    mRunStandardTest( !newkey.isEmpty() && newkey != key,
+		      "Other key for rewritten stored data" );
+    mRunStandardTest( !AIC().covers(newkey,tkzs),
+		      "No cache hit for rewritten stored data" );
+    return true;
+}
+
+
+mLoad1Module("AttributeEngine")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    const od_int64 maxsize = AIC().maxSize();
+    AIC().setMaxSize( 16*1024*1024, false );
+
+    IOObjContext ctxt = mIOObjContext(SeisTrc);
+    ctxt.forread_ = false;
+    ctxt.deftransl_ = CBVSSeisTrcTranslator::translKey();
+    CtxtIOObj ctio( ctxt );
+    ctio.setName( "_tmp_intermediate_cache" );
+    IOM().getNewEntry( ctio );
+    mRunStandardTest( ctio.ioobj_, "Create the stored data entry" );
+
+    const MultiID storedkey = ctio.ioobj_->key();
+    const bool res = writeCube( *ctio.ioobj_, cNrCrl ) &&
+		     testKey( storedkey, *ctio.ioobj_ );
+
+    AIC().clear();
+    AIC().setMaxSize( maxsize, false );
+    uiRetVal uirv;
+    IOM().implRemove( storedkey, true, &uirv );
+    return res;
+}
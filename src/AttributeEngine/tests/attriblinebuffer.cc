@@ -0,0 +1,113 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "attriblinebuffer.h"
+
+#include "attribdataholder.h"
+#include "testprog.h"
+#include "valseries.h"
+
+using namespace Attrib;
+
+
+class TestLineBuffer : public DataHolderLineBuffer
+{
+public:
+
+    int		poolSize() const	{ return pool_.size(); }
+};
+
+
+static DataHolder* createFilled( TestLineBuffer& buf, const BinID& bid,
+				 int z0, int nrsamples )
+{
+    DataHolder* dh = buf.createDataHolder( bid, z0, nrsamples );
+    while ( dh->nrSeries() < 2 )
+	dh->add();
+
+    dh->classstatus_[1] = 1;
+    dh->extrazfromsamppos_ = 0.5f;
+    for ( int iser=0; iser<dh->nrSeries(); iser++ )
+	dh->series(iser)->setAll( float(iser+1) );
+
+    return dh;
+}
+
+
+/* A re-used holder looks like a new one: undefined values, unknown class
+   status and the requested z0 */
+
+static bool isReset( const DataHolder& dh, int z0, int nrsamples )
+{
+    if ( dh.z0_ != z0 || dh.nrsamples_ != nrsamples ||
+	 !mIsZero(dh.extrazfromsamppos_,1e-6f) )
+	return false;
+
+    for ( int iser=0; iser<dh.nrSeries(); iser++ )
+    {
+	if ( dh.classstatus_[iser] != -1 )
+	    return false;
+
+	for ( int idx=0; idx<nrsamples; idx++ )
+	{
+	    if ( !mIsUdf(dh.series(iser)->value(idx)) )
+		return false;
+	}
+    }
+
+    return true;
+}
+
+
+static bool testReUse()
+{
+    TestLineBuffer buf;
+    const DataHolder* dh11 = createFilled( buf, BinID(1,1), 5, 10 );
+    createFilled( buf, BinID(1,2), 5, 10 );
+    createFilled( buf, BinID(2,1), 5, 10 );
+    mRunStandardTest( buf.poolSize() == 0, "Empty pool" );
+
+    buf.removeDataHolder( BinID(1,1) );
+    mRunStandardTest( buf.poolSize() == 1 && !buf.getDataHolder(BinID(1,1)),
+		      "Removed holder in the pool" );
+
+    const DataHolder* dh23 = buf.createDataHolder( BinID(2,3), 7, 10 );
+    mRunStandardTest( dh23 == dh11 && buf.poolSize() == 0,
+		      "Holder re-used for the same size" );
+    mRunStandardTest( isReset(*dh23,7,10), "Re-used holder reset" );
+
+    // Whole lines go to the pool as well
+    buf.removeBefore( BinID(2,0), BinID(1,1) );
+    mRunStandardTest( buf.poolSize() == 1 && !buf.getDataHolder(BinID(1,2)) &&
+		      buf.getDataHolder(BinID(2,1)),
+		      "Removed line in the pool" );
+    buf.removeAllExcept( BinID(2,3) );
+    mRunStandardTest( buf.poolSize() == 2 && !buf.getDataHolder(BinID(2,1)) &&
+		      buf.getDataHolder(BinID(2,3)),
+		      "All but one holder in the pool" );
+
+    // Other sizes: new holders, and the pool shrinks on each miss
+    const DataHolder* dh31 = buf.createDataHolder( BinID(3,1), 0, 20 );
+    mRunStandardTest( dh31->nrsamples_ == 20 && buf.poolSize() == 1,
+		      "New holder for another size" );
+    buf.createDataHolder( BinID(3,2), 0, 20 );
+    mRunStandardTest( buf.poolSize() == 0, "Pool emptied by the misses" );
+    return true;
+}
+
+
+int mTestMainFnName( int argc, char** argv )
+{
+    mInitTestProg();
+
+    if ( !testReUse() )
+	return 1;
+
+    return 0;
+}
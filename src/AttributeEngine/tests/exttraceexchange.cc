@@ -0,0 +1,259 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "exttraceexchange.h"
+
+#include "atomic.h"
+#include "callback.h"
+#include "genc.h"
+#include "seisbuf.h"
+#include "seistrc.h"
+#include "testprog.h"
+#include "thread.h"
+
+using namespace Attrib;
+
+static const int cNrSlots = 3;
+static const int cMaxNrTrcs = 4;
+static const int cNrSamples = 50;
+
+
+/* Does what the external process does, from the same memory: squares the
+   input samples of the oldest waiting batch */
+
+class TestExchange : public ExtTraceExchange
+{
+public:
+		TestExchange( const char* nm )
+		    : ExtTraceExchange(nm,cNrSlots,cMaxNrTrcs,cNrSamples)
+		{}
+
+    int		takeBatch()
+		{
+		    int res = -1;
+		    for ( int slot=0; slot<nrSlots(); slot++ )
+		    {
+			if ( getState(slot) == Input &&
+			     (res<0 || slotHeader(slot).seqnr_ <
+				       slotHeader(res).seqnr_) )
+			    res = slot;
+		    }
+
+		    if ( res >= 0 )
+			setState( res, Busy );
+
+		    return res;
+		}
+
+    void	computeBatch( int slot, int seqnr )
+		{
+		    const SlotHeader& slothdr = slotHeader( slot );
+		    const float* inp = sampleData( slot, false, 0 );
+		    float* outp = sampleData( slot, true, 0 );
+		    for ( int itrc=0; itrc<slothdr.nrtrcs_; itrc++ )
+		    {
+			const od_int64 offs = itrc * (od_int64)cNrSamples;
+			for ( int isamp=0; isamp<slothdr.nrsamples_; isamp++ )
+			    outp[offs+isamp] = inp[offs+isamp]*inp[offs+isamp];
+		    }
+
+		    finishBatch( slot, seqnr );
+		}
+
+    void	finishBatch( int slot, int seqnr )
+		{
+		    SlotHeader& slothdr = slotHeader( slot );
+		    if ( slothdr.seqnr_ != seqnr || getState(slot) != Busy )
+			return;
+
+		    slothdr.doneseqnr_ = seqnr;
+		    setState( slot, Output );
+		}
+
+    void	lateFinish( int slot, int seqnr )
+		{
+		    // A writer that passed the checks of finishBatch just
+		    // before the batch was reset
+		    slotHeader( slot ).doneseqnr_ = seqnr;
+		    setState( slot, Output );
+		}
+
+    bool	allFree() const
+		{
+		    for ( int slot=0; slot<nrSlots(); slot++ )
+		    {
+			if ( getState(slot) != Free )
+			    return false;
+		    }
+
+		    return true;
+		}
+
+    int		seqNr( int slot ) const	{ return slotHeader(slot).seqnr_; }
+};
+
+
+class ExternalProcess : public CallBacker
+{
+public:
+		ExternalProcess( TestExchange& exch )
+		    : exch_(exch)
+		{}
+
+    void	runCB( CallBacker* )
+		{
+		    while ( !stop_ )
+		    {
+			const int slot = exch_.takeBatch();
+			if ( slot < 0 )
+			    Threads::sleep( 0.0001 );
+			else if ( latewrite_ )
+			{
+			    latewrite_ = false;
+			    exch_.lateFinish( slot, exch_.seqNr(slot)-1 );
+			}
+			else
+			    exch_.computeBatch( slot, exch_.seqNr(slot) );
+		    }
+		}
+
+    TestExchange&		exch_;
+    Threads::Atomic<bool>	stop_	= false;
+    bool			latewrite_ = false;
+				//!< Marks the first batch done for another one
+};
+
+
+static void fillInput( SeisTrcBuf& buf, int nrtrcs )
+{
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+    {
+	auto* trc = new SeisTrc( cNrSamples );
+	trc->info().setPos( BinID(100+itrc/10,200+itrc%10) );
+	trc->info().sampling_.start_ = 0.5f;
+	trc->info().sampling_.step_ = 0.004f;
+	for ( int isamp=0; isamp<cNrSamples; isamp++ )
+	    trc->set( isamp, float(itrc) + 0.01f*isamp, 0 );
+
+	buf.add( trc );
+    }
+}
+
+
+static bool checkOutput( const SeisTrcBuf& inp, const SeisTrcBuf& outp )
+{
+    if ( inp.size() != outp.size() )
+	return false;
+
+    for ( int itrc=0; itrc<inp.size(); itrc++ )
+    {
+	const SeisTrc& inptrc = *inp.get( itrc );
+	const SeisTrc& outtrc = *outp.get( itrc );
+	if ( outtrc.info().binID() != inptrc.info().binID() ||
+	     outtrc.size() != inptrc.size() )
+	    return false;
+
+	for ( int isamp=0; isamp<inptrc.size(); isamp++ )
+	{
+	    const float inpval = inptrc.get( isamp, 0 );
+	    if ( !mIsEqual(outtrc.get(isamp,0),inpval*inpval,1e-4f) )
+		return false;
+	}
+    }
+
+    return true;
+}
+
+
+static bool testRoundTrip( TestExchange& exch, bool latewrite=false )
+{
+    ExternalProcess extproc( exch );
+    extproc.latewrite_ = latewrite;
+    Threads::Thread thread( mCB(&extproc,ExternalProcess,runCB),
+			    "External process" );
+
+    SeisTrcBuf inp( true ), outp( true );
+    fillInput( inp, 25 );
+    const bool res = exch.process( inp, outp, 10 );
+    extproc.stop_ = true;
+    thread.waitForFinish();
+
+    mRunStandardTestWithError( res, "Process all batches",
+			       toString(exch.errMsg()) );
+    mRunStandardTest( checkOutput(inp,outp), "Output of all batches" );
+    mRunStandardTest( exch.allFree(), "All slots freed after the run" );
+    return true;
+}
+
+
+static bool testTimeout( TestExchange& exch )
+{
+    SeisTrcBuf inp( true ), outp( true );
+    fillInput( inp, 10 );
+    const int slot = exch.takeBatch();
+    mRunStandardTest( slot < 0, "No batch waiting before the run" );
+
+    mRunStandardTest( !exch.process(inp,outp,0.05),
+		      "Fail without an external process" );
+    mRunStandardTest( exch.allFree(), "All slots reset after the timeout" );
+
+    int nrput = 0;
+    const int newslot = exch.putBatch( inp, 0, nrput );
+    mRunStandardTest( newslot >= 0 && nrput == cMaxNrTrcs,
+		      "Reuse a slot after the timeout" );
+
+    const int takenslot = exch.takeBatch();
+    mRunStandardTest( takenslot == newslot, "Take the new batch" );
+    exch.finishBatch( takenslot, exch.seqNr(takenslot)-1 );
+    mRunStandardTest( !exch.isDone(takenslot),
+		      "Ignore the result of a batch that was reset" );
+
+    exch.reset();
+    return true;
+}
+
+
+/* Results written for a batch that was reset may still arrive: neither a
+   slot of the reset batch, nor a new batch in it, may be blocked by them */
+
+static bool testLateWrite( TestExchange& exch )
+{
+    SeisTrcBuf inp( true );
+    fillInput( inp, 10 );
+    int nrput = 0;
+    const int slot = exch.putBatch( inp, 0, nrput );
+    mRunStandardTest( slot >= 0 && exch.takeBatch() == slot,
+		      "Take a batch before the reset" );
+
+    const int seqnr = exch.seqNr( slot );
+    exch.reset();
+    exch.lateFinish( slot, seqnr );
+    mRunStandardTest( !exch.isDone(slot),
+		      "Ignore a late result after the reset" );
+
+    return testRoundTrip( exch ) && testRoundTrip( exch, true );
+}
+
+
+int mTestMainFnName( int argc, char** argv )
+{
+    mInitTestProg();
+
+    const BufferString nm( "od_test_trcexch_", GetPID() );
+    TestExchange exch( nm );
+    if ( !handleTestResult(exch.isOK(),"Create the shared memory",
+			   toString(exch.errMsg())) )
+	return 1;
+
+    if ( !testRoundTrip(exch) || !testTimeout(exch) ||
+	 !testRoundTrip(exch) || !testLateWrite(exch) )
+	return 1;
+
+    return 0;
+}
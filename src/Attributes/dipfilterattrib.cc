@@ -12,6 +12,7 @@ ________________________________________________________________________
 #include "attribdesc.h"
 #include "attribfactory.h"
 #include "attribparam.h"
+#include "fourier.h"
 #include "math2.h"
 #include "survinfo.h"
 
@@ -22,6 +23,14 @@ ________________________________________________________________________
 #define mFilterTypeHighPass          1
 #define mFilterTypeBandPass          2
 
+#define mMethodAuto		0
+#define mMethodDirect		1
+#define mMethodSeparable	2
+#define mMethodFFT		3
+
+// Kernel sizes from which the FFT outperforms the direct convolution
+#define mMinFFTSize		25
+
 namespace Attrib
 {
 
@@ -73,6 +82,15 @@ void DipFilter::initClass()
     taperlen->setDefaultValue( 20 );
     desc->addParam( taperlen );
 
+    EnumParam* method = new EnumParam( methodStr() );
+    method->addEnum( methodNamesStr(mMethodAuto) );
+    method->addEnum( methodNamesStr(mMethodDirect) );
+    method->addEnum( methodNamesStr(mMethodSeparable) );
+    method->addEnum( methodNamesStr(mMethodFFT) );
+    method->setDefaultValue( mMethodAuto );
+    method->setRequired( false );
+    desc->addParam( method );
+
     desc->addOutputDataType( Seis::UnknowData );
 
     desc->addInput( InputSpec("Input data",true) );
@@ -122,10 +140,21 @@ const char* DipFilter::filterTypeNamesStr( int type )
 }
 
 
+const char* DipFilter::methodNamesStr( int method )
+{
+    if ( method==mMethodDirect ) return "Direct";
+    if ( method==mMethodSeparable ) return "Separable";
+    if ( method==mMethodFFT ) return "FFT";
+    return "Auto";
+}
+
+
 DipFilter::DipFilter( Desc& ds )
     : Provider( ds )
     , kernel_(0,0,0)
     , minvel_(0)
+    , method_(mMethodAuto)
+    , usemethod_(mMethodDirect)
 {
     if ( !isOK() ) return;
 
@@ -163,6 +192,7 @@ DipFilter::DipFilter( Desc& ds )
 
     mGetFloat( taperlen_, taperlenStr() );
     taperlen_ = taperlen_/100;
+    mGetEnum( method_, methodStr() );
 
     kernel_.setSize( is2D() ? 1 : size_, size_, size_ );
     valrange_ = Interval<float>(minvel_,maxvel_);
@@ -303,10 +333,102 @@ bool DipFilter::initKernel()
 	}
     }
 
+    initMethod();
     return true;
 }
 
 
+void DipFilter::initMethod()
+{
+    const int hsz = size_/2;
+    const int sizeinl = is2D() ? 1 : size_;
+    const int nrtrcs = sizeinl * size_;
+
+    firsttap_.setEmpty(); taps_.setEmpty(); tapweights_.setEmpty();
+    trcweights_.setSize( nrtrcs, 0.f );
+    float maxweight = 0.f;
+    int maxtrc = 0, maxt = 0;
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+    {
+	firsttap_ += taps_.size();
+	const int idi = itrc / size_;
+	const int idc = itrc % size_;
+	trcweights_[itrc] = 0.f;
+	for ( int idt=0; idt<size_; idt++ )
+	{
+	    const float weight = kernel_.get( idi, idc, idt );
+	    if ( mIsZero(weight,mDefEps) )
+		continue;
+
+	    taps_ += idt - hsz;
+	    tapweights_ += weight;
+	    trcweights_[itrc] += weight;
+	    if ( fabs(weight) > maxweight )
+		{ maxweight = fabs(weight); maxtrc = itrc; maxt = idt; }
+	}
+    }
+    firsttap_ += taps_.size();
+
+    // Separable if kernel(trc,t) == spatialfactor(trc) * zfactor(t)
+    spatialfactors_.setSize( nrtrcs, 0.f );
+    zfactors_.setSize( size_, 0.f );
+    bool separable = maxweight > 0.f;
+    if ( separable )
+    {
+	const float pivot = kernel_.get( maxtrc/size_, maxtrc%size_, maxt );
+	for ( int idt=0; idt<size_; idt++ )
+	    zfactors_[idt] =
+		kernel_.get( maxtrc/size_, maxtrc%size_, idt ) / pivot;
+
+	for ( int itrc=0; itrc<nrtrcs && separable; itrc++ )
+	{
+	    const int idi = itrc / size_;
+	    const int idc = itrc % size_;
+	    spatialfactors_[itrc] = kernel_.get( idi, idc, maxt );
+	    for ( int idt=0; idt<size_; idt++ )
+	    {
+		const float weight = kernel_.get( idi, idc, idt );
+		const float sepweight = spatialfactors_[itrc] * zfactors_[idt];
+		if ( !mIsEqual(weight,sepweight,1e-5f*maxweight) )
+		    { separable = false; break; }
+	    }
+	}
+    }
+
+    usemethod_ = method_;
+    if ( method_==mMethodAuto )
+	usemethod_ = separable ? mMethodSeparable
+		   : (size_>=mMinFFTSize ? mMethodFFT : mMethodDirect);
+    else if ( method_==mMethodSeparable && !separable )
+	usemethod_ = mMethodDirect;
+
+    kernelspectra_.setEmpty();
+    fftsz_ = 0;
+    if ( usemethod_ != mMethodFFT )
+	return;
+
+    // Spectra of the reversed kernel of each trace, to correlate blocks
+    fftsz_ = Fourier::FFTCC1D::getFastSize( 8*size_ );
+    Fourier::FFTCC1D fft;
+    if ( !fft.setSize(fftsz_) )
+	{ usemethod_ = mMethodDirect; fftsz_ = 0; return; }
+
+    kernelspectra_.setSize( nrtrcs*fftsz_, float_complex(0.f,0.f) );
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+    {
+	if ( firsttap_[itrc] == firsttap_[itrc+1] )
+	    continue;
+
+	float_complex* spec = kernelspectra_.arr() + itrc*fftsz_;
+	for ( int idt=0; idt<size_; idt++ )
+	    spec[size_-1-idt] =
+		float_complex( kernel_.get(itrc/size_,itrc%size_,idt), 0.f );
+
+	fft.run( spec );
+    }
+}
+
+
 float DipFilter::taper( float pos ) const
 {
     if ( pos < 0 ) return 0;
@@ -343,46 +465,223 @@ bool DipFilter::getInputData( const BinID& relpos, int index )
 }
 
 
-bool DipFilter::computeData( const DataHolder& output, const BinID& relpos,
-			     int z0, int nrsamples, int threadid ) const
+bool DipFilter::getTrace( const DataHolder& dh, int z0, int nrsamples,
+			  float* vals ) const
 {
-    if ( outputinterest_.isEmpty() ) return false;
+    const int hsz = size_/2;
+    const Interval<int> dhinterval( dh.z0_, dh.z0_+dh.nrsamples_ );
+    bool alldefined = true;
+    for ( int idx=0; idx<nrsamples+2*hsz; idx++ )
+    {
+	const int sampidx = idx - hsz;
+	float val = mUdf(float);
+	if ( dhinterval.includes(z0+sampidx,false) )
+	    val = getInputValue( dh, dataidx_, sampidx, z0 );
+
+	vals[idx] = val;
+	if ( mIsUdf(val) )
+	    alldefined = false;
+    }
+
+    return alldefined;
+}
+
 
+void DipFilter::computeDirect( const float* trcvals, int nrsamples,
+			       float* sums, float* wsums ) const
+{
     const int hsz = size_/2;
-    const int sizeinl = is2D() ? 1 : size_;
-    for ( int idx=0; idx<nrsamples; idx++)
+    const int trcsz = nrsamples + 2*hsz;
+    for ( int itrc=0; itrc<inputdata_.size(); itrc++ )
     {
-	int dhoff = 0;
-	float sum = 0;
-	float wsum = 0;
-	for ( int idi=0; idi<sizeinl; idi++ )
+	if ( !inputdata_[itrc] )
+	    continue;
+
+	for ( int itap=firsttap_[itrc]; itap<firsttap_[itrc+1]; itap++ )
 	{
-	    for ( int idc=0; idc<size_; idc++ )
+	    const float* vals = trcvals + itrc*trcsz + hsz + taps_[itap];
+	    const float weight = tapweights_[itap];
+	    for ( int idx=0; idx<nrsamples; idx++ )
 	    {
-		const DataHolder* dh = inputdata_[dhoff++];
-		if ( !dh ) continue;
+		const float val = vals[idx];
+		if ( mIsUdf(val) )
+		    continue;
 
-		Interval<int> dhinterval( dh->z0_, dh->z0_+dh->nrsamples_ );
+		sums[idx] += val*weight;
+		wsums[idx] += weight;
+	    }
+	}
+    }
+}
 
-		for ( int idt=0, relt = -hsz; idt<size_; idt++, relt++ )
-		{
-		    const int sample = z0 + idx + relt;
-		    if ( dhinterval.includes(sample,false) )
-		    {
-			const float weight = kernel_.get( idi, idc, idt );
-			const float val =
-				getInputValue( *dh, dataidx_, idx+relt, z0 );
-			if ( mIsUdf(val) ) continue;
 
-			sum += val*weight;
-			wsum += weight;
-		    }
-		}
+void DipFilter::computeSeparable( const float* trcvals, int nrsamples,
+				  float* stack, float* sums ) const
+{
+    const int hsz = size_/2;
+    const int trcsz = nrsamples + 2*hsz;
+    for ( int idx=0; idx<trcsz; idx++ )
+	stack[idx] = 0.f;
+
+    for ( int itrc=0; itrc<inputdata_.size(); itrc++ )
+    {
+	const float factor = spatialfactors_[itrc];
+	if ( !inputdata_[itrc] || mIsZero(factor,mDefEps) )
+	    continue;
+
+	const float* vals = trcvals + itrc*trcsz;
+	for ( int idx=0; idx<trcsz; idx++ )
+	    stack[idx] += factor * vals[idx];
+    }
+
+    for ( int idt=0; idt<size_; idt++ )
+    {
+	const float factor = zfactors_[idt];
+	if ( mIsZero(factor,mDefEps) )
+	    continue;
+
+	const float* vals = stack + idt;
+	for ( int idx=0; idx<nrsamples; idx++ )
+	    sums[idx] += factor * vals[idx];
+    }
+}
+
+
+bool DipFilter::computeFFT( const float* trcvals, int nrsamples,
+			    float* sums ) const
+{
+    const int hsz = size_/2;
+    const int trcsz = nrsamples + 2*hsz;
+    const int blocksz = fftsz_ - size_ + 1;
+    Fourier::FFTCC1D fft, ifft;
+    ifft.setDir( false );
+    ifft.setNormalization( true );
+    if ( blocksz < 1 || !fft.setSize(fftsz_) || !ifft.setSize(fftsz_) )
+	return false;
+
+    TypeSet<int> trcidxs;
+    for ( int itrc=0; itrc<inputdata_.size(); itrc++ )
+    {
+	if ( inputdata_[itrc] && firsttap_[itrc] != firsttap_[itrc+1] )
+	    trcidxs += itrc;
+    }
+
+    TypeSet<float_complex> spec( fftsz_, float_complex(0.f,0.f) );
+    TypeSet<float_complex> accum( fftsz_, float_complex(0.f,0.f) );
+    for ( int start=0; start<nrsamples; start+=blocksz )
+    {
+	const int nrout = mMIN( blocksz, nrsamples-start );
+	const int nrin = nrout + 2*hsz;
+	accum.setAll( float_complex(0.f,0.f) );
+
+	// Two real traces per complex transform
+	for ( int ipair=0; ipair<trcidxs.size(); ipair+=2 )
+	{
+	    const int itrc0 = trcidxs[ipair];
+	    const int itrc1 = ipair+1<trcidxs.size() ? trcidxs[ipair+1] : -1;
+	    const float* vals0 = trcvals + itrc0*trcsz + start;
+	    const float* vals1 = itrc1<0 ? nullptr
+					 : trcvals + itrc1*trcsz + start;
+	    for ( int idx=0; idx<fftsz_; idx++ )
+		spec[idx] = idx<nrin ? float_complex( vals0[idx],
+						  vals1 ? vals1[idx] : 0.f )
+				     : float_complex( 0.f, 0.f );
+
+	    fft.run( spec.arr() );
+	    const float_complex* kern0 = kernelspectra_.arr() + itrc0*fftsz_;
+	    if ( !vals1 )
+	    {
+		for ( int idx=0; idx<fftsz_; idx++ )
+		    accum[idx] += spec[idx] * kern0[idx];
+
+		continue;
+	    }
+
+	    const float_complex* kern1 = kernelspectra_.arr() + itrc1*fftsz_;
+	    for ( int idx=0; idx<fftsz_; idx++ )
+	    {
+		const float_complex val = spec[idx];
+		const float_complex mirror =
+				std::conj( spec[(fftsz_-idx)%fftsz_] );
+		const float_complex spec0 = (val + mirror) * 0.5f;
+		const float_complex spec1 =
+				(val - mirror) * float_complex( 0.f, -0.5f );
+		accum[idx] += spec0 * kern0[idx] + spec1 * kern1[idx];
 	    }
 	}
 
+	ifft.run( accum.arr() );
+	for ( int idx=0; idx<nrout; idx++ )
+	    sums[start+idx] = accum[idx+2*hsz].real();
+    }
+
+    return true;
+}
+
+
+bool DipFilter::computeData( const DataHolder& output, const BinID& relpos,
+			     int z0, int nrsamples, int threadid ) const
+{
+    if ( outputinterest_.isEmpty() || firsttap_.isEmpty() ) return false;
+
+    const int hsz = size_/2;
+    const int nrtrcs = inputdata_.size();
+    const int trcsz = nrsamples + 2*hsz;
+    float* trcvals = getScratchBuffer( threadid, 0, nrtrcs*trcsz );
+    float* sums = getScratchBuffer( threadid, 1, nrsamples );
+    float* wsums = getScratchBuffer( threadid, 2, nrsamples );
+    if ( !trcvals || !sums || !wsums || nrtrcs>=firsttap_.size() )
+	return false;
+
+    bool alldefined = true;
+    float trcweightsum = 0.f;
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+    {
+	const DataHolder* dh = inputdata_[itrc];
+	if ( !dh || firsttap_[itrc] == firsttap_[itrc+1] )
+	    continue;
+
+	if ( !getTrace(*dh,z0,nrsamples,trcvals+itrc*trcsz) )
+	    alldefined = false;
+
+	trcweightsum += trcweights_[itrc];
+    }
+
+    for ( int idx=0; idx<nrsamples; idx++ )
+	sums[idx] = wsums[idx] = 0.f;
+
+    // Without undefined values the sum of the weights is the same everywhere
+    bool done = false;
+    if ( alldefined && usemethod_==mMethodSeparable )
+    {
+	float* stack = getScratchBuffer( threadid, 3, trcsz );
+	if ( stack )
+	{
+	    computeSeparable( trcvals, nrsamples, stack, sums );
+	    done = true;
+	}
+    }
+    else if ( alldefined && usemethod_==mMethodFFT && nrsamples>=size_ )
+	done = computeFFT( trcvals, nrsamples, sums );
+
+    if ( done )
+    {
+	for ( int idx=0; idx<nrsamples; idx++ )
+	    wsums[idx] = trcweightsum;
+    }
+    else
+    {
+	for ( int idx=0; idx<nrsamples; idx++ )
+	    sums[idx] = 0.f;
+
+	computeDirect( trcvals, nrsamples, sums, wsums );
+    }
+
+    for ( int idx=0; idx<nrsamples; idx++ )
+    {
+	const float wsum = wsums[idx];
 	setOutputValue( output, 0, idx, z0,
-		!mIsZero(wsum,mDefEps) ? sum/wsum : mUdf(float) );
+		!mIsZero(wsum,mDefEps) ? sums[idx]/wsum : mUdf(float) );
     }
 
     return true;
@@ -202,9 +202,13 @@ bool Mathematics::computeData( const DataHolder& output,
 				       const BinID& relpos, int z0,
 				       int nrsamples, int threadid ) const
 {
-    PtrMan< ::Math::Formula > mathobj
-		= formula_ ? new ::Math::Formula(*formula_) : nullptr;
-    if ( !mathobj ) return false;
+    if ( !formula_ )
+	return false;
+
+    if ( computeAllSamples(output,z0,nrsamples,threadid) )
+	return true;
+
+    PtrMan< ::Math::Formula > mathobj = new ::Math::Formula( *formula_ );
 
     mathobj->startNewSeries();
 
@@ -263,6 +267,101 @@ bool Mathematics::computeData( const DataHolder& output,
 }
 
 
+bool Mathematics::computeAllSamples( const DataHolder& output, int z0,
+				     int nrsamples, int threadidx ) const
+{
+    if ( formula_->isRecursive() )
+	return false;
+
+    const int nrvals = formula_->nrValues2Provide();
+    TypeSet<float> vals( nrvals, mUdf(float) );
+    TypeSet<const float*> valarrs( nrvals, nullptr );
+    int nrbufs = 0;
+    int validx = 0, nrconstsandspecsfound = 0;
+    for ( int inpidx=0; inpidx<formula_->nrInputs(); inpidx++ )
+    {
+	if ( formula_->isConst(inpidx) )
+	{
+	    vals[validx++] = float( formula_->getConstVal(inpidx) );
+	    nrconstsandspecsfound++;
+	    continue;
+	}
+
+	const int specidx = formula_->specIdx( inpidx );
+	if ( specidx == 4 || specidx == 5 )
+	    return false; // Coordinates need double precision
+
+	if ( specidx == 3 || specidx == 6 )
+	{
+	    float* zarr = getScratchBuffer( threadidx, nrbufs++, nrsamples );
+	    if ( !zarr )
+		return false;
+
+	    for ( int idx=0; idx<nrsamples; idx++ )
+		zarr[idx] = specidx == 3 ? float( z0+idx )
+					 : float( (z0+idx)*refstep_ );
+	    valarrs[validx++] = zarr;
+	}
+	else if ( specidx >= 0 )
+	{
+	    float& val = vals[validx++];
+	    switch ( specidx )
+	    {
+		case 0: val = refstep_; break;
+		case 1: val = float( getInl() ); break;
+		case 2: val = float( getCrl() ); break;
+		case 7: val = float( currentbid_.lineNr() ); break;
+		case 8: val = float( currentbid_.trcNr() ); break;
+	    }
+	}
+
+	if ( specidx >= 0 )
+	{
+	    nrconstsandspecsfound++;
+	    continue;
+	}
+
+	const int inpdataidx = inpidx - nrconstsandspecsfound;
+	const DataHolder* inpdh = inputdata_[inpdataidx];
+	const TypeSet<int>& reqshifts = formula_->getShifts( inpidx );
+	for ( int ishft=0; ishft<reqshifts.size(); ishft++ )
+	{
+	    float* inparr = getScratchBuffer( threadidx, nrbufs++, nrsamples );
+	    if ( !inparr )
+		return false;
+
+	    const int shift = reqshifts[ishft];
+	    for ( int idx=0; idx<nrsamples; idx++ )
+		inparr[idx] = inpdh ? getInputValue( *inpdh,
+						     inputidxs_[inpdataidx],
+						     idx+shift, z0 )
+				    : mUdf(float);
+
+	    valarrs[validx++] = inparr;
+	}
+    }
+
+    float* result = getScratchBuffer( threadidx, nrbufs++, nrsamples );
+    if ( !result )
+	return false;
+
+    for ( int idx=0; idx<nrsamples; idx++ )
+	result[idx] = mUdf(float);
+
+    if ( !formula_->getValues(valarrs.arr(),vals.arr(),result,nrsamples) )
+	return false;
+
+    for ( int idx=0; idx<nrsamples; idx++ )
+    {
+	const float res = result[idx];
+	setOutputValue( output, 0, idx, z0,
+			Math::IsNormalNumber(res) ? res : mUdf(float) );
+    }
+
+    return true;
+}
+
+
 int Mathematics::getInl() const
 {
     return is2D() ? SI().transform( getCurrentCoord() ).inl()
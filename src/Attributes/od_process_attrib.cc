@@ -240,6 +240,11 @@ bool BatchProgram::doWork( od_ostream& strm )
 	if ( !proc )
 	    mRetJobErr( ::toString(errmsg) );
 
+	bool dostats = false;
+	pars().getYN( Attrib::Processor::sKeyStatistics(), dostats );
+	if ( dostats )
+	    proc->enableStatistics( true );
+
 	progressmeter.setName( proc->name() );
 	progressmeter.setMessage( proc->uiMessage() );
 
@@ -320,17 +325,27 @@ bool BatchProgram::doWork( od_ostream& strm )
 		if ( res >= 0 )
 		{
 		    nriter++;
-		    if ( !proc->outputs_[0]->writeTrc() )
-			mRetJobErr( BufferString("Cannot write output trace",
-			":\n",proc->outputs_[0]->errMsg().getString()) )
+		    for ( auto* output : proc->outputs_ )
+		    {
+			if ( !output->writeTrc() )
+			    mRetJobErr( BufferString(
+				"Cannot write output trace",
+				":\n",output->errMsg().getString()) )
+		    }
 		}
 	    }
 	}
 
 	progressmeter.setFinished();
+	if ( dostats )
+	    proc->reportStatistics( strm );
+
 	bool closeok = true;
 	if ( nriter )
-	    closeok = proc->outputs_[0]->finishWrite();
+	{
+	    for ( auto* output : proc->outputs_ )
+		closeok = output->finishWrite() && closeok;
+	}
 
 	if ( !closeok )
 	{ mMessage( "Could not close output data." ); }
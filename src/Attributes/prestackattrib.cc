@@ -15,6 +15,7 @@ ________________________________________________________________________
 #include "attribparam.h"
 #include "posinfo.h"
 #include "prestackanglecomputer.h"
+#include "prestackgatherwindow.h"
 #include "prestackprocessortransl.h"
 #include "prestackprocessor.h"
 #include "prestackprop.h"
@@ -249,6 +250,7 @@ PSAttrib::~PSAttrib()
 {
     delete propcalc_;
     delete preprocessor_;
+    delete gatherwindow_;
     delete psrdr_;
     delete psioobj_;
 }
@@ -434,6 +436,13 @@ DataPackID PSAttrib::getPreProcessedID( const BinID& relpos )
     BinID relbid;
     TypeSet<DataPackID> gatheridstoberemoved;
     const BinID sistep( SI().inlRange(true).step_, SI().crlRange(true).step_ );
+    if ( gatherwindow_ )
+    {
+	// Neighbouring positions share most of their input gathers
+	gatherwindow_->setStepout( stepout, sistep );
+	gatherwindow_->setCenter( currentbid_+relpos );
+    }
+
     for ( relbid.inl()=-stepout.inl(); relbid.inl()<=stepout.inl();
 	  relbid.inl()++ )
     {
@@ -447,11 +456,8 @@ DataPackID PSAttrib::getPreProcessedID( const BinID& relpos )
 	    ConstRefMan<PreStack::Gather> gather;
 	    if ( gatherset_.isEmpty() )
 	    {
-		RefMan<PreStack::Gather> dbgather = new PreStack::Gather;
-		TrcKey tk;
-		getTrcKey( *psrdr_, bid, tk );
-		if ( dbgather->readFrom(*psioobj_,*psrdr_,tk,component_) )
-		    gather = dbgather;
+		if ( gatherwindow_ )
+		    gather = gatherwindow_->getGather( bid );
 	    }
 	    else
 	    {
@@ -511,6 +517,7 @@ bool PSAttrib::getInputData( const BinID& relpos, int zintv )
 
 void PSAttrib::prepPriorToBoundsCalc()
 {
+    deleteAndNullPtr( gatherwindow_ );
     delete psioobj_;
 
     if ( psid_.isInMemoryDPID() )
@@ -547,6 +554,9 @@ void PSAttrib::prepPriorToBoundsCalc()
 
 	const uiString emsg = psrdr_->errMsg();
 	if ( emsg.isSet() ) mErrRet( tr("PS Reader: %1").arg(emsg) );
+
+	gatherwindow_ = new PreStack::GatherWindow( *psioobj_, *psrdr_,
+						    component_ );
     }
 
     PreStack::PropCalc::Setup calcsetup( setup_ );
@@ -0,0 +1,173 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "arrayndimpl.h"
+#include "attribdesc.h"
+#include "attribdescset.h"
+#include "attribengman.h"
+#include "attribfactory.h"
+#include "attribprocessor.h"
+#include "attribsel.h"
+#include "moddepmgr.h"
+#include "seisdatapack.h"
+#include "survgeom.h"
+#include "survinfo.h"
+#include "testprog.h"
+
+using namespace Attrib;
+
+static DescID addMath( DescSet& ds, const char* expr, const char* nm,
+		       const Desc* inp0=nullptr, const Desc* inp1=nullptr )
+{
+    RefMan<Desc> desc = PF().createDescCopy( "Math" );
+    const BufferString defstr( "Math expression=", expr );
+    if ( !desc || !desc->parseDefStr(defstr) )
+	return DescID();
+
+    if ( inp0 )
+	desc->setInput( 0, inp0 );
+    if ( inp1 )
+	desc->setInput( 1, inp1 );
+
+    desc->setUserRef( nm );
+    return ds.addDesc( desc.ptr() );
+}
+
+
+/* The two inputs of the top attribute are not stored and share no provider,
+   hence they are computed concurrently by the input data task */
+
+static bool testIndependentInputs()
+{
+    DescSet ds( false );
+    const DescID inlid = addMath( ds, "Inl*2", "inl" );
+    const DescID crlid = addMath( ds, "Crl*3", "crl" );
+    mRunStandardTest( inlid.isValid() && crlid.isValid(),
+		      "Create the input attributes" );
+
+    const DescID sumid = addMath( ds, "x0+x1", "sum",
+				  ds.getDesc(inlid).ptr(),
+				  ds.getDesc(crlid).ptr() );
+    mRunStandardTest( sumid.isValid(), "Create the top attribute" );
+
+    TrcKeyZSampling tkzs( true );
+    const BinID start = tkzs.hsamp_.start_;
+    tkzs.hsamp_.setInlRange( StepInterval<int>( start.inl(),
+				start.inl()+4*tkzs.hsamp_.step_.inl(),
+				tkzs.hsamp_.step_.inl() ) );
+    tkzs.hsamp_.setCrlRange( StepInterval<int>( start.crl(),
+				start.crl()+6*tkzs.hsamp_.step_.crl(),
+				tkzs.hsamp_.step_.crl() ) );
+    tkzs.zsamp_.stop_ = tkzs.zsamp_.atIndex( 9 );
+
+    EngineMan em;
+    em.setAttribSet( &ds );
+    em.setAttribSpec( SelSpec(nullptr,sumid) );
+    em.setGeomID( Survey::default3DGeomID() );
+    em.setTrcKeyZSampling( tkzs );
+
+    uiString errmsg;
+    PtrMan<Processor> proc = em.createDataPackOutput( errmsg );
+    mRunStandardTestWithError( proc, "Create the processor",
+			       toString(errmsg) );
+    mRunStandardTestWithError( proc->execute(), "Compute the attribute",
+			       toString(proc->uiMessage()) );
+
+    RefMan<RegularSeisDataPack> dp = em.getDataPackOutput( *proc );
+    mRunStandardTest( dp && !dp->isEmpty(), "Get the output" );
+
+    const TrcKeySampling& hs = dp->sampling().hsamp_;
+    const Array3DImpl<float>& arr = dp->data( 0 );
+    const int nrz = arr.getSize( 2 );
+    bool allok = nrz > 0;
+    for ( int iinl=0; iinl<arr.getSize(0) && allok; iinl++ )
+    {
+	const int inl = hs.inlRange().atIndex( iinl );
+	for ( int icrl=0; icrl<arr.getSize(1) && allok; icrl++ )
+	{
+	    const int crl = hs.crlRange().atIndex( icrl );
+	    const float expval = float( 2*inl + 3*crl );
+	    for ( int iz=0; iz<nrz; iz++ )
+	    {
+		if ( !mIsEqual(arr.get(iinl,icrl,iz),expval,1e-3f) )
+		    { allok = false; break; }
+	    }
+	}
+    }
+
+    mRunStandardTest( allok, "Values of the concurrently computed inputs" );
+    return true;
+}
+
+
+/* Two copies of the same input graph are merged into one, bottom-up. Other
+   definitions, and the steering flag, keep descs apart */
+
+static bool testMergeIdentical()
+{
+    DescSet ds( false );
+    const DescID inl1id = addMath( ds, "Inl*2", "inl1" );
+    const DescID inl2id = addMath( ds, "Inl*2", "inl2" );
+    const DescID otherid = addMath( ds, "Inl*3", "other" );
+    const DescID steerid = addMath( ds, "Inl*2", "steering" );
+    ds.getDesc( steerid )->setSteering( true );
+    const DescID top1id = addMath( ds, "x0+1", "top1",
+				   ds.getDesc(inl1id).ptr() );
+    const DescID top2id = addMath( ds, "x0+1", "top2",
+				   ds.getDesc(inl2id).ptr() );
+    const DescID prodid = addMath( ds, "x0*x1", "prod",
+				   ds.getDesc(top1id).ptr(),
+				   ds.getDesc(top2id).ptr() );
+    mRunStandardTest( prodid.isValid(), "Create the attribute graph" );
+
+    const int nrdescs = ds.size();
+    TypeSet<DescID> keep;
+    keep += prodid; keep += otherid; keep += steerid;
+    mRunStandardTest( ds.mergeIdenticalDescs(keep) == 2,
+		      "Merge the identical descs" );
+    mRunStandardTest( ds.size() == nrdescs-2 && !ds.getDesc(inl2id) &&
+		      !ds.getDesc(top2id), "Unused duplicates removed" );
+
+    ConstRefMan<Desc> prod = ds.getDesc( prodid );
+    ConstRefMan<Desc> top1 = ds.getDesc( top1id );
+    mRunStandardTest( prod->getInput(0).ptr() == top1.ptr() &&
+		      prod->getInput(1).ptr() == top1.ptr(),
+		      "Both inputs use the same desc" );
+    mRunStandardTest( top1->getInput(0).ptr() == ds.getDesc(inl1id).ptr() &&
+		      ds.getDesc(otherid) && ds.getDesc(steerid),
+		      "Other descs kept" );
+    mRunStandardTest( ds.mergeIdenticalDescs(keep) == 0, "Nothing to merge" );
+
+    // Duplicates that are asked for are kept, though no longer used
+    const DescID dupid = addMath( ds, "x0+1", "dup",
+				  ds.getDesc(inl1id).ptr() );
+    const DescID dupprodid = addMath( ds, "x0*2", "dupprod",
+				      ds.getDesc(dupid).ptr() );
+    keep += dupid;
+    mRunStandardTest( ds.mergeIdenticalDescs(keep) == 1 &&
+		      ds.getDesc(dupid) &&
+		      ds.getDesc(dupprodid)->getInput(0).ptr() == top1.ptr(),
+		      "Duplicate in the kept list" );
+    return true;
+}
+
+
+mLoad1Module("Attributes")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    if ( !testIndependentInputs() || !testMergeIdentical() )
+	return false;
+
+    return true;
+}
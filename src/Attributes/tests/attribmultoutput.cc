@@ -0,0 +1,198 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "attribdesc.h"
+#include "attribdescset.h"
+#include "attribengman.h"
+#include "attribfactory.h"
+#include "attriboutput.h"
+#include "attribprocessor.h"
+#include "ctxtioobj.h"
+#include "ioman.h"
+#include "keystrs.h"
+#include "moddepmgr.h"
+#include "seiscbvs.h"
+#include "seisread.h"
+#include "seistrc.h"
+#include "seistrctr.h"
+#include "survinfo.h"
+#include "testprog.h"
+
+using namespace Attrib;
+
+static const int cNrTargets = 2;
+
+
+static DescID addMath( DescSet& ds, const char* expr, const char* nm )
+{
+    RefMan<Desc> desc = PF().createDescCopy( "Math" );
+    const BufferString defstr( "Math expression=", expr );
+    if ( !desc || !desc->parseDefStr(defstr) )
+	return DescID();
+
+    desc->setUserRef( nm );
+    return ds.addDesc( desc.ptr() );
+}
+
+
+static TrcKeyZSampling getSampling()
+{
+    TrcKeyZSampling tkzs( true );
+    const BinID start = tkzs.hsamp_.start_;
+    const BinID step = tkzs.hsamp_.step_;
+    tkzs.hsamp_.setInlRange( StepInterval<int>( start.inl(),
+				start.inl()+3*step.inl(), step.inl() ) );
+    tkzs.hsamp_.setCrlRange( StepInterval<int>( start.crl(),
+				start.crl()+4*step.crl(), step.crl() ) );
+    tkzs.zsamp_.stop_ = tkzs.zsamp_.atIndex( 9 );
+    return tkzs;
+}
+
+
+static float getValue( int target, int comp, const BinID& bid )
+{
+    if ( target == 0 )
+	return float( 2*bid.inl() );
+
+    return comp == 0 ? float( 3*bid.crl() )
+		     : float( 2*bid.inl() + 3*bid.crl() );
+}
+
+
+/* Both targets are written from the same processor: the first one gets the
+   inline attribute, the second one the crossline and sum attributes */
+
+static bool runJob( const TypeSet<MultiID>& targetids )
+{
+    DescSet ds( false );
+    TypeSet<DescID> ids;
+    ids += addMath( ds, "Inl*2", "inl" );
+    ids += addMath( ds, "Crl*3", "crl" );
+    ids += addMath( ds, "Inl*2+Crl*3", "sum" );
+    for ( const auto& id : ids )
+	mRunStandardTest( id.isValid(), "Create an attribute" );
+
+    IOPar iop;
+    iop.set( IOPar::compKey(sKey::Output(),sKey::Type()), sKey::Cube() );
+    IOPar subselpar;
+    getSampling().fillPar( subselpar );
+    iop.mergeComp( subselpar, IOPar::compKey(sKey::Output(),sKey::Subsel()) );
+    for ( int target=0; target<cNrTargets; target++ )
+    {
+	const BufferString keybase = IOPar::compKey( sKey::Output(), target );
+	iop.set( IOPar::compKey(keybase,SeisTrcStorOutput::seisidkey()),
+		 targetids[target] );
+	const BufferString attribkey =
+		IOPar::compKey( keybase, SeisTrcStorOutput::attribkey() );
+	if ( target == 0 )
+	    iop.set( IOPar::compKey(attribkey,0), ids[0].asInt() );
+	else
+	{
+	    iop.set( IOPar::compKey(attribkey,0), ids[1].asInt() );
+	    iop.set( IOPar::compKey(attribkey,1), ids[2].asInt() );
+	}
+    }
+
+    EngineMan em;
+    uiString errmsg;
+    PtrMan<Processor> proc = em.usePar( iop, ds, "", errmsg );
+    mRunStandardTestWithError( proc, "Create the processor",
+			       toString(errmsg) );
+    mRunStandardTest( proc->outputs_.size() == cNrTargets,
+		      "One output per target" );
+
+    while ( true )
+    {
+	const int res = proc->nextStep();
+	mRunStandardTestWithError( res >= 0, "Process a position",
+				   toString(proc->uiMessage()) );
+	if ( res == 0 )
+	    break;
+
+	for ( auto* output : proc->outputs_ )
+	    mRunStandardTestWithError( output->writeTrc(), "Write a trace",
+				       toString(output->errMsg()) );
+    }
+
+    for ( auto* output : proc->outputs_ )
+	mRunStandardTest( output->finishWrite(), "Close a target" );
+
+    return true;
+}
+
+
+static bool checkTarget( const MultiID& targetid, int target )
+{
+    PtrMan<IOObj> ioobj = IOM().get( targetid );
+    mRunStandardTest( ioobj, "Get the target entry" );
+
+    SeisTrcReader rdr( *ioobj );
+    mRunStandardTest( rdr.prepareWork(), "Open the target" );
+
+    const int nrcomps = target == 0 ? 1 : 2;
+    const TrcKeyZSampling tkzs = getSampling();
+    SeisTrc trc;
+    int nrtrcs = 0;
+    bool samevals = true;
+    while ( rdr.get(trc) )
+    {
+	nrtrcs++;
+	if ( trc.nrComponents() != nrcomps )
+	    { samevals = false; break; }
+
+	const BinID bid = trc.info().binID();
+	for ( int icomp=0; icomp<nrcomps; icomp++ )
+	{
+	    for ( int isamp=0; isamp<trc.size(); isamp++ )
+	    {
+		if ( !mIsEqual(trc.get(isamp,icomp),
+			       getValue(target,icomp,bid),1e-3f) )
+		    samevals = false;
+	    }
+	}
+    }
+
+    const BufferString desc( "target ", target );
+    mRunStandardTest( nrtrcs == tkzs.hsamp_.totalNr(),
+		      BufferString("All positions in ",desc) );
+    mRunStandardTest( samevals,
+		      BufferString("Components and values in ",desc) );
+    return true;
+}
+
+
+mLoad1Module("Attributes")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    IOObjContext ctxt = mIOObjContext(SeisTrc);
+    ctxt.forread_ = false;
+    ctxt.deftransl_ = CBVSSeisTrcTranslator::translKey();
+    TypeSet<MultiID> targetids;
+    for ( int target=0; target<cNrTargets; target++ )
+    {
+	CtxtIOObj ctio( ctxt );
+	ctio.setName( BufferString("_tmp_attrib_target_",target) );
+	IOM().getNewEntry( ctio );
+	mRunStandardTest( ctio.ioobj_, "Create a target entry" );
+	targetids += ctio.ioobj_->key();
+    }
+
+    bool res = runJob( targetids );
+    for ( int target=0; target<cNrTargets && res; target++ )
+	res = checkTarget( targetids[target], target );
+
+    uiRetVal uirv;
+    IOM().implRemove( targetids, true, &uirv );
+    return res;
+}
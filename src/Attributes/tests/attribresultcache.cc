@@ -0,0 +1,212 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "attribdesc.h"
+#include "attribdescset.h"
+#include "attribfactory.h"
+#include "attribresultcache.h"
+#include "attribsel.h"
+#include "moddepmgr.h"
+#include "seisdatapack.h"
+#include "survinfo.h"
+#include "testprog.h"
+#include "thread.h"
+
+using namespace Attrib;
+
+static const char* sKey1()	{ return "test_attribresultcache_1"; }
+static const char* sKey2()	{ return "test_attribresultcache_2"; }
+static const int cNrComps = 2;
+
+
+static BufferString getMathKey( const char* expr )
+{
+    DescSet ds( false );
+    RefMan<Desc> desc = PF().createDescCopy( "Math" );
+    const BufferString defstr( "Math expression=", expr );
+    if ( !desc || !desc->parseDefStr(defstr) )
+	return BufferString();
+
+    desc->setUserRef( "math" );
+    const DescID id = ds.addDesc( desc.ptr() );
+    TypeSet<SelSpec> specs;
+    specs += SelSpec( nullptr, id );
+    return ResultCache::getKey( ds, specs );
+}
+
+
+static TrcKeyZSampling getSampling( int inl0, int nrinl, int crl0, int nrcrl,
+				    int z0, int nrz )
+{
+    TrcKeyZSampling tkzs( true );
+    const BinID start = tkzs.hsamp_.start_;
+    const BinID step = tkzs.hsamp_.step_;
+    tkzs.hsamp_.setInlRange( StepInterval<int>( start.inl()+inl0*step.inl(),
+		start.inl()+(inl0+nrinl-1)*step.inl(), step.inl() ) );
+    tkzs.hsamp_.setCrlRange( StepInterval<int>( start.crl()+crl0*step.crl(),
+		start.crl()+(crl0+nrcrl-1)*step.crl(), step.crl() ) );
+    const StepInterval<float> zrg = tkzs.zsamp_;
+    tkzs.zsamp_.start_ = zrg.atIndex( z0 );
+    tkzs.zsamp_.stop_ = zrg.atIndex( z0+nrz-1 );
+    return tkzs;
+}
+
+
+static float getValue( int icomp, int inl, int crl, float z )
+{
+    return 1000.f*icomp + 10.f*inl + crl + z;
+}
+
+
+static RefMan<RegularSeisDataPack> getDataPack( const TrcKeyZSampling& tkzs )
+{
+    RefMan<RegularSeisDataPack> dp = new RegularSeisDataPack(
+				VolumeDataPack::categoryStr(tkzs) );
+    dp->setSampling( tkzs );
+    for ( int icomp=0; icomp<cNrComps; icomp++ )
+    {
+	dp->addComponent( BufferString("comp",icomp) );
+	Array3D<float>& arr = dp->data( icomp );
+	for ( int iinl=0; iinl<tkzs.nrInl(); iinl++ )
+	{
+	    const int inl = tkzs.hsamp_.inlRange().atIndex( iinl );
+	    for ( int icrl=0; icrl<tkzs.nrCrl(); icrl++ )
+	    {
+		const int crl = tkzs.hsamp_.crlRange().atIndex( icrl );
+		for ( int iz=0; iz<tkzs.nrZ(); iz++ )
+		    arr.set( iinl, icrl, iz,
+			getValue(icomp,inl,crl,tkzs.zsamp_.atIndex(iz)) );
+	    }
+	}
+    }
+
+    return dp;
+}
+
+
+static bool hasValues( const RegularSeisDataPack& dp )
+{
+    const TrcKeyZSampling& tkzs = dp.sampling();
+    if ( dp.nrComponents() != cNrComps )
+	return false;
+
+    for ( int icomp=0; icomp<cNrComps; icomp++ )
+    {
+	const Array3D<float>& arr = dp.data( icomp );
+	for ( int iinl=0; iinl<tkzs.nrInl(); iinl++ )
+	{
+	    const int inl = tkzs.hsamp_.inlRange().atIndex( iinl );
+	    for ( int icrl=0; icrl<tkzs.nrCrl(); icrl++ )
+	    {
+		const int crl = tkzs.hsamp_.crlRange().atIndex( icrl );
+		for ( int iz=0; iz<tkzs.nrZ(); iz++ )
+		{
+		    const float exp =
+			getValue( icomp, inl, crl, tkzs.zsamp_.atIndex(iz) );
+		    if ( !mIsEqual(arr.get(iinl,icrl,iz),exp,1e-3f) )
+			return false;
+		}
+	    }
+	}
+    }
+
+    return true;
+}
+
+
+static bool testKey()
+{
+    const BufferString key = getMathKey( "Inl*2" );
+    mRunStandardTest( !key.isEmpty(), "Computed attribute has a key" );
+    mRunStandardTest( key == getMathKey("Inl*2"), "Same key for same def" );
+    mRunStandardTest( key != getMathKey("Inl*3"), "Other key for other def" );
+    return true;
+}
+
+
+static bool testStoreAndGet()
+{
+    const TrcKeyZSampling stored = getSampling( 0, 6, 0, 8, 0, 20 );
+    mRunStandardTest( ARC().store(sKey1(),*getDataPack(stored)),
+		      "Store a volume" );
+
+    RefMan<RegularSeisDataPack> dp = ARC().get( sKey1(), stored );
+    mRunStandardTest( dp && dp->sampling() == stored && hasValues(*dp),
+		      "Get the stored volume" );
+
+    // Only the overlapping part is returned
+    const TrcKeyZSampling partly = getSampling( 2, 7, 3, 8, 5, 26 );
+    dp = ARC().get( sKey1(), partly );
+    mRunStandardTest( dp && dp->sampling() == getSampling(2,4,3,5,5,15) &&
+		      hasValues(*dp), "Get the overlapping part" );
+
+    TrcKeyZSampling shifted( stored );
+    shifted.zsamp_.start_ += 0.5f * shifted.zsamp_.step_;
+    shifted.zsamp_.stop_ += 0.5f * shifted.zsamp_.step_;
+    mRunStandardTest( !ARC().get(sKey1(),shifted),
+		      "No volume between the stored samples" );
+    mRunStandardTest( !ARC().get(sKey1(),getSampling(10,2,0,8,0,20)),
+		      "No volume without overlap" );
+    mRunStandardTest( !ARC().get(sKey2(),stored), "No volume for other key" );
+
+    // Stored sub-volumes are reused, and replaced by larger ones
+    const od_int64 usedsize = ARC().usedSize();
+    mRunStandardTest( ARC().store(sKey1(),*getDataPack(partly)) &&
+		      ARC().usedSize() > usedsize, "Store another part" );
+    const TrcKeyZSampling all = getSampling( 0, 9, 0, 11, 0, 31 );
+    const od_int64 allsize = all.totalNr() * cNrComps * sizeof(float);
+    mRunStandardTest( ARC().store(sKey1(),*getDataPack(all)) &&
+		      ARC().usedSize() == allsize,
+		      "Replace the parts by a larger volume" );
+    dp = ARC().get( sKey1(), partly );
+    mRunStandardTest( dp && dp->sampling() == partly && hasValues(*dp),
+		      "Get from the larger volume" );
+    return true;
+}
+
+
+static bool testLimitSize()
+{
+    const TrcKeyZSampling tkzs = getSampling( 0, 4, 0, 4, 0, 10 );
+    const od_int64 entrysize = tkzs.totalNr() * cNrComps * sizeof(float);
+    ARC().clear();
+    ARC().setMaxSize( entrysize + entrysize/2, false );
+    mRunStandardTest( ARC().store(sKey1(),*getDataPack(tkzs)),
+		      "Store the first entry" );
+    Threads::sleep( 0.01 );
+    mRunStandardTest( ARC().store(sKey2(),*getDataPack(tkzs)),
+		      "Store the second entry" );
+    mRunStandardTest( ARC().usedSize() <= ARC().maxSize(),
+		      "Cache size limited" );
+    mRunStandardTest( !ARC().get(sKey1(),tkzs) && ARC().get(sKey2(),tkzs),
+		      "Least recently used entry removed" );
+
+    ARC().setMaxSize( 0, false );
+    mRunStandardTest( !ARC().isEnabled() && !ARC().get(sKey2(),tkzs),
+		      "Disabled cache" );
+    return true;
+}
+
+
+mLoad1Module("Attributes")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    const od_int64 maxsize = ARC().maxSize();
+    ARC().setMaxSize( 64*1024*1024, false );
+    ARC().clear();
+    const bool res = testKey() && testStoreAndGet() && testLimitSize();
+    ARC().clear();
+    ARC().setMaxSize( maxsize, false );
+    return res;
+}
@@ -0,0 +1,145 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "attribdesc.h"
+#include "attribdescset.h"
+#include "attribengman.h"
+#include "attribfactory.h"
+#include "attribprocessor.h"
+#include "attribprovider.h"
+#include "attribsel.h"
+#include "moddepmgr.h"
+#include "survgeom.h"
+#include "survinfo.h"
+#include "testprog.h"
+
+using namespace Attrib;
+
+static const int cNrInl = 5;
+static const int cNrCrl = 7;
+static const int cNrZ = 10;
+
+
+static DescID addMath( DescSet& ds, const char* expr, const char* nm,
+		       const Desc* inp0=nullptr, const Desc* inp1=nullptr )
+{
+    RefMan<Desc> desc = PF().createDescCopy( "Math" );
+    const BufferString defstr( "Math expression=", expr );
+    if ( !desc || !desc->parseDefStr(defstr) )
+	return DescID();
+
+    if ( inp0 )
+	desc->setInput( 0, inp0 );
+    if ( inp1 )
+	desc->setInput( 1, inp1 );
+
+    desc->setUserRef( nm );
+    return ds.addDesc( desc.ptr() );
+}
+
+
+static bool runProcessor( bool withstats, BufferStringSet& nms,
+			  TypeSet<ProviderStats>& stats )
+{
+    DescSet ds( false );
+    const DescID inlid = addMath( ds, "Inl*2", "inl" );
+    const DescID crlid = addMath( ds, "Crl*3", "crl" );
+    const DescID sumid = addMath( ds, "x0+x1", "sum",
+				  ds.getDesc(inlid).ptr(),
+				  ds.getDesc(crlid).ptr() );
+    mRunStandardTest( sumid.isValid(), "Create the attributes" );
+
+    TrcKeyZSampling tkzs( true );
+    const BinID start = tkzs.hsamp_.start_;
+    const BinID step = tkzs.hsamp_.step_;
+    tkzs.hsamp_.setInlRange( StepInterval<int>( start.inl(),
+			start.inl()+(cNrInl-1)*step.inl(), step.inl() ) );
+    tkzs.hsamp_.setCrlRange( StepInterval<int>( start.crl(),
+			start.crl()+(cNrCrl-1)*step.crl(), step.crl() ) );
+    tkzs.zsamp_.stop_ = tkzs.zsamp_.atIndex( cNrZ-1 );
+
+    EngineMan em;
+    em.setAttribSet( &ds );
+    em.setAttribSpec( SelSpec(nullptr,sumid) );
+    em.setGeomID( Survey::default3DGeomID() );
+    em.setTrcKeyZSampling( tkzs );
+
+    uiString errmsg;
+    PtrMan<Processor> proc = em.createDataPackOutput( errmsg );
+    mRunStandardTestWithError( proc, "Create the processor",
+			       toString(errmsg) );
+    proc->enableStatistics( withstats );
+    mRunStandardTestWithError( proc->execute(), "Compute the attribute",
+			       toString(proc->uiMessage()) );
+
+    proc->getStatistics( nms, stats );
+    return true;
+}
+
+
+static bool testStatistics()
+{
+    BufferStringSet nms;
+    TypeSet<ProviderStats> stats;
+    if ( !runProcessor(false,nms,stats) )
+	return false;
+
+    mRunStandardTest( stats.size() == 3, "All providers listed" );
+    bool allempty = true;
+    for ( const auto& st : stats )
+	allempty = allempty && st == ProviderStats();
+
+    mRunStandardTest( allempty, "Nothing collected when disabled" );
+
+    if ( !runProcessor(true,nms,stats) )
+	return false;
+
+    mRunStandardTest( stats.size() == 3 && nms.size() == 3,
+		      "Statistics of all providers" );
+    mRunStandardTest( nms.get(0) == "sum (Math)" && nms.isPresent("inl (Math)")
+		      && nms.isPresent("crl (Math)"), "Provider names" );
+
+    // The top provider computes each position once, its inputs at least once
+    const int nrpos = cNrInl * cNrCrl;
+    const ProviderStats& top = stats[0];
+    mRunStandardTest( top.nrcomputed_.load() == nrpos &&
+		      top.nrsamples_.load() == nrpos*cNrZ,
+		      "Positions and samples of the top provider" );
+    bool inputsok = true, timesok = true;
+    for ( const auto& st : stats )
+    {
+	if ( st.nrcomputed_.load() < nrpos ||
+	     st.nrbufferhits_.load() + st.nrbuffermisses_.load()
+			< st.nrcomputed_.load() ||
+	     st.nrtrcsread_.load() != 0 )
+	    inputsok = false;
+
+	if ( st.totaltime_.load() < st.computetime_.load() )
+	    timesok = false;
+    }
+
+    mRunStandardTest( inputsok, "Counters of the inputs" );
+    mRunStandardTest( timesok, "Total time includes the compute time" );
+    return true;
+}
+
+
+mLoad1Module("Attributes")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    if ( !testStatistics() )
+	return false;
+
+    return true;
+}
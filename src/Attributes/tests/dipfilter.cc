@@ -0,0 +1,158 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "arrayndimpl.h"
+#include "attribdesc.h"
+#include "attribdescset.h"
+#include "attribengman.h"
+#include "attribfactory.h"
+#include "attribprocessor.h"
+#include "attribsel.h"
+#include "moddepmgr.h"
+#include "seisdatapack.h"
+#include "survgeom.h"
+#include "survinfo.h"
+#include "testprog.h"
+
+using namespace Attrib;
+
+static const char* methods[] = { "Direct", "Separable", "FFT", "Auto", 0 };
+
+
+static DescID addDesc( DescSet& ds, const char* attrnm, const char* defstr,
+		       const Desc* inp=nullptr )
+{
+    RefMan<Desc> desc = PF().createDescCopy( attrnm );
+    if ( !desc || !desc->parseDefStr(defstr) )
+	return DescID();
+
+    if ( inp )
+	desc->setInput( 0, inp );
+
+    desc->setUserRef( attrnm );
+    return ds.addDesc( desc.ptr() );
+}
+
+
+/* Away from the survey edges, so all input values are defined */
+
+static TrcKeyZSampling getSampling()
+{
+    TrcKeyZSampling tkzs( true );
+    const BinID step = tkzs.hsamp_.step_;
+    const BinID start = tkzs.hsamp_.start_ + BinID( 10*step.inl(),
+						    10*step.crl() );
+    tkzs.hsamp_.setInlRange( StepInterval<int>( start.inl(),
+				start.inl()+8*step.inl(), step.inl() ) );
+    tkzs.hsamp_.setCrlRange( StepInterval<int>( start.crl(),
+				start.crl()+10*step.crl(), step.crl() ) );
+    tkzs.zsamp_.start_ = tkzs.zsamp_.atIndex( 20 );
+    tkzs.zsamp_.stop_ = tkzs.zsamp_.atIndex( 79 );
+    return tkzs;
+}
+
+
+static RefMan<RegularSeisDataPack> runDipFilter( const char* filterdef,
+						 const char* method )
+{
+    DescSet ds( false );
+    const DescID inpid = addDesc( ds, "Math",
+		"Math expression=sin(Z*40+Inl*0.7)+cos(Crl*0.45-Z*25)" );
+    if ( !inpid.isValid() )
+	return nullptr;
+
+    BufferString defstr( "DipFilter ", filterdef );
+    defstr.add( " method=" ).add( method );
+    const DescID filterid = addDesc( ds, "DipFilter", defstr,
+				     ds.getDesc(inpid).ptr() );
+    if ( !filterid.isValid() )
+	return nullptr;
+
+    EngineMan em;
+    em.setAttribSet( &ds );
+    em.setAttribSpec( SelSpec(nullptr,filterid) );
+    em.setGeomID( Survey::default3DGeomID() );
+    em.setTrcKeyZSampling( getSampling() );
+
+    uiString errmsg;
+    PtrMan<Processor> proc = em.createDataPackOutput( errmsg );
+    if ( !proc || !proc->execute() )
+	return nullptr;
+
+    return em.getDataPackOutput( *proc );
+}
+
+
+static bool isSame( const Array3D<float>& arr, const Array3D<float>& exparr )
+{
+    const float* expvals = exparr.getData();
+    const float* vals = arr.getData();
+    if ( !vals || !expvals || arr.info() != exparr.info() )
+	return false;
+
+    float maxabs = 0.f;
+    const od_int64 totsz = exparr.info().getTotalSz();
+    for ( od_int64 idx=0; idx<totsz; idx++ )
+    {
+	if ( mIsUdf(expvals[idx]) )
+	    return false;
+
+	maxabs = mMAX( maxabs, fabs(expvals[idx]) );
+    }
+
+    if ( mIsZero(maxabs,1e-6f) )
+	return false;
+
+    for ( od_int64 idx=0; idx<totsz; idx++ )
+    {
+	if ( mIsUdf(vals[idx]) || fabs(vals[idx]-expvals[idx]) > 1e-4f*maxabs )
+	    return false;
+    }
+
+    return true;
+}
+
+
+/* All methods are run on the same input, and compared with Direct */
+
+static bool testMethods( const char* filterdef, const char* desc )
+{
+    RefMan<RegularSeisDataPack> direct = runDipFilter( filterdef, methods[0] );
+    mRunStandardTest( direct && !direct->isEmpty(),
+		      BufferString(desc,": Direct") );
+
+    for ( int idx=1; methods[idx]; idx++ )
+    {
+	RefMan<RegularSeisDataPack> dp = runDipFilter( filterdef,
+						       methods[idx] );
+	const BufferString testnm( desc, ": ", methods[idx] );
+	mRunStandardTest( dp && !dp->isEmpty(), testnm );
+	mRunStandardTest( isSame(dp->data(0),direct->data(0)),
+			  BufferString(testnm," same as Direct") );
+    }
+
+    return true;
+}
+
+
+mLoad1Module("Attributes")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    // Separable falls back to Direct for the fan kernels; the kernel that
+    // only keeps the centre trace is separable
+    return testMethods( "size=7 type=LowPass maxvel=2000", "Fan" ) &&
+	   testMethods( "size=5 type=LowPass maxvel=1", "Separable kernel" ) &&
+	   testMethods( "size=5 type=BandPass minvel=800 maxvel=3000 "
+			"filterazi=Yes minazi=-20 maxazi=40", "Azimuth" );
+}
@@ -45,6 +45,11 @@ int Counter::elapsed() const
     return qelapstimer_->elapsed();
 }
 
+od_int64 Counter::elapsedUs() const
+{
+    return qelapstimer_->nsecsElapsed() / 1000;
+}
+
 
 // FileTimeSet
 
@@ -11,6 +11,7 @@ ________________________________________________________________________
 #include "ctype.h"
 #include "ptrman.h"
 #include "math2.h"
+#include "odmemory.h"
 #include "statrand.h"
 #include "statruncalc.h"
 #include "undefval.h"
@@ -159,6 +160,11 @@ double getValue() const override
     return val_;
 }
 
+double value() const
+{
+    return val_;
+}
+
 Expression* clone() const override
 {
     auto* res = new ExpressionConstant( val_ );
@@ -755,6 +761,352 @@ void Math::Expression::doDump( BufferString& str, int nrtabs ) const
 }
 
 
+//--- Compiled program
+
+Math::ExpressionProgram::ExpressionProgram( int nrvars )
+    : nrvars_(nrvars)
+{
+}
+
+
+Math::ExpressionProgram::~ExpressionProgram()
+{
+}
+
+
+Math::ExpressionProgram* Math::ExpressionProgram::compile(
+						const Expression& expr )
+{
+    PtrMan<ExpressionProgram> prog =
+				new ExpressionProgram( expr.nrVariables() );
+    TypeSet<int> freetemps;
+    prog->outreg_ = prog->addNode( expr, expr, freetemps );
+    if ( prog->outreg_ == mUdf(int) )
+	return nullptr;
+
+    if ( prog->outreg_ < -1 )
+    {
+	// The output must be in the first temporary
+	const int outreg = prog->outreg_;
+	for ( auto& instr : prog->instrs_ )
+	{
+	    for ( int& reg : instr.srcs_ )
+		reg = reg==outreg ? -1 : (reg==-1 ? outreg : reg);
+	    int& dest = instr.dest_;
+	    dest = dest==outreg ? -1 : (dest==-1 ? outreg : dest);
+	}
+	prog->outreg_ = -1;
+    }
+    else if ( prog->outreg_ >= 0 )
+    {
+	// Result is a variable or a constant: still needs an instruction
+	Instruction instr;
+	instr.opcode_ = Copy;
+	instr.dest_ = -1;
+	instr.srcs_ += prog->outreg_;
+	prog->instrs_ += instr;
+	prog->nrtemps_ = mMAX( prog->nrtemps_, 1 );
+	prog->outreg_ = -1;
+    }
+
+    return prog.release();
+}
+
+
+int Math::ExpressionProgram::addNode( const Expression& expr,
+				      const Expression& root,
+				      TypeSet<int>& freetemps )
+{
+    mDynamicCastGet(const ExpressionVariable*,var,&expr)
+    if ( var )
+    {
+	const StringView varstr = var->fullVariableExpression( 0 );
+	for ( int ivar=0; ivar<root.nrVariables(); ivar++ )
+	{
+	    if ( varstr == root.fullVariableExpression(ivar) )
+		return ivar;
+	}
+
+	return mUdf(int);
+    }
+
+    mDynamicCastGet(const ExpressionConstant*,cnst,&expr)
+    if ( cnst )
+    {
+	const double val = cnst->value();
+	constvals_ += Values::isUdf(val) ? mUdf(float) : float(val);
+	return nrvars_ + constvals_.size() - 1;
+    }
+
+    Instruction instr;
+#   define mIfOpCode(clss) \
+    if ( dynamic_cast<const Expression##clss*>(&expr) ) \
+	instr.opcode_ = clss;
+    mIfOpCode(Plus) else mIfOpCode(Minus) else mIfOpCode(Multiply)
+    else mIfOpCode(Divide) else mIfOpCode(IntDivide)
+    else mIfOpCode(IntDivRest) else mIfOpCode(Abs) else mIfOpCode(Power)
+    else mIfOpCode(Condition) else mIfOpCode(LessOrEqual)
+    else mIfOpCode(Less) else mIfOpCode(MoreOrEqual) else mIfOpCode(More)
+    else mIfOpCode(Equal) else mIfOpCode(NotEqual) else mIfOpCode(OR)
+    else mIfOpCode(AND) else mIfOpCode(Sine) else mIfOpCode(ArcSine)
+    else mIfOpCode(Cosine) else mIfOpCode(ArcCosine)
+    else mIfOpCode(Tangent) else mIfOpCode(ArcTangent) else mIfOpCode(Log)
+    else mIfOpCode(NatLog) else mIfOpCode(Exp) else mIfOpCode(Sqrt)
+    else mIfOpCode(Min) else mIfOpCode(Max) else mIfOpCode(Sum)
+    else mIfOpCode(Median) else mIfOpCode(Average) else mIfOpCode(Variance)
+    else
+	return mUdf(int);
+#   undef mIfOpCode
+
+    for ( const auto* inp : expr.inputs_ )
+    {
+	if ( !inp )
+	    return mUdf(int);
+
+	const int reg = addNode( *inp, root, freetemps );
+	if ( reg == mUdf(int) )
+	    return mUdf(int);
+
+	instr.srcs_ += reg;
+    }
+
+    // Each temporary is used once, so the inputs' ones can be recycled
+    for ( const int reg : instr.srcs_ )
+    {
+	if ( reg < 0 )
+	    freetemps += reg;
+    }
+
+    if ( freetemps.isEmpty() )
+	instr.dest_ = -(++nrtemps_);
+    else
+    {
+	instr.dest_ = freetemps.last();
+	freetemps.removeSingle( freetemps.size()-1 );
+    }
+
+    instrs_ += instr;
+    return instr.dest_;
+}
+
+
+namespace Math
+{
+
+template <class OP>
+static void applyBinary( const float* v0, const float* v1, float* out,
+			 int sz, OP op )
+{
+    for ( int idx=0; idx<sz; idx++ )
+    {
+	const float val0 = v0[idx];
+	const float val1 = v1[idx];
+	out[idx] = mIsUdf(val0) || mIsUdf(val1) ? mUdf(float)
+						 : op( val0, val1 );
+    }
+}
+
+
+template <class OP>
+static void applyUnary( const float* v0, float* out, int sz, OP op )
+{
+    for ( int idx=0; idx<sz; idx++ )
+    {
+	const float val = v0[idx];
+	const float res = mIsUdf(val) ? mUdf(float) : op( val );
+	out[idx] = res == res ? res : mUdf(float);
+    }
+}
+
+
+static void applyStats( Stats::Type stattype, const ObjectSet<const float>& vs,
+			float* out, int sz )
+{
+    Stats::RunCalc<double> stats( Stats::CalcSetup().require(stattype) );
+    for ( int idx=0; idx<sz; idx++ )
+    {
+	stats.clear();
+	for ( const auto* v : vs )
+	    stats += v[idx];
+
+	const double res = stats.getValue( stattype );
+	out[idx] = Values::isUdf(res) ? mUdf(float) : float(res);
+    }
+}
+
+} // namespace Math
+
+
+void Math::ExpressionProgram::execute( const float* const* vararrs,
+				       const float* varvals, float* out,
+				       int sz ) const
+{
+    if ( sz < 1 || instrs_.isEmpty() )
+	return;
+
+    // Fixed values are broadcast, so that all kernels are array-to-array
+    const int nrfixed = nrvars_ + constvals_.size();
+    TypeSet<float> work( (nrfixed + nrtemps_ - 1) * sz, 0.f );
+    TypeSet<const float*> regs( nrfixed, nullptr );
+    float* workptr = work.arr();
+    for ( int ireg=0; ireg<nrfixed; ireg++ )
+    {
+	if ( ireg < nrvars_ && vararrs && vararrs[ireg] )
+	{
+	    regs[ireg] = vararrs[ireg];
+	    continue;
+	}
+
+	const float val = ireg < nrvars_ ? varvals[ireg]
+					 : constvals_[ireg-nrvars_];
+	OD::memValueSet( workptr, val, sz );
+	regs[ireg] = workptr;
+	workptr += sz;
+    }
+
+    // The first temporary is the output buffer
+    TypeSet<float*> temps( nrtemps_, nullptr );
+    for ( int itmp=0; itmp<nrtemps_; itmp++ )
+    {
+	temps[itmp] = itmp ? workptr : out;
+	if ( itmp )
+	    workptr += sz;
+    }
+
+    ObjectSet<const float> srcs;
+    for ( const auto& instr : instrs_ )
+    {
+	srcs.erase();
+	for ( const int reg : instr.srcs_ )
+	    srcs += reg < 0 ? temps[-1-reg] : regs[reg];
+
+	float* dest = temps[-1-instr.dest_];
+	const float* v0 = srcs.first();
+	const float* v1 = srcs.size() > 1 ? srcs[1] : nullptr;
+	switch ( instr.opcode_ )
+	{
+	case Copy:
+	    OD::sysMemCopy( dest, v0, sz*sizeof(float) );
+	break;
+	case Plus:
+	    applyBinary( v0, v1, dest, sz,
+			 []( float a, float b ) { return a + b; } );
+	break;
+	case Minus:
+	    applyBinary( v0, v1, dest, sz,
+			 []( float a, float b ) { return a - b; } );
+	break;
+	case Multiply:
+	    applyBinary( v0, v1, dest, sz,
+			 []( float a, float b ) { return a * b; } );
+	break;
+	case Divide:
+	    applyBinary( v0, v1, dest, sz, []( float a, float b )
+	    {
+		if ( mIsZero(b,mDefEps) )
+		    return mIsZero(a,mDefEps) ? 1.f : mUdf(float);
+		return a / b;
+	    } );
+	break;
+	case IntDivide: case IntDivRest:
+	{
+	    const bool isrest = instr.opcode_ == IntDivRest;
+	    applyBinary( v0, v1, dest, sz, [isrest]( float a, float b )
+	    {
+		const od_int64 i0 = mRounded(od_int64,a);
+		const od_int64 i1 = mRounded(od_int64,b);
+		if ( i1 == 0 )
+		    return mUdf(float);
+		return float( isrest ? i0 % i1 : i0 / i1 );
+	    } );
+	}
+	break;
+	case Abs:
+	    for ( int idx=0; idx<sz; idx++ )
+		dest[idx] = fabs( v0[idx] );
+	break;
+	case Power:
+	    applyBinary( v0, v1, dest, sz, []( float a, float b )
+	    {
+		if ( a < 0 && !mIsEqual(b,(int)b,mDefEps) )
+		    return mUdf(float);
+		return float( pow(a,b) );
+	    } );
+	break;
+	case Condition:
+	{
+	    const float* v2 = srcs[2];
+	    for ( int idx=0; idx<sz; idx++ )
+	    {
+		const float cond = v0[idx];
+		dest[idx] = mIsUdf(cond) ? mUdf(float)
+			  : (!mIsZero(cond,mDefEps) ? v1[idx] : v2[idx]);
+	    }
+	}
+	break;
+	case LessOrEqual:
+	    applyBinary( v0, v1, dest, sz,
+			 []( float a, float b ) { return float(a <= b); } );
+	break;
+	case Less:
+	    applyBinary( v0, v1, dest, sz,
+			 []( float a, float b ) { return float(a < b); } );
+	break;
+	case MoreOrEqual:
+	    applyBinary( v0, v1, dest, sz,
+			 []( float a, float b ) { return float(a >= b); } );
+	break;
+	case More:
+	    applyBinary( v0, v1, dest, sz,
+			 []( float a, float b ) { return float(a > b); } );
+	break;
+	case Equal: case NotEqual:
+	{
+	    const bool iseq = instr.opcode_ == Equal;
+	    for ( int idx=0; idx<sz; idx++ )
+	    {
+		const bool udf0 = mIsUdf(v0[idx]);
+		const bool udf1 = mIsUdf(v1[idx]);
+		const bool equal = udf0 || udf1 ? udf0 && udf1
+				 : mIsEqual(v0[idx],v1[idx],mDefEps);
+		dest[idx] = equal == iseq ? 1.f : 0.f;
+	    }
+	}
+	break;
+	case OR:
+	    applyBinary( v0, v1, dest, sz, []( float a, float b )
+	    { return float( !mIsZero(a,mDefEps) || !mIsZero(b,mDefEps) ); } );
+	break;
+	case AND:
+	    applyBinary( v0, v1, dest, sz, []( float a, float b )
+	    { return float( !mIsZero(a,mDefEps) && !mIsZero(b,mDefEps) ); } );
+	break;
+#	define mCaseUnary(opc,func) \
+	case opc: \
+	    applyUnary( v0, dest, sz, []( float a ) { return func(a); } ); \
+	break
+	mCaseUnary( Sine, sin );
+	mCaseUnary( ArcSine, Math::ASin );
+	mCaseUnary( Cosine, cos );
+	mCaseUnary( ArcCosine, Math::ACos );
+	mCaseUnary( Tangent, tan );
+	mCaseUnary( ArcTangent, atan );
+	mCaseUnary( Log, Math::Log10 );
+	mCaseUnary( NatLog, Math::Log );
+	mCaseUnary( Exp, Math::Exp );
+	mCaseUnary( Sqrt, Math::Sqrt );
+#	undef mCaseUnary
+	case Min:	applyStats( Stats::Min, srcs, dest, sz );	break;
+	case Max:	applyStats( Stats::Max, srcs, dest, sz );	break;
+	case Sum:	applyStats( Stats::Sum, srcs, dest, sz );	break;
+	case Median:	applyStats( Stats::Median, srcs, dest, sz );	break;
+	case Average:	applyStats( Stats::Average, srcs, dest, sz );	break;
+	case Variance:	applyStats( Stats::Variance, srcs, dest, sz );	break;
+	}
+    }
+}
+
+
 //--- Parser
 
 
@@ -255,6 +255,8 @@ Math::Formula& Math::Formula::operator =( const Math::Formula& oth )
 	const_cast<bool&>(inputsareseries_) = oth.inputsareseries_;
 	delete expr_;
 	expr_ = oth.expr_ ? oth.expr_->clone() : nullptr;
+	deleteAndNullPtr( prog_ );
+	progdone_ = false;
 	inpidxs_ = oth.inpidxs_;
 	recshifts_ = oth.recshifts_;
 	validxs_ = oth.validxs_;
@@ -267,6 +269,7 @@ Math::Formula& Math::Formula::operator =( const Math::Formula& oth )
 
 Math::Formula::~Formula()
 {
+    delete prog_;
     delete expr_;
     deepErase( inps_ );
 }
@@ -371,6 +374,8 @@ void Math::Formula::setText( const char* inp )
     text_ = inp;
     ExpressionParser mep( inp, inputsareseries_ );
     delete expr_;
+    deleteAndNullPtr( prog_ );
+    progdone_ = false;
     expr_ = mep.parse();
     if ( !expr_ )
     {
@@ -633,6 +638,66 @@ double Math::Formula::getValue( const double* vals ) const
 }
 
 
+bool Math::Formula::getValues( const float* const* valarrs, const float* vals,
+			       float* out, int sz ) const
+{
+    if ( !expr_ || isRecursive() )
+	return false;
+
+    Threads::Locker lckr( formlock_ );
+    if ( !progdone_ )
+    {
+	prog_ = ExpressionProgram::compile( *expr_ );
+	progdone_ = true;
+    }
+
+    lckr.unlockNow();
+    if ( !prog_ )
+	return false;
+
+    const int nrvars = inpidxs_.size();
+    TypeSet<const float*> vararrs( nrvars, nullptr );
+    TypeSet<float> varvals( nrvars, mUdf(float) );
+    ManagedObjectSet<TypeSet<float> > convarrs;
+    for ( int ivar=0; ivar<nrvars; ivar++ )
+    {
+	const int inpidx = inpidxs_[ivar];
+	if ( inpidx < 0 )
+	    return false;
+
+	const int validx = validxs_[ivar];
+	const InpDef& id = *inps_.get( inpidx );
+	const float* arr = valarrs ? valarrs[validx] : nullptr;
+	if ( !arr )
+	{
+	    varvals[ivar] = vals[validx];
+	    if ( id.valunit_ )
+		convValue( varvals[ivar], id.valunit_, id.formunit_ );
+	}
+	else if ( id.valunit_ )
+	{
+	    auto* convarr = new TypeSet<float>( arr, sz );
+	    for ( auto& val : *convarr )
+		convValue( val, id.valunit_, id.formunit_ );
+
+	    convarrs += convarr;
+	    vararrs[ivar] = convarr->arr();
+	}
+	else
+	    vararrs[ivar] = arr;
+    }
+
+    prog_->execute( vararrs.arr(), varvals.arr(), out, sz );
+    if ( outputvalunit_ )
+    {
+	for ( int idx=0; idx<sz; idx++ )
+	    convValue( out[idx], outputformunit_, outputvalunit_ );
+    }
+
+    return true;
+}
+
+
 #define mDefInpKeybase \
     const BufferString inpkybase( IOPar::compKey(sKey::Input(),iinp) )
 #define mDefValKeybase \
@@ -131,6 +131,58 @@ static bool testAbs()
 }
 
 
+static bool testCompiled( const char* expression )
+{
+    Math::ExpressionParser mep( expression );
+    PtrMan<Math::Expression> me = mep.parse();
+    mRunStandardTest( me, BufferString("Parsing ", expression ) );
+    PtrMan<Math::ExpressionProgram> prog =
+				Math::ExpressionProgram::compile( *me );
+    mRunStandardTest( prog, BufferString("Compiling ", expression ) );
+
+    const int nrvars = me->nrVariables();
+    const int sz = 17;
+    TypeSet<float> vararr( sz, 0.f );
+    for ( int idx=0; idx<sz; idx++ )
+	vararr[idx] = idx==5 ? mUdf(float) : float(idx-8) * 0.5f;
+
+    TypeSet<const float*> vararrs( nrvars, nullptr );
+    TypeSet<float> varvals( nrvars, 3.f );
+    if ( nrvars > 0 )
+	vararrs[0] = vararr.arr();
+
+    TypeSet<float> out( sz, 0.f );
+    prog->execute( vararrs.arr(), varvals.arr(), out.arr(), sz );
+    bool isok = true;
+    for ( int idx=0; idx<sz; idx++ )
+    {
+	for ( int ivar=0; ivar<nrvars; ivar++ )
+	    me->setVariableValue( ivar, ivar ? varvals[ivar] : vararr[idx] );
+
+	const double expval = me->getValue();
+	if ( Values::isUdf(expval) ? !mIsUdf(out[idx])
+				   : !mIsEqual(out[idx],float(expval),1e-4) )
+	    isok = false;
+    }
+
+    mRunStandardTest( isok, BufferString("Compiled values of ",expression) );
+    return true;
+}
+
+
+static bool testCompiledExpressions()
+{
+    return testCompiled( "3+4*5" ) &&
+	   testCompiled( "x" ) &&
+	   testCompiled( "x*x - 2*y + 1" ) &&
+	   testCompiled( "x>0 ? sqrt(x) : -abs(x)/y" ) &&
+	   testCompiled( "(x==y || x<=-2) && x!=1 ? exp(x) : ln(y)" ) &&
+	   testCompiled( "x/(x-0.5) + y^2 + idiv(y,2) + x%2" ) &&
+	   testCompiled( "min(x,y) + max(x,y,2) + avg(x,y) + med(x,1,y)" ) &&
+	   testCompiled( "x[-1] + x[1] + sin(x) * cos(y)" );
+}
+
+
 int mTestMainFnName( int argc, char** argv )
 {
     mInitTestProg();
@@ -145,6 +197,8 @@ int mTestMainFnName( int argc, char** argv )
 	    return 1;
 	if ( !testAbs() )
 	    return 1;
+	if ( !testCompiledExpressions() )
+	    return 1;
     }
 
     return 0;
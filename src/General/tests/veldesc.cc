@@ -436,6 +436,85 @@ static bool testVelocityConversion()
 }
 
 
+/* A brick of traces converted in place must give the same velocities as
+   converting each trace on its own */
+
+static bool testBrickConv( VelocityType typein, VelocityType typeout,
+			   const ZDomain::Info& zinfo, bool inpinfeetsec,
+			   bool outinfeetsec )
+{
+    VelocityDesc descin, descout;
+    descin.type_ = typein;
+    descout.type_ = typeout;
+    setDescUnit( inpinfeetsec, descin );
+    setDescUnit( outinfeetsec, descout );
+
+    TypeSet<double> modvels, zvals;
+    getVelocities( descin, modvels );
+    getZVals( zinfo, zvals );
+    const ArrayZValues<double> zvalsarr( zvals, zinfo );
+
+    const int nrtrcs = 5;
+    TypeSet<double> brick, expvels;
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+    {
+	for ( int idx=0; idx<modsz_; idx++ )
+	    brick += modvels[idx] * (1. + 0.02*itrc);
+    }
+
+    const Vel::Worker worker( descin, srd_, UnitOfMeasure::meterUnit() );
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+    {
+	const ArrayValueSeries<double,double> Vin( brick.arr()+itrc*modsz_,
+						   false, modsz_ );
+	ArrayValueSeries<double,double> Vout( modsz_ );
+	if ( !worker.convertVelocities(Vin,zvalsarr,descout,Vout) )
+	    return false;
+
+	for ( int idx=0; idx<modsz_; idx++ )
+	    expvels += Vout.value( idx );
+    }
+
+    BufferString desc( "Convert a brick from ", toString(typein), " to " );
+    desc.add( toString(typeout) ).add( " in " )
+	.add( zinfo.isTime() ? "time" : "depth" )
+	.add( ", " ).add( descin.getUnit()->symbol() ).add( " to " )
+	.add( descout.getUnit()->symbol() );
+    mRunStandardTest( worker.convertVelocities(brick.arr(),nrtrcs,zvalsarr,
+					       descout), desc );
+
+    bool same = true;
+    for ( int idx=0; idx<brick.size(); idx++ )
+    {
+	if ( !mIsEqual(brick[idx],expvels[idx],1e-6*expvels[idx]) )
+	    same = false;
+    }
+
+    mRunStandardTest( same, BufferString(desc,": same as per trace") );
+    return true;
+}
+
+
+static bool testBrickConversion()
+{
+    const ZDomain::Info& ztwt = ZDomain::TWT();
+    const ZDomain::Info& zdepthft = ZDomain::DepthFeet();
+    if ( !testBrickConv(VelocityType::Interval,VelocityType::Avg,ztwt,
+			false,false) ||
+	 !testBrickConv(VelocityType::Interval,VelocityType::RMS,ztwt,
+			false,true) ||
+	 !testBrickConv(VelocityType::RMS,VelocityType::Interval,ztwt,
+			true,false) ||
+	 !testBrickConv(VelocityType::Avg,VelocityType::Interval,zdepthft,
+			true,true) ||
+	 !testBrickConv(VelocityType::Interval,VelocityType::Interval,ztwt,
+			false,true) )
+	return false;
+
+    return true;
+}
+
+
 static bool testSampleVelocities()
 {
     const ZSampling zsamp_time( 0.4f, 1.1f, 0.004f );
@@ -579,6 +658,7 @@ int mTestMainFnName( int argc, char** argv )
     mInitTestProg();
 
     if ( !testVelocityConversion() ||
+	 !testBrickConversion() ||
 	 !testSampleVelocities() ||
 	 !testCalcZ() ||
 	 !testCalcZLinear() )
@@ -17,6 +17,7 @@ ________________________________________________________________________
 #include "uistrings.h"
 #include "unitofmeasure.h"
 #include "velocitycalc.h"
+#include "zdomain.h"
 #include "zvalseriesimpl.h"
 
 const char* sKeyIsVelocity = "Is Velocity";
@@ -245,6 +246,36 @@ bool VelocityDesc::isUsable( OD::VelocityType type, const ZDomain::Def& zddef,
 
 // Vel::Worker
 
+static bool convertVels( const VelocityDesc& desc, const VelocityDesc& newdesc,
+			 const ValueSeries<double>& Vin,
+			 const ZValueSeries& zvals, ValueSeries<double>& Vout,
+			 double t0 )
+{
+    bool isok = false;
+    if ( desc.isInterval() )
+    {
+	if ( newdesc.isAvg() )
+	    isok = Vel::computeVavg( Vin, zvals, Vout );
+	else if ( newdesc.isRMS() )
+	    isok = Vel::computeVrms( Vin, zvals, Vout, t0 );
+    }
+    else if ( desc.isAvg() )
+    {
+	isok = Vel::computeVint( Vin, zvals, Vout );
+	if ( isok && newdesc.isRMS() )
+	    isok = Vel::computeVrms( Vout, zvals, Vout, t0 ) ;
+    }
+    else if ( desc.isRMS() )
+    {
+	isok = zvals.isTime() && Vel::computeDix( Vin, zvals, Vout, t0 );
+	if ( isok && newdesc.isAvg() )
+	    isok = Vel::computeVavg( Vout, zvals, Vout );
+    }
+
+    return isok;
+}
+
+
 Vel::Worker::Worker( const VelocityDesc& desc, double srd,
 		     const UnitOfMeasure* srduom )
     : desc_(desc)
@@ -332,25 +363,87 @@ bool Vel::Worker::convertVelocities( const ValueSeries<double>& Vin_src,
     if ( !zvals )
 	return false;
 
-    bool isok = false;
-    if ( desc_.isInterval() )
+    return convertVels( desc_, newdesc, Vin, *zvals, Vout, t0 );
+}
+
+
+bool Vel::Worker::convertVelocities( double* vels, int nrtrcs,
+				     const ZValueSeries& zvals_in,
+				     const VelocityDesc& newdesc,
+				     double t0 ) const
+{
+    if ( !vels || nrtrcs < 1 || !desc_.isVelocity() || !newdesc.isVelocity() )
+	return false;
+
+    const od_int64 sz = zvals_in.size();
+    const bool sametype = desc_.type_ == newdesc.type_;
+    TypeSet<double> zarr;
+    bool zistime = true;
+    if ( !sametype )
     {
-	if ( newdesc.isAvg() )
-	    isok = computeVavg( Vin, *zvals, Vout );
-	else if ( newdesc.isRMS() )
-	    isok = computeVrms( Vin, *zvals, Vout, t0 );
+	if ( zvals_in.isDepth() && (desc_.isRMS() || newdesc.isRMS()) )
+	    return false;
+
+	PtrMan<ZValueSeries> zvals = getZVals( zvals_in, srd_, nullptr );
+	if ( !zvals )
+	    return false;
+
+	// The Z values of all traces, scaled once
+	zarr.setSize( sz );
+	for ( od_int64 idx=0; idx<sz; idx++ )
+	    zarr[idx] = zvals->value( idx );
+
+	zistime = zvals->isTime();
     }
-    else if ( desc_.isAvg() )
+
+    const od_int64 totsz = sz * nrtrcs;
+    const Scaler& inpvelscaler = desc_.getUnit()->scaler();
+    const Scaler& outvelscaler = newdesc.getUnit()->scaler();
+    const bool scaleinp = !inpvelscaler.isEmpty();
+    const bool scaleout = !outvelscaler.isEmpty();
+    if ( scaleinp )
     {
-	isok = computeVint( Vin, *zvals, Vout );
-	if ( isok && newdesc.isRMS() )
-	    isok = computeVrms( Vout, *zvals, Vout, t0 ) ;
+	for ( od_int64 idx=0; idx<totsz; idx++ )
+	    vels[idx] = inpvelscaler.scale( vels[idx] );
     }
-    else if ( desc_.isRMS() )
+
+    bool isok = true;
+    BoolTypeSet trcisok( nrtrcs, true );
+    if ( !sametype )
     {
-	isok = zvals->isTime() && computeDix( Vin, *zvals, Vout, t0 );
-	if ( isok && newdesc.isAvg() )
-	    isok = computeVavg( Vout, *zvals, Vout );
+	const ZDomain::Info& zinfo = zistime ? zvals_in.zDomainInfo()
+					     : ZDomain::DepthMeter();
+	const ArrayZValues<double> zvalsarr( zarr, zinfo );
+	for ( int itrc=0; itrc<nrtrcs; itrc++ )
+	{
+	    ArrayValueSeries<double,double> trcvels( vels + itrc*sz,
+						     false, sz );
+	    trcisok[itrc] = convertVels( desc_, newdesc, trcvels, zvalsarr,
+					 trcvels, t0 );
+	    if ( !trcisok[itrc] )
+		isok = false;
+	}
+    }
+
+    if ( !scaleinp && !scaleout )
+	return isok;
+
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+    {
+	double* trcvels = vels + itrc*sz;
+	if ( !trcisok[itrc] )
+	{
+	    if ( scaleinp )
+	    {
+		for ( od_int64 idx=0; idx<sz; idx++ )
+		    trcvels[idx] = inpvelscaler.unScale( trcvels[idx] );
+	    }
+	}
+	else if ( scaleout )
+	{
+	    for ( od_int64 idx=0; idx<sz; idx++ )
+		trcvels[idx] = outvelscaler.unScale( trcvels[idx] );
+	}
     }
 
     return isok;
@@ -16,6 +16,7 @@ ________________________________________________________________________
 #include "keystrs.h"
 #include "jobcommunic.h"
 #include "moddepmgr.h"
+#include "paralleltask.h"
 #include "progressmeter.h"
 #include "posinfo.h"
 #include "posinfo2d.h"
@@ -28,6 +29,7 @@ ________________________________________________________________________
 #include "seistrc.h"
 #include "seistype.h"
 #include "survinfo.h"
+#include "thread.h"
 #include "trckeysampling.h"
 
 #include <iostream>
@@ -38,6 +40,304 @@ using namespace PreStack;
 { deleteAndNullPtr( procman ); writer = nullptr; }
 
 
+namespace PreStack
+{
+
+struct GatherJob
+{
+    BinID			pos_;
+    TypeSet<BinID>		relbids_;
+    RefObjectSet<Gather>	inputs_;
+    ConstRefMan<Gather>		output_;
+};
+
+
+/*!\brief Reads the input gathers of the next output positions. The gathers
+  stay in a window that follows the processing, so neighbouring positions
+  share them. */
+
+class GatherPrefetcher
+{
+public:
+			GatherPrefetcher(const ProcessManager&,
+					 const BinID& firstpos,
+					 const BinID& step,
+					 SeisPSReader*,const IOObj*);
+
+    void		setIterator( TrcKeySamplingIterator& iter )
+			{ hiter_ = &iter; }
+    void		setCDPRange( const StepInterval<int>& rg )
+			{ cdprange_ = rg; }
+
+    void		fillBatch(ObjectSet<GatherJob>&,int maxnrpos);
+
+protected:
+
+    Gather*		getGather(const BinID&);
+    bool		nextPosition();
+    void		removeObsolete();
+
+    TypeSet<BinID>	relbids_;
+    BinID		stepout_;
+    BinID		step_;
+    BinID		curpos_;
+    bool		atend_			= false;
+    SeisPSReader*	reader_;
+    const IOObj*	ioobj_;
+    TrcKeySamplingIterator* hiter_		= nullptr;
+    StepInterval<int>	cdprange_;
+
+    TypeSet<BinID>	bids_;
+    RefObjectSet<Gather> gathers_;
+    RefMan<Gather>	sparegather_;
+};
+
+
+GatherPrefetcher::GatherPrefetcher( const ProcessManager& procman,
+				    const BinID& firstpos, const BinID& step,
+				    SeisPSReader* reader, const IOObj* ioobj )
+    : stepout_(procman.getInputStepout())
+    , step_(step)
+    , curpos_(firstpos)
+    , reader_(procman.needsPreStackInput() ? reader : nullptr)
+    , ioobj_(ioobj)
+    , cdprange_(0,0,1)
+{
+    gathers_.setNullAllowed();
+    BinID relbid;
+    for ( relbid.inl()=-stepout_.inl(); relbid.inl()<=stepout_.inl();
+					relbid.inl()++ )
+    {
+	for ( relbid.crl()=-stepout_.crl(); relbid.crl()<=stepout_.crl();
+					    relbid.crl()++)
+	{
+	    if ( procman.wantsInput(relbid) )
+		relbids_ += relbid;
+	}
+    }
+}
+
+
+void GatherPrefetcher::fillBatch( ObjectSet<GatherJob>& jobs, int maxnrpos )
+{
+    while ( !atend_ && jobs.size()<maxnrpos )
+    {
+	auto* job = new GatherJob;
+	job->pos_ = curpos_;
+	for ( const auto& relbid : relbids_ )
+	{
+	    const BinID inputbid( curpos_.inl()+relbid.inl()*step_.inl(),
+				  curpos_.crl()+relbid.crl()*step_.crl() );
+	    Gather* gather = getGather( inputbid );
+	    if ( !gather )
+		continue;
+
+	    job->relbids_ += relbid;
+	    job->inputs_ += gather;
+	}
+
+	jobs += job;
+	atend_ = !nextPosition();
+	if ( !atend_ )
+	    removeObsolete();
+    }
+}
+
+
+Gather* GatherPrefetcher::getGather( const BinID& inputbid )
+{
+    const int bufidx = bids_.indexOf( inputbid );
+    if ( bufidx!=-1 )
+	return gathers_[bufidx];
+
+    RefMan<Gather> gather = sparegather_;
+    sparegather_ = nullptr;
+    if ( !gather )
+	gather = new Gather;
+
+    if ( reader_ )
+    {
+	TrcKey tk;
+	if ( reader_->is3D() )
+	    tk.setPosition( inputbid );
+	else
+	    tk.setGeomID( reader_->geomID() ).setTrcNr( inputbid.trcNr() );
+
+	if ( !gather->readFrom(*ioobj_,*reader_,tk) )
+	{
+	    sparegather_ = gather;
+	    gather = nullptr;
+	}
+    }
+
+    bids_ += inputbid;
+    gathers_ += gather.ptr();
+    if ( gather )
+	DPM( DataPackMgr::FlatID() ).add( gather );
+
+    return gather.ptr();
+}
+
+
+bool GatherPrefetcher::nextPosition()
+{
+    if ( hiter_ )
+	return hiter_->next( curpos_ );
+
+    curpos_.crl() += cdprange_.step_;
+    return cdprange_.includes( curpos_.crl(), true );
+}
+
+
+void GatherPrefetcher::removeObsolete()
+{
+    // The jobs keep their own references to the gathers
+    const bool is3d = hiter_ != nullptr;
+    const int obsolete = is3d
+		? curpos_.inl() - (stepout_.inl()+1)*step_.inl()
+		: curpos_.crl() - (stepout_.crl()+1)*cdprange_.step_;
+    for ( int idx=bids_.size()-1; idx>=0; idx-- )
+    {
+	if ( (is3d ? bids_[idx].inl() : bids_[idx].crl()) <= obsolete )
+	{
+	    bids_.removeSingle( idx );
+	    gathers_.removeSingle( idx );
+	}
+    }
+}
+
+
+/*!\brief Processes a batch of output positions concurrently. Each thread runs
+  its own copy of the processing chain, as the processors keep the state of
+  the position they work on. */
+
+class GatherBatchProcessor : public ParallelTask
+{ mODTextTranslationClass(GatherBatchProcessor)
+public:
+			GatherBatchProcessor(const ProcessManager&,
+					     int nrthreads);
+
+    bool		isOK() const		{ return !procmans_.isEmpty(); }
+    uiString		errMsg() const		{ return errmsg_; }
+
+    void		setJobs( ObjectSet<GatherJob>& jobs )
+			{ jobs_ = &jobs; success_ = false; }
+    void		processCB(CallBacker*);
+    bool		succeeded() const	{ return success_; }
+
+protected:
+
+    od_int64		nrIterations() const override
+			{ return jobs_ ? jobs_->size() : 0; }
+    int			maxNrThreads() const override
+			{ return procmans_.size(); }
+    int			minThreadSize() const override	{ return 1; }
+    bool		doWork(od_int64,od_int64,int) override;
+
+    ManagedObjectSet<ProcessManager> procmans_;
+    ObjectSet<GatherJob>* jobs_			= nullptr;
+    bool		needpsinput_;
+    bool		success_		= false;
+    uiString		errmsg_;
+};
+
+
+GatherBatchProcessor::GatherBatchProcessor( const ProcessManager& procman,
+					    int nrthreads )
+    : needpsinput_(procman.needsPreStackInput())
+{
+    IOPar par;
+    procman.fillPar( par );
+    for ( int idx=0; idx<nrthreads; idx++ )
+    {
+	auto* copy = new ProcessManager( procman.getGeomSystem() );
+	if ( !copy->usePar(par) )
+	{
+	    errmsg_ = copy->errMsg();
+	    delete copy;
+	    break;
+	}
+
+	procmans_ += copy;
+    }
+}
+
+
+void GatherBatchProcessor::processCB( CallBacker* )
+{
+    success_ = execute();
+}
+
+
+bool GatherBatchProcessor::doWork( od_int64 start, od_int64 stop,
+				   int threadidx )
+{
+    ProcessManager& procman = *procmans_[threadidx];
+    for ( int idx=mCast(int,start); idx<=stop; idx++ )
+    {
+	GatherJob& job = *(*jobs_)[idx];
+	job.output_ = nullptr;
+	if ( job.inputs_.isEmpty() )
+	    continue;
+
+	procman.reset( false );
+	if ( !procman.prepareWork() )
+	    return false;
+
+	for ( int iinp=0; iinp<job.inputs_.size(); iinp++ )
+	    procman.setInput( job.relbids_[iinp], job.inputs_.get(iinp) );
+
+	if ( !needpsinput_ )
+	    procman.getProcessor(0)->retainCurBID( job.pos_ );
+
+	if ( procman.process() )
+	    job.output_ = procman.getOutput();
+    }
+
+    return true;
+}
+
+} // namespace PreStack
+
+
+static bool writeGather( SeisPSWriter& writer, const Gather& gather,
+			 const BinID& pos, const SeisPS2DReader* reader2d,
+			 bool needpsinput )
+{
+    const int nrtraces = gather.size( !Gather::offsetDim() );
+    const int nrsamples = gather.size( Gather::offsetDim() );
+    const StepInterval<double> zrg =
+		gather.posData().range( Gather::offsetDim() );
+    SeisTrc trc( nrsamples );
+    trc.info().sampling_.start_ = (float) zrg.start_;
+    trc.info().sampling_.step_ = (float) zrg.step_;
+
+    if ( reader2d )
+    {
+	trc.info().setGeomID( reader2d->geomID() )
+		  .setTrcNr( pos.trcNr() );
+    }
+    else
+	trc.info().setPos( pos );
+
+    trc.info().calcCoord();
+
+    for ( int idx=0; idx<nrtraces; idx++ )
+    {
+	if ( needpsinput )
+	    trc.info().azimuth_ = gather.getAzimuth( idx );
+	trc.info().offset_ = gather.getOffset( idx );
+	for ( int idy=0; idy<nrsamples; idy++ )
+	    trc.set( idy, gather.data().get( idx, idy ), 0 );
+
+	if ( !writer.put( trc ) )
+	    return false;
+    }
+
+    return true;
+}
+
+
 mLoad1Module("PreStackProcessing")
 
 bool BatchProgram::doWork( od_ostream& strm )
@@ -221,16 +521,39 @@ bool BatchProgram::doWork( od_ostream& strm )
 	step.crl() = SI().crlRange(true).step_;
     }
 
-    mSetCommState(Working);
+    procman->reset( false );
+    if ( !procman->prepareWork() )
+    {
+	mRetError("\nCannot prepare processing.");
+    }
 
-    RefObjectSet<Gather> gathers;
-    gathers.setNullAllowed();
-    TypeSet<BinID> bids;
+    int nrparallel = Threads::getNrProcessors();
+    pars().get( ProcessManager::sKeyNrParallelGathers(), nrparallel );
+    if ( nrparallel < 1 )
+	nrparallel = 1;
 
-    while ( true )
+    PtrMan<GatherBatchProcessor> batchproc =
+			new GatherBatchProcessor( *procman, nrparallel );
+    if ( !batchproc->isOK() )
     {
-	bool paused = false;
+	mRetError( batchproc->errMsg() );
+    }
 
+    GatherPrefetcher prefetcher( *procman, curbid, step, reader,
+				 inputioobj.ptr() );
+    if ( geomtype==Seis::VolPS )
+	prefetcher.setIterator( hiter );
+    else
+	prefetcher.setCDPRange( cdprange );
+
+    mSetCommState(Working);
+
+    const int batchsize = nrparallel>1 ? 4*nrparallel : 1;
+    ManagedObjectSet<GatherJob> curjobs, nextjobs;
+    prefetcher.fillBatch( curjobs, batchsize );
+    bool paused = false;
+    while ( !curjobs.isEmpty() )
+    {
 	if ( pauseRequested() )
 	{
 	    paused = true;
@@ -246,170 +569,49 @@ bool BatchProgram::doWork( od_ostream& strm )
 	    setResumed();
 	}
 
-	procman->reset( false );
-	BinID relbid;
-
-	if ( !procman->prepareWork() )
+	batchproc->setJobs( curjobs );
+	if ( nrparallel > 1 )
 	{
-	    mRetError("\nCannot prepare processing.");
+	    // Read the gathers of the next batch while this one is processed
+	    Threads::Thread procthread(
+			mCB(batchproc.ptr(),GatherBatchProcessor,processCB),
+			"Gather processing" );
+	    prefetcher.fillBatch( nextjobs, batchsize );
+	    procthread.waitForFinish();
 	}
-
-	const BinID stepout = procman->getInputStepout();
-
-	int nrfound = 0;
-	RefMan<Gather> sparegather;
-	for ( relbid.inl()=-stepout.inl(); relbid.inl()<=stepout.inl();
-					   relbid.inl()++ )
+	else
 	{
-	    for ( relbid.crl()=-stepout.crl(); relbid.crl()<=stepout.crl();
-					       relbid.crl()++)
-	    {
-		if ( !procman->wantsInput(relbid) )
-		    continue;
-
-		const BinID inputbid( curbid.inl()+relbid.inl()*step.inl(),
-				      curbid.crl()+relbid.crl()*step.crl() );
-
-		RefMan<Gather> gather;
-		const int bufidx = bids.indexOf( inputbid );
-		if ( bufidx!=-1 )
-		{
-		    gather = gathers[bufidx];
-		}
-		else
-		{
-		    if ( sparegather )
-		    {
-			gather = sparegather;
-			sparegather = nullptr;
-		    }
-		    else
-		    {
-			gather = new Gather;
-		    }
-
-		    TrcKey tk;
-		    if ( reader3d )
-			tk.setPosition( inputbid );
-		    else if ( reader2d )
-		    {
-			tk.setGeomID( reader2d->geomID() )
-			  .setTrcNr( inputbid.trcNr() );
-		    }
-
-		    if ( procman->needsPreStackInput() &&
-			 !gather->readFrom(*inputioobj,*reader,tk) )
-		    {
-			sparegather = gather;
-			gather = nullptr;
-		    }
-
-		    bids += inputbid;
-		    gathers += gather.ptr();
-		    DPM( DataPackMgr::FlatID() ).add( gather );
-		}
-
-		if ( !gather )
-		    continue;
-
-		nrfound ++;
-
-		procman->setInput( relbid, gather->id() );
-	    }
+	    batchproc->processCB( nullptr );
+	    prefetcher.fillBatch( nextjobs, batchsize );
 	}
 
-	sparegather = nullptr;
-
-	if ( !needpsinput )
-	    procman->getProcessor(0)->retainCurBID( curbid );
-
-	if ( nrfound && procman->process() )
+	if ( !batchproc->succeeded() )
 	{
-	    auto gather = DPM(DataPackMgr::FlatID()).get<Gather>(
-						    procman->getOutputID() );
-	    if ( gather )
-	    {
-		const int nrtraces =
-		    gather->size( !Gather::offsetDim() );
-		const int nrsamples =
-		    gather->size( Gather::offsetDim() );
-		const StepInterval<double> zrg =
-		    gather->posData().range( Gather::offsetDim() );
-		SeisTrc trc( nrsamples );
-		trc.info().sampling_.start_ = (float) zrg.start_;
-		trc.info().sampling_.step_ = (float) zrg.step_;
-
-		if ( reader2d )
-		{
-		    trc.info().setGeomID( reader2d->geomID() )
-			      .setTrcNr( curbid.trcNr() );
-		}
-		else
-		    trc.info().setPos( curbid );
-
-		trc.info().calcCoord();
-
-		for ( int idx=0; idx<nrtraces; idx++ )
-		{
-		    if ( needpsinput )
-			trc.info().azimuth_ = gather->getAzimuth( idx );
-		    trc.info().offset_ = gather->getOffset( idx );
-		    for ( int idy=0; idy<nrsamples; idy++ )
-			trc.set( idy, gather->data().get( idx, idy ), 0 );
-
-		    if ( !writer->put( trc ) )
-		    {
-			mRetError("\nCannot write output");
-		    }
-		}
-	    }
-
-	    ++progressmeter;
+	    mRetError("\nCannot prepare processing.");
 	}
 
-
-	if ( geomtype==Seis::VolPS )
+	for ( const auto* job : curjobs )
 	{
-	    const int prevline = curbid.inl();
-	    if ( !hiter.next(curbid) )
-		break;
+	    if ( !job->output_ )
+		continue;
 
-	    if ( prevline!=curbid.inl() )
-	    {
-		const int obsoleteline =
-		    curbid.inl() - (stepout.inl()+1)*step.inl();
-		for ( int idx=bids.size()-1; idx>=0; idx-- )
-		{
-		    if ( bids[idx].inl()<=obsoleteline )
-		    {
-			bids.removeSingle( idx );
-			gathers.removeSingle( idx );
-		    }
-		}
-	    }
-	}
-	else
-	{
-	    curbid.crl() += cdprange.step_;
-	    if ( !cdprange.includes( curbid.crl(), true ) )
-		break;
-	    const int obsoletetrace =
-		    curbid.crl() -(stepout.crl()+1)*cdprange.step_;
-	    for ( int idx=bids.size()-1; idx>=0; idx-- )
+	    if ( !writeGather(*writer,*job->output_,job->pos_,reader2d.ptr(),
+			      needpsinput) )
 	    {
-		if ( bids[idx].crl()<=obsoletetrace )
-		{
-		    bids.removeSingle( idx );
-		    gathers.removeSingle( idx );
-		}
+		mRetError("\nCannot write output");
 	    }
+
+	    ++progressmeter;
 	}
+
+	curjobs.erase();
+	while ( !nextjobs.isEmpty() )
+	    curjobs += nextjobs.removeAndTake( 0 );
     }
 
     // It is VERY important workers are destroyed BEFORE the last sendState!!!
     deleteAndNullPtr( procman );
     writer = nullptr;
-    gathers.setEmpty();
 
     progressmeter.setFinished();
     mMessage( "Threads closed; Writing finish status" );
@@ -0,0 +1,62 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "executor.h"
+#include "ioman.h"
+#include "ioobj.h"
+#include "iopar.h"
+#include "keystrs.h"
+#include "moddepmgr.h"
+#include "prestackvelocityscan.h"
+#include "ptrman.h"
+#include "trckeysampling.h"
+
+using namespace PreStack;
+
+#define mErrRet(msg) { strm << msg << od_endl; return false; }
+
+mLoad1Module("PreStackProcessing")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    MultiID inpid, outid;
+    if ( !pars().get(sKey::Input(),inpid) )
+	mErrRet("No input prestack data store specified")
+    if ( !pars().get(sKey::Output(),outid) )
+	mErrRet("No output volume specified")
+
+    PtrMan<IOObj> inpioobj = IOM().get( inpid );
+    PtrMan<IOObj> outioobj = IOM().get( outid );
+    if ( !inpioobj || !outioobj )
+	mErrRet("Cannot find the input or the output in the database")
+
+    VelocityScanner scanner;
+    if ( !scanner.usePar(pars()) )
+	mErrRet("Invalid velocity range")
+
+    TrcKeySampling tks( true );
+    PtrMan<IOPar> subselpar = pars().subselect( sKey::Subsel() );
+    if ( subselpar )
+	tks.usePar( *subselpar );
+
+    VelocityScanVolume scanvol( scanner, *inpioobj, *outioobj, tks );
+    if ( !scanvol.isOK() )
+	mErrRet(scanvol.uiMessage().getString())
+
+    strm << "Computing the semblance of " << scanner.nrVelocities()
+	 << " velocities at " << tks.totalNr() << " positions" << od_endl;
+    TextTaskRunner taskrunner( strm );
+    if ( !taskrunner.execute(scanvol) )
+	mErrRet(scanvol.uiMessage().getString())
+
+    strm << "Finished" << od_endl;
+    return true;
+}
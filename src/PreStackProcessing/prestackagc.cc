@@ -10,7 +10,6 @@ ________________________________________________________________________
 #include "prestackagc.h"
 
 #include "agc.h"
-#include "arrayndslice.h"
 #include "flatposdata.h"
 #include "iopar.h"
 #include "prestackgather.h"
@@ -22,6 +21,7 @@ namespace PreStack
 
 const char* AGC::sKeyWindow()		{ return "Window"; }
 const char* AGC::sKeyMuteFraction()	{ return "Mutefraction"; }
+const char* AGC::sKeyIgnoreZeros()	{ return "Ignore zeros"; }
 
 AGC::AGC()
     : Processor(sFactoryKeyword())
@@ -73,11 +73,18 @@ void AGC::setLowEnergyMute( float iv )
 float AGC::getLowEnergyMute() const
 { return mutefraction_; }
 
+void AGC::setIgnoreZeros( bool yn )
+{ ignorezeros_ = yn; }
+
+bool AGC::ignoreZeros() const
+{ return ignorezeros_; }
+
 
 void AGC::fillPar( IOPar& par ) const
 {
     par.set( sKeyWindow(), window_ );
     par.set( sKeyMuteFraction(), mutefraction_ );
+    par.setYN( sKeyIgnoreZeros(), ignorezeros_ );
 }
 
 
@@ -85,16 +92,14 @@ bool AGC::usePar( const IOPar& par )
 {
     par.get( sKeyWindow(), window_ );
     par.get( sKeyMuteFraction(), mutefraction_ );
+    ignorezeros_ = false;
+    par.getYN( sKeyIgnoreZeros(), ignorezeros_ );
     return true;
 }
 
 
 bool AGC::doWork( od_int64 start, od_int64 stop, int )
 {
-    ::AGC<float> agc;
-    agc.setMuteFraction( mutefraction_ );
-    agc.setSampleGate( samplewindow_ );
-
     const int incr = mCast( int, stop-start+1 );
     for ( int idx=outputs_.size()-1; idx>=0; idx--, addToNrDone(incr) )
     {
@@ -103,25 +108,45 @@ bool AGC::doWork( od_int64 start, od_int64 stop, int )
 	if ( !output || !input )
 	    continue;
 
-	Array1DSlice<float> inputtrace( input->data() );
-	inputtrace.setDimMap( 0, Gather::zDim() );
+	const Array2D<float>& inparr = input->data();
+	Array2D<float>& outarr = output->data();
+	const int nrz = inparr.getSize( Gather::zDim() );
+	if ( nrz<1 || outarr.getSize(Gather::zDim())!=nrz )
+	    continue;
 
-	Array1DSlice<float> outputtrace( output->data() );
-	outputtrace.setDimMap( 0, Gather::zDim() );
+	// Traces are rows of the arrays: use them in place when possible
+	const float* inpdata = inparr.getData();
+	float* outdata = outarr.getData();
+	mAllocLargeVarLenArr( float, workbuf, 2*nrz );
+	mAllocLargeVarLenArr( float, inptrc, inpdata ? 0 : nrz );
+	mAllocLargeVarLenArr( float, outtrc, outdata ? 0 : nrz );
+	if ( !mIsVarLenArrOK(workbuf) ||
+	     (!inpdata && !mIsVarLenArrOK(inptrc)) ||
+	     (!outdata && !mIsVarLenArrOK(outtrc)) )
+	    return false;
 
 	const int lastoffset = input->size( Gather::offsetDim()==0 ) - 1;
-
 	const int curstop = mCast( int, mMIN(lastoffset,stop) );
 	for ( int offsetidx=mCast(int,start); offsetidx<=curstop; offsetidx++ )
 	{
-	    inputtrace.setPos( Gather::offsetDim(), offsetidx );
-	    outputtrace.setPos( Gather::offsetDim(), offsetidx );
-	    if ( !inputtrace.init() || !outputtrace.init() )
-		continue;
-
-	    agc.setInput( inputtrace, inputtrace.info().getSize(0) );
-	    agc.setOutput( outputtrace );
-	    agc.executeParallel( false );
+	    const float* inp = inpdata ? inpdata + od_int64(offsetidx)*nrz
+				       : mVarLenArr(inptrc);
+	    float* outp = outdata ? outdata + od_int64(offsetidx)*nrz
+				  : mVarLenArr(outtrc);
+	    if ( !inpdata )
+	    {
+		for ( int iz=0; iz<nrz; iz++ )
+		    inptrc[iz] = inparr.get( offsetidx, iz );
+	    }
+
+	    ::AGC<float>::applyToTrace( inp, outp, nrz, samplewindow_,
+					mutefraction_, ignorezeros_,
+					mVarLenArr(workbuf) );
+	    if ( !outdata )
+	    {
+		for ( int iz=0; iz<nrz; iz++ )
+		    outarr.set( offsetidx, iz, outtrc[iz] );
+	    }
 	}
     }
 
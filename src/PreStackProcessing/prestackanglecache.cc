@@ -0,0 +1,361 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackanglecache.h"
+
+#include "ailayer.h"
+#include "iopar.h"
+#include "raytracerrunner.h"
+#include "settings.h"
+
+
+namespace PreStack
+{
+
+static const od_uint64 cHashSeed = 14695981039346656037ULL;
+
+static inline void addToHash( od_uint64& hash, od_int64 val )
+{
+    // FNV-1a, one byte at a time
+    for ( int idx=0; idx<8; idx++ )
+    {
+	hash ^= od_uint64( (val >> (8*idx)) & 0xff );
+	hash *= 1099511628211ULL;
+    }
+}
+
+
+static inline void addToHash( od_uint64& hash, const char* str )
+{
+    for ( ; str && *str; str++ )
+    {
+	hash ^= od_uint64( (unsigned char)(*str) );
+	hash *= 1099511628211ULL;
+    }
+}
+
+
+static inline od_int64 quantized( double val, float quantum )
+{
+    if ( mIsUdf(val) )
+	return mUdf(od_int64);
+
+    if ( quantum <= 0.f )
+    {
+	const float fval = float( val );
+	od_int32 bits;
+	OD::memCopy( &bits, &fval, sizeof(bits) );
+	return bits;
+    }
+
+    return mRounded( od_int64, val / quantum );
+}
+
+
+AngleModelCache& AMC()
+{
+    mDefineStaticLocalObject(PtrMan<AngleModelCache>,amc,
+			     = new AngleModelCache() );
+    return *amc;
+}
+
+
+AngleModelCache::AngleModelCache()
+{
+    models_.setNullAllowed( false );
+    Settings::common().get( sKeyMaxNrModels(), maxnrmodels_ );
+}
+
+
+AngleModelCache::~AngleModelCache()
+{
+}
+
+
+const char* AngleModelCache::sKeyMaxNrModels()
+{
+    return "dTect.Angle model cache.Max nr models";
+}
+
+
+void AngleModelCache::setQuanta( float thickness, float vel, float den )
+{
+    Threads::Locker locker( lock_ );
+    thicknessquantum_ = thickness;
+    velquantum_ = vel;
+    denquantum_ = den;
+    removeAll();
+}
+
+
+void AngleModelCache::setMaxNrModels( int nr )
+{
+    Threads::Locker locker( lock_ );
+    maxnrmodels_ = nr;
+    limitSize();
+}
+
+
+int AngleModelCache::nrModels() const
+{
+    Threads::Locker locker( lock_ );
+    return models_.size();
+}
+
+
+void AngleModelCache::clear()
+{
+    Threads::Locker locker( lock_ );
+    removeAll();
+}
+
+
+void AngleModelCache::removeAll()
+{
+    keys_.erase();
+    emodels_.erase();
+    parsstrs_.erase();
+    models_.erase();
+    stamps_.erase();
+}
+
+
+BufferString AngleModelCache::getParsString( const TypeSet<float>& offsets,
+					     Seis::OffsetType offstyp,
+					     const IOPar& raypars,
+					     const RayTracer1D::Setup& rtsu )
+{
+    IOPar par( raypars );
+    par.removeWithKey( RayTracer1D::sKeyOffset() );
+    par.removeWithKey( RayTracer1D::sKeyOffsetInFeet() );
+    rtsu.fillPar( par );
+    BufferString res;
+    par.putTo( res );
+    res.add( " " ).add( od_int64(offstyp) );
+    for ( const auto& offset : offsets )
+	res.add( " " ).add( quantized(offset,0.f) );
+
+    return res;
+}
+
+
+od_uint64 AngleModelCache::getKey( const ElasticModel& emodel,
+				   od_uint64 parskey ) const
+{
+    od_uint64 hash = parskey;
+    addToHash( hash, quantized(emodel.aboveThickness(),thicknessquantum_) );
+    addToHash( hash, quantized(emodel.startTime(),0.f) );
+    addToHash( hash, od_int64(emodel.size()) );
+    for ( const auto* layer : emodel )
+    {
+	addToHash( hash, od_int64(layer->getType()) );
+	addToHash( hash, quantized(layer->getThickness(),thicknessquantum_) );
+	addToHash( hash, quantized(layer->getPVel(),velquantum_) );
+	addToHash( hash, quantized(layer->getSVel(),velquantum_) );
+	addToHash( hash, quantized(layer->getDen(),denquantum_) );
+	if ( layer->isVTI() )
+	    addToHash( hash, quantized(layer->getFracRho(),0.f) );
+	if ( layer->isHTI() )
+	    addToHash( hash, quantized(layer->getFracAzi(),0.f) );
+    }
+
+    return hash;
+}
+
+
+bool AngleModelCache::isSame( const ElasticModel& em1,
+			      const ElasticModel& em2 ) const
+{
+#define mIsSame( val1, val2, quantum ) \
+    (quantized(val1,quantum) == quantized(val2,quantum))
+
+    if ( em1.size() != em2.size() ||
+	 !mIsSame(em1.aboveThickness(),em2.aboveThickness(),thicknessquantum_)
+	 || !mIsSame(em1.startTime(),em2.startTime(),0.f) )
+	return false;
+
+    for ( int idx=0; idx<em1.size(); idx++ )
+    {
+	const RefLayer& lay1 = *em1.get( idx );
+	const RefLayer& lay2 = *em2.get( idx );
+	if ( lay1.getType() != lay2.getType() ||
+	     !mIsSame(lay1.getThickness(),lay2.getThickness(),
+		      thicknessquantum_) ||
+	     !mIsSame(lay1.getPVel(),lay2.getPVel(),velquantum_) ||
+	     !mIsSame(lay1.getSVel(),lay2.getSVel(),velquantum_) ||
+	     !mIsSame(lay1.getDen(),lay2.getDen(),denquantum_) ||
+	     (lay1.isVTI() &&
+	      !mIsSame(lay1.getFracRho(),lay2.getFracRho(),0.f)) ||
+	     (lay1.isHTI() &&
+	      !mIsSame(lay1.getFracAzi(),lay2.getFracAzi(),0.f)) )
+	    return false;
+    }
+
+#undef mIsSame
+    return true;
+}
+
+
+int AngleModelCache::indexOf( od_uint64 key, const ElasticModel& emodel,
+			      const char* parsstr ) const
+{
+    // The hash only preselects: the model itself must match too
+    for ( int idx=0; idx<keys_.size(); idx++ )
+    {
+	if ( keys_[idx] == key && parsstrs_.get(idx) == parsstr &&
+	     isSame(*emodels_.get(idx),emodel) )
+	    return idx;
+    }
+
+    return -1;
+}
+
+
+void AngleModelCache::limitSize()
+{
+    while ( models_.size() > maxnrmodels_ && !models_.isEmpty() )
+    {
+	int oldestidx = 0;
+	for ( int idx=1; idx<stamps_.size(); idx++ )
+	{
+	    if ( stamps_[idx] < stamps_[oldestidx] )
+		oldestidx = idx;
+	}
+
+	keys_.removeSingle( oldestidx );
+	emodels_.removeSingle( oldestidx );
+	parsstrs_.removeSingle( oldestidx );
+	models_.removeSingle( oldestidx );
+	stamps_.removeSingle( oldestidx );
+    }
+}
+
+
+bool AngleModelCache::getRefModels( const ObjectSet<const ElasticModel>& ems,
+				    const TypeSet<float>& offsets,
+				    Seis::OffsetType offstyp,
+				    const IOPar& raypars,
+				    const RayTracer1D::Setup& rtsu,
+			RefObjectSet<const OffsetReflectivityModel>& refmodels,
+				    uiString& errmsg, bool parallel )
+{
+    refmodels.erase();
+    refmodels.setNullAllowed( true );
+    const BufferString parsstr = getParsString( offsets, offstyp, raypars,
+						rtsu );
+    od_uint64 parskey = cHashSeed;
+    addToHash( parskey, parsstr.buf() );
+    TypeSet<od_uint64> keys;
+    TypeSet<int> todoidxs;
+    ElasticModelSet todo;
+    Threads::Locker locker( lock_ );
+    for ( int idx=0; idx<ems.size(); idx++ )
+    {
+	const od_uint64 key = getKey( *ems.get(idx), parskey );
+	keys += key;
+	const int cacheidx = indexOf( key, *ems.get(idx), parsstr );
+	if ( cacheidx >= 0 )
+	{
+	    refmodels.add( models_.get(cacheidx) );
+	    stamps_[cacheidx] = curstamp_++;
+	    continue;
+	}
+
+	refmodels.add( nullptr );
+	// Models with the same key within the set are traced once
+	bool found = false;
+	for ( const auto& todoidx : todoidxs )
+	{
+	    if ( keys[todoidx] == key &&
+		 isSame(*ems.get(todoidx),*ems.get(idx)) )
+		{ found = true; break; }
+	}
+
+	if ( !found )
+	{
+	    todoidxs += idx;
+	    todo.add( new ElasticModel(*ems.get(idx)) );
+	}
+    }
+    locker.unlockNow();
+
+    if ( todo.isEmpty() )
+	return true;
+
+    RayTracerRunner rtrunner( raypars );
+    rtrunner.setOffsets( offsets, offstyp );
+    if ( !rtrunner.setModel(todo,&rtsu) ||
+	 !rtrunner.executeParallel(parallel) )
+    {
+	errmsg = rtrunner.uiMessage();
+	return false;
+    }
+
+    ConstRefMan<ReflectivityModelSet> rtmodels = rtrunner.getRefModels();
+    if ( !rtmodels || rtmodels->nrModels() != todo.size() )
+    {
+	errmsg = tr("Cannot compute the ray traced models");
+	return false;
+    }
+
+    locker.reLock();
+    for ( int itodo=0; itodo<todoidxs.size(); itodo++ )
+    {
+	mDynamicCastGet(const OffsetReflectivityModel*,refmodel,
+			rtmodels->get(itodo));
+	if ( !refmodel )
+	{
+	    errmsg = tr("Cannot compute the ray traced models");
+	    return false;
+	}
+
+	const int todoidx = todoidxs[itodo];
+	const od_uint64 key = keys[todoidx];
+	const ElasticModel& emodel = *ems.get( todoidx );
+	for ( int idx=todoidx; idx<keys.size(); idx++ )
+	{
+	    if ( !refmodels.get(idx) && keys[idx] == key &&
+		 isSame(*ems.get(idx),emodel) )
+		refmodels.replace( idx, refmodel );
+	}
+
+	if ( indexOf(key,emodel,parsstr) >= 0 || maxnrmodels_ < 1 )
+	    continue;
+
+	keys_ += key;
+	emodels_.add( new ElasticModel(emodel) );
+	parsstrs_.add( parsstr );
+	models_.add( refmodel );
+	stamps_ += curstamp_++;
+    }
+
+    limitSize();
+    return true;
+}
+
+
+ConstRefMan<OffsetReflectivityModel> AngleModelCache::getRefModel(
+				    const ElasticModel& emodel,
+				    const TypeSet<float>& offsets,
+				    Seis::OffsetType offstyp,
+				    const IOPar& raypars,
+				    const RayTracer1D::Setup& rtsu,
+				    uiString& errmsg, bool parallel )
+{
+    ObjectSet<const ElasticModel> ems;
+    ems.add( &emodel );
+    RefObjectSet<const OffsetReflectivityModel> refmodels;
+    if ( !getRefModels(ems,offsets,offstyp,raypars,rtsu,refmodels,errmsg,
+		       parallel) || refmodels.isEmpty() )
+	return nullptr;
+
+    return refmodels.get( 0 );
+}
+
+} // namespace PreStack
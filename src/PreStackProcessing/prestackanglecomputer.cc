@@ -14,6 +14,7 @@ ________________________________________________________________________
 #include "fftfilter.h"
 #include "keystrs.h"
 #include "mathfunc.h"
+#include "prestackanglecache.h"
 #include "prestackgather.h"
 #include "raytrace1d.h"
 #include "reflectivitymodel.h"
@@ -433,28 +434,15 @@ RefMan<Gather> AngleComputer::computeAngleData()
 	    return nullptr;
 	}
 
-	PtrMan<RayTracer1D> raytracer =
-		     RayTracer1D::createInstance( raypars_, errmsg_, &rtsu_ );
-	if ( !raytracer || !errmsg_.isEmpty() )
-	    return nullptr;
-
-	raytracer->setup().doreflectivity( false );
-
+	RayTracer1D::Setup rtsu( rtsu_ );
+	rtsu.doreflectivity( false );
 	TypeSet<float> offsets;
 	outputsampling_.getPositions( true, offsets );
-	raytracer->setOffsets( offsets, gather->offsetType() );
-	if ( !raytracer->setModel(*emodel) || !raytracer->execute() )
-	{
-	    errmsg_ = raytracer->uiMessage();
-	    return nullptr;
-	}
-
-	ConstRefMan<OffsetReflectivityModel> refmodel =raytracer->getRefModel();
+	ConstRefMan<OffsetReflectivityModel> refmodel =
+		AMC().getRefModel( *emodel, offsets, gather->offsetType(),
+				   raypars_, rtsu, errmsg_ );
 	if ( !refmodel )
-	{
-	    errmsg_ = raytracer->uiMessage();
 	    return nullptr;
-	}
 
 	setRefModel( *refmodel.ptr() );
     }
@@ -12,10 +12,10 @@ ________________________________________________________________________
 #include "arrayndslice.h"
 #include "ioman.h"
 #include "muter.h"
+#include "prestackanglecache.h"
 #include "prestackanglecomputer.h"
 #include "prestackgather.h"
 #include "prestackmute.h"
-#include "raytracerrunner.h"
 #include "unitofmeasure.h"
 
 
@@ -95,7 +95,6 @@ AngleMuteBase::AngleMuteBase()
 AngleMuteBase::~AngleMuteBase()
 {
     delete params_;
-    deepErase( rtrunners_ );
 }
 
 
@@ -317,7 +316,6 @@ Muter* AngleMute::getMuter( int idx )
 
 bool AngleMute::doPrepare( int nrthreads )
 {
-    deepErase( rtrunners_ );
     deepErase( muters_ );
 
     if ( !::isSynthetic(gs_) && !setVelocityFunction() )
@@ -325,10 +323,7 @@ bool AngleMute::doPrepare( int nrthreads )
 
     raytraceparallel_ = nrthreads < Threads::getNrProcessors();
     for ( int idx=0; idx<nrthreads; idx++ )
-    {
 	muters_ += new Muter( params().taperlen_, params().tail_ );
-	rtrunners_ += new RayTracerRunner( params().raypar_ );
-    }
 
     return true;
 }
@@ -356,40 +351,34 @@ void AngleMute::fillPar( IOPar& par ) const
 
 bool AngleMute::doWork( od_int64 start, od_int64 stop, int thread )
 {
-    if ( !rtrunners_.validIdx(thread) )
-	return false;
-
-    RayTracerRunner* rtrunner = rtrunners_[thread];
     Muter* muter = getMuter( thread );
-    if ( !rtrunner || !muter )
+    if ( !muter )
 	return false;
 
-    const RayTracer1D::Setup& rtsu = params().rtsu_;
-    const bool innermute = params().tail_;
-
+    // Consecutive gathers with the same offsets are ray traced together
     ElasticModelSet emodels;
-    auto* layers = new ElasticModel();
-    emodels.add( layers );
-    bool nonemuted = false;
-    bool allmuted = false;
-    TypeSet<float> offsets;
-    offsets.setCapacity( 100, true );
-    for ( int idx=mCast(int,start); idx<=stop; idx++, addToNrDone(1) )
+    ObjectSet<const ElasticModel> batch;
+    TypeSet<int> batchidxs;
+    TypeSet<float> batchoffsets, offsets;
+    Seis::OffsetType batchoffstyp = Seis::OffsetType::OffsetMeter;
+    for ( int idx=mCast(int,start); idx<=stop; idx++ )
     {
 	const Gather* input = inputs_[idx];
 	Gather* output = outputs_[idx];
 	if ( !input || !output )
-	    continue;
+	    { addToNrDone( 1 ); continue; }
 
 	const int nroffsets = input->size( Gather::offsetDim()==0 );
 	offsets.setEmpty();
 	for ( int ioff=0; ioff<nroffsets; ioff++ )
 	    offsets += input->getOffset( ioff );
 
+	auto* layers = new ElasticModel();
+	emodels.add( layers );
 	if ( ::isSynthetic(gs_) )
 	{
 	    if ( !models_.validIdx(idx) || !models_.get(idx) )
-		continue;
+		{ addToNrDone( 1 ); continue; }
 
 	    *layers = *models_.get( idx );
 	    block( *layers );
@@ -397,92 +386,137 @@ bool AngleMute::doWork( od_int64 start, od_int64 stop, int thread )
 	else
 	{
 	    const TrcKey& tk = input->getTrcKey();
-	    layers->setEmpty();
 	    if ( !getLayers(tk,*layers,errmsg_) )
-		continue;
+		{ addToNrDone( 1 ); continue; }
+	}
+
+	if ( !batch.isEmpty() &&
+	     (offsets != batchoffsets || input->offsetType() != batchoffstyp) )
+	{
+	    if ( !muteBatch(batchidxs,batch,batchoffsets,batchoffstyp,*muter) )
+		return false;
+
+	    batch.erase();
+	    batchidxs.erase();
+	}
+
+	if ( batch.isEmpty() )
+	{
+	    batchoffsets = offsets;
+	    batchoffstyp = input->offsetType();
 	}
 
-	rtrunner->setModel( emodels, &rtsu );
-	rtrunner->setOffsets( offsets, input->offsetType() );
-	if ( !rtrunner->executeParallel(raytraceparallel_) )
-	    { errmsg_ = rtrunner->uiMessage(); continue; }
+	batch.add( layers );
+	batchidxs += idx;
+    }
+
+    return batch.isEmpty() ||
+	   muteBatch( batchidxs, batch, batchoffsets, batchoffstyp, *muter );
+}
+
+
+bool AngleMute::muteBatch( const TypeSet<int>& idxs,
+			   const ObjectSet<const ElasticModel>& emodels,
+			   const TypeSet<float>& offsets,
+			   Seis::OffsetType offstyp, Muter& muter )
+{
+    RefObjectSet<const OffsetReflectivityModel> refmodels;
+    if ( !AMC().getRefModels(emodels,offsets,offstyp,params().raypar_,
+			     params().rtsu_,refmodels,errmsg_,
+			     raytraceparallel_) )
+    {
+	addToNrDone( idxs.size() );
+	return true;
+    }
 
-	ConstRefMan<ReflectivityModelSet> refmodels = rtrunner->getRefModels();
-	const ReflectivityModelBase* refmodel = refmodels ? refmodels->get(0)
-							  : nullptr;
+    for ( int imdl=0; imdl<idxs.size(); imdl++, addToNrDone(1) )
+    {
+	const ReflectivityModelBase* refmodel = refmodels.get( imdl );
 	if ( !refmodel || !refmodel->hasAngles() )
 	    return false;
 
-	const TimeDepthModel& tdmodel = refmodel->getDefaultModel();
-	Array1DSlice<float> trace( output->data() );
-	trace.setDimMap( 0, Gather::zDim() );
+	applyMute( idxs[imdl], *refmodel, offsets, muter );
+    }
 
-	const ZSampling& zrg = input->zRange();
-	const bool zistime = input->zIsTime();
-	const int nrsamps = input->size( Gather::zDim() == 0 );
-	float zpos;
-	for ( int ioff=0; ioff<nroffsets; ioff++ )
-	{
-	    trace.setPos( Gather::offsetDim(), ioff );
-	    if ( !trace.init() )
-		continue;
+    return true;
+}
 
-	    const float offset = offsets[ioff];
-	    TypeSet< Interval<float> > mutelayeritvs;
-	    float mutelayer;
-	    if ( mIsZero(offset,1e-2f) )
-	    {
-		mutelayer = mUdf(float);
-		if ( innermute )
-		    allmuted = true;
-		else
-		    nonemuted = true;
-	    }
-	    else
-	    {
-		mutelayer = getOffsetMuteLayer( *refmodel, ioff,
-						innermute, nonemuted,
-						allmuted, mutelayeritvs );
-	    }
 
-	    if ( nonemuted )
-		continue;
+void AngleMute::applyMute( int idx, const ReflectivityModelBase& refmodel,
+			   const TypeSet<float>& offsets, Muter& muter )
+{
+    const Gather* input = inputs_[idx];
+    Gather* output = outputs_[idx];
+    const bool innermute = params().tail_;
+    const TimeDepthModel& tdmodel = refmodel.getDefaultModel();
+    Array1DSlice<float> trace( output->data() );
+    trace.setDimMap( 0, Gather::zDim() );
 
-	    if ( allmuted )
-	    {
-		for ( int idz=0; idz<nrsamps; idz++ )
-		    trace.set( idz, 0.f );
-		continue;
-	    }
+    const ZSampling& zrg = input->zRange();
+    const bool zistime = input->zIsTime();
+    const int nrsamps = input->size( Gather::zDim() == 0 );
+    bool nonemuted = false;
+    bool allmuted = false;
+    float zpos;
+    for ( int ioff=0; ioff<offsets.size(); ioff++ )
+    {
+	trace.setPos( Gather::offsetDim(), ioff );
+	if ( !trace.init() )
+	    continue;
 
-	    if ( !mIsUdf(mutelayer) )
-	    {
-		zpos = getfMutePos( tdmodel, zistime, mutelayer, offset );
-		const float muteflayer = zrg.getfIndex( zpos );
-		muter->mute( trace, nrsamps, muteflayer );
-		continue;
-	    }
+	const float offset = offsets[ioff];
+	TypeSet< Interval<float> > mutelayeritvs;
+	float mutelayer;
+	if ( mIsZero(offset,1e-2f) )
+	{
+	    mutelayer = mUdf(float);
+	    if ( innermute )
+		allmuted = true;
+	    else
+		nonemuted = true;
+	}
+	else
+	{
+	    mutelayer = getOffsetMuteLayer( refmodel, ioff,
+					    innermute, nonemuted,
+					    allmuted, mutelayeritvs );
+	}
 
-	    for ( auto& itvml : mutelayeritvs )
-	    {
-		if ( mIsUdf(itvml.start_) )
-		    continue;
+	if ( nonemuted )
+	    continue;
 
-		zpos = getfMutePos( tdmodel, zistime, itvml.start_, offset );
-		itvml.start_ = zrg.getfIndex( zpos );
-		if ( mIsUdf(itvml.stop_) )
-		    continue;
+	if ( allmuted )
+	{
+	    for ( int idz=0; idz<nrsamps; idz++ )
+		trace.set( idz, 0.f );
+	    continue;
+	}
 
-		zpos = getfMutePos( tdmodel, zistime, itvml.stop_, offset );
-		itvml.stop_ = zrg.getfIndex( zpos );
-	    }
+	if ( !mIsUdf(mutelayer) )
+	{
+	    zpos = getfMutePos( tdmodel, zistime, mutelayer, offset );
+	    const float muteflayer = zrg.getfIndex( zpos );
+	    muter.mute( trace, nrsamps, muteflayer );
+	    continue;
+	}
 
-	    if ( !mutelayeritvs.isEmpty() )
-		muter->muteIntervals( trace, nrsamps, mutelayeritvs );
+	for ( auto& itvml : mutelayeritvs )
+	{
+	    if ( mIsUdf(itvml.start_) )
+		continue;
+
+	    zpos = getfMutePos( tdmodel, zistime, itvml.start_, offset );
+	    itvml.start_ = zrg.getfIndex( zpos );
+	    if ( mIsUdf(itvml.stop_) )
+		continue;
+
+	    zpos = getfMutePos( tdmodel, zistime, itvml.stop_, offset );
+	    itvml.stop_ = zrg.getfIndex( zpos );
 	}
-    }
 
-    return true;
+	if ( !mutelayeritvs.isEmpty() )
+	    muter.muteIntervals( trace, nrsamps, mutelayeritvs );
+    }
 }
 
 
@@ -12,11 +12,11 @@ ________________________________________________________________________
 #include "ailayer.h"
 #include "ioman.h"
 #include "multiid.h"
+#include "prestackanglecache.h"
 #include "prestackgather.h"
 #include "prestackmute.h"
 #include "prestackmutedef.h"
 #include "prestackmutedeftransl.h"
-#include "raytracerrunner.h"
 #include "survinfo.h"
 #include "timedepthconv.h"
 #include "velocityfunctionvolume.h"
@@ -83,12 +83,10 @@ bool AngleMuteComputer::usePar( const IOPar& par )
 }
 
 
-bool AngleMuteComputer::doPrepare( int nrthreads )
+bool AngleMuteComputer::doPrepare( int /* nrthreads */ )
 {
     errmsg_.setEmpty();
 
-    deepErase( rtrunners_ );
-
     if ( !setVelocityFunction() )
 	return false;
 
@@ -108,20 +106,12 @@ bool AngleMuteComputer::doPrepare( int nrthreads )
 					? Seis::OffsetType::OffsetFeet
 					: Seis::OffsetType::OffsetMeter );
 
-    for ( int idx=0; idx<nrthreads; idx++ )
-	rtrunners_ += new RayTracerRunner( params().raypar_ );
-
     return errmsg_.isEmpty();
 }
 
 
-bool AngleMuteComputer::doWork( od_int64 start, od_int64 stop, int thread )
+bool AngleMuteComputer::doWork( od_int64 start, od_int64 stop, int )
 {
-    if ( !rtrunners_.validIdx(thread) )
-	return false;
-
-    RayTracerRunner* rtrunner = rtrunners_[thread];
-
     const TrcKeySampling& tks = params().tks_;
     ObjectSet<PointBasedMathFunction> mutefuncs;
     TypeSet<BinID> bids;
@@ -132,25 +122,22 @@ bool AngleMuteComputer::doWork( od_int64 start, od_int64 stop, int thread )
     const RayTracer1D::Setup& rtsu = params().rtsu_;
     const float cutoffsin = (float) sin( params().mutecutoff_ * M_PIf / 180.f );
 
-    ElasticModelSet emodels;
-    auto* layers = new ElasticModel();
-    emodels.add( layers );
+    ElasticModel layers;
     bool nonemuted, allmuted;
     for ( od_int64 pidx=start; pidx<=stop && shouldContinue(); pidx++ )
     {
 	const TrcKey tk = tks.trcKeyAt( pidx );
-	layers->setEmpty();
-	if ( !getLayers(tk,*layers,errmsg_) )
+	layers.setEmpty();
+	if ( !getLayers(tk,layers,errmsg_) )
 	    continue;
 
-	rtrunner->setModel( emodels, &rtsu );
-	if ( !rtrunner->executeParallel(false) )
-	    { errmsg_ = rtrunner->uiMessage(); continue; }
+	ConstRefMan<OffsetReflectivityModel> refmodel =
+		AMC().getRefModel( layers, offsets, outputmute_.offsetType(),
+				   params().raypar_, rtsu, errmsg_, false );
+	if ( !refmodel )
+	    continue;
 
-	ConstRefMan<ReflectivityModelSet> refmodels = rtrunner->getRefModels();
-	const ReflectivityModelBase* refmodel = refmodels ? refmodels->get(0)
-							  : nullptr;
-	if ( !refmodel || !refmodel->hasAngles() )
+	if ( !refmodel->hasAngles() )
 	    return false;
 
 	const TimeDepthModel& tdmodel = refmodel->getDefaultModel();
@@ -193,7 +180,7 @@ bool AngleMuteComputer::doWork( od_int64 start, od_int64 stop, int thread )
 	    }
 	}
 
-	const int nrlayers = layers->size();
+	const int nrlayers = layers.size();
 	if ( lastioff != offsets.size()-1 )
 	{
 	    zpos = zistime ? tdmodel.getTime( nrlayers )
@@ -21,11 +21,13 @@ ________________________________________________________________________
 #include "ioobj.h"
 #include "keystrs.h"
 #include "prestackevents.h"
+#include "prestackeventstore.h"
 #include "prestackeventtransl.h"
 #include "rowcol.h"
 #include "safefileio.h"
 #include "samplingdata.h"
 #include "separstr.h"
+#include "settings.h"
 #include "survinfo.h"
 #include "streamconn.h"
 #include "strmoper.h"
@@ -171,11 +173,15 @@ EventReader::~EventReader()
     if ( eventmanager_ ) eventmanager_->blockChange( false, trigger_ );
     delete ioobj_;
     deepErase( patchreaders_ );
+    delete store_;
 }
 
 
 bool EventReader::getPositions( BinIDValueSet& bidset ) const
 {
+    if ( store_ )
+	store_->getPositions( bidset );
+
     for ( int idx=patchreaders_.size()-1; idx>=0; idx-- )
     {
 	mDynamicCastGet( const EventPatchReader*, reader, patchreaders_[idx] );
@@ -189,11 +195,21 @@ bool EventReader::getPositions( BinIDValueSet& bidset ) const
 bool EventReader::getBoundingBox( Interval<int>& inlrg,
 				  Interval<int>& crlrg ) const
 {
+    TrcKeySampling storerg;
+    const bool hasstore = store_ && store_->getRange( storerg );
+    if ( hasstore )
+    {
+	inlrg.start_ = storerg.start_.inl();
+	inlrg.stop_ = storerg.stop_.inl();
+	crlrg.start_ = storerg.start_.crl();
+	crlrg.stop_ = storerg.stop_.crl();
+    }
+
     for ( int idx=0; idx<patchreaders_.size(); idx++ )
     {
 	mDynamicCastGet( const EventPatchReader*, reader, patchreaders_[idx] );
 	const TrcKeySampling& hrg = reader->getRange();
-	if ( !idx )
+	if ( !idx && !hasstore )
 	{
             inlrg.start_ = hrg.start_.inl();
             inlrg.stop_ = hrg.stop_.inl();
@@ -209,7 +225,7 @@ bool EventReader::getBoundingBox( Interval<int>& inlrg,
 	}
     }
 
-    return patchreaders_.size();
+    return hasstore || !patchreaders_.isEmpty();
 }
 
 
@@ -251,7 +267,7 @@ int EventReader::nextStep()
 {
     if ( !eventmanager_ ) return Finished();
 
-    if ( !patchreaders_.size() )
+    if ( !store_ && !patchreaders_.size() )
     {
 	if ( !prepareWork() )
 	{
@@ -267,7 +283,19 @@ int EventReader::nextStep()
 	    return ErrorOccurred();
 	}
 
-	return patchreaders_.size() ? MoreToDo() : Finished();
+	return store_ || patchreaders_.size() ? MoreToDo() : Finished();
+    }
+
+    if ( store_ )
+    {
+	if ( !store_->load(*eventmanager_,bidsel_,horsel_) )
+	{
+	    errmsg_ = tr("Cannot load events from %1")
+			.arg( store_->fileName() );
+	    return ErrorOccurred();
+	}
+
+	return Finished();
     }
 
     const int res = patchreaders_[0]->doStep();
@@ -321,6 +349,7 @@ bool EventReader::readSamplingData( const IOObj& ioobj,
 bool EventReader::prepareWork()
 {
     if ( !ioobj_ ) return false;
+    if ( store_ ) return true;
 
     const BufferString fnm( ioobj_->fullUserExpr(true) );
     if ( !File::isDirectory(fnm.buf()) )
@@ -337,6 +366,20 @@ bool EventReader::prepareWork()
 	return false;
     }
 
+    const FilePath storefp( fnm.buf(), EventStore::sFileName() );
+    if ( File::exists(storefp.fullPath()) )
+    {
+	store_ = new EventStore( storefp.fullPath() );
+	if ( !store_->isOK() )
+	{
+	    errmsg_ = store_->errMsg();
+	    deleteAndNullPtr( store_ );
+	    return false;
+	}
+
+	return true;
+    }
+
     BufferString mask = "*.";
     mask += PSEventTranslatorGroup::sDefExtension();
 
@@ -525,6 +568,7 @@ EventWriter::EventWriter( IOObj* ioobj, EventManager& events )
     , eventmanager_( events )
     , ioobj_( ioobj )
 {
+    Settings::common().getYN( sKeyIndexedStore(), indexedstore_ );
     eventmanager_.blockChange( true, true );
 }
 
@@ -582,6 +626,9 @@ int EventWriter::nextStep()
 	if ( !writeAuxData( fnm.buf() ) )
 	    return ErrorOccurred();
 
+	if ( useIndexedStore(fnm.buf()) )
+	    return writeStore( fnm.buf() ) ? Finished() : ErrorOccurred();
+
 	const MultiDimStorage<EventSet*>& evstor = eventmanager_.getStorage();
 	int pos[] = { -1, -1 };
 	TypeSet<RowCol> rcols;
@@ -684,6 +731,65 @@ uiString EventWriter::errMsg() const
 { return errmsg_; }
 
 
+const char* EventWriter::sKeyIndexedStore()
+{
+    return "dTect.Prestack events.Indexed store";
+}
+
+
+bool EventWriter::useIndexedStore( const char* dirnm ) const
+{
+    const FilePath storefp( dirnm, EventStore::sFileName() );
+    if ( File::exists(storefp.fullPath()) )
+	return true;
+
+    if ( !indexedstore_ )
+	return false;
+
+    // Sets stored in patches are not converted
+    BufferString mask = "*.";
+    mask += PSEventTranslatorGroup::sDefExtension();
+    const DirList dirlist( dirnm, File::DirListType::FilesInDir, mask.buf() );
+    return dirlist.isEmpty();
+}
+
+
+bool EventWriter::writeStore( const char* dirnm )
+{
+    const BufferString storefnm =
+			FilePath( dirnm, EventStore::sFileName() ).fullPath();
+    EventStore* prev = nullptr;
+    if ( File::exists(storefnm) )
+    {
+	prev = new EventStore( storefnm );
+	if ( !prev->isOK() )
+	{
+	    errmsg_ = prev->errMsg();
+	    delete prev;
+	    return false;
+	}
+    }
+
+    bool ischanged = !prev;
+    const MultiDimStorage<EventSet*>& evstor = eventmanager_.getStorage();
+    int pos[] = { -1, -1 };
+    while ( !ischanged && evstor.next(pos,true) )
+	ischanged = evstor.getRef( pos, 0 )->ischanged_;
+
+    if ( !ischanged )
+    {
+	delete prev;
+	return true;
+    }
+
+    if ( !EventStore::write(storefnm,eventmanager_,prev,errmsg_) )
+	return false;
+
+    eventmanager_.resetChangedFlag( false );
+    return true;
+}
+
+
 bool EventWriter::writeAuxData( const char* fnm )
 {
     auxinfo_.set( EventReader::sKeyNrHorizons(),
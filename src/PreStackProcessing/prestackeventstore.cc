@@ -0,0 +1,697 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackeventstore.h"
+
+#include "binidvalset.h"
+#include "file.h"
+#include "multidimstorage.h"
+#include "paralleltask.h"
+#include "prestackeventio.h"
+#include "prestackevents.h"
+#include "trckeysampling.h"
+
+#include <string.h>
+
+#ifdef __win__
+# include "winutils.h"
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace PreStack
+{
+
+static const char cStoreMagic[] = "dTectPSE";
+static const od_int32 cStoreVersion = 1;
+static const od_int32 cByteOrderMark = 0x01020304;
+
+
+static char* mapFile( const char* fnm, bool forwrite, od_int64& size,
+		      void*& handle )
+{
+    handle = nullptr;
+#ifdef __win__
+    HANDLE file = CreateFileA( fnm, forwrite ? GENERIC_READ | GENERIC_WRITE
+					    : GENERIC_READ,
+			       FILE_SHARE_READ, NULL,
+			       forwrite ? CREATE_ALWAYS : OPEN_EXISTING,
+			       FILE_ATTRIBUTE_NORMAL, NULL );
+    if ( file == INVALID_HANDLE_VALUE )
+	return nullptr;
+
+    if ( !forwrite )
+    {
+	LARGE_INTEGER filesz;
+	if ( !GetFileSizeEx(file,&filesz) )
+	    { CloseHandle( file ); return nullptr; }
+
+	size = filesz.QuadPart;
+    }
+
+    const DWORD szhigh = mCast(DWORD,size >> 32);
+    const DWORD szlow = mCast(DWORD,size & 0xFFFFFFFF);
+    HANDLE mapping = size < 1 ? NULL
+		   : CreateFileMappingA( file, NULL,
+				forwrite ? PAGE_READWRITE : PAGE_READONLY,
+				szhigh, szlow, NULL );
+    CloseHandle( file );
+    if ( !mapping )
+	return nullptr;
+
+    char* data = (char*)MapViewOfFile( mapping,
+				forwrite ? FILE_MAP_WRITE : FILE_MAP_READ,
+				0, 0, 0 );
+    if ( !data )
+    {
+	CloseHandle( mapping );
+	return nullptr;
+    }
+
+    handle = mapping;
+    return data;
+#else
+    const int fd = forwrite ? open( fnm, O_RDWR | O_CREAT | O_TRUNC, 0644 )
+			    : open( fnm, O_RDONLY );
+    if ( fd < 0 )
+	return nullptr;
+
+    if ( forwrite )
+    {
+	if ( ftruncate(fd,size) != 0 )
+	    { close( fd ); return nullptr; }
+    }
+    else
+    {
+	struct stat st;
+	if ( fstat(fd,&st) != 0 )
+	    { close( fd ); return nullptr; }
+
+	size = st.st_size;
+    }
+
+    void* ptr = size < 1 ? MAP_FAILED
+	      : mmap( nullptr, size,
+		      forwrite ? PROT_READ | PROT_WRITE : PROT_READ,
+		      MAP_SHARED, fd, 0 );
+    close( fd );
+    return ptr == MAP_FAILED ? nullptr : (char*)ptr;
+#endif
+}
+
+
+static void unmapFile( char* data, od_int64 size, void* handle )
+{
+    if ( !data )
+	return;
+
+#ifdef __win__
+    UnmapViewOfFile( data );
+    CloseHandle( (HANDLE)handle );
+#else
+    munmap( data, size );
+#endif
+}
+
+
+static inline od_int64 aligned( od_int64 nrbytes )
+{
+    return (nrbytes+7) & ~od_int64(7);
+}
+
+
+// EventStoreColumns
+
+class EventStoreColumns
+{
+public:
+
+    struct Header
+    {
+	char		magic_[8];
+	od_int32	version_;
+	od_int32	byteorder_;
+	od_int64	nrpos_;
+	od_int64	nrevents_;
+	od_int64	nrpicks_;
+    };
+
+    struct Position
+    {
+	od_int32	inl_;
+	od_int32	crl_;
+	od_int64	firstevent_;
+    };
+
+    od_int64		layOut(char* data,od_int64 nrpos,od_int64 nrevents,
+			       od_int64 nrpicks);
+			/*!<Sets the pointers if data is not null, returns the
+			    file size */
+
+    od_int64		firstEvent( od_int64 posidx ) const
+			{
+			    return posidx<nrpos_
+				? positions_[posidx].firstevent_ : nrevents_;
+			}
+
+    od_int64		nrpos_			= 0;
+    od_int64		nrevents_		= 0;
+
+    Header*		header_			= nullptr;
+    Position*		positions_		= nullptr;
+    od_int64*		firstpick_		= nullptr; //nrevents+1
+    od_int16*		horid_			= nullptr;
+    unsigned char*	evquality_		= nullptr;
+    unsigned char*	evtype_			= nullptr;
+    float*		depth_			= nullptr;
+    float*		offset_			= nullptr;
+    float*		azimuth_		= nullptr;
+    unsigned char*	pickquality_		= nullptr;
+};
+
+
+od_int64 EventStoreColumns::layOut( char* data, od_int64 nrpos,
+				    od_int64 nrevents, od_int64 nrpicks )
+{
+    nrpos_ = nrpos;
+    nrevents_ = nrevents;
+    od_int64 offset = 0;
+#   define mSetColumn( col, type, nr ) \
+    if ( data ) col = (type*)(data + offset); \
+    offset += aligned( sizeof(type) * (nr) )
+
+    mSetColumn( header_, Header, 1 );
+    mSetColumn( positions_, Position, nrpos );
+    mSetColumn( firstpick_, od_int64, nrevents+1 );
+    mSetColumn( horid_, od_int16, nrevents );
+    mSetColumn( evquality_, unsigned char, nrevents );
+    mSetColumn( evtype_, unsigned char, nrevents );
+    mSetColumn( depth_, float, nrpicks );
+    mSetColumn( offset_, float, nrpicks );
+    mSetColumn( azimuth_, float, nrpicks );
+    mSetColumn( pickquality_, unsigned char, nrpicks );
+#   undef mSetColumn
+
+    return offset;
+}
+
+
+// EventStoreWriter
+
+class EventStoreWriter : public ParallelTask
+{ mODTextTranslationClass(EventStoreWriter)
+public:
+
+EventStoreWriter( const char* fnm, EventManager& mgr, EventStore* prev )
+    : filename_(fnm)
+    , tmpfilename_(fnm,".tmp")
+    , bckfilename_(fnm,".bck")
+    , mgr_(mgr)
+    , prev_(prev)
+{
+    sets_.setNullAllowed( true );
+}
+
+
+~EventStoreWriter()
+{
+    unmapFile( data_, datasize_, maphandle_ );
+    deepUnRef( sets_ );
+    delete prev_;
+}
+
+
+od_int64 nrIterations() const override	{ return bids_.size(); }
+uiString uiMessage() const override	{ return tr("Storing events"); }
+uiString uiNrDoneText() const override	{ return tr("Positions done"); }
+const uiString& errMsg() const		{ return errmsg_; }
+
+protected:
+
+bool doPrepare( int ) override
+{
+    BinIDValueSet allbids( 0, false );
+    if ( prev_ )
+	prev_->getPositions( allbids );
+
+    const MultiDimStorage<EventSet*>& evstor = mgr_.getStorage();
+    int pos[] = { -1, -1 };
+    while ( evstor.next(pos,true) )
+    {
+	BinID bid;
+	evstor.getPos( pos, bid );
+	allbids.add( bid );
+    }
+
+    // The sets are sorted on in-line and cross-line
+    od_int64 nrevents = 0, nrpicks = 0;
+    BinIDValueSet::SPos spos;
+    while ( allbids.next(spos) )
+    {
+	const BinID bid = allbids.getBinID( spos );
+	const od_int64 previdx = prev_ ? prev_->indexOf( bid ) : -1;
+	const EventSet* es = mgr_.getEvents( bid, false, false );
+	if ( es && !es->ischanged_ && previdx>=0 )
+	    es = nullptr;
+
+	int nrev = 0;
+	od_int64 nrpk = 0;
+	if ( es )
+	{
+	    for ( const auto* ev : es->events_ )
+	    {
+		if ( ev->sz_ )
+		    { nrev++; nrpk += ev->sz_; }
+	    }
+	}
+	else if ( previdx>=0 )
+	{
+	    nrev = prev_->nrEvents( previdx );
+	    nrpk = prev_->nrPicks( previdx );
+	}
+
+	if ( !nrev )
+	    continue;
+
+	if ( es )
+	    es->ref();
+
+	bids_ += bid;
+	sets_ += es;
+	previdxs_ += es ? -1 : previdx;
+	firstevents_ += nrevents;
+	firstpicks_ += nrpicks;
+	nrevents += nrev;
+	nrpicks += nrpk;
+    }
+
+    datasize_ = columns_.layOut( nullptr, bids_.size(), nrevents, nrpicks );
+    data_ = mapFile( tmpfilename_, true, datasize_, maphandle_ );
+    if ( !data_ )
+    {
+	errmsg_ = tr("Cannot create %1").arg( tmpfilename_ );
+	return false;
+    }
+
+    columns_.layOut( data_, bids_.size(), nrevents, nrpicks );
+    EventStoreColumns::Header& hdr = *columns_.header_;
+    OD::memCopy( hdr.magic_, cStoreMagic, sizeof(hdr.magic_) );
+    hdr.version_ = cStoreVersion;
+    hdr.byteorder_ = cByteOrderMark;
+    hdr.nrpos_ = bids_.size();
+    hdr.nrevents_ = nrevents;
+    hdr.nrpicks_ = nrpicks;
+    columns_.firstpick_[nrevents] = nrpicks;
+    return true;
+}
+
+
+bool doWork( od_int64 start, od_int64 stop, int ) override
+{
+    EventStoreColumns& out = columns_;
+    for ( od_int64 posidx=start; posidx<=stop; posidx++ )
+    {
+	const int idx = mCast(int,posidx);
+	EventStoreColumns::Position& pos = out.positions_[posidx];
+	pos.inl_ = bids_[idx].inl();
+	pos.crl_ = bids_[idx].crl();
+	pos.firstevent_ = firstevents_[idx];
+
+	od_int64 evidx = firstevents_[idx];
+	od_int64 pickidx = firstpicks_[idx];
+	const EventSet* es = sets_[idx];
+	if ( !es )
+	{
+	    copyFromPrev( previdxs_[idx], evidx, pickidx );
+	    addToNrDone( 1 );
+	    continue;
+	}
+
+	for ( const auto* ev : es->events_ )
+	{
+	    if ( !ev->sz_ )
+		continue;
+
+	    out.firstpick_[evidx] = pickidx;
+	    out.horid_[evidx] = ev->horid_;
+	    out.evquality_[evidx] = ev->quality_;
+	    out.evtype_[evidx] = mCast( unsigned char,
+			EventReader::encodeEventType(ev->eventtype_) );
+	    for ( int idy=0; idy<ev->sz_; idy++, pickidx++ )
+	    {
+		out.depth_[pickidx] = ev->pick_[idy];
+		out.offset_[pickidx] = ev->offsetazimuth_[idy].offset();
+		out.azimuth_[pickidx] = ev->offsetazimuth_[idy].azimuth();
+		out.pickquality_[pickidx] = ev->pickquality_
+			? ev->pickquality_[idy] : Event::cManPickQuality();
+	    }
+
+	    evidx++;
+	}
+
+	addToNrDone( 1 );
+    }
+
+    return true;
+}
+
+
+void copyFromPrev( od_int64 previdx, od_int64 evidx, od_int64 pickidx )
+{
+    const EventStoreColumns& in = prev_->columns_;
+    EventStoreColumns& out = columns_;
+    const od_int64 firstev = in.firstEvent( previdx );
+    const od_int64 nrev = in.firstEvent( previdx+1 ) - firstev;
+    const od_int64 firstpick = in.firstpick_[firstev];
+    const od_int64 nrpicks = in.firstpick_[firstev+nrev] - firstpick;
+    for ( od_int64 idx=0; idx<nrev; idx++ )
+    {
+	out.firstpick_[evidx+idx] =
+			pickidx + in.firstpick_[firstev+idx] - firstpick;
+    }
+
+    OD::memCopy( out.horid_+evidx, in.horid_+firstev,
+		 nrev*sizeof(od_int16) );
+    OD::memCopy( out.evquality_+evidx, in.evquality_+firstev, nrev );
+    OD::memCopy( out.evtype_+evidx, in.evtype_+firstev, nrev );
+    OD::memCopy( out.depth_+pickidx, in.depth_+firstpick,
+		 nrpicks*sizeof(float) );
+    OD::memCopy( out.offset_+pickidx, in.offset_+firstpick,
+		 nrpicks*sizeof(float) );
+    OD::memCopy( out.azimuth_+pickidx, in.azimuth_+firstpick,
+		 nrpicks*sizeof(float) );
+    OD::memCopy( out.pickquality_+pickidx, in.pickquality_+firstpick,
+		 nrpicks );
+}
+
+
+bool doFinish( bool success ) override
+{
+    unmapFile( data_, datasize_, maphandle_ );
+    data_ = nullptr;
+    if ( !success )
+    {
+	File::remove( tmpfilename_ );
+	return false;
+    }
+
+    // The old file may still be mapped. It is kept as a backup until the
+    // new one is in place.
+    deleteAndNullPtr( prev_ );
+    const bool hasold = File::exists( filename_ );
+    if ( hasold )
+    {
+	if ( File::isFile(bckfilename_) )
+	    File::remove( bckfilename_ );
+
+	if ( !File::rename(filename_,bckfilename_) )
+	{
+	    errmsg_ = tr("Cannot rename %1 to %2").arg( filename_ )
+						  .arg( bckfilename_ );
+	    File::remove( tmpfilename_ );
+	    return false;
+	}
+    }
+
+    if ( !File::rename(tmpfilename_,filename_) )
+    {
+	errmsg_ = tr("Cannot rename %1 to %2").arg( tmpfilename_ )
+					      .arg( filename_ );
+	// The new events stay in the temporary file if the old ones are lost
+	if ( hasold && File::rename(bckfilename_,filename_) )
+	    File::remove( tmpfilename_ );
+
+	return false;
+    }
+
+    if ( hasold )
+	File::remove( bckfilename_ );
+
+    return true;
+}
+
+    const BufferString		filename_;
+    const BufferString		tmpfilename_;
+    const BufferString		bckfilename_;
+    EventManager&		mgr_;
+    EventStore*			prev_;
+
+    TypeSet<BinID>		bids_;
+    ObjectSet<const EventSet>	sets_;		//null: from prev_
+    TypeSet<od_int64>		previdxs_;
+    TypeSet<od_int64>		firstevents_;
+    TypeSet<od_int64>		firstpicks_;
+
+    EventStoreColumns		columns_;
+    char*			data_		= nullptr;
+    od_int64			datasize_	= 0;
+    void*			maphandle_	= nullptr;
+    uiString			errmsg_;
+};
+
+
+// EventStoreLoader
+
+class EventStoreLoader : public ParallelTask
+{ mODTextTranslationClass(EventStoreLoader)
+public:
+
+EventStoreLoader( const EventStore& store, EventManager& mgr,
+		  const BinIDValueSet* bidsel, const TrcKeySampling* horsel )
+    : store_(store)
+    , mgr_(mgr)
+{
+    // A small selection is looked up, instead of scanning the whole store
+    if ( bidsel && !horsel )
+    {
+	BinIDValueSet::SPos spos;
+	while ( bidsel->next(spos) )
+	{
+	    const od_int64 posidx = store_.indexOf( bidsel->getBinID(spos) );
+	    if ( posidx>=0 )
+		posidxs_ += posidx;
+	}
+
+	return;
+    }
+
+    for ( od_int64 posidx=0; posidx<store_.nrPositions(); posidx++ )
+    {
+	const BinID bid = store_.getBinID( posidx );
+	if ( (!bidsel && !horsel) || (horsel && horsel->includes(bid)) ||
+	     (bidsel && bidsel->includes(bid)) )
+	    posidxs_ += posidx;
+    }
+}
+
+
+od_int64 nrIterations() const override	{ return posidxs_.size(); }
+uiString uiMessage() const override	{ return tr("Loading events"); }
+uiString uiNrDoneText() const override	{ return tr("Positions done"); }
+
+protected:
+
+bool doWork( od_int64 start, od_int64 stop, int ) override
+{
+    for ( od_int64 idx=start; idx<=stop; idx++, addToNrDone(1) )
+    {
+	const od_int64 posidx = posidxs_[mCast(int,idx)];
+	const BinID bid = store_.getBinID( posidx );
+	const EventSet* cur = mgr_.getEvents( bid, false, false );
+	if ( cur && cur->ischanged_ )
+	    continue;
+
+	RefMan<EventSet> es = mgr_.getEvents( bid, false, true );
+	if ( !es )
+	    continue;
+
+	deepErase( es->events_ );
+	if ( !store_.getEvents(posidx,es->events_) )
+	    return false;
+    }
+
+    return true;
+}
+
+    const EventStore&	store_;
+    EventManager&	mgr_;
+    TypeSet<od_int64>	posidxs_;
+};
+
+
+// EventStore
+
+EventStore::EventStore( const char* fnm )
+    : filename_(fnm)
+    , columns_(*new EventStoreColumns)
+{
+    data_ = mapFile( fnm, false, datasize_, maphandle_ );
+    if ( !data_ )
+    {
+	errmsg_ = tr("Cannot open %1").arg( filename_ );
+	return;
+    }
+
+    const auto* hdr = (const EventStoreColumns::Header*)data_;
+    const od_int64 hdrsz = sizeof(EventStoreColumns::Header);
+    if ( datasize_<hdrsz ||
+	 memcmp(hdr->magic_,cStoreMagic,sizeof(hdr->magic_)) )
+	errmsg_ = tr("%1 is not a Prestack event store").arg( filename_ );
+    else if ( hdr->version_>cStoreVersion )
+	errmsg_ = tr("%1 was written by a newer version").arg( filename_ );
+    else if ( hdr->byteorder_!=cByteOrderMark )
+	errmsg_ = tr("%1 was written on a platform with another byte order")
+		    .arg( filename_ );
+    else if ( columns_.layOut(nullptr,hdr->nrpos_,hdr->nrevents_,
+			      hdr->nrpicks_) != datasize_ )
+	errmsg_ = tr("%1 is truncated").arg( filename_ );
+
+    if ( !errmsg_.isEmpty() )
+    {
+	unmapFile( data_, datasize_, maphandle_ );
+	data_ = nullptr;
+	return;
+    }
+
+    nrpos_ = hdr->nrpos_;
+    nrevents_ = hdr->nrevents_;
+    nrpicks_ = hdr->nrpicks_;
+    columns_.layOut( data_, nrpos_, nrevents_, nrpicks_ );
+}
+
+
+EventStore::~EventStore()
+{
+    unmapFile( data_, datasize_, maphandle_ );
+    delete &columns_;
+}
+
+
+BinID EventStore::getBinID( od_int64 posidx ) const
+{
+    const EventStoreColumns::Position& pos = columns_.positions_[posidx];
+    return BinID( pos.inl_, pos.crl_ );
+}
+
+
+od_int64 EventStore::indexOf( const BinID& bid ) const
+{
+    od_int64 start = 0, stop = nrpos_-1;
+    while ( start<=stop )
+    {
+	const od_int64 mid = (start+stop) / 2;
+	const EventStoreColumns::Position& pos = columns_.positions_[mid];
+	if ( pos.inl_==bid.inl() && pos.crl_==bid.crl() )
+	    return mid;
+
+	if ( pos.inl_<bid.inl() ||
+	     (pos.inl_==bid.inl() && pos.crl_<bid.crl()) )
+	    start = mid+1;
+	else
+	    stop = mid-1;
+    }
+
+    return -1;
+}
+
+
+void EventStore::getPositions( BinIDValueSet& bidset ) const
+{
+    for ( od_int64 posidx=0; posidx<nrpos_; posidx++ )
+	bidset.add( getBinID(posidx) );
+}
+
+
+bool EventStore::getRange( TrcKeySampling& tks ) const
+{
+    if ( nrpos_<1 )
+	return false;
+
+    tks.start_ = tks.stop_ = getBinID( 0 );
+    for ( od_int64 posidx=1; posidx<nrpos_; posidx++ )
+	tks.include( getBinID(posidx) );
+
+    return true;
+}
+
+
+int EventStore::nrEvents( od_int64 posidx ) const
+{
+    return mCast( int, columns_.firstEvent(posidx+1) -
+		       columns_.firstEvent(posidx) );
+}
+
+
+od_int64 EventStore::nrPicks( od_int64 posidx ) const
+{
+    return columns_.firstpick_[ columns_.firstEvent(posidx+1) ] -
+	   columns_.firstpick_[ columns_.firstEvent(posidx) ];
+}
+
+
+bool EventStore::getEvents( od_int64 posidx, ObjectSet<Event>& events ) const
+{
+    if ( !data_ || posidx<0 || posidx>=nrpos_ )
+	return false;
+
+    const EventStoreColumns& in = columns_;
+    const od_int64 lastev = in.firstEvent( posidx+1 );
+    for ( od_int64 evidx=in.firstEvent(posidx); evidx<lastev; evidx++ )
+    {
+	const od_int64 firstpick = in.firstpick_[evidx];
+	const int nrpicks = mCast( int, in.firstpick_[evidx+1] - firstpick );
+	auto* ev = new Event( nrpicks, true );
+	ev->horid_ = in.horid_[evidx];
+	ev->quality_ = in.evquality_[evidx];
+	ev->eventtype_ = EventReader::decodeEventType( in.evtype_[evidx] );
+	for ( int idx=0; idx<nrpicks; idx++ )
+	{
+	    const od_int64 pickidx = firstpick + idx;
+	    ev->pick_[idx] = in.depth_[pickidx];
+	    ev->pickquality_[idx] = in.pickquality_[pickidx];
+	    ev->offsetazimuth_[idx] =
+		OffsetAzimuth( in.offset_[pickidx], in.azimuth_[pickidx] );
+	}
+
+	events += ev;
+    }
+
+    return true;
+}
+
+
+bool EventStore::load( EventManager& mgr, const BinIDValueSet* bidsel,
+		       const TrcKeySampling* horsel ) const
+{
+    if ( !data_ )
+	return false;
+
+    EventStoreLoader loader( *this, mgr, bidsel, horsel );
+    return loader.execute();
+}
+
+
+bool EventStore::write( const char* fnm, EventManager& mgr, EventStore* prev,
+			uiString& errmsg )
+{
+    EventStoreWriter writer( fnm, mgr, prev );
+    if ( writer.execute() )
+	return true;
+
+    errmsg = writer.errMsg();
+    if ( errmsg.isEmpty() )
+	errmsg = tr("Cannot write %1").arg( fnm );
+
+    return false;
+}
+
+} // namespace PreStack
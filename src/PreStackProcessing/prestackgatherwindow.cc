@@ -0,0 +1,95 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackgatherwindow.h"
+
+#include "prestackgather.h"
+#include "seispsread.h"
+#include "trckey.h"
+
+
+namespace PreStack
+{
+
+GatherWindow::GatherWindow( const IOObj& ioobj, SeisPSReader& reader,
+			    int comp )
+    : ioobj_(ioobj)
+    , reader_(reader)
+    , comp_(comp)
+    , stepout_(BinID::noStepout())
+    , step_(1,1)
+    , center_(BinID::udf())
+{
+    gathers_.setNullAllowed( true );
+}
+
+
+GatherWindow::~GatherWindow()
+{
+}
+
+
+void GatherWindow::setStepout( const BinID& stepout, const BinID& step )
+{
+    stepout_ = stepout;
+    step_ = step;
+}
+
+
+bool GatherWindow::isInWindow( const BinID& bid ) const
+{
+    return abs(bid.inl()-center_.inl()) <= stepout_.inl()*abs(step_.inl()) &&
+	   abs(bid.crl()-center_.crl()) <= stepout_.crl()*abs(step_.crl());
+}
+
+
+void GatherWindow::setCenter( const BinID& bid )
+{
+    center_ = bid;
+    for ( int idx=bids_.size()-1; idx>=0; idx-- )
+    {
+	if ( isInWindow(bids_[idx]) )
+	    continue;
+
+	bids_.removeSingle( idx );
+	gathers_.removeSingle( idx );
+    }
+}
+
+
+ConstRefMan<Gather> GatherWindow::getGather( const BinID& bid )
+{
+    const int bufidx = bids_.indexOf( bid );
+    if ( bufidx!=-1 )
+	return gathers_.get( bufidx );
+
+    RefMan<Gather> gather = new Gather;
+    TrcKey tk;
+    if ( reader_.is3D() )
+	tk.setPosition( bid );
+    else
+	tk.setGeomID( reader_.geomID() ).setTrcNr( bid.trcNr() );
+
+    if ( tk.isUdf() || !gather->readFrom(ioobj_,reader_,tk,comp_) )
+	gather = nullptr;
+
+    bids_ += bid;
+    gathers_ += gather.ptr();
+    return gather.ptr();
+}
+
+
+void GatherWindow::clear()
+{
+    bids_.erase();
+    gathers_.erase();
+    center_ = BinID::udf();
+}
+
+} // namespace PreStack
@@ -38,6 +38,7 @@ LateralStack::LateralStack()
     : Processor( sFactoryKeyword() )
     , patternstepout_( 1, 1 )
 {
+    stackgathers_.setNullAllowed( true );
 }
 
 
@@ -46,6 +47,18 @@ LateralStack::~LateralStack()
 }
 
 
+static int getTraceIdx( const Gather& gather, const OffsetAzimuth& oa )
+{
+    for ( int idx=gather.size(Gather::offsetDim()==0)-1; idx>=0; idx-- )
+    {
+	if ( gather.getOffsetAzimuth(idx)==oa )
+	    return idx;
+    }
+
+    return -1;
+}
+
+
 bool LateralStack::reset( bool force )
 {
     inputstepout_ = BinID::noStepout();
@@ -60,6 +73,7 @@ bool LateralStack::setPattern( const BinID& stepout, bool cross )
 
     patternstepout_ = stepout;
     iscross_ = cross;
+    clearRunningStack();
 
     inputs_.setEmpty();
     inputstepout_ = BinID::noStepout();
@@ -151,10 +165,93 @@ bool LateralStack::prepareWork()
     for ( int idx=0; idx<nroffsets; idx++ )
 	offsetazi_ += centergather->getOffsetAzimuth( idx );
 
+    prepareRunningStack( *centergather );
     return true;
 }
 
 
+void LateralStack::clearRunningStack()
+{
+    stackgathers_.erase();
+    stackoffsetazi_.erase();
+    colsums_.erase();
+    colcounts_.erase();
+    totsums_.erase();
+    totcounts_.erase();
+    nrz_ = 0;
+    userunningstack_ = shiftstack_ = false;
+}
+
+
+void LateralStack::prepareRunningStack( const Gather& centergather )
+{
+    const int centeroffset =
+		getRelBidOffset( BinID::noStepout(), outputstepout_ );
+    if ( iscross_ || patternstepout_.crl()<1 ||
+	 outputstepout_!=BinID::noStepout() ||
+	 !outputinterest_[centeroffset] )
+    {
+	clearRunningStack();
+	return;
+    }
+
+    const int nrrows = 2*patternstepout_.inl() + 1;
+    const int nrcols = 2*patternstepout_.crl() + 1;
+    RefObjectSet<Gather> gathers;
+    gathers.setNullAllowed( true );
+    for ( int col=0; col<nrcols; col++ )
+    {
+	for ( int row=0; row<nrrows; row++ )
+	{
+	    const BinID relbid( row-patternstepout_.inl(),
+				col-patternstepout_.crl() );
+	    gathers.add( inputs_[getRelBidOffset(relbid,getInputStepout())] );
+	}
+    }
+
+    const int nrz = centergather.size( Gather::zDim()==0 );
+    shiftstack_ = userunningstack_ && nrz==nrz_ &&
+		  offsetazi_==stackoffsetazi_ &&
+		  stackgathers_.size()==gathers.size() &&
+		  colsums_.size()==nrcols;
+
+    //The pattern moved one cross-line if the gathers did too
+    for ( int idx=0; shiftstack_ && idx<gathers.size()-nrrows; idx++ )
+    {
+	if ( gathers.get(idx)!=stackgathers_.get(idx+nrrows) )
+	    shiftstack_ = false;
+    }
+
+    stackgathers_ = gathers;
+    userunningstack_ = true;
+    if ( shiftstack_ )
+    {
+	//The column that left the pattern becomes the last one
+	for ( int col=0; col<nrcols-1; col++ )
+	{
+	    colsums_.swap( col, col+1 );
+	    colcounts_.swap( col, col+1 );
+	}
+
+	return;
+    }
+
+    nrz_ = nrz;
+    stackoffsetazi_ = offsetazi_;
+    const int sz = offsetazi_.size() * nrz_;
+    colsums_.erase();
+    colcounts_.erase();
+    for ( int col=0; col<nrcols; col++ )
+    {
+	colsums_.add( new TypeSet<double>(sz,0.) );
+	colcounts_.add( new TypeSet<int>(sz,0) );
+    }
+
+    totsums_.setSize( sz, 0. );
+    totcounts_.setSize( sz, 0 );
+}
+
+
 void LateralStack::fillPar( IOPar& par ) const
 {
     par.set( sKeyStepout(), patternstepout_ );
@@ -177,6 +274,14 @@ bool LateralStack::doWork( od_int64 start, od_int64 stop, int )
 {
     for ( int ioffs=mCast(int,start); ioffs<=stop; ioffs++, addToNrDone(1) )
     {
+	if ( userunningstack_ )
+	{
+	    if ( !processRunningStack(ioffs) )
+		return false;
+
+	    continue;
+	}
+
 	for ( int oinl=-outputstepout_.inl();
 					oinl<=outputstepout_.inl(); oinl++ )
 	{
@@ -203,16 +308,12 @@ bool LateralStack::processOutput( const OffsetAzimuth& oa,const BinID& center )
 	return false;
 
     float* outputtrc = 0;
-    for ( int idx=outputgather->size(Gather::offsetDim()==0)-1; idx>=0; idx-- )
+    const int outputtrcidx = getTraceIdx( *outputgather, oa );
+    if ( outputtrcidx!=-1 )
     {
-	if ( outputgather->getOffsetAzimuth(idx)==oa )
-	{
-	    outputtrc = outputgather->data().getData();
-	    if ( outputtrc )
-		outputtrc += outputgather->data().info().getOffset( idx, 0 );
-
-	    break;
-	}
+	outputtrc = outputgather->data().getData();
+	if ( outputtrc )
+	    outputtrc += outputgather->data().info().getOffset(outputtrcidx,0);
     }
 
     if ( !outputtrc )
@@ -239,13 +340,7 @@ bool LateralStack::processOutput( const OffsetAzimuth& oa,const BinID& center )
 	    if ( !gather )
 		continue;
 
-	    int trcidx = -1;
-	    for ( int idx=gather->size(gather->offsetDim()==0)-1;idx>=0; idx-- )
-	    {
-		if ( gather->getOffsetAzimuth(idx)==oa )
-		{ trcidx = idx; break; }
-	    }
-
+	    const int trcidx = getTraceIdx( *gather, oa );
 	    if ( trcidx==-1 )
 		continue;
 
@@ -275,4 +370,101 @@ bool LateralStack::processOutput( const OffsetAzimuth& oa,const BinID& center )
     return true;
 }
 
+
+void LateralStack::stackColumn( int col, int offsetidx )
+{
+    double* sums = colsums_[col]->arr() + od_int64(offsetidx)*nrz_;
+    int* counts = colcounts_[col]->arr() + od_int64(offsetidx)*nrz_;
+    OD::sysMemZero( sums, nrz_*sizeof(double) );
+    OD::sysMemZero( counts, nrz_*sizeof(int) );
+
+    const OffsetAzimuth& oa = offsetazi_[offsetidx];
+    const int nrrows = 2*patternstepout_.inl() + 1;
+    for ( int row=0; row<nrrows; row++ )
+    {
+	const Gather* gather = stackgathers_[col*nrrows+row];
+	if ( !gather )
+	    continue;
+
+	const int trcidx = getTraceIdx( *gather, oa );
+	const float* trc = gather->data().getData();
+	if ( trcidx==-1 || !trc )
+	    continue;
+
+	trc += gather->data().info().getOffset( trcidx, 0 );
+	const int nrz = mMIN( gather->size(Gather::zDim()==0), nrz_ );
+	for ( int idx=0; idx<nrz; idx++ )
+	{
+	    const float val = trc[idx];
+	    if ( mIsUdf(val) )
+		continue;
+
+	    sums[idx] += val;
+	    counts[idx]++;
+	}
+    }
+}
+
+
+bool LateralStack::processRunningStack( int offsetidx )
+{
+    const int centeroffset =
+		getRelBidOffset( BinID::noStepout(), outputstepout_ );
+    Gather* outputgather = outputs_[centeroffset];
+    float* outputtrc = outputgather ? outputgather->data().getData() : 0;
+    if ( !outputtrc )
+	return false;
+
+    outputtrc += outputgather->data().info().getOffset( offsetidx, 0 );
+
+    const od_int64 firstidx = od_int64(offsetidx)*nrz_;
+    double* totsums = totsums_.arr() + firstidx;
+    int* totcounts = totcounts_.arr() + firstidx;
+    const int nrcols = colsums_.size();
+    if ( shiftstack_ )
+    {
+	//Only the new column is stacked
+	const int lastcol = nrcols-1;
+	const double* sums = colsums_[lastcol]->arr() + firstidx;
+	const int* counts = colcounts_[lastcol]->arr() + firstidx;
+	for ( int idx=0; idx<nrz_; idx++ )
+	{
+	    totsums[idx] -= sums[idx];
+	    totcounts[idx] -= counts[idx];
+	}
+
+	stackColumn( lastcol, offsetidx );
+	for ( int idx=0; idx<nrz_; idx++ )
+	{
+	    totsums[idx] += sums[idx];
+	    totcounts[idx] += counts[idx];
+	}
+    }
+    else
+    {
+	OD::sysMemZero( totsums, nrz_*sizeof(double) );
+	OD::sysMemZero( totcounts, nrz_*sizeof(int) );
+	for ( int col=0; col<nrcols; col++ )
+	{
+	    stackColumn( col, offsetidx );
+	    const double* sums = colsums_[col]->arr() + firstidx;
+	    const int* counts = colcounts_[col]->arr() + firstidx;
+	    for ( int idx=0; idx<nrz_; idx++ )
+	    {
+		totsums[idx] += sums[idx];
+		totcounts[idx] += counts[idx];
+	    }
+	}
+    }
+
+    const int nrz = mMIN( outputgather->size(Gather::zDim()==0), nrz_ );
+    for ( int idx=0; idx<nrz; idx++ )
+    {
+	outputtrc[idx] = totcounts[idx]
+		       ? mCast(float,totsums[idx]/totcounts[idx]) : 0.f;
+    }
+
+    return true;
+}
+
 } // namespace PreStack
@@ -10,8 +10,10 @@ ________________________________________________________________________
 #include "prestacktrimstatics.h"
 
 #include "arrayndimpl.h"
+#include "crosscorrelator.h"
 #include "iopar.h"
 #include "prestackgather.h"
+#include "survinfo.h"
 
 
 namespace PreStack
@@ -91,12 +93,17 @@ od_int64 TrimStatics::nrIterations() const
 }
 
 
+/* Stacks the traces within the pilot offset range. The traces are those of
+   the gather, shifted by the previous iterations. */
+
 class PilotTraceExtractor : public ParallelTask
 {
 public:
-PilotTraceExtractor( const TrimStatics::Iteration& it, const Gather& gth )
+PilotTraceExtractor( const TrimStatics::Iteration& it, const Gather& gth,
+		     const float* trcs )
     : gather_(gth)
     , it_(it)
+    , trcs_(trcs)
 {
     nrz_ = gather_.data().info().getSize( Gather::zDim() );
     pilottrc_ = new Array1DImpl<float>( mCast(int,nrz_) );
@@ -116,10 +123,10 @@ bool doWork( od_int64 start, od_int64 stop, int ) override
 	for ( int ido=0; ido<nroffsets; ido++ )
 	{
 	    const float offset = gather_.getOffset(ido);
-	    if ( !it_.tsoffsetrg_.includes(offset,true) )
+	    if ( !it_.ptoffsetrg_.includes(offset,true) )
 		continue;
 
-	    const float val = gather_.data().get( ido, idz );
+	    const float val = trcs_[ido*nrz_+idz];
 	    if ( mIsUdf(val) )
 		continue;
 
@@ -143,22 +150,105 @@ Array1D<float>* getPilotTrace() const
 protected:
     const Gather&			gather_;
     const TrimStatics::Iteration&	it_;
+    const float*			trcs_;
     od_int64				nrz_;
     Array1D<float>*			pilottrc_;
 };
 
 
+static float getShifted( const float* trc, int nrz, float pos )
+{
+    if ( pos<0.f || pos>nrz-1 )
+	return 0.f;
+
+    const int idx0 = (int)pos;
+    if ( idx0 >= nrz-1 )
+	return trc[nrz-1];
+
+    const float val0 = trc[idx0];
+    const float val1 = trc[idx0+1];
+    if ( mIsUdf(val0) || mIsUdf(val1) )
+	return mUdf(float);
+
+    return val0 + (pos-idx0) * (val1-val0);
+}
+
+
 bool TrimStatics::prepareWork()
 {
     if ( !Processor::prepareWork() )
 	return false;
 
     deepErase( pilottrcs_ );
+    const Gather& input = *inputs_[0];
+    const Array2D<float>& inparr = input.data();
+    const int nrtrcs = inparr.getSize( Gather::offsetDim() );
+    const int nrz = inparr.getSize( Gather::zDim() );
+    shifts_.setSize( nrtrcs, 0.f );
+    shiftedtrcs_.setSize( nrtrcs*nrz, mUdf(float) );
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+	for ( int idz=0; idz<nrz; idz++ )
+	    shiftedtrcs_[itrc*nrz+idz] = inparr.get( itrc, idz );
+
+    const TypeSet<float> orig( shiftedtrcs_ );
+    const float zstep = input.zRange().step_ * (SI().zIsTime() ? 1000 : 1);
+    TypeSet<int> trcidxs;
+    TypeSet<const float*> trcs;
+    TypeSet<float> pilot( nrz, mUdf(float) );
+    TypeSet<float> xcorrs;
+    Fourier::CrossCorrelator correlator;
     for ( int idx=0; idx<iterations_.size(); idx++ )
     {
-	PilotTraceExtractor task( iterations_[idx], *inputs_[0] );
+	// The pilot is re-stacked from the traces shifted so far
+	const Iteration& it = iterations_[idx];
+	PilotTraceExtractor task( it, input, shiftedtrcs_.arr() );
 	task.execute();
 	pilottrcs_ += task.getPilotTrace();
+
+	const int maxlag = mIsUdf(it.maxshift_) || zstep<=0.f ? 0
+			 : mNINT32( Math::Floor(it.maxshift_/zstep) );
+	if ( maxlag<1 || nrz<1 )
+	    continue;
+
+	trcidxs.setEmpty();
+	trcs.setEmpty();
+	for ( int itrc=0; itrc<nrtrcs; itrc++ )
+	{
+	    if ( !it.tsoffsetrg_.includes(input.getOffset(itrc),true) )
+		continue;
+
+	    trcidxs += itrc;
+	    trcs += shiftedtrcs_.arr() + itrc*nrz;
+	}
+
+	if ( trcidxs.isEmpty() )
+	    continue;
+
+	for ( int idz=0; idz<nrz; idz++ )
+	    pilot[idz] = pilottrcs_[idx]->get( idz );
+
+	// All lags of all selected traces in one batch of FFTs
+	const int nrlags = 2*maxlag + 1;
+	xcorrs.setSize( trcidxs.size()*nrlags );
+	if ( !correlator.setSize(nrz,maxlag) ||
+	     !correlator.setReference(pilot.arr()) ||
+	     !correlator.correlate(trcs.size(),trcs.arr(),xcorrs.arr()) )
+	    return false;
+
+	for ( int ipos=0; ipos<trcidxs.size(); ipos++ )
+	{
+	    const float lag = Fourier::CrossCorrelator::findPeak(
+				xcorrs.arr()+ipos*nrlags, maxlag );
+	    if ( mIsUdf(lag) )
+		continue;
+
+	    const int itrc = trcidxs[ipos];
+	    shifts_[itrc] += lag;
+	    const float* origtrc = orig.arr() + itrc*nrz;
+	    float* curtrc = shiftedtrcs_.arr() + itrc*nrz;
+	    for ( int idz=0; idz<nrz; idz++ )
+		curtrc[idz] = getShifted( origtrc, nrz, idz+shifts_[itrc] );
+	}
     }
 
     return true;
@@ -204,12 +294,32 @@ bool TrimStatics::doPilotTraceOutput( od_int64 start, od_int64 stop )
 
 bool TrimStatics::doShiftOutput( od_int64 start, od_int64 stop )
 {
+    Gather* output = outputs_[0];
+    const int nrz = output->data().info().getSize( Gather::zDim() );
+    const float zstep =
+	inputs_[0]->zRange().step_ * (SI().zIsTime() ? 1000 : 1);
+    for ( int ido=mCast(int,start); ido<=stop; ido++, addToNrDone(1) )
+    {
+	const float shift = shifts_.validIdx(ido) ? shifts_[ido]*zstep : 0.f;
+	for ( int idz=0; idz<nrz; idz++ )
+	    output->data().set( ido, idz, shift );
+    }
+
     return true;
 }
 
 
 bool TrimStatics::doTrimStaticsOutput( od_int64 start, od_int64 stop )
 {
+    Gather* output = outputs_[0];
+    const int nrz = output->data().info().getSize( Gather::zDim() );
+    for ( int ido=mCast(int,start); ido<=stop; ido++, addToNrDone(1) )
+    {
+	const float* trc = shiftedtrcs_.arr() + od_int64(ido)*nrz;
+	for ( int idz=0; idz<nrz; idz++ )
+	    output->data().set( ido, idz, trc[idz] );
+    }
+
     return true;
 }
 
@@ -0,0 +1,449 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackvelocityscan.h"
+
+#include "arrayndimpl.h"
+#include "bufstringset.h"
+#include "iopar.h"
+#include "ioobj.h"
+#include "paralleltask.h"
+#include "prestackgather.h"
+#include "seispsioprov.h"
+#include "seispsread.h"
+#include "seistrc.h"
+#include "seiswrite.h"
+
+#include <math.h>
+
+namespace PreStack
+{
+
+/*!\brief Computes the semblance of a range of trial velocities, one
+  velocity per iteration. */
+
+class SemblancePanelComputer : public ParallelTask
+{ mODTextTranslationClass(SemblancePanelComputer)
+public:
+SemblancePanelComputer( const VelocityScanner& scanner, const float* trcs,
+			const float* offsetsq, int nrtrcs,
+			const ZSampling& zrg, int nrz, float* panel )
+    : scanner_(scanner)
+    , trcs_(trcs)
+    , offsetsq_(offsetsq)
+    , nrtrcs_(nrtrcs)
+    , z0_(zrg.start_)
+    , dz_(zrg.step_)
+    , nrz_(nrz)
+    , panel_(panel)
+{
+    t0sq_.setSize( nrz_ );
+    for ( int iz=0; iz<nrz_; iz++ )
+    {
+	const float t0 = z0_ + iz*dz_;
+	t0sq_[iz] = t0*t0;
+    }
+
+    const float maxstretch = scanner_.maxStretch();
+    if ( !mIsUdf(maxstretch) && maxstretch>0.f )
+	stretchfac_ = 1.f / ( (1.f+maxstretch)*(1.f+maxstretch) - 1.f );
+}
+
+od_int64 nrIterations() const override
+{ return scanner_.nrVelocities(); }
+
+int minThreadSize() const override
+{ return 1; }
+
+bool doWork( od_int64 start, od_int64 stop, int ) override
+{
+    TypeSet<float> numbuf( nrz_, 0.f ), denbuf( nrz_, 0.f ),
+		   cntbuf( nrz_, 0.f );
+    float* num = numbuf.arr();
+    float* den = denbuf.arr();
+    float* cnt = cntbuf.arr();
+    const float* t0sq = t0sq_.arr();
+    const float invdz = 1.f / dz_;
+    const float tmax = z0_ + (nrz_-1)*dz_;
+    const int firstpos = z0_<0.f ? mNINT32(Math::Ceil(-z0_*invdz)) : 0;
+    const int lasti0 = nrz_ - 2;
+    for ( int iv=mCast(int,start); iv<=stop; iv++ )
+    {
+	float* semblance = panel_ + od_int64(iv)*nrz_;
+	const float vel = scanner_.velocityRange().atIndex( iv );
+	if ( vel<=0.f )
+	{
+	    OD::memValueSet( semblance, 0.f, nrz_ );
+	    continue;
+	}
+
+	OD::memZero( num, nrz_*sizeof(float) );
+	OD::memZero( den, nrz_*sizeof(float) );
+	OD::memZero( cnt, nrz_*sizeof(float) );
+	const float invvelsq = 1.f / (vel*vel);
+	for ( int itrc=0; itrc<nrtrcs_; itrc++ )
+	{
+	    const float dtsq = offsetsq_[itrc] * invvelsq;
+	    if ( tmax*tmax <= dtsq )
+		continue;
+
+	    int izstart = firstpos;
+	    if ( !mIsUdf(stretchfac_) )
+	    {
+		const float t0min = Math::Sqrt( dtsq*stretchfac_ );
+		const int stretchstart =
+			mNINT32( Math::Ceil((t0min-z0_)*invdz) );
+		if ( stretchstart > izstart )
+		    izstart = stretchstart;
+	    }
+
+	    const float t0max = Math::Sqrt( tmax*tmax - dtsq );
+	    int izstop = (int)Math::Floor( (t0max-z0_)*invdz );
+	    if ( izstop >= nrz_ )
+		izstop = nrz_-1;
+
+	    const float* trc = trcs_ + od_int64(itrc)*nrz_;
+	    for ( int iz=izstart; iz<=izstop; iz++ )
+	    {
+		const float fidx = (sqrtf(t0sq[iz]+dtsq) - z0_) * invdz;
+		int i0 = (int)fidx;
+		i0 = i0 < lasti0 ? i0 : lasti0;
+		const float val = trc[i0] + (fidx-i0) * (trc[i0+1]-trc[i0]);
+		num[iz] += val;
+		den[iz] += val*val;
+		cnt[iz] += 1.f;
+	    }
+	}
+
+	const int hw = scanner_.windowSize() / 2;
+	double sumnum = 0., sumden = 0.;
+	for ( int iz=0; iz<hw && iz<nrz_; iz++ )
+	{
+	    sumnum += num[iz]*num[iz];
+	    sumden += cnt[iz]*den[iz];
+	}
+
+	for ( int iz=0; iz<nrz_; iz++ )
+	{
+	    const int addidx = iz + hw;
+	    if ( addidx < nrz_ )
+	    {
+		sumnum += num[addidx]*num[addidx];
+		sumden += cnt[addidx]*den[addidx];
+	    }
+
+	    const int remidx = iz - hw - 1;
+	    if ( remidx >= 0 )
+	    {
+		sumnum -= num[remidx]*num[remidx];
+		sumden -= cnt[remidx]*den[remidx];
+	    }
+
+	    semblance[iz] = sumden>0. ? mCast(float,sumnum/sumden) : 0.f;
+	}
+    }
+
+    return true;
+}
+
+protected:
+
+    const VelocityScanner&	scanner_;
+    const float*		trcs_;
+    const float*		offsetsq_;
+    const int			nrtrcs_;
+    const float			z0_;
+    const float			dz_;
+    const int			nrz_;
+    float*			panel_;
+    TypeSet<float>		t0sq_;
+    float			stretchfac_	= mUdf(float);
+};
+
+
+// VelocityScanner
+VelocityScanner::VelocityScanner()
+    : velrg_(1500.f,4500.f,25.f)
+{
+}
+
+
+VelocityScanner::~VelocityScanner()
+{
+}
+
+
+int VelocityScanner::nrVelocities() const
+{
+    return velrg_.step_>0.f ? velrg_.nrSteps()+1 : 0;
+}
+
+
+bool VelocityScanner::computePanel( const Gather& gather,
+				    Array2D<float>& panel,
+				    bool parallel ) const
+{
+    if ( gather.isOffsetAngle() || !gather.isLoaded() )
+	return false;
+
+    const Array2D<float>& data = gather.data();
+    const int nrtrcs = data.getSize( Gather::offsetDim() );
+    const int nrz = data.getSize( Gather::zDim() );
+    const int nrvels = nrVelocities();
+    const ZSampling& zrg = gather.zRange();
+    if ( nrtrcs<1 || nrz<2 || nrvels<1 || zrg.step_<=0.f ||
+	 panel.getSize(0)!=nrvels || panel.getSize(1)!=nrz )
+	return false;
+
+    // Contiguous copy, shared by all trial velocities
+    mAllocLargeVarLenArr( float, trcs, od_int64(nrtrcs)*nrz );
+    mAllocLargeVarLenArr( float, offsetsq, nrtrcs );
+    if ( !mIsVarLenArrOK(trcs) || !mIsVarLenArrOK(offsetsq) )
+	return false;
+
+    for ( int itrc=0; itrc<nrtrcs; itrc++ )
+    {
+	const float offset = gather.getOffset( itrc );
+	mVarLenArr(offsetsq)[itrc] = mIsUdf(offset) ? 0.f : offset*offset;
+	float* trc = mVarLenArr(trcs) + od_int64(itrc)*nrz;
+	for ( int iz=0; iz<nrz; iz++ )
+	{
+	    const float val = data.get( itrc, iz );
+	    trc[iz] = mIsUdf(val) ? 0.f : val;
+	}
+    }
+
+    float* panelptr = panel.getData();
+    ArrPtrMan<float> panelbuf;
+    if ( !panelptr )
+    {
+	mTryAllocPtrMan( panelbuf, float[od_int64(nrvels)*nrz] );
+	if ( !panelbuf )
+	    return false;
+
+	panelptr = panelbuf.ptr();
+    }
+
+    SemblancePanelComputer computer( *this, mVarLenArr(trcs),
+				     mVarLenArr(offsetsq), nrtrcs, zrg, nrz,
+				     panelptr );
+    if ( !computer.executeParallel(parallel) )
+	return false;
+
+    if ( panelptr != panel.getData() )
+    {
+	for ( int iv=0; iv<nrvels; iv++ )
+	    for ( int iz=0; iz<nrz; iz++ )
+		panel.set( iv, iz, panelptr[od_int64(iv)*nrz+iz] );
+    }
+
+    return true;
+}
+
+
+float VelocityScanner::pickVelocity( const Array2D<float>& panel,
+				     int zidx ) const
+{
+    if ( zidx<0 || zidx>=panel.getSize(1) )
+	return mUdf(float);
+
+    int bestidx = -1;
+    float bestval = 0.f;
+    for ( int iv=0; iv<panel.getSize(0); iv++ )
+    {
+	const float val = panel.get( iv, zidx );
+	if ( !mIsUdf(val) && val>bestval )
+	{
+	    bestval = val;
+	    bestidx = iv;
+	}
+    }
+
+    return bestidx<0 ? mUdf(float) : velrg_.atIndex( bestidx );
+}
+
+
+void VelocityScanner::fillPar( IOPar& par ) const
+{
+    par.set( sKeyVelocityRange(), velrg_ );
+    par.set( sKeyWindowSize(), winsz_ );
+    par.set( sKeyMaxStretch(), maxstretch_ );
+}
+
+
+bool VelocityScanner::usePar( const IOPar& par )
+{
+    par.get( sKeyVelocityRange(), velrg_ );
+    par.get( sKeyWindowSize(), winsz_ );
+    par.get( sKeyMaxStretch(), maxstretch_ );
+    return nrVelocities() > 0;
+}
+
+
+/*!\brief Computes the panels of a batch of gathers, one gather per
+  iteration. */
+
+class VelocityScanBatch : public ParallelTask
+{ mODTextTranslationClass(VelocityScanBatch)
+public:
+VelocityScanBatch( const VelocityScanner& scanner,
+		   const ObjectSet<Gather>& gathers,
+		   ObjectSet<Array2D<float> >& panels,
+		   BoolTypeSet& success )
+    : scanner_(scanner)
+    , gathers_(gathers)
+    , panels_(panels)
+    , success_(success)
+{}
+
+od_int64 nrIterations() const override
+{ return gathers_.size(); }
+
+int minThreadSize() const override
+{ return 1; }
+
+bool doWork( od_int64 start, od_int64 stop, int ) override
+{
+    for ( int idx=mCast(int,start); idx<=stop; idx++ )
+	success_[idx] = scanner_.computePanel( *gathers_[idx], *panels_[idx],
+					       false );
+    return true;
+}
+
+protected:
+
+    const VelocityScanner&	scanner_;
+    const ObjectSet<Gather>&	gathers_;
+    ObjectSet<Array2D<float> >& panels_;
+    BoolTypeSet&		success_;
+};
+
+
+// VelocityScanVolume
+VelocityScanVolume::VelocityScanVolume( const VelocityScanner& scanner,
+					const IOObj& input, const IOObj& output,
+					const TrcKeySampling& tks )
+    : Executor("Velocity scan")
+    , scanner_(scanner)
+    , inputioobj_(input.clone())
+    , tks_(tks)
+    , iter_(tks)
+    , totalnr_(tks.totalNr())
+{
+    reader_ = SPSIOPF().get3DReader( input );
+    const Seis::GeomType gt = Seis::Vol;
+    writer_ = new SeisTrcWriter( output, &gt );
+    BufferStringSet compnms;
+    for ( int iv=0; iv<scanner_.nrVelocities(); iv++ )
+	compnms.add( BufferString("Semblance ",
+				  scanner_.velocityRange().atIndex(iv)) );
+
+    writer_->setComponentNames( compnms );
+    batchsize_ = 4 * Threads::getNrProcessors();
+    if ( !reader_ )
+	msg_ = tr("Cannot open input data store");
+    else if ( !writer_->isOK() )
+	msg_ = writer_->errMsg();
+    else
+	msg_ = tr("Computing semblance");
+}
+
+
+VelocityScanVolume::~VelocityScanVolume()
+{
+    delete writer_;
+    delete reader_;
+    delete inputioobj_;
+}
+
+
+bool VelocityScanVolume::isOK() const
+{
+    return reader_ && writer_ && writer_->isOK();
+}
+
+
+uiString VelocityScanVolume::uiNrDoneText() const
+{
+    return tr("Gathers done");
+}
+
+
+int VelocityScanVolume::nextStep()
+{
+    if ( !isOK() )
+	return ErrorOccurred();
+
+    RefObjectSet<Gather> gathers;
+    BinID bid;
+    bool atend = false;
+    while ( gathers.size() < batchsize_ )
+    {
+	if ( !iter_.next(bid) )
+	{
+	    atend = true;
+	    break;
+	}
+
+	nrdone_++;
+	TrcKey tk;
+	tk.setPosition( bid );
+	RefMan<Gather> gather = new Gather;
+	if ( gather->readFrom(*inputioobj_,*reader_,tk) )
+	    gathers += gather.ptr();
+    }
+
+    ManagedObjectSet<Array2D<float> > panels;
+    for ( const auto* gather : gathers )
+	panels += new Array2DImpl<float>( scanner_.nrVelocities(),
+					  gather->data().getSize(1) );
+
+    BoolTypeSet success( gathers.size(), false );
+    VelocityScanBatch batch( scanner_, gathers, panels, success );
+    if ( !batch.execute() )
+    {
+	msg_ = tr("Cannot compute semblance");
+	return ErrorOccurred();
+    }
+
+    for ( int idx=0; idx<gathers.size(); idx++ )
+    {
+	if ( success[idx] && !writePanel(*gathers[idx],*panels[idx]) )
+	{
+	    msg_ = tr("Cannot write output");
+	    return ErrorOccurred();
+	}
+    }
+
+    return atend ? Finished() : MoreToDo();
+}
+
+
+bool VelocityScanVolume::writePanel( const Gather& gather,
+				     const Array2D<float>& panel )
+{
+    const int nrz = panel.getSize( 1 );
+    const int nrvels = panel.getSize( 0 );
+    const ZSampling& zrg = gather.zRange();
+    SeisTrc trc( nrz );
+    trc.setNrComponents( nrvels );
+    trc.info().sampling_.start_ = zrg.start_;
+    trc.info().sampling_.step_ = zrg.step_;
+    trc.info().setPos( gather.getBinID() );
+    trc.info().calcCoord();
+    for ( int iv=0; iv<nrvels; iv++ )
+    {
+	for ( int iz=0; iz<nrz; iz++ )
+	    trc.set( iz, panel.get(iv,iz), iv );
+    }
+
+    return writer_->put( trc );
+}
+
+} // namespace PreStack
@@ -0,0 +1,225 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "ailayer.h"
+#include "keystrs.h"
+#include "moddepmgr.h"
+#include "prestackanglecache.h"
+#include "raytrace1d.h"
+#include "reflectivitymodel.h"
+#include "testprog.h"
+
+using namespace PreStack;
+
+
+static ElasticModel* createModel( float pvelshift )
+{
+    auto* emdl = new ElasticModel;
+    *emdl += new ElasticLayer( 48.f, 2000.f, 1000.f, 2500.f );
+    *emdl += new ElasticLayer( 520.f, 2600.f+pvelshift, 1400.f, 2300.f );
+    *emdl += new ElasticLayer( 385.f, 3500.f, 1900.f, 2200.f );
+    *emdl += new ElasticLayer( 400.f, 4000.f, 2300.f, 2800.f );
+    return emdl;
+}
+
+
+static TypeSet<float> getOffsets( float step )
+{
+    TypeSet<float> offsets;
+    for ( int idx=0; idx<8; idx++ )
+	offsets += step * idx;
+
+    return offsets;
+}
+
+
+static IOPar getRayPars()
+{
+    IOPar raypars;
+    raypars.set( sKey::Type(), VrmsRayTracer1D::sFactoryKeyword() );
+    return raypars;
+}
+
+
+static RayTracer1D::Setup getSetup()
+{
+    RayTracer1D::Setup rtsu;
+    rtsu.doreflectivity( false );
+    return rtsu;
+}
+
+
+/* The cached model must be the one of the requested layers, not of a model
+   with the same hash or a nearby profile */
+
+static bool hasAnglesOf( const OffsetReflectivityModel& refmodel,
+			 const ElasticModel& emodel,
+			 const TypeSet<float>& offsets )
+{
+    VrmsRayTracer1D raytracer;
+    raytracer.setup() = getSetup();
+    raytracer.setOffsets( offsets, Seis::OffsetType::OffsetMeter );
+    if ( !raytracer.setModel(emodel) || !raytracer.execute() ||
+	 !raytracer.getRefModel() )
+	return false;
+
+    const ReflectivityModelBase& exp = *raytracer.getRefModel();
+    if ( refmodel.nrRefModels() != exp.nrRefModels() ||
+	 refmodel.nrLayers() != exp.nrLayers() )
+	return false;
+
+    for ( int ioff=0; ioff<exp.nrRefModels(); ioff++ )
+    {
+	for ( int idz=0; idz<exp.nrLayers(); idz++ )
+	{
+	    if ( !mIsEqual(refmodel.getSinAngle(ioff,idz),
+			   exp.getSinAngle(ioff,idz),1e-6f) )
+		return false;
+	}
+    }
+
+    return true;
+}
+
+
+static bool getModels( const ObjectSet<const ElasticModel>& ems,
+		       const TypeSet<float>& offsets,
+		       RefObjectSet<const OffsetReflectivityModel>& refmodels,
+		       const char* desc )
+{
+    uiString errmsg;
+    mRunStandardTestWithError( AMC().getRefModels(ems,offsets,
+				Seis::OffsetType::OffsetMeter,getRayPars(),
+				getSetup(),refmodels,errmsg) &&
+			       refmodels.size() == ems.size(),
+			       desc, toString(errmsg) );
+    for ( int idx=0; idx<ems.size(); idx++ )
+    {
+	const OffsetReflectivityModel* refmodel = refmodels.get( idx );
+	BufferString modeldesc( desc, ": angles of model " );
+	modeldesc.add( idx );
+	mRunStandardTest( refmodel &&
+			  hasAnglesOf(*refmodel,*ems.get(idx),offsets),
+			  modeldesc );
+    }
+
+    return true;
+}
+
+
+static bool testSharing()
+{
+    AMC().clear();
+    ManagedObjectSet<ElasticModel> emodels;
+    emodels += createModel( 0.f );
+    emodels += createModel( 300.f );
+    emodels += createModel( 0.f );
+    emodels += createModel( 0.01f );
+    ObjectSet<const ElasticModel> ems;
+    for ( const auto* emodel : emodels )
+	ems += emodel;
+
+    const TypeSet<float> offsets = getOffsets( 250.f );
+    RefObjectSet<const OffsetReflectivityModel> refmodels;
+    if ( !getModels(ems,offsets,refmodels,"First request") )
+	return false;
+
+    mRunStandardTest( AMC().nrModels() == 3, "Same models traced once" );
+    mRunStandardTest( refmodels.get(0) == refmodels.get(2),
+		      "Same model shared within a request" );
+    mRunStandardTest( refmodels.get(0) != refmodels.get(3),
+		      "Nearby model not shared" );
+
+    RefObjectSet<const OffsetReflectivityModel> again;
+    ObjectSet<const ElasticModel> copyems;
+    copyems += emodels[2];
+    copyems += emodels[3];
+    if ( !getModels(copyems,offsets,again,"Second request") )
+	return false;
+
+    mRunStandardTest( AMC().nrModels() == 3 &&
+		      again.get(0) == refmodels.get(0) &&
+		      again.get(1) == refmodels.get(3),
+		      "Models reused from the cache" );
+
+    RefObjectSet<const OffsetReflectivityModel> otheroffs;
+    if ( !getModels(copyems,getOffsets(200.f),otheroffs,"Other offsets") )
+	return false;
+
+    mRunStandardTest( AMC().nrModels() == 5 &&
+		      otheroffs.get(0) != refmodels.get(0),
+		      "No reuse for other offsets" );
+
+    // Quanta are an opt-in: nearby models share a model
+    AMC().setQuanta( 1.f, 1.f, 1.f );
+    mRunStandardTest( AMC().nrModels() == 0, "Cache cleared for new quanta" );
+    RefObjectSet<const OffsetReflectivityModel> quantized;
+    uiString errmsg;
+    mRunStandardTestWithError( AMC().getRefModels(copyems,offsets,
+				Seis::OffsetType::OffsetMeter,getRayPars(),
+				getSetup(),quantized,errmsg) &&
+			       quantized.size() == 2 && quantized.get(0) &&
+			       quantized.get(0) == quantized.get(1),
+			       "Nearby models shared with quanta",
+			       toString(errmsg) );
+    AMC().setQuanta( 0.f, 0.f, 0.f );
+    return true;
+}
+
+
+static bool testLimitSize()
+{
+    AMC().clear();
+    AMC().setMaxNrModels( 2 );
+    ManagedObjectSet<ElasticModel> emodels;
+    RefObjectSet<const OffsetReflectivityModel> refmodels;
+    const TypeSet<float> offsets = getOffsets( 250.f );
+    for ( int idx=0; idx<3; idx++ )
+    {
+	emodels += createModel( 100.f*idx );
+	ObjectSet<const ElasticModel> ems;
+	ems += emodels[idx];
+	RefObjectSet<const OffsetReflectivityModel> res;
+	if ( !getModels(ems,offsets,res,BufferString("Model ",idx)) )
+	    return false;
+
+	refmodels.add( res.get(0) );
+    }
+
+    mRunStandardTest( AMC().nrModels() == 2, "Number of models limited" );
+
+    ObjectSet<const ElasticModel> ems;
+    ems += emodels[0];
+    ems += emodels[2];
+    RefObjectSet<const OffsetReflectivityModel> res;
+    if ( !getModels(ems,offsets,res,"After the limit") )
+	return false;
+
+    mRunStandardTest( res.get(0) != refmodels.get(0) &&
+		      res.get(1) == refmodels.get(2),
+		      "Least recently used model removed" );
+    return true;
+}
+
+
+mLoad1Module("PreStackProcessing")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    const int maxnrmodels = AMC().maxNrModels();
+    AMC().setMaxNrModels( 128 );
+    const bool res = testSharing() && testLimitSize();
+    AMC().setMaxNrModels( maxnrmodels );
+    AMC().clear();
+    return res;
+}
@@ -0,0 +1,203 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "flatposdata.h"
+#include "moddepmgr.h"
+#include "prestackgather.h"
+#include "prestacklateralstack.h"
+#include "testprog.h"
+#include "zdomain.h"
+
+#include <math.h>
+
+static const BinID cPatternStepout( 1, 2 );
+static const int cFirstCrl = 0;
+static const int cLastCrl = 11;
+static const int cNrRows = 2*cPatternStepout.inl() + 1;
+static const int cNrCols = cLastCrl - cFirstCrl + 2*cPatternStepout.crl() + 1;
+
+
+/* Processes either with the running sums, or with a full restack of the
+   pattern at every position */
+
+class TestLateralStack : public PreStack::LateralStack
+{
+public:
+		TestLateralStack( bool fullrestack )
+		    : fullrestack_(fullrestack)
+		{
+		    setGeomSystem( OD::Geom3D );
+		    setPattern( cPatternStepout, false );
+		}
+
+    bool	prepareWork() override
+		{
+		    if ( !LateralStack::prepareWork() )
+			return false;
+
+		    if ( fullrestack_ )
+			clearRunningStack();
+
+		    return true;
+		}
+
+    bool	isShifted() const	{ return shiftstack_; }
+
+    const bool	fullrestack_;
+};
+
+
+static bool isMissing( int row, int crl )
+{
+    return (row==0 && crl==3) || (row==2 && crl==6) ||
+	   (row==1 && crl==8) || (row==1 && crl==12);
+}
+
+
+static RefMan<PreStack::Gather> createGather( int row, int crl )
+{
+    if ( isMissing(row,crl) )
+	return nullptr;
+
+    FlatPosData fp;
+    fp.setRange( true, StepInterval<double>(0.,500.,100.) );
+    fp.setRange( false, StepInterval<double>(0.,0.1,0.004) );
+    RefMan<PreStack::Gather> gather = new PreStack::Gather( fp,
+			Seis::OffsetType::OffsetMeter, OD::AngleType::Degrees,
+			ZDomain::TWT() );
+
+    Array2D<float>& data = gather->data();
+    for ( int itrc=0; itrc<data.getSize(0); itrc++ )
+    {
+	for ( int iz=0; iz<data.getSize(1); iz++ )
+	{
+	    const bool isudf = (crl+row+itrc+iz) % 17 == 0;
+	    data.set( itrc, iz, isudf ? mUdf(float)
+			: sinf(0.3f*iz + 0.7f*crl + 1.3f*row + 0.2f*itrc) );
+	}
+    }
+
+    return gather;
+}
+
+
+static bool process( TestLateralStack& stack,
+		     const ObjectSet<PreStack::Gather>& gathers, int crl,
+		     ConstRefMan<PreStack::Gather>& output )
+{
+    stack.reset();
+    stack.setOutputInterest( BinID::noStepout(), true );
+    const BinID stepout = stack.getInputStepout();
+    BinID relbid;
+    for ( relbid.inl()=-stepout.inl(); relbid.inl()<=stepout.inl();
+	  relbid.inl()++ )
+    {
+	for ( relbid.crl()=-stepout.crl(); relbid.crl()<=stepout.crl();
+	      relbid.crl()++ )
+	{
+	    if ( !stack.wantsInput(relbid) )
+		continue;
+
+	    const int row = relbid.inl() + cPatternStepout.inl();
+	    const int col = crl + relbid.crl() - cFirstCrl
+			  + cPatternStepout.crl();
+	    const PreStack::Gather* gather = gathers[col*cNrRows+row];
+	    stack.setInput( relbid, gather );
+	}
+    }
+
+    if ( !stack.prepareWork() || !stack.execute() )
+	return false;
+
+    output = stack.getOutput( BinID::noStepout() );
+    return output;
+}
+
+
+static bool isSame( const PreStack::Gather& gather1,
+		    const PreStack::Gather& gather2 )
+{
+    const Array2D<float>& data1 = gather1.data();
+    const Array2D<float>& data2 = gather2.data();
+    if ( data1.getSize(0) != data2.getSize(0) ||
+	 data1.getSize(1) != data2.getSize(1) )
+	return false;
+
+    for ( int itrc=0; itrc<data1.getSize(0); itrc++ )
+    {
+	for ( int iz=0; iz<data1.getSize(1); iz++ )
+	{
+	    if ( !mIsEqual(data1.get(itrc,iz),data2.get(itrc,iz),1e-4f) )
+		return false;
+	}
+    }
+
+    return true;
+}
+
+
+/* Moves along an in-line. The gathers are shared between the positions, as
+   with a GatherWindow, so the running stack can shift. Some gathers are
+   missing, including the center one at one position. */
+
+static bool testRunningStack()
+{
+    RefObjectSet<PreStack::Gather> gathers;
+    gathers.setNullAllowed( true );
+    for ( int col=0; col<cNrCols; col++ )
+    {
+	const int crl = cFirstCrl - cPatternStepout.crl() + col;
+	for ( int row=0; row<cNrRows; row++ )
+	    gathers.add( createGather(row,crl).ptr() );
+    }
+
+    TestLateralStack runningstack( false );
+    TestLateralStack fullstack( true );
+    int nrshifted = 0;
+    for ( int crl=cFirstCrl; crl<=cLastCrl; crl++ )
+    {
+	ConstRefMan<PreStack::Gather> runningout, fullout;
+	const bool hasrunning = process( runningstack, gathers, crl,
+					 runningout );
+	const bool hasfull = process( fullstack, gathers, crl, fullout );
+	BufferString desc( "Cross-line ", crl );
+	mRunStandardTest( hasrunning == hasfull,
+			  BufferString(desc,": same outputs") );
+	mRunStandardTest( hasrunning == !isMissing(1,crl),
+			  BufferString(desc,": output with a center gather") );
+	if ( !hasrunning )
+	    continue;
+
+	if ( runningstack.isShifted() )
+	    nrshifted++;
+
+	mRunStandardTest( isSame(*runningout,*fullout),
+			  BufferString(desc,": running stack") );
+    }
+
+    mRunStandardTest( nrshifted>0, "Running stack shifted" );
+    mRunStandardTest( nrshifted<cLastCrl-cFirstCrl,
+		      "Running stack restacked after a missing center" );
+    return true;
+}
+
+
+mLoad1Module("PreStackProcessing")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    if ( !testRunningStack() )
+	return false;
+
+    return true;
+}
@@ -0,0 +1,241 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "prestackeventstore.h"
+
+#include "binidvalset.h"
+#include "file.h"
+#include "filepath.h"
+#include "offsetazimuth.h"
+#include "prestackevents.h"
+#include "testprog.h"
+
+using namespace PreStack;
+
+
+/* Events of a position are derived from the position and a version, so the
+   expected events can be recreated when checking */
+
+static void fillEvents( EventSet& es, const BinID& bid, int version )
+{
+    deepErase( es.events_ );
+    const int nrevents = 1 + (bid.inl()+bid.crl()) % 3;
+    for ( int iev=0; iev<nrevents; iev++ )
+    {
+	const int nrpicks = 2 + iev;
+	auto* ev = new Event( nrpicks, true );
+	ev->horid_ = mCast( short, iev );
+	ev->quality_ = mCast( unsigned char, 10*version + iev );
+	ev->eventtype_ = iev%2 ? VSEvent::Min : VSEvent::Max;
+	for ( int idx=0; idx<nrpicks; idx++ )
+	{
+	    ev->pick_[idx] = bid.inl() + 0.01f*bid.crl() + 0.1f*iev
+			   + 0.001f*idx + 100.f*version;
+	    ev->offsetazimuth_[idx] = OffsetAzimuth( 100.f*(idx+1),
+						     0.5f*iev );
+	    ev->pickquality_[idx] = mCast( unsigned char, idx );
+	}
+
+	es.events_ += ev;
+    }
+
+    // Events without picks are not stored
+    es.events_ += new Event( 0, true );
+    es.ischanged_ = true;
+}
+
+
+static void addPositions( EventManager& mgr, const TypeSet<BinID>& bids,
+			  int version )
+{
+    for ( const auto& bid : bids )
+	fillEvents( *mgr.getEvents(bid,false,true), bid, version );
+}
+
+
+static bool isSame( const ObjectSet<Event>& events, const EventSet& exp )
+{
+    int evidx = 0;
+    for ( const auto* expev : exp.events_ )
+    {
+	if ( !expev->sz_ )
+	    continue;
+
+	if ( !events.validIdx(evidx) )
+	    return false;
+
+	const Event& ev = *events[evidx++];
+	if ( ev.sz_ != expev->sz_ || ev.horid_ != expev->horid_ ||
+	     ev.quality_ != expev->quality_ ||
+	     ev.eventtype_ != expev->eventtype_ )
+	    return false;
+
+	for ( int idx=0; idx<ev.sz_; idx++ )
+	{
+	    if ( ev.pick_[idx] != expev->pick_[idx] ||
+		 ev.pickquality_[idx] != expev->pickquality_[idx] ||
+		 !(ev.offsetazimuth_[idx]==expev->offsetazimuth_[idx]) )
+		return false;
+	}
+    }
+
+    return evidx == events.size();
+}
+
+
+static bool checkStore( const EventStore& store, const TypeSet<BinID>& bids,
+			const TypeSet<int>& versions, const char* desc )
+{
+    mRunStandardTestWithError( store.isOK(), BufferString("Open ",desc),
+			       toString(store.errMsg()) );
+    mRunStandardTest( store.nrPositions() == bids.size(),
+		      BufferString("Number of positions ",desc) );
+
+    bool sorted = true;
+    for ( od_int64 posidx=1; posidx<store.nrPositions(); posidx++ )
+    {
+	const BinID prev = store.getBinID( posidx-1 );
+	const BinID cur = store.getBinID( posidx );
+	if ( prev.inl()>cur.inl() ||
+	     (prev.inl()==cur.inl() && prev.crl()>=cur.crl()) )
+	    sorted = false;
+    }
+
+    mRunStandardTest( sorted, BufferString("Positions sorted ",desc) );
+
+    RefMan<EventSet> exp = new EventSet;
+    bool allsame = true;
+    for ( int idx=0; idx<bids.size(); idx++ )
+    {
+	const od_int64 posidx = store.indexOf( bids[idx] );
+	ManagedObjectSet<Event> events;
+	fillEvents( *exp, bids[idx], versions[idx] );
+	if ( posidx<0 || !store.getEvents(posidx,events) ||
+	     !isSame(events,*exp) )
+	    allsame = false;
+    }
+
+    mRunStandardTest( allsame, BufferString("Events ",desc) );
+    mRunStandardTest( store.indexOf(BinID(1,1)) < 0,
+		      BufferString("Missing position ",desc) );
+    return true;
+}
+
+
+static bool testRoundTrip( const char* fnm )
+{
+    const BufferString tmpfnm( fnm, ".tmp" );
+    TypeSet<BinID> bids;
+    bids += BinID( 11, 5 );
+    bids += BinID( 10, 21 );
+    bids += BinID( 10, 20 );
+    TypeSet<int> versions( bids.size(), 0 );
+
+    RefMan<EventManager> mgr = new EventManager;
+    addPositions( *mgr, bids, 0 );
+    uiString errmsg;
+    mRunStandardTestWithError( EventStore::write(fnm,*mgr,nullptr,errmsg),
+			       "Write a new store", toString(errmsg) );
+    mRunStandardTest( !File::exists(tmpfnm), "Temporary file removed" );
+    {
+	const EventStore store( fnm );
+	if ( !checkStore(store,bids,versions,"after writing") )
+	    return false;
+    }
+
+    // Rewrite with one changed and one new position, the others are
+    // copied from the previous store
+
+    mgr = new EventManager;
+    TypeSet<BinID> changedbids;
+    changedbids += BinID( 10, 21 );
+    changedbids += BinID( 10, 22 );
+    addPositions( *mgr, changedbids, 1 );
+    bids += BinID( 10, 22 );
+    versions[1] = 1;
+    versions += 1;
+
+    auto* prev = new EventStore( fnm );
+    mRunStandardTest( prev->isOK(), "Open the previous store" );
+    mRunStandardTestWithError( EventStore::write(fnm,*mgr,prev,errmsg),
+			       "Rewrite the store", toString(errmsg) );
+    mRunStandardTest( !File::exists(tmpfnm),
+		      "Temporary file removed after rewrite" );
+
+    const EventStore store( fnm );
+    if ( !checkStore(store,bids,versions,"after rewriting") )
+	return false;
+
+    RefMan<EventManager> loadmgr = new EventManager;
+    mRunStandardTest( store.load(*loadmgr), "Load all events" );
+    RefMan<EventSet> exp = new EventSet;
+    bool allsame = true;
+    for ( int idx=0; idx<bids.size(); idx++ )
+    {
+	const EventSet* es = loadmgr->getEvents( bids[idx] );
+	fillEvents( *exp, bids[idx], versions[idx] );
+	if ( !es || !isSame(es->events_,*exp) )
+	    allsame = false;
+    }
+
+    mRunStandardTest( allsame, "Loaded events" );
+    return true;
+}
+
+
+/* The old store cannot be moved aside, as a directory is in the way of its
+   backup: the write fails, and the old store is kept as it was */
+
+static bool testFailedRename( const char* fnm )
+{
+    const BufferString tmpfnm( fnm, ".tmp" );
+    const BufferString bckfnm( fnm, ".bck" );
+    TypeSet<BinID> bids;
+    bids += BinID( 10, 20 );
+    bids += BinID( 10, 21 );
+    bids += BinID( 10, 22 );
+    bids += BinID( 11, 5 );
+    TypeSet<int> versions;
+    versions += 0; versions += 1; versions += 1; versions += 0;
+
+    const FilePath blockerfp( bckfnm, "blocker" );
+    mRunStandardTest( File::createDir(bckfnm) &&
+		      File::putContent(blockerfp.fullPath(),"x"),
+		      "Block the backup" );
+
+    RefMan<EventManager> mgr = new EventManager;
+    TypeSet<BinID> changedbids;
+    changedbids += BinID( 10, 20 );
+    addPositions( *mgr, changedbids, 2 );
+    uiString errmsg;
+    const bool res = EventStore::write( fnm, *mgr, new EventStore(fnm),
+					errmsg );
+    File::removeDir( bckfnm );
+    mRunStandardTest( !res && !errmsg.isEmpty(), "Fail to replace the store" );
+    mRunStandardTest( !File::exists(tmpfnm),
+		      "Temporary file removed after failing" );
+
+    const EventStore store( fnm );
+    if ( !checkStore(store,bids,versions,"after failing") )
+	return false;
+
+    return true;
+}
+
+
+int mTestMainFnName( int argc, char** argv )
+{
+    mInitTestProg();
+
+    const BufferString fnm =
+		FilePath::getTempFullPath( "test_psevents", "psstore" );
+    const bool res = testRoundTrip( fnm ) && testFailedRename( fnm );
+    File::remove( fnm );
+    return res ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "flatposdata.h"
+#include "iopar.h"
+#include "manobjectset.h"
+#include "moddepmgr.h"
+#include "paralleltask.h"
+#include "prestackagc.h"
+#include "prestackgather.h"
+#include "prestackprocessor.h"
+#include "testprog.h"
+#include "zdomain.h"
+
+#include <math.h>
+
+static const int cNrGathers = 24;
+static const int cNrThreads = 4;
+
+
+static RefMan<PreStack::Gather> createGather( int igath )
+{
+    FlatPosData fp;
+    fp.setRange( true, StepInterval<double>(0.,700.,100.) );
+    fp.setRange( false, StepInterval<double>(0.,0.4,0.004) );
+    RefMan<PreStack::Gather> gather = new PreStack::Gather( fp,
+			Seis::OffsetType::OffsetMeter, OD::AngleType::Degrees,
+			ZDomain::TWT() );
+
+    // A top mute of zeros, growing with the offset
+    Array2D<float>& data = gather->data();
+    for ( int itrc=0; itrc<data.getSize(0); itrc++ )
+    {
+	for ( int iz=0; iz<data.getSize(1); iz++ )
+	{
+	    const float amp = 1.f + 0.05f*(igath+1)*iz;
+	    data.set( itrc, iz, iz < 3*itrc ? 0.f
+			: amp * sinf(0.2f*iz + 0.4f*itrc + 0.9f*igath) );
+	}
+    }
+
+    return gather;
+}
+
+
+struct GatherJob
+{
+    ConstRefMan<PreStack::Gather>	input_;
+    ConstRefMan<PreStack::Gather>	output_;
+};
+
+
+static bool processJob( PreStack::ProcessManager& procman, GatherJob& job )
+{
+    job.output_ = nullptr;
+    procman.reset( false );
+    if ( !procman.prepareWork() )
+	return false;
+
+    procman.setInput( BinID::noStepout(), job.input_.ptr() );
+    if ( !procman.process() )
+	return false;
+
+    job.output_ = procman.getOutput();
+    return job.output_;
+}
+
+
+/* As in od_process_prestack: every thread runs its own copy of the chain,
+   cloned through fillPar/usePar */
+
+class ParallelGatherProcessor : public ParallelTask
+{
+public:
+		ParallelGatherProcessor(
+			const PreStack::ProcessManager& procman,
+			ObjectSet<GatherJob>& jobs )
+		    : jobs_(jobs)
+		{
+		    IOPar par;
+		    procman.fillPar( par );
+		    for ( int idx=0; idx<cNrThreads; idx++ )
+		    {
+			auto* copy = new PreStack::ProcessManager(
+						procman.getGeomSystem() );
+			if ( copy->usePar(par) )
+			    procmans_ += copy;
+			else
+			    delete copy;
+		    }
+		}
+
+    const ObjectSet<PreStack::ProcessManager>& procMans() const
+		{ return procmans_; }
+
+protected:
+
+    od_int64	nrIterations() const override	{ return jobs_.size(); }
+    int		maxNrThreads() const override	{ return procmans_.size(); }
+    int		minThreadSize() const override	{ return 1; }
+
+    bool	doWork( od_int64 start, od_int64 stop, int threadidx ) override
+		{
+		    PreStack::ProcessManager& procman = *procmans_[threadidx];
+		    for ( int idx=mCast(int,start); idx<=stop; idx++ )
+		    {
+			if ( !processJob(procman,*jobs_[idx]) )
+			    return false;
+		    }
+
+		    return true;
+		}
+
+    ManagedObjectSet<PreStack::ProcessManager> procmans_;
+    ObjectSet<GatherJob>&	jobs_;
+};
+
+
+static bool isSame( const PreStack::Gather& gather1,
+		    const PreStack::Gather& gather2 )
+{
+    const Array2D<float>& data1 = gather1.data();
+    const Array2D<float>& data2 = gather2.data();
+    if ( data1.getSize(0) != data2.getSize(0) ||
+	 data1.getSize(1) != data2.getSize(1) )
+	return false;
+
+    for ( int itrc=0; itrc<data1.getSize(0); itrc++ )
+    {
+	for ( int iz=0; iz<data1.getSize(1); iz++ )
+	{
+	    if ( !mIsEqual(data1.get(itrc,iz),data2.get(itrc,iz),1e-5f) )
+		return false;
+	}
+    }
+
+    return true;
+}
+
+
+static bool testParallelChains()
+{
+    PreStack::ProcessManager procman( OD::Geom3D );
+    auto* agc = new PreStack::AGC;
+    agc->setWindow( Interval<float>(-40.f,40.f) );
+    agc->setIgnoreZeros( true );
+    procman.addProcessor( agc );
+    auto* lowagc = new PreStack::AGC;
+    lowagc->setWindow( Interval<float>(-100.f,100.f) );
+    lowagc->setLowEnergyMute( 0.1f );
+    procman.addProcessor( lowagc );
+
+    ManagedObjectSet<GatherJob> seqjobs, parjobs;
+    for ( int igath=0; igath<cNrGathers; igath++ )
+    {
+	ConstRefMan<PreStack::Gather> input = createGather( igath );
+	auto* seqjob = new GatherJob;
+	seqjob->input_ = input;
+	seqjobs += seqjob;
+	auto* parjob = new GatherJob;
+	parjob->input_ = input;
+	parjobs += parjob;
+    }
+
+    // Sequential reference with the original chain
+    for ( auto* job : seqjobs )
+	mRunStandardTest( processJob(procman,*job), "Process sequentially" );
+
+    ParallelGatherProcessor parproc( procman, parjobs );
+    const ObjectSet<PreStack::ProcessManager>& procmans = parproc.procMans();
+    mRunStandardTest( procmans.size() == cNrThreads,
+		      "Chain cloned for every thread" );
+    bool samechain = true;
+    for ( const auto* copy : procmans )
+    {
+	const auto* copyagc =
+		dynamic_cast<const PreStack::AGC*>( copy->getProcessor(0) );
+	const auto* copylowagc =
+		dynamic_cast<const PreStack::AGC*>( copy->getProcessor(1) );
+	if ( copy->nrProcessors() != 2 || !copyagc || !copylowagc ||
+	     copyagc == agc || copyagc->getWindow() != agc->getWindow() ||
+	     !copyagc->ignoreZeros() ||
+	     !mIsEqual(copylowagc->getLowEnergyMute(),0.1f,1e-6f) )
+	    samechain = false;
+    }
+
+    mRunStandardTest( samechain, "Cloned chains have the same settings" );
+    mRunStandardTestWithError( parproc.execute(), "Process in parallel",
+			       toString(parproc.uiMessage()) );
+
+    bool sameoutput = true;
+    for ( int igath=0; igath<cNrGathers; igath++ )
+    {
+	const GatherJob& seqjob = *seqjobs[igath];
+	const GatherJob& parjob = *parjobs[igath];
+	if ( !parjob.output_ || !isSame(*seqjob.output_,*parjob.output_) )
+	    sameoutput = false;
+    }
+
+    mRunStandardTest( sameoutput, "Parallel output same as sequential" );
+    mRunStandardTest( StringView(
+			PreStack::ProcessManager::sKeyNrParallelGathers()) ==
+		      "Nr parallel gathers", "Key for the number of threads" );
+    return true;
+}
+
+
+mLoad1Module("PreStackProcessing")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    if ( !testParallelChains() )
+	return false;
+
+    return true;
+}
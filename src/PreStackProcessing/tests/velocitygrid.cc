@@ -0,0 +1,215 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "binidvalset.h"
+#include "moddepmgr.h"
+#include "survgeom.h"
+#include "survinfo.h"
+#include "testprog.h"
+#include "unitofmeasure.h"
+#include "veldesc.h"
+#include "velocityfunctiongrid.h"
+
+static int nrcomputed_ = 0;
+
+/* Scattered source positions, as fractions of the survey size, so that the
+   triangulation is unique */
+
+static const float cSourcePos[][2] = { { 0.f, 0.f }, { 1.f, 0.1f },
+	{ 0.1f, 1.f }, { 0.95f, 0.9f }, { 0.5f, 0.45f }, { 0.2f, 0.6f },
+	{ 0.7f, 0.2f } };
+static const int cNrSources = 7;
+
+
+static BinID getBinID( float inlfrac, float crlfrac )
+{
+    const TrcKeySampling& tks = SI().sampling( false ).hsamp_;
+    return BinID( tks.inlRange().atIndex( mNINT32(inlfrac*(tks.nrInl()-1)) ),
+		  tks.crlRange().atIndex( mNINT32(crlfrac*(tks.nrCrl()-1)) ) );
+}
+
+
+// Linear in the position, so the triangulated gridding is exact
+
+static float getModelVelocity( const BinID& bid, float z )
+{
+    const TrcKeySampling& tks = SI().sampling( false ).hsamp_;
+    const int iinl = tks.inlIdx( bid.inl() );
+    const int icrl = tks.crlIdx( bid.crl() );
+    return 2000.f + 3.f*iinl + 2.f*icrl + 500.f*z;
+}
+
+
+class TestFunction : public Vel::Function
+{
+public:
+		TestFunction( Vel::FunctionSource& src )
+		    : Vel::Function(src)
+		{ copyDescFrom( src ); }
+
+    ZSampling	getAvailableZ() const override	{ return SI().zRange(true); }
+
+protected:
+
+    bool	computeVelocity( float z0, float dz, int sz,
+				 float* res ) const override
+		{
+		    nrcomputed_++;
+		    for ( int idx=0; idx<sz; idx++ )
+			res[idx] = getModelVelocity( bid_, z0+idx*dz );
+
+		    return true;
+		}
+};
+
+
+class TestSource : public Vel::FunctionSource
+{
+public:
+		TestSource()
+		    : desc_(OD::VelocityType::Interval,
+			    UnitOfMeasure::surveyDefVelUnit())
+		{}
+
+    const VelocityDesc& getDesc() const override	{ return desc_; }
+
+    void	getAvailablePositions( BinIDValueSet& bvs ) const override
+		{
+		    for ( int idx=0; idx<cNrSources; idx++ )
+			bvs.add( getBinID(cSourcePos[idx][0],
+					  cSourcePos[idx][1]) );
+		}
+
+    Vel::Function* createFunction( const BinID& bid ) override
+		{
+		    BinIDValueSet bvs( 0, false );
+		    getAvailablePositions( bvs );
+		    if ( !bvs.isValid(bid) )
+			return nullptr;
+
+		    auto* func = new TestFunction( *this );
+		    func->moveTo( bid );
+		    return func;
+		}
+
+protected:
+		~TestSource()
+		{}
+
+    VelocityDesc desc_;
+};
+
+
+static bool hasVelocities( const Vel::Function& func, const BinID& bid )
+{
+    const ZSampling zrg = SI().zRange( true );
+    for ( int idx=0; idx<zrg.nrSteps(); idx+=10 )
+    {
+	const float z = zrg.atIndex( idx );
+	if ( !mIsEqual(func.getVelocity(z),getModelVelocity(bid,z),1e-2f) )
+	    return false;
+    }
+
+    return true;
+}
+
+
+static bool testWeights( Vel::GriddedSource& gs, const BinID& bid )
+{
+    TypeSet<double> weights, cachedweights;
+    TypeSet<int> usedpoints, cachedpoints;
+    mRunStandardTest( gs.getWeights(bid,weights,usedpoints),
+		      "Gridder weights at a trace" );
+
+    double weightsum = 0.;
+    for ( const auto& weight : weights )
+	weightsum += weight;
+
+    mRunStandardTest( weights.size() == usedpoints.size() &&
+		      mIsEqual(weightsum,1.,1e-6), "Weights sum up to one" );
+    mRunStandardTest( gs.getWeights(bid,cachedweights,cachedpoints) &&
+		      cachedweights == weights && cachedpoints == usedpoints,
+		      "Same weights from the cache" );
+    return true;
+}
+
+
+static bool evaluate( Vel::GriddedSource& gs, const BinID& bid,
+		      const char* desc )
+{
+    nrcomputed_ = 0;
+    ConstRefMan<Vel::Function> func = gs.getFunction( bid );
+    mRunStandardTest( func && hasVelocities(*func,bid),
+		      BufferString("Gridded velocities ",desc) );
+    return true;
+}
+
+
+static bool testCache()
+{
+    RefMan<Vel::GriddedSource> gs =
+		new Vel::GriddedSource( Survey::default3DGeomID() );
+    ObjectSet<Vel::FunctionSource> sources;
+    sources += new TestSource;
+    gs->setSource( sources );
+    gs->setMaxNrCachedFunctions( 16 );
+
+    const BinID bid = getBinID( 0.45f, 0.55f );
+    if ( !testWeights(*gs,bid) )
+	return false;
+
+    if ( !evaluate(*gs,bid,"between the sources") )
+	return false;
+
+    mRunStandardTest( nrcomputed_ > 0, "Sources evaluated" );
+
+    // A function recreated at the same trace is not gridded again
+    if ( !evaluate(*gs,bid,"recreated at the same trace") )
+	return false;
+
+    mRunStandardTest( nrcomputed_ == 0, "Gridded velocities from the cache" );
+
+    if ( !evaluate(*gs,getBinID(0.6f,0.4f),"at another trace") )
+	return false;
+
+    mRunStandardTest( nrcomputed_ > 0, "No cache hit at another trace" );
+
+    const BinID sourcebid = getBinID( cSourcePos[4][0], cSourcePos[4][1] );
+    if ( !evaluate(*gs,sourcebid,"at a source position") )
+	return false;
+
+    gs->clearCache();
+    if ( !evaluate(*gs,bid,"after clearing the cache") )
+	return false;
+
+    mRunStandardTest( nrcomputed_ > 0, "Sources evaluated after clearing" );
+
+    gs->setMaxNrCachedFunctions( 0 );
+    if ( !evaluate(*gs,bid,"without a cache") ||
+	 !evaluate(*gs,bid,"again without a cache") )
+	return false;
+
+    mRunStandardTest( nrcomputed_ > 0, "Sources evaluated without a cache" );
+    return true;
+}
+
+
+mLoad1Module("PreStackProcessing")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    if ( !testCache() )
+	return false;
+
+    return true;
+}
@@ -0,0 +1,108 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "arrayndimpl.h"
+#include "flatposdata.h"
+#include "moddepmgr.h"
+#include "prestackgather.h"
+#include "prestackvelocityscan.h"
+#include "testprog.h"
+#include "zdomain.h"
+
+#include <math.h>
+
+static const float cT0s[] = { 0.6f, 1.4f };
+static const float cVels[] = { 2000.f, 3200.f };
+static const int cNrEvents = 2;
+
+
+/* Uncorrected gather with two events on hyperbolic moveout curves */
+
+static RefMan<PreStack::Gather> createGather()
+{
+    FlatPosData fp;
+    fp.setRange( true, StepInterval<double>(0.,2000.,100.) );
+    fp.setRange( false, StepInterval<double>(0.,2.,0.004) );
+    RefMan<PreStack::Gather> gather = new PreStack::Gather( fp,
+			Seis::OffsetType::OffsetMeter, OD::AngleType::Degrees,
+			ZDomain::TWT() );
+    gather->setCorrected( false );
+
+    Array2D<float>& data = gather->data();
+    const ZSampling& zrg = gather->zRange();
+    const float pulsewidth = 0.008f;
+    for ( int itrc=0; itrc<data.getSize(0); itrc++ )
+    {
+	const float offset = gather->getOffset( itrc );
+	for ( int iz=0; iz<data.getSize(1); iz++ )
+	{
+	    const float t = zrg.atIndex( iz );
+	    float val = 0.f;
+	    for ( int iev=0; iev<cNrEvents; iev++ )
+	    {
+		const float tx = Math::Sqrt( cT0s[iev]*cT0s[iev] +
+			offset*offset / (cVels[iev]*cVels[iev]) );
+		const float dt = (t-tx) / pulsewidth;
+		val += expf( -dt*dt );
+	    }
+
+	    data.set( itrc, iz, val );
+	}
+    }
+
+    return gather;
+}
+
+
+static bool testPickedVelocities()
+{
+    RefMan<PreStack::Gather> gather = createGather();
+    PreStack::VelocityScanner scanner;
+    scanner.setVelocityRange( StepInterval<float>(1500.f,4000.f,50.f) );
+    scanner.setWindowSize( 5 );
+
+    const int nrz = gather->data().getSize( PreStack::Gather::zDim() );
+    Array2DImpl<float> panel( scanner.nrVelocities(), nrz );
+    mRunStandardTest( scanner.computePanel(*gather,panel),
+		      "Compute the semblance panel" );
+
+    const ZSampling& zrg = gather->zRange();
+    for ( int iev=0; iev<cNrEvents; iev++ )
+    {
+	const int zidx = zrg.nearestIndex( cT0s[iev] );
+	const float pickedvel = scanner.pickVelocity( panel, zidx );
+	const BufferString desc( "Picked velocity of event ", iev+1 );
+	BufferString err( "Found ", pickedvel, " instead of " );
+	err.add( cVels[iev] );
+	mRunStandardTestWithError(
+		!mIsUdf(pickedvel) && fabs(pickedvel-cVels[iev])<=50.f,
+		desc, err );
+    }
+
+    const int emptyidx = zrg.nearestIndex( 0.2f );
+    mRunStandardTest( mIsUdf(scanner.pickVelocity(panel,emptyidx)),
+		      "No velocity picked without an event" );
+
+    return true;
+}
+
+
+mLoad1Module("PreStackProcessing")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    if ( !testPickedVelocities() )
+	return false;
+
+    return true;
+}
@@ -22,6 +22,7 @@ ________________________________________________________________________
 #include "segyscanner.h"
 #include "segyfiledef.h"
 #include "scaler.h"
+#include "seisimporter.h"
 #include "seisresampler.h"
 #include "seissingtrcproc.h"
 #include "keystrs.h"
@@ -31,6 +32,7 @@ ________________________________________________________________________
 #include "prog.h"
 
 #include "seistrc.h"
+#include "trckeyzsampling.h"
 #include "segytr.h"
 #include "seiswrite.h"
 #include "seisread.h"
@@ -93,6 +95,30 @@ static void splitIOPars( const IOPar& base, ObjectSet<IOPar>& pars )
 }
 
 
+static bool doSortedImport( od_ostream& strm,
+			    const SeisStoreAccess::Setup& ssasuin,
+			    const SeisStoreAccess::Setup& ssasuout,
+			    const IOPar& outpar )
+{
+    auto* rdr = new SeisStdImporterReader( ssasuin, "SEG-Y" );
+    rdr->setScaler( Scaler::get(outpar.find(sKey::Scale())) );
+    rdr->removeNull( outpar.find(SEGY::IO::sKeyNullTrcPol()).toInt() < 1 );
+    TrcKeyZSampling tkzs;
+    if ( tkzs.usePar(outpar) )
+	rdr->setResampler( new SeisResampler(tkzs,false) );
+
+    SeisTrcWriter wrr( ssasuout );
+    SeisImporter imp( rdr, wrr, Seis::Vol );
+    imp.setPipelined( true );
+    imp.setSortInput( true );
+    const bool res = imp.go( strm );
+    if ( !res )
+	strm << imp.uiMessage() << od_endl;
+
+    return res;
+}
+
+
 static bool doImport( od_ostream& strm, const IOPar& iop, Seis::GeomType gt )
 {
     PtrMan<IOPar> inppar = iop.subselect( sKey::Input() );
@@ -142,20 +168,26 @@ static bool doImport( od_ostream& strm, const IOPar& iop, Seis::GeomType gt )
     if ( ssasuout.seldata_ )
 	ssasuin.seldata( ssasuout.seldata_ );
 
-    PtrMan<SeisSingleTraceProc> stp = new SeisSingleTraceProc( ssasuin,
+    bool res;
+    if ( gt == Seis::Vol && outpar->isTrue(SEGY::IO::sKeySortInput()) )
+	res = doSortedImport( strm, ssasuin, ssasuout, *outpar );
+    else
+    {
+	PtrMan<SeisSingleTraceProc> stp = new SeisSingleTraceProc( ssasuin,
 					ssasuout, "SEG-Y importer",
 					toUiString("Importing traces") );
-    if ( !stp->isOK() )
-    {
-	strm.add( stp->errMsg() );
-	return false;
-    }
+	if ( !stp->isOK() )
+	{
+	    strm.add( stp->errMsg() );
+	    return false;
+	}
 
-    const bool is2d = Seis::is2D( gt );
-    stp->setProcPars( *outpar, is2d );
-    const bool res = stp->go( strm );
-    if ( !res )
-	strm << stp->errMsg() << od_endl;
+	const bool is2d = Seis::is2D( gt );
+	stp->setProcPars( *outpar, is2d );
+	res = stp->go( strm );
+	if ( !res )
+	    strm << stp->errMsg() << od_endl;
+    }
 
     if ( gt != Seis::Vol )
 	return res;
@@ -112,6 +112,9 @@ bool BatchProgram::doWork( od_ostream& strm )
     else
 	veldesc = nullptr;
 
+    int batchsize = 0;
+    pars().get( ProcessTime2Depth::sKeyBatchSize(), batchsize );
+
     TaskGroup taskgrp;
     const SeisIOObjInfo seisinfo( inputmid );
     const bool is2d = seisinfo.is2D();
@@ -141,6 +144,7 @@ bool BatchProgram::doWork( od_ostream& strm )
 	    outputcs.hsamp_.setTrcRange( trcrgs[idx] );
 	    auto* exec = new SeisZAxisStretcher( *inputioobj, *outputioobj,
 			outputcs, *ztransform, istime2depth, veldesc.ptr() );
+	    exec->setBatchSize( batchsize );
 	    exec->setName( BufferString("Time to depth conversion - ",
 					Survey::GM().getName(geomids[idx])) );
 	    taskgrp.addTask( exec );
@@ -151,6 +155,7 @@ bool BatchProgram::doWork( od_ostream& strm )
 	auto* exec =
 		new SeisZAxisStretcher( *inputioobj, *outputioobj, outputcs,
 				*ztransform, istime2depth, veldesc.ptr() );
+	exec->setBatchSize( batchsize );
 	exec->setName( "Time to depth conversion");
 	taskgrp.addTask( exec );
     }
@@ -11,20 +11,27 @@ ________________________________________________________________________
 
 #include "binidsorting.h"
 #include "cbvsreadmgr.h"
-#include "ioobj.h"
+#include "file.h"
+#include "filepath.h"
+#include "iostrm.h"
+#include "odsysmem.h"
 #include "ptrman.h"
 #include "scaler.h"
 #include "seisbuf.h"
+#include "seiscbvs.h"
 #include "seisread.h"
 #include "seisresampler.h"
 #include "seisselection.h"
 #include "seistrc.h"
+#include "seistrctr.h"
 #include "seiswrite.h"
 #include "survinfo.h"
 #include "thread.h"
 #include "threadwork.h"
 #include "uistrings.h"
 
+#include <algorithm>
+
 
 SeisImporter::SeisImporter( SeisImporter::Reader* r, SeisTrcWriter& w,
 			    Seis::GeomType gt )
@@ -39,6 +46,8 @@ SeisImporter::SeisImporter( SeisImporter::Reader* r, SeisTrcWriter& w,
     , sortanal_(new BinIDSortingAnalyser(Seis::is2D(gt)))
     , geomtype_(gt)
     , state_( Seis::isPS(gt) ? ReadWrite : ReadBuf )
+    , readlock_(*new Threads::ConditionVar)
+    , readbuf_(*new SeisTrcBuf(true))
 {
     queueid_ = Threads::WorkManager::twm().addQueue(
 					Threads::WorkManager::SingleThread,
@@ -50,9 +59,11 @@ SeisImporter::SeisImporter( SeisImporter::Reader* r, SeisTrcWriter& w,
 
 SeisImporter::~SeisImporter()
 {
+    stopReading();
     Threads::WorkManager::twm().removeQueue( queueid_, false );
 
     buf_.deepErase();
+    removeRuns();
 
     delete rdr_;
     delete sorting_;
@@ -62,6 +73,8 @@ SeisImporter::~SeisImporter()
     delete &trc_;
     delete &prevbid_;
     delete &lock_;
+    delete &readbuf_;
+    delete &readlock_;
 }
 
 
@@ -101,9 +114,46 @@ bool SeisImporter::goImpl( od_ostream* strm, bool first, bool last, int delay )
 }
 
 
+static void sortRun( SeisTrcBuf& buf )
+{
+    const int sz = buf.size();
+    TypeSet<int> idxs( sz, 0 );
+    for ( int idx=0; idx<sz; idx++ )
+	idxs[idx] = idx;
+
+    // Stable, so that traces at identical positions keep their input order
+    std::stable_sort( idxs.arr(), idxs.arr()+sz, [&buf]( int i1, int i2 )
+    {
+	const BinID bid1 = buf.get( i1 )->info().binID();
+	const BinID bid2 = buf.get( i2 )->info().binID();
+	return bid1.inl() < bid2.inl() ||
+	      (bid1.inl() == bid2.inl() && bid1.crl() < bid2.crl());
+    } );
+
+    ObjectSet<SeisTrc> trcs;
+    for ( int idx=0; idx<sz; idx++ )
+	trcs += buf.get( idxs[idx] );
+
+    const bool isowner = buf.isOwner();
+    buf.setIsOwner( false );
+    buf.erase();
+    for ( auto* trc : trcs )
+	buf.add( trc );
+
+    buf.setIsOwner( isowner );
+}
+
+
+void SeisImporter::setSortInput( bool yn, int maxnrtrcsinmem )
+{
+    sortinput_ = yn && !Seis::is2D(geomtype_) && !Seis::isPS(geomtype_);
+    maxnrtrcsinmem_ = maxnrtrcsinmem;
+}
+
+
 #define mDoRead(trc) \
     bool atend = false; \
-    if ( rdr_->fetch(trc) ) \
+    if ( fetch(trc) ) \
 	nrread_++; \
     else \
     { \
@@ -116,6 +166,9 @@ bool SeisImporter::goImpl( od_ostream* strm, bool first, bool last, int delay )
 
 int SeisImporter::nextStep()
 {
+    if ( state_ == MergeRuns )
+	return writeFromRuns();
+
     if ( state_ == WriteBuf )
     {
 	Threads::MutexLocker lock( lock_ );
@@ -129,6 +182,9 @@ int SeisImporter::nextStep()
 	else
 	{
 	    PtrMan<SeisTrc> trc = buf_.remove( ((int)0) );
+	    if ( sortinput_ && !sortedTrcOk(*trc) )
+		return ErrorOccurred();
+
 	    return doWrite( *trc );
 	}
     }
@@ -254,6 +310,20 @@ int SeisImporter::readIntoBuf()
 	    return ErrorOccurred();
 	}
 
+	if ( sortinput_ )
+	{
+	    if ( !runioobjs_.isEmpty() )
+	    {
+		if ( !spillRun() || !openRuns() )
+		    return ErrorOccurred();
+
+		state_ = MergeRuns;
+		return MoreToDo();
+	    }
+
+	    sortRun( buf_ );
+	}
+
 	state_ = buf_.isEmpty() ? ReadWrite : WriteBuf;
 	return MoreToDo();
     }
@@ -267,6 +337,25 @@ int SeisImporter::readIntoBuf()
     else
     {
 	buf_.add( trc );
+	if ( sortinput_ )
+	{
+	    if ( maxnrtrcsinmem_ < 1 )
+	    {
+		od_int64 totmem, freemem;
+		OD::getSystemMemory( totmem, freemem );
+		const od_int64 trcsz = sizeof(float) * trc->size() *
+				       trc->nrComponents() + sizeof(SeisTrc);
+		maxnrtrcsinmem_ = mCast(int,freemem / 4 / trcsz);
+		if ( maxnrtrcsinmem_ < 1000 )
+		    maxnrtrcsinmem_ = 1000;
+	    }
+
+	    if ( buf_.size() >= maxnrtrcsinmem_ && !spillRun() )
+		return ErrorOccurred();
+
+	    return MoreToDo();
+	}
+
 	if ( !sortingOk(*trc) )
 	    return ErrorOccurred();
 	if ( !sortanal_ )
@@ -367,6 +456,245 @@ bool SeisImporter::sortingOk( const SeisTrc& trc )
 }
 
 
+bool SeisImporter::sortedTrcOk( const SeisTrc& trc )
+{
+    // The checks of the unsorted input, done on the sorted output
+    nrsamepos_ = trc.info().binID() == prevbid_ ? nrsamepos_+1 : 0;
+    if ( nrsamepos_ > 999 )
+    {
+	errmsg_ = tr("Input contains too many (1000+) identical positions");
+	return false;
+    }
+
+    return sortingOk( trc );
+}
+
+
+class SeisImporterReaderTask : public Task
+{
+public:
+    SeisImporterReaderTask( SeisImporter& imp )
+	: importer_( imp )
+    {}
+
+    bool execute() override
+    {
+	importer_.readAhead();
+	return true;
+    }
+
+protected:
+
+    SeisImporter&	importer_;
+};
+
+
+bool SeisImporter::fetch( SeisTrc& trc )
+{
+    if ( !pipelined_ )
+	return rdr_->fetch( trc );
+
+    if ( readqueueid_ < 0 )
+	startReading();
+
+    Threads::MutexLocker lock( readlock_ );
+    while ( readbuf_.isEmpty() && !readdone_ )
+	readlock_.wait();
+
+    if ( readbuf_.isEmpty() )
+	return false; // errmsg_ of the reader is set by readAhead()
+
+    PtrMan<SeisTrc> rdtrc = readbuf_.remove( 0 );
+    readlock_.signal( true );
+    lock.unLock();
+
+    trc = *rdtrc;
+    return true;
+}
+
+
+void SeisImporter::startReading()
+{
+    readqueueid_ = Threads::WorkManager::twm().addQueue(
+					Threads::WorkManager::SingleThread,
+					"SeisImporter reader");
+    Task* task = new SeisImporterReaderTask( *this );
+    Threads::WorkManager::twm().addWork( Threads::Work(*task,true), 0,
+					 readqueueid_, false );
+}
+
+
+void SeisImporter::stopReading()
+{
+    if ( readqueueid_ < 0 )
+	return;
+
+    Threads::MutexLocker lock( readlock_ );
+    stopreading_ = true;
+    readlock_.signal( true );
+    lock.unLock();
+
+    Threads::WorkManager::twm().emptyQueue( readqueueid_, true );
+    Threads::WorkManager::twm().removeQueue( readqueueid_, false );
+    readqueueid_ = -1;
+    readbuf_.deepErase();
+}
+
+
+void SeisImporter::readAhead()
+{
+    while ( true )
+    {
+	auto* trc = new SeisTrc;
+	const bool isok = rdr_->fetch( *trc );
+
+	Threads::MutexLocker lock( readlock_ );
+	if ( !isok || stopreading_ )
+	{
+	    delete trc;
+	    readdone_ = true;
+	    readlock_.signal( true );
+	    return;
+	}
+
+	readbuf_.add( trc );
+	readlock_.signal( true );
+	while ( readbuf_.size() >= maxqueuesize_ && !stopreading_ )
+	    readlock_.wait();
+    }
+}
+
+
+bool SeisImporter::spillRun()
+{
+    if ( buf_.isEmpty() )
+	return true;
+
+    if ( rundirnm_.isEmpty() )
+    {
+	rundirnm_ = FilePath::getTempFullPath( "seisimp_runs", nullptr );
+	if ( !File::createDir(rundirnm_) )
+	{
+	    errmsg_ = uiStrings::phrCannotCreateDirectory(
+						toUiString(rundirnm_) );
+	    rundirnm_.setEmpty();
+	    return false;
+	}
+    }
+
+    sortRun( buf_ );
+
+    BufferString fnm( "run_" );
+    fnm.add( runioobjs_.size() ).add( ".cbvs" );
+    const FilePath fp( rundirnm_, fnm );
+    const MultiID tmpid( 100010, IOObj::tmpID() );
+    auto* iostrm = new IOStream( "_tmp_SeisImporter_run",
+				 DBKey(tmpid,SI().diskLocation()) );
+    iostrm->setGroup( mTranslGroupName(SeisTrc) );
+    iostrm->setTranslator( CBVSSeisTrcTranslator::translKey() );
+    iostrm->fileSpec().setFileName( fp.fullPath() );
+    runioobjs_ += iostrm;
+
+    SeisTrcWriter wrr( *iostrm );
+    for ( int idx=0; idx<buf_.size(); idx++ )
+    {
+	if ( !wrr.put(*buf_.get(idx)) )
+	{
+	    errmsg_ = wrr.errMsg();
+	    return false;
+	}
+    }
+
+    if ( !wrr.close() )
+    {
+	errmsg_ = wrr.errMsg();
+	return false;
+    }
+
+    buf_.deepErase();
+    return true;
+}
+
+
+bool SeisImporter::openRuns()
+{
+    runtrcs_.setNullAllowed();
+    for ( const auto* ioobj : runioobjs_ )
+    {
+	auto* rdr = new SeisTrcReader( *ioobj );
+	auto* trc = new SeisTrc;
+	if ( !rdr->prepareWork() || !rdr->get(*trc) )
+	{
+	    errmsg_ = rdr->errMsg();
+	    delete rdr; delete trc;
+	    if ( errmsg_.isEmpty() )
+		continue;
+
+	    return false;
+	}
+
+	runrdrs_ += rdr;
+	runtrcs_ += trc;
+    }
+
+    return true;
+}
+
+
+int SeisImporter::writeFromRuns()
+{
+    int runidx = -1;
+    BinID curbid;
+    for ( int idx=0; idx<runtrcs_.size(); idx++ )
+    {
+	const SeisTrc* trc = runtrcs_[idx];
+	if ( !trc )
+	    continue;
+
+	const BinID bid = trc->info().binID();
+	if ( runidx < 0 || bid.inl() < curbid.inl() ||
+	     (bid.inl() == curbid.inl() && bid.crl() < curbid.crl()) )
+	{
+	    runidx = idx;
+	    curbid = bid;
+	}
+    }
+
+    if ( runidx < 0 )
+    {
+	Threads::WorkManager::twm().emptyQueue( queueid_, true );
+	Threads::MutexLocker lock( lock_ );
+	return errmsg_.isEmpty() ? Finished() : ErrorOccurred();
+    }
+
+    SeisTrc* trc = runtrcs_[runidx];
+    if ( !sortedTrcOk(*trc) )
+	return ErrorOccurred();
+
+    const int res = doWrite( *trc );
+    if ( !runrdrs_[runidx]->get(*trc) )
+    {
+	errmsg_ = runrdrs_[runidx]->errMsg();
+	if ( !errmsg_.isEmpty() )
+	    return ErrorOccurred();
+
+	delete runtrcs_.replace( runidx, nullptr );
+    }
+
+    return res;
+}
+
+
+void SeisImporter::removeRuns()
+{
+    deepErase( runrdrs_ );
+    deepErase( runtrcs_ );
+    runioobjs_.setEmpty();
+    if ( !rundirnm_.isEmpty() && File::isDirectory(rundirnm_) )
+	File::removeDir( rundirnm_ );
+}
+
+
 // SeisStdImporterReader
 
 SeisStdImporterReader::SeisStdImporterReader( const SeisStoreAccess::Setup& su,
@@ -733,6 +733,23 @@ RefMan<FloatDistrib> SeisIOObjInfo::getDataDistribution( int icomp ) const
     }
 
     // No .stats file. Extract stats right now
+    if ( !is2D() && !isPS() )
+    {
+	// A partial scan of about 100k samples, stored as the .stats
+	SpaceInfo si;
+	getDefSpaceInfo( si );
+	const int nrsamps = si.expectednrsamps > 0 ? si.expectednrsamps : 1;
+	const int nrtrcs = 100000 / nrsamps;
+	Seis::ParallelStatsCollector collector( *ioobj_, allcomps ? -1 : icomp );
+	collector.setNrSampledTraces( nrtrcs < 10 ? 10 : nrtrcs );
+	if ( collector.execute() )
+	{
+	    ret = &collector.result().distribution();
+	    if ( !ret->isEmpty() )
+		return ret;
+	}
+    }
+
     SeisTrcReader rdr( *ioobj_ );
     if ( !allcomps )
 	rdr.setComponent( icomp );
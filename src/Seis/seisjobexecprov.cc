@@ -10,6 +10,7 @@ ________________________________________________________________________
 #include "seisjobexecprov.h"
 
 #include "batchjobdispatch.h"
+#include "bufstringset.h"
 #include "cbvsreader.h"
 #include "ctxtioobj.h"
 #include "genc.h"
@@ -31,6 +32,7 @@ ________________________________________________________________________
 #include "ptrman.h"
 #include "seiscbvs.h"
 #include "seis2ddata.h"
+#include "seismerge.h"
 #include "seissingtrcproc.h"
 #include "strmdata.h"
 #include "separstr.h"
@@ -249,6 +251,32 @@ void SeisJobExecProv::getMissingLines( TypeSet<int>& inlnrs ) const
 }
 
 
+void SeisJobExecProv::getTempFiles( BufferStringSet& fnms ) const
+{
+    // Only the files of the jobs, not the CBVS split or auxiliary files
+    FilePath basefp( iopar_.find(sKey::TmpStor()) );
+    for ( int inl=todoinls_.start_; inl<=todoinls_.stop_; inl+=todoinls_.step_ )
+    {
+	BufferString fnm( "i." ); fnm += inl;
+	FilePath fp( basefp, fnm );
+	fnm = fp.fullPath();
+	od_istream* strm = new od_istream( fnm );
+	if ( !strm->isOK() )
+	{
+	    delete strm;
+	    continue;
+	}
+
+	CBVSReader rdr( strm, false ); // stream closed by reader
+	if ( rdr.errMsg() )
+	    continue;
+
+	fnms.add( fnm );
+	inl = rdr.info().geom_.stop_.inl();
+    }
+}
+
+
 MultiID SeisJobExecProv::tempStorID() const
 {
     FilePath fp( iopar_.find(sKey::TmpStor()) );
@@ -310,6 +338,11 @@ Executor* SeisJobExecProv::getPostProcessor()
     if ( !inioobj || !outioobj )
 	return nullptr;
 
+    BufferStringSet fnms;
+    getTempFiles( fnms );
+    if ( fnms.size() > 1 )
+	return new SeisParallelMerger( fnms, *outioobj, &iopar_ );
+
     return new SeisSingleTraceProc( *inioobj, *outioobj,
 				    "Data transfer", &iopar_,
 				    tr("Writing results to output cube") );
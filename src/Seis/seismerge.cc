@@ -21,12 +21,77 @@ ________________________________________________________________________
 #include "ioobj.h"
 #include "keystrs.h"
 #include "oddirs.h"
+#include "paralleltask.h"
 #include "scaler.h"
+#include "sorting.h"
 #include "survinfo.h"
 #include "trckeyzsampling.h"
 #include <iostream>
 
 
+static SeisTrc* getMergedTrc( SeisTrcBuf& buf, bool stack )
+{
+    int nrtrcs = buf.size();
+    if ( nrtrcs < 1 )
+	return nullptr;
+    else if ( nrtrcs == 1 )
+	return buf.remove( 0 );
+
+    SeisTrcBuf nulltrcs( false );
+    for ( int idx=nrtrcs-1; idx>-1; idx-- )
+    {
+	if ( buf.get(idx)->isNull() )
+	    nulltrcs.add( buf.remove(idx) );
+    }
+
+    nrtrcs = buf.size();
+    SeisTrc* ret = nullptr;
+    if ( nrtrcs < 1 )
+	ret = nulltrcs.remove(0);
+
+    if ( nrtrcs == 1 )
+	ret = buf.remove( 0 );
+
+    nulltrcs.deepErase();
+    if ( ret )
+	return ret;
+
+    SeisTrc& trc( *buf.get(0) );
+    if ( stack )
+    {
+	SeisTrcPropChg stckr( trc );
+	for ( int idx=1; idx<nrtrcs; idx++ )
+	    stckr.stack( *buf.get(idx), false, mCast(float,idx) );
+    }
+
+    ret = buf.remove( 0 );
+    buf.deepErase();
+    return ret;
+}
+
+
+static SeisTrc* getConformedTrc( SeisTrc* trc, int nrsamps,
+				 const SamplingData<float>& sd )
+{
+    if ( trc->size() == nrsamps && trc->info().sampling_ == sd )
+	return trc;
+
+    SeisTrc* newtrc = new SeisTrc( *trc );
+    newtrc->info().sampling_ = sd;
+    newtrc->reSize( nrsamps, false );
+    const int nrcomps = trc->nrComponents();
+    for ( int isamp=0; isamp<nrsamps; isamp++ )
+    {
+	const float z = newtrc->info().samplePos(isamp);
+	for ( int icomp=0; icomp<nrcomps; icomp++ )
+	    newtrc->set( isamp, trc->getValue(z,icomp), icomp );
+    }
+
+    delete trc;
+    return newtrc;
+}
+
+
 SeisMerger::SeisMerger( const ObjectSet<IOPar>& iops, const IOPar& outiop,
 			bool is2d )
     : Executor(is2d?"Merging line parts":"Merging cubes")
@@ -301,42 +366,7 @@ void SeisMerger::get3DTraces()
 
 SeisTrc* SeisMerger::getStacked( SeisTrcBuf& buf )
 {
-    int nrtrcs = buf.size();
-    if ( nrtrcs < 1 )
-	return 0;
-    else if ( nrtrcs == 1 )
-	return buf.remove( 0 );
-
-    SeisTrcBuf nulltrcs( false );
-    for ( int idx=nrtrcs-1; idx>-1; idx-- )
-    {
-	if ( buf.get(idx)->isNull() )
-	    nulltrcs.add( buf.remove(idx) );
-    }
-
-    nrtrcs = buf.size();
-    SeisTrc* ret = 0;
-    if ( nrtrcs < 1 )
-	ret = nulltrcs.remove(0);
-
-    if ( nrtrcs == 1 )
-	ret = buf.remove( 0 );
-
-    nulltrcs.deepErase();
-    if ( ret )
-	return ret;
-
-    SeisTrc& trc( *buf.get(0) );
-    if ( stacktrcs_ )
-    {
-	SeisTrcPropChg stckr( trc );
-	for ( int idx=1; idx<nrtrcs; idx++ )
-	    stckr.stack( *buf.get(idx), false, mCast(float,idx) );
-    }
-
-    ret = buf.remove( 0 );
-    buf.deepErase();
-    return ret;
+    return getMergedTrc( buf, stacktrcs_ );
 }
 
 
@@ -363,21 +393,8 @@ int SeisMerger::writeTrc( SeisTrc* trc )
 	nrsamps_ = trc->size();
 	sd_ = trc->info().sampling_;
     }
-    else if ( trc->size() != nrsamps_ || trc->info().sampling_ != sd_ )
-    {
-	SeisTrc* newtrc = new SeisTrc(*trc);
-	newtrc->info().sampling_ = sd_;
-	newtrc->reSize( nrsamps_, false );
-	const int nrcomps = trc->nrComponents();
-	for ( int isamp=0; isamp<nrsamps_; isamp++ )
-	{
-	    const float z = newtrc->info().samplePos(isamp);
-	    for ( int icomp=0; icomp<nrcomps; icomp++ )
-		newtrc->set( isamp, trc->getValue(z,icomp), icomp );
-	}
-
-	delete trc; trc = newtrc;
-    }
+    else
+	trc = getConformedTrc( trc, nrsamps_, sd_ );
 
     if ( scaler_ ) trc->data().scale( *scaler_ );
     bool ret = wrr_->put( *trc );
@@ -417,3 +434,474 @@ int SeisMerger::writeFromBuf()
 
     return writeTrc( getStacked(tmp) );
 }
+
+
+// SeisParallelMerger
+
+class SeisParallelMergerReader : public ParallelTask
+{ mODTextTranslationClass(SeisParallelMergerReader)
+public:
+
+SeisParallelMergerReader( SeisParallelMerger& mrgr,
+			  const TypeSet<int>& rdridxs )
+    : ParallelTask("Reading traces")
+    , mrgr_(mrgr)
+    , rdridxs_(rdridxs)
+{}
+
+uiString uiMessage() const override
+{ return errmsg_.isEmpty() ? tr("Reading traces") : errmsg_; }
+
+uiString uiNrDoneText() const override
+{ return tr("Inputs read"); }
+
+protected:
+
+od_int64 nrIterations() const override
+{ return rdridxs_.size(); }
+
+bool doWork( od_int64 start, od_int64 stop, int ) override
+{
+    for ( int idx=mCast(int,start); idx<=stop && shouldContinue(); idx++ )
+    {
+	const int rdridx = rdridxs_[idx];
+	SeisTrcReader& rdr = *mrgr_.rdrs_[rdridx];
+	SeisTrcBuf& buf = *mrgr_.bufs_[rdridx];
+	while ( buf.size() < mrgr_.lookahead_ )
+	{
+	    auto* trc = new SeisTrc;
+	    if ( !rdr.get(*trc) )
+	    {
+		delete trc;
+		if ( !rdr.errMsg().isEmpty() )
+		{
+		    Threads::MutexLocker lckr( errlock_ );
+		    errmsg_ = rdr.errMsg();
+		    return false;
+		}
+
+		mrgr_.atend_[rdridx] = true;
+		break;
+	    }
+
+	    buf.add( trc );
+	}
+
+	addToNrDone( 1 );
+    }
+
+    return true;
+}
+
+    SeisParallelMerger&		mrgr_;
+    const TypeSet<int>&		rdridxs_;
+    Threads::Mutex		errlock_;
+    uiString			errmsg_;
+
+};
+
+
+class SeisParallelMergerStacker : public ParallelTask
+{ mODTextTranslationClass(SeisParallelMergerStacker)
+public:
+
+SeisParallelMergerStacker( const SeisParallelMerger& mrgr,
+			   ObjectSet<SeisTrcBuf>& grps,
+			   ObjectSet<SeisTrc>& outtrcs )
+    : ParallelTask("Stacking traces")
+    , mrgr_(mrgr)
+    , grps_(grps)
+    , outtrcs_(outtrcs)
+{
+    outtrcs_.setNullAllowed();
+    for ( int idx=0; idx<grps_.size(); idx++ )
+	outtrcs_.add( nullptr );
+}
+
+uiString uiMessage() const override
+{ return tr("Stacking traces"); }
+
+uiString uiNrDoneText() const override
+{ return sPosFinished(); }
+
+protected:
+
+od_int64 nrIterations() const override
+{ return grps_.size(); }
+
+bool doWork( od_int64 start, od_int64 stop, int ) override
+{
+    for ( int idx=mCast(int,start); idx<=stop && shouldContinue(); idx++ )
+    {
+	SeisTrc* trc = getMergedTrc( *grps_[idx], mrgr_.stacktrcs_ );
+	if ( !trc )
+	    continue;
+
+	trc = getConformedTrc( trc, mrgr_.nrsamps_, mrgr_.sd_ );
+	if ( mrgr_.scaler_ )
+	    trc->data().scale( *mrgr_.scaler_ );
+
+	outtrcs_.replace( idx, trc );
+	addToNrDone( 1 );
+    }
+
+    return true;
+}
+
+    const SeisParallelMerger&	mrgr_;
+    ObjectSet<SeisTrcBuf>&	grps_;
+    ObjectSet<SeisTrc>&		outtrcs_;
+
+};
+
+
+SeisParallelMerger::SeisParallelMerger( const ObjectSet<IOPar>& iops,
+					const IOPar& outiop )
+    : Executor("Merging cubes")
+{
+    if ( iops.isEmpty() )
+    {
+	errmsg_ = tr("Nothing to merge");
+	return;
+    }
+
+    const Seis::GeomType gt = Seis::Vol;
+    for ( const auto* iop : iops )
+    {
+	PtrMan<IOObj> newobj = SeisStoreAccess::getFromPar( *iop );
+	if ( !newobj )
+	    continue;
+
+	auto* newrdr = new SeisTrcReader( *newobj, &gt );
+	newrdr->usePar( *iop );
+	addReader( newrdr );
+    }
+
+    setTotalNr();
+    PtrMan<IOObj> outobj = SeisStoreAccess::getFromPar( outiop );
+    if ( outobj )
+	setOutput( *outobj, &outiop );
+}
+
+
+SeisParallelMerger::SeisParallelMerger( const BufferStringSet& infnms,
+					const IOObj& out, const IOPar* outpars )
+    : Executor("Merging cubes")
+{
+    if ( infnms.isEmpty() )
+    {
+	errmsg_ = tr("Nothing to merge");
+	return;
+    }
+
+    for ( const auto* fnm : infnms )
+	addReader( new SeisTrcReader(fnm->buf()) );
+
+    setTotalNr();
+    setOutput( out, outpars );
+}
+
+
+SeisParallelMerger::~SeisParallelMerger()
+{
+    if ( seqwrr_ )
+	seqwrr_->finishWrite();
+
+    delete seqwrr_;
+    delete wrr_;
+    deepErase( bufs_ );
+    deepErase( rdrs_ );
+    delete scaler_;
+}
+
+
+bool SeisParallelMerger::addReader( SeisTrcReader* rdr )
+{
+    if ( !rdr->prepareWork() )
+    {
+	errmsg_ = rdr->errMsg();
+	delete rdr;
+	return false;
+    }
+
+    // The inputs' own sampling is kept, not the survey's
+    StepInterval<float> zrg( mUdf(float), -mUdf(float), mUdf(float) );
+    if ( nrsamps_ > 0 )
+	zrg = sd_.interval( nrsamps_ );
+
+    PtrMan<Seis::Bounds> rgs = rdr->getBounds();
+    if ( rgs )
+    {
+	const StepInterval<float> rdrzrg = rgs->getZRange();
+	if ( mIsUdf(zrg.step_) )
+	    zrg.step_ = rdrzrg.step_;
+
+	zrg.include( rdrzrg, false );
+    }
+
+    if ( !mIsUdf(zrg.start_) && !mIsUdf(zrg.stop_) && !mIsUdf(zrg.step_) )
+    {
+	sd_.start_ = zrg.start_; sd_.step_ = zrg.step_;
+	nrsamps_ = zrg.nrSteps() + 1;
+    }
+
+    rdrs_ += rdr;
+    bufs_ += new SeisTrcBuf( true );
+    atend_ += false;
+    return true;
+}
+
+
+static od_int64 getNrUniquePositions( const TypeSet<TrcKeySampling>& tkss )
+{
+    if ( tkss.isEmpty() )
+	return -1;
+
+    TrcKeySampling all( tkss.first() );
+    for ( const auto& tks : tkss )
+	all.include( tks );
+
+    const int crlstep = all.step_.crl() > 0 ? all.step_.crl() : 1;
+    od_int64 nrpos = 0;
+    const StepInterval<int> inlrg = all.lineRange();
+    for ( int inl=inlrg.start_; inl<=inlrg.stop_; inl+=inlrg.step_ )
+    {
+	TypeSet<int> crlstarts, crlstops;
+	for ( const auto& tks : tkss )
+	{
+	    if ( !tks.lineOK(inl) )
+		continue;
+
+	    crlstarts += tks.start_.crl();
+	    crlstops += tks.stop_.crl();
+	}
+
+	// Overlapping cross-line ranges are counted once
+	sort_coupled( crlstarts.arr(), crlstops.arr(), crlstarts.size() );
+	int nextcrl = mUdf(int);
+	for ( int idx=0; idx<crlstarts.size(); idx++ )
+	{
+	    int start = crlstarts[idx];
+	    if ( !mIsUdf(nextcrl) && start < nextcrl )
+		start = nextcrl;
+
+	    if ( start > crlstops[idx] )
+		continue;
+
+	    nrpos += (crlstops[idx] - start) / crlstep + 1;
+	    nextcrl = crlstops[idx] + crlstep;
+	}
+
+	if ( inlrg.step_ < 1 )
+	    break;
+    }
+
+    return nrpos;
+}
+
+
+void SeisParallelMerger::setTotalNr()
+{
+    TypeSet<TrcKeySampling> tkss;
+    for ( auto* rdr : rdrs_ )
+    {
+	PtrMan<Seis::Bounds> rgs = rdr->getBounds();
+	mDynamicCastGet(const Seis::Bounds3D*,rgs3d,rgs.ptr())
+	if ( rgs3d )
+	    tkss += rgs3d->tkzs_.hsamp_;
+    }
+
+    totnrpos_ = getNrUniquePositions( tkss );
+}
+
+
+void SeisParallelMerger::setOutput( const IOObj& out, const IOPar* iop )
+{
+    if ( rdrs_.isEmpty() )
+    {
+	if ( errmsg_.isEmpty() )
+	    errmsg_ = tr("Nothing to merge");
+	return;
+    }
+
+    const Seis::GeomType gt = Seis::Vol;
+    SeisStoreAccess::Setup wrsu( out, &gt );
+    if ( iop )
+	wrsu.usePar( *iop );
+
+    wrr_ = new SeisTrcWriter( wrsu );
+
+    if ( !wrr_->errMsg().isEmpty() )
+    {
+	errmsg_ = wrr_->errMsg();
+	deleteAndNullPtr( wrr_ );
+	return;
+    }
+
+    seqwrr_ = new SeisSequentialWriter( wrr_ );
+}
+
+
+uiString SeisParallelMerger::uiMessage() const
+{
+    return errmsg_.isEmpty() ? tr("Handling traces") : errmsg_;
+}
+
+
+void SeisParallelMerger::setScaler( Scaler* scaler )
+{
+    delete scaler_;
+    scaler_ = scaler;
+}
+
+
+void SeisParallelMerger::setLookAhead( int nrtrcs )
+{
+    lookahead_ = nrtrcs < 1 ? 1 : nrtrcs;
+}
+
+
+int SeisParallelMerger::nextStep()
+{
+    if ( !seqwrr_ )
+	return ErrorOccurred();
+
+    if ( !fillBuffers() )
+	return ErrorOccurred();
+
+    ManagedObjectSet<SeisTrcBuf> grps;
+    getNextBatch( grps );
+    if ( grps.isEmpty() )
+	return finish();
+
+    return writeBatch( grps ) ? MoreToDo() : ErrorOccurred();
+}
+
+
+bool SeisParallelMerger::fillBuffers()
+{
+    TypeSet<int> rdridxs;
+    for ( int idx=0; idx<rdrs_.size(); idx++ )
+    {
+	if ( !atend_[idx] && bufs_[idx]->size() < lookahead_ )
+	    rdridxs += idx;
+    }
+
+    if ( rdridxs.isEmpty() )
+	return true;
+
+    SeisParallelMergerReader reader( *this, rdridxs );
+    if ( !reader.execute() )
+    {
+	errmsg_ = reader.uiMessage();
+	return false;
+    }
+
+    return true;
+}
+
+
+void SeisParallelMerger::getNextBatch( ObjectSet<SeisTrcBuf>& grps )
+{
+    while ( grps.size() < lookahead_ )
+    {
+	BinID curbid = BinID::udf();
+	for ( int idx=0; idx<bufs_.size(); idx++ )
+	{
+	    const SeisTrcBuf& buf = *bufs_[idx];
+	    if ( buf.isEmpty() )
+	    {
+		if ( atend_[idx] )
+		    continue;
+
+		return; // Cannot decide on the next position before reading
+	    }
+
+	    const BinID bid = buf.first()->info().binID();
+	    if ( curbid.isUdf() || bid.inl() < curbid.inl() ||
+		 (bid.inl() == curbid.inl() && bid.crl() < curbid.crl()) )
+		curbid = bid;
+	}
+
+	if ( curbid.isUdf() )
+	    return;
+
+	auto* grp = new SeisTrcBuf( true );
+	for ( auto* buf : bufs_ )
+	{
+	    while ( !buf->isEmpty() && buf->first()->info().binID() == curbid )
+		grp->add( buf->remove(0) );
+	}
+
+	grps += grp;
+    }
+}
+
+
+bool SeisParallelMerger::writeBatch( ObjectSet<SeisTrcBuf>& grps )
+{
+    if ( nrsamps_ < 1 )
+    {
+	const SeisTrc* trc0 = grps.first()->first();
+	nrsamps_ = trc0->size();
+	sd_ = trc0->info().sampling_;
+    }
+
+    ObjectSet<SeisTrc> trcs;
+    SeisParallelMergerStacker stacker( *this, grps, trcs );
+    if ( !stacker.execute() )
+    {
+	deepErase( trcs );
+	errmsg_ = tr("Cannot stack traces");
+	return false;
+    }
+
+    for ( const auto* trc : trcs )
+    {
+	if ( trc && !seqwrr_->announceTrace(trc->info().binID()) )
+	{
+	    errmsg_ = seqwrr_->errMsg();
+	    deepErase( trcs );
+	    return false;
+	}
+    }
+
+    bool res = true;
+    for ( auto* trc : trcs )
+    {
+	if ( !trc )
+	    continue;
+
+	if ( res )
+	{
+	    res = seqwrr_->submitTrace( trc, true );
+	    nrpos_++;
+	}
+	else
+	    delete trc;
+    }
+
+    if ( !res )
+	errmsg_ = seqwrr_->errMsg();
+
+    return res;
+}
+
+
+int SeisParallelMerger::finish()
+{
+    const bool res = seqwrr_->finishWrite();
+    if ( !res )
+    {
+	errmsg_ = seqwrr_->errMsg();
+	return ErrorOccurred();
+    }
+
+    if ( !wrr_->close() )
+    {
+	errmsg_ = wrr_->errMsg();
+	return ErrorOccurred();
+    }
+
+    return Finished();
+}
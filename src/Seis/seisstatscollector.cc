@@ -10,10 +10,17 @@ ________________________________________________________________________
 #include "seisstatscollector.h"
 
 #include "seistrc.h"
+#include "seisbounds.h"
+#include "seisread.h"
+#include "seistrctr.h"
 #include "statrand.h"
 #include "despiker.h"
 #include "datadistributiontools.h"
 #include "datadistributionextracter.h"
+#include "filepath.h"
+#include "ioobj.h"
+#include "iopar.h"
+#include "keystrs.h"
 
 static const int cSampleBufferSize = 1048576;
 
@@ -136,6 +143,66 @@ void Seis::StatsCollector::useTrace( const SeisTrc& trc )
 }
 
 
+void Seis::StatsCollector::merge( const StatsCollector& oth )
+{
+    if ( !vals_ || oth.nrtrcshandled_ < 1 )
+	return;
+
+    if ( nrtrcshandled_ < 1 )
+	tkzs_ = oth.tkzs_;
+    else
+    {
+	TrcKeySampling& tks = tkzs_.hsamp_;
+	const TrcKeySampling& othtks = oth.tkzs_.hsamp_;
+	const BinID step = tks.step_;
+	tks.include( othtks, true );
+	tks.step_ = step;
+	updateStepNr( step.lineNr(), step.lineNr()+othtks.step_.lineNr(),
+		      tks.step_.lineNr() );
+	updateStepNr( step.trcNr(), step.trcNr()+othtks.step_.trcNr(),
+		      tks.step_.trcNr() );
+	tkzs_.zsamp_.include( oth.tkzs_.zsamp_.start_, false );
+	tkzs_.zsamp_.include( oth.tkzs_.zsamp_.stop_, false );
+    }
+
+    if ( !mIsUdf(oth.valrg_.start_) )
+    {
+	if ( nrvalshandled_ < 1 )
+	    valrg_ = oth.valrg_;
+	else
+	{
+	    valrg_.include( oth.valrg_.start_, false );
+	    valrg_.include( oth.valrg_.stop_, false );
+	}
+    }
+
+    if ( !mIsUdf(oth.offsrg_.start_) )
+    {
+	if ( mIsUdf(offsrg_.start_) || offsrg_.start_ > oth.offsrg_.start_ )
+	    offsrg_.start_ = oth.offsrg_.start_;
+	if ( offsrg_.stop_ < oth.offsrg_.stop_ )
+	    offsrg_.stop_ = oth.offsrg_.stop_;
+    }
+
+    for ( int idx=0; idx<oth.nrvalscollected_; idx++ )
+    {
+	if ( nrvalscollected_ < cSampleBufferSize )
+	    vals_[nrvalscollected_++] = oth.vals_[idx];
+	else
+	{
+	    const od_int64 replidx = gen_.getIndex( nrvalshandled_+idx+1 );
+	    if ( replidx < cSampleBufferSize )
+		vals_[replidx] = oth.vals_[idx];
+	}
+    }
+
+    nrtrcshandled_ += oth.nrtrcshandled_;
+    nrvalshandled_ += oth.nrvalshandled_;
+    totalnrsamples_ += oth.totalnrsamples_;
+    distrib_ = nullptr;
+}
+
+
 bool Seis::StatsCollector::finish() const
 {
     if ( distrib_ )
@@ -224,3 +291,215 @@ od_int64 Seis::StatsCollector::getNrTraces( const IOPar& iop )
     iop.get( "Count.Traces", nrtrcs );
     return nrtrcs;
 }
+
+
+
+// Seis::ParallelStatsCollector
+
+Seis::ParallelStatsCollector::ParallelStatsCollector( const IOObj& ioobj,
+						      int icomp )
+    : ParallelTask("Data statistics collector")
+    , ioobj_(ioobj.clone())
+    , icomp_(icomp)
+    , result_(new StatsCollector(icomp))
+    , msg_(tr("Collecting data statistics"))
+{
+}
+
+
+Seis::ParallelStatsCollector::~ParallelStatsCollector()
+{
+    deepErase( rdrs_ );
+    deepErase( collectors_ );
+    delete result_;
+    delete ioobj_;
+}
+
+
+bool Seis::ParallelStatsCollector::init()
+{
+    SeisTrcReader rdr( *ioobj_ );
+    if ( !rdr.prepareWork() || !rdr.seisTranslator() )
+    {
+	msg_ = rdr.errMsg();
+	return false;
+    }
+
+    if ( !rdr.seisTranslator()->supportsGoTo() || rdr.is2D() || rdr.isPS() )
+    {
+	msg_ = tr("Data set does not support parallel scanning");
+	return false;
+    }
+
+    if ( !rdr.get3DGeometryInfo(cd_) || cd_.isEmpty() )
+    {
+	msg_ = tr("Cannot read the geometry of the data set");
+	return false;
+    }
+
+    linestarts_.erase();
+    totalnrpos_ = 0;
+    for ( const auto* ld : cd_ )
+    {
+	linestarts_ += totalnrpos_;
+	totalnrpos_ += ld->size();
+    }
+
+    if ( totalnrpos_ < 1 )
+    {
+	msg_ = tr("Data set is empty");
+	return false;
+    }
+
+    int nrsampled = nrsampled_;
+    if ( nrsampled < 1 )
+    {
+	const PtrMan<Seis::Bounds> bounds = rdr.getBounds();
+	const int nrsamps = bounds ? bounds->getZRange().nrSteps()+1 : 1000;
+	nrsampled = 1048576 / (nrsamps < 1 ? 1 : nrsamps);
+	if ( nrsampled < 100 )
+	    nrsampled = 100;
+    }
+
+    if ( nrsampled > totalnrpos_ )
+	nrsampled = mCast(int,totalnrpos_);
+
+    Stats::RandGen randgen;
+    sampledidxs_.setSize( nrsampled, 0 );
+    for ( int idx=0; idx<nrsampled; idx++ )
+    {
+	const od_int64 stratumstart = idx * totalnrpos_ / nrsampled;
+	const od_int64 stratumstop = (idx+1) * totalnrpos_ / nrsampled;
+	sampledidxs_[idx] = stratumstart +
+			    randgen.getIndex( stratumstop - stratumstart );
+    }
+
+    return true;
+}
+
+
+BinID Seis::ParallelStatsCollector::getBinID( od_int64 globalidx ) const
+{
+    int lidx = 0, hidx = linestarts_.size()-1;
+    while ( lidx < hidx )
+    {
+	const int midx = (lidx + hidx + 1) / 2;
+	if ( linestarts_[midx] <= globalidx )
+	    lidx = midx;
+	else
+	    hidx = midx - 1;
+    }
+
+    const PosInfo::LineData& ld = *cd_.get( lidx );
+    od_int64 posinline = globalidx - linestarts_[lidx];
+    for ( const auto& seg : ld.segments_ )
+    {
+	const int segsz = seg.nrSteps() + 1;
+	if ( posinline < segsz )
+	    return BinID( ld.linenr_, seg.atIndex(mCast(int,posinline)) );
+
+	posinline -= segsz;
+    }
+
+    return BinID::udf();
+}
+
+
+bool Seis::ParallelStatsCollector::executeParallel( bool parallel )
+{
+    if ( !init() )
+	return false;
+
+    return ParallelTask::executeParallel( parallel ) && writeStats();
+}
+
+
+od_int64 Seis::ParallelStatsCollector::nrIterations() const
+{
+    return sampledidxs_.size();
+}
+
+
+bool Seis::ParallelStatsCollector::doPrepare( int nrthreads )
+{
+    deepErase( rdrs_ );
+    deepErase( collectors_ );
+    for ( int idx=0; idx<nrthreads; idx++ )
+    {
+	auto* rdr = new SeisTrcReader( *ioobj_ );
+	if ( icomp_ >= 0 )
+	    rdr->setComponent( icomp_ );
+
+	if ( !rdr->prepareWork() )
+	{
+	    msg_ = rdr->errMsg();
+	    delete rdr;
+	    return false;
+	}
+
+	rdrs_ += rdr;
+	collectors_ += new StatsCollector( icomp_ );
+    }
+
+    return true;
+}
+
+
+bool Seis::ParallelStatsCollector::doWork( od_int64 start, od_int64 stop,
+					   int threadidx )
+{
+    SeisTrcReader& rdr = *rdrs_[threadidx];
+    SeisTrcTranslator& trl = *rdr.seisTranslator();
+    StatsCollector& collector = *collectors_[threadidx];
+    SeisTrc trc;
+    for ( od_int64 idx=start; idx<=stop && shouldContinue(); idx++ )
+    {
+	const BinID bid = getBinID( sampledidxs_[idx] );
+	if ( !bid.isUdf() && trl.goTo(bid) && rdr.get(trc) && !trc.isNull() )
+	    collector.useTrace( trc );
+
+	quickAddToNrDone( idx );
+    }
+
+    return true;
+}
+
+
+bool Seis::ParallelStatsCollector::doFinish( bool success )
+{
+    deepErase( rdrs_ );
+    if ( success )
+    {
+	result_->setEmpty();
+	for ( const auto* collector : collectors_ )
+	    result_->merge( *collector );
+    }
+
+    deepErase( collectors_ );
+    return success;
+}
+
+
+bool Seis::ParallelStatsCollector::writeStats() const
+{
+    if ( result_->nrSamplesUsed() < 1 )
+	return false;
+
+    FilePath fp( ioobj_->mainFileName() );
+    fp.setExtension( sStatsFileExtension() );
+
+    IOPar iop;
+    iop.read( fp.fullPath(), sKey::Stats() );
+
+    IOPar subiop;
+    subiop.set( sKey::Source(), sKeyPartialScan() );
+    if ( !result_->fillPar(subiop) )
+	return false;
+
+    if ( icomp_ < 0 )
+	iop.merge( subiop );
+    else
+	iop.mergeComp( subiop, IOPar::compKey(sKey::Component(),icomp_) );
+
+    return iop.write( fp.fullPath(), sKey::Stats() );
+}
@@ -0,0 +1,426 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "seistilecache.h"
+
+#include "ioman.h"
+#include "ioobj.h"
+#include "odsysmem.h"
+#include "ptrman.h"
+#include "seisbuf.h"
+#include "seisread.h"
+#include "seistrc.h"
+#include "seistrctr.h"
+#include "sorting.h"
+#include "survinfo.h"
+#include "uistrings.h"
+
+namespace Seis
+{
+
+// TraceTile
+TraceTile::TraceTile( const MultiID& key, const BinID& tileidx, int comp )
+    : key_(key)
+    , tileidx_(tileidx)
+    , comp_(comp)
+    , trcs_(*new SeisTrcBuf(true))
+{
+}
+
+
+TraceTile::~TraceTile()
+{
+    delete &trcs_;
+}
+
+
+const SeisTrc* TraceTile::get( const BinID& bid ) const
+{
+    const int idx = trcs_.find( bid );
+    return trcs_.validIdx(idx) ? trcs_.get( idx ) : nullptr;
+}
+
+
+void TraceTile::add( SeisTrc* trc )
+{
+    if ( !trc )
+	return;
+
+    memsize_ += sizeof(SeisTrc) +
+		sizeof(float) * trc->size() * trc->nrComponents();
+    trcs_.add( trc );
+}
+
+
+// TraceTileCache::Entry
+TraceTileCache::Entry::Entry( TraceTile& tile, od_int64 stamp )
+    : tile_(&tile)
+    , stamp_(stamp)
+{
+}
+
+
+TraceTileCache::Entry::~Entry()
+{
+}
+
+
+// TraceTileCache
+TraceTileCache::TraceTileCache()
+{
+    od_int64 totmem, freemem;
+    OD::getSystemMemory( totmem, freemem );
+    maxmem_ = totmem / 16;
+    mAttachCB( IOM().implUpdated, TraceTileCache::implUpdatedCB );
+    mAttachCB( IOM().surveyToBeChanged, TraceTileCache::surveyChangeCB );
+}
+
+
+TraceTileCache::~TraceTileCache()
+{
+    detachAllNotifiers();
+}
+
+
+BinID TraceTileCache::tileIdxOf( const BinID& bid )
+{
+    const TrcKeySampling& tks = SI().sampling( false ).hsamp_;
+    const BinID relidx( tks.inlIdx(bid.inl()), tks.crlIdx(bid.crl()) );
+    const int ts = tileSize();
+    return BinID( relidx.inl()<0 ? (relidx.inl()+1)/ts-1 : relidx.inl()/ts,
+		  relidx.crl()<0 ? (relidx.crl()+1)/ts-1 : relidx.crl()/ts );
+}
+
+
+TrcKeySampling TraceTileCache::tileSampling( const BinID& tileidx,
+					     const BinID& step )
+{
+    const TrcKeySampling& survtks = SI().sampling( false ).hsamp_;
+    const BinID& survstep = survtks.step_;
+    const int ts = tileSize();
+    const BinID start( survtks.start_.inl() + tileidx.inl()*ts*survstep.inl(),
+		       survtks.start_.crl() + tileidx.crl()*ts*survstep.crl() );
+    const BinID stop( start.inl() + (ts-1)*survstep.inl(),
+		      start.crl() + (ts-1)*survstep.crl() );
+    TrcKeySampling tks;
+    tks.set( StepInterval<int>(start.inl(),stop.inl(),step.inl()),
+	     StepInterval<int>(start.crl(),stop.crl(),step.crl()) );
+    return tks;
+}
+
+
+void TraceTileCache::setMaxMemory( od_int64 nrbytes )
+{
+    Threads::Locker locker( lock_ );
+    maxmem_ = nrbytes;
+    limitMemory();
+}
+
+
+od_int64 TraceTileCache::memoryUsage() const
+{
+    Threads::Locker locker( lock_ );
+    return memusage_;
+}
+
+
+int TraceTileCache::indexOf( const MultiID& key, const BinID& tileidx,
+			     int comp ) const
+{
+    for ( int idx=0; idx<entries_.size(); idx++ )
+    {
+	const TraceTile& tile = *entries_.get(idx)->tile_;
+	if ( tile.tileIdx() == tileidx && tile.component() == comp &&
+	     tile.dbKey() == key )
+	    return idx;
+    }
+
+    return -1;
+}
+
+
+RefMan<TraceTile> TraceTileCache::get( const MultiID& key,
+				       const BinID& tileidx, int comp )
+{
+    Threads::Locker locker( lock_ );
+    const int idx = indexOf( key, tileidx, comp );
+    if ( idx < 0 )
+	return nullptr;
+
+    Entry& entry = *entries_.get( idx );
+    entry.stamp_ = ++curstamp_;
+    return entry.tile_;
+}
+
+
+void TraceTileCache::add( TraceTile& tile )
+{
+    Threads::Locker locker( lock_ );
+    const int idx = indexOf( tile.dbKey(), tile.tileIdx(), tile.component() );
+    if ( idx >= 0 )
+    {
+	memusage_ -= entries_.get(idx)->tile_->memSize();
+	entries_.removeSingle( idx );
+    }
+
+    entries_ += new Entry( tile, ++curstamp_ );
+    memusage_ += tile.memSize();
+    limitMemory();
+}
+
+
+void TraceTileCache::limitMemory()
+{
+    while ( memusage_ > maxmem_ && !entries_.isEmpty() )
+    {
+	int oldestidx = 0;
+	for ( int idx=1; idx<entries_.size(); idx++ )
+	{
+	    if ( entries_.get(idx)->stamp_ < entries_.get(oldestidx)->stamp_ )
+		oldestidx = idx;
+	}
+
+	memusage_ -= entries_.get(oldestidx)->tile_->memSize();
+	entries_.removeSingle( oldestidx );
+    }
+}
+
+
+void TraceTileCache::remove( const MultiID& key )
+{
+    Threads::Locker locker( lock_ );
+    for ( int idx=entries_.size()-1; idx>=0; idx-- )
+    {
+	const TraceTile& tile = *entries_.get(idx)->tile_;
+	if ( tile.dbKey() != key )
+	    continue;
+
+	memusage_ -= tile.memSize();
+	entries_.removeSingle( idx );
+    }
+}
+
+
+void TraceTileCache::clear()
+{
+    Threads::Locker locker( lock_ );
+    entries_.setEmpty();
+    memusage_ = 0;
+}
+
+
+void TraceTileCache::implUpdatedCB( CallBacker* cb )
+{
+    mCBCapsuleUnpack(const MultiID&,key,cb);
+    remove( key );
+}
+
+
+void TraceTileCache::surveyChangeCB( CallBacker* )
+{
+    clear();
+}
+
+
+TraceTileCache& TTC()
+{
+    mDefineStaticLocalObject(PtrMan<TraceTileCache>,ttc,
+			     = new TraceTileCache() );
+    return *ttc;
+}
+
+
+// PathTraceReader
+PathTraceReader::PathTraceReader( const IOObj& ioobj, const TrcKeySet& path,
+				  SeisTrcBuf& output, int comp )
+    : ParallelTask("Reading traces")
+    , ioobj_(ioobj.clone())
+    , path_(path)
+    , output_(output)
+    , comp_(comp)
+    , zrg_(Interval<float>::udf())
+    , step_(SI().sampling(false).hsamp_.step_)
+    , msg_(tr("Reading traces"))
+{
+}
+
+
+PathTraceReader::~PathTraceReader()
+{
+    deepErase( rdrs_ );
+    delete ioobj_;
+}
+
+
+uiString PathTraceReader::uiNrDoneText() const
+{
+    return tr("Tiles read");
+}
+
+
+bool PathTraceReader::doPrepare( int nrthreads )
+{
+    tiles_.erase();
+    tilestoread_.erase();
+    deepErase( rdrs_ );
+
+    const MultiID& key = ioobj_->key();
+    for ( const auto& tk : path_ )
+    {
+	const BinID tileidx = TraceTileCache::tileIdxOf( tk.position() );
+	if ( tilestoread_.isPresent(tileidx) )
+	    continue;
+
+	RefMan<TraceTile> tile = TTC().get( key, tileidx, comp_ );
+	if ( tile )
+	{
+	    if ( !tiles_.isPresent(tile.ptr()) )
+		tiles_ += tile.ptr();
+	}
+	else
+	    tilestoread_ += tileidx;
+    }
+
+    if ( tilestoread_.isEmpty() )
+	return true;
+
+    // Read in storage order, to keep the file access mostly sequential
+    sort( tilestoread_ );
+    const int nrrdrs = mMIN( nrthreads, tilestoread_.size() );
+    for ( int idx=0; idx<nrrdrs; idx++ )
+    {
+	SeisTrcReader* rdr = createReader();
+	if ( !rdr )
+	    return false;
+
+	rdrs_ += rdr;
+    }
+
+    return true;
+}
+
+
+SeisTrcReader* PathTraceReader::createReader()
+{
+    auto* rdr = new SeisTrcReader( *ioobj_ );
+    rdr->setComponent( comp_ );
+    if ( !rdr->prepareWork() || !rdr->seisTranslator() )
+    {
+	Threads::Locker locker( rdrslock_ );
+	msg_ = rdr->errMsg();
+	delete rdr;
+	return nullptr;
+    }
+
+    if ( !rdr->seisTranslator()->supportsGoTo() )
+    {
+	Threads::Locker locker( rdrslock_ );
+	msg_ = tr("Cannot read traces at random positions from '%1'")
+		.arg( ioobj_->name() );
+	delete rdr;
+	return nullptr;
+    }
+
+    return rdr;
+}
+
+
+SeisTrcReader* PathTraceReader::getReader()
+{
+    Threads::Locker locker( rdrslock_ );
+    if ( !rdrs_.isEmpty() )
+	return rdrs_.removeSingle( rdrs_.size()-1 );
+
+    locker.unlockNow();
+    return createReader();
+}
+
+
+void PathTraceReader::releaseReader( SeisTrcReader* rdr )
+{
+    Threads::Locker locker( rdrslock_ );
+    rdrs_ += rdr;
+}
+
+
+bool PathTraceReader::doWork( od_int64 start, od_int64 stop, int threadidx )
+{
+    if ( start > stop )
+	return true;
+
+    // Readers are taken from a pool, so any thread can do any range
+    SeisTrcReader* rdr = getReader();
+    if ( !rdr )
+	return false;
+
+    SeisTrcTranslator& trl = *rdr->seisTranslator();
+    const MultiID& key = ioobj_->key();
+    for ( od_int64 idx=start; idx<=stop && shouldContinue(); idx++ )
+    {
+	const BinID& tileidx = tilestoread_[idx];
+	RefMan<TraceTile> tile = new TraceTile( key, tileidx, comp_ );
+	const TrcKeySampling tks =
+			TraceTileCache::tileSampling( tileidx, step_ );
+	TrcKeySamplingIterator iter( tks );
+	BinID bid;
+	while ( iter.next(bid) )
+	{
+	    if ( !trl.goTo(bid) )
+		continue;
+
+	    auto* trc = new SeisTrc;
+	    if ( rdr->get(*trc) )
+		tile->add( trc );
+	    else
+		delete trc;
+	}
+
+	TTC().add( *tile );
+	Threads::Locker locker( tileslock_ );
+	tiles_ += tile.ptr();
+	locker.unlockNow();
+	addToNrDone( 1 );
+    }
+
+    releaseReader( rdr );
+    return true;
+}
+
+
+bool PathTraceReader::doFinish( bool success )
+{
+    deepErase( rdrs_ );
+    if ( !success )
+	return false;
+
+    const bool restrictz = !zrg_.isUdf();
+    for ( const auto& tk : path_ )
+    {
+	const BinID bid = tk.position();
+	const BinID tileidx = TraceTileCache::tileIdxOf( bid );
+	const SeisTrc* trc = nullptr;
+	for ( const auto* tile : tiles_ )
+	{
+	    if ( tile->tileIdx() == tileidx )
+		{ trc = tile->get( bid ); break; }
+	}
+
+	if ( !trc )
+	    continue;
+
+	SeisTrc* outtrc = restrictz ? trc->getExtendedTo( zrg_ )
+				    : new SeisTrc( *trc );
+	if ( outtrc )
+	    output_.add( outtrc );
+    }
+
+    return true;
+}
+
+} // namespace Seis
@@ -15,6 +15,7 @@ ________________________________________________________________________
 #include "ioman.h"
 #include "paralleltask.h"
 #include "posinfo.h"
+#include "seisbuf.h"
 #include "seisioobjinfo.h"
 #include "seisread.h"
 #include "seispacketinfo.h"
@@ -61,6 +62,7 @@ SeisZAxisStretcher::SeisZAxisStretcher( const IOObj& in, const IOObj& out,
 SeisZAxisStretcher::~SeisZAxisStretcher()
 {
     delete seisreader_;
+    delete pendingtrc_;
     delete sequentialwriter_;
     delete seiswriter_;
     delete worker_;
@@ -215,6 +217,12 @@ void SeisZAxisStretcher::setUdfVal( float val )
 }
 
 
+void SeisZAxisStretcher::setBatchSize( int nrtrcs )
+{
+    batchsize_ = nrtrcs;
+}
+
+
 bool SeisZAxisStretcher::doPrepare( int nrthreads )
 {
     msg_ = tr("Stretching data");
@@ -236,35 +244,27 @@ bool SeisZAxisStretcher::doPrepare( int nrthreads )
 
 bool SeisZAxisStretcher::doWork( od_int64, od_int64, int )
 {
+    if ( batchsize_ > 1 && !worker_ )
+	return doWorkBatched();
+
     const ZSampling trcrg = outcs_.zsamp_;
     const SamplingData<float> sd( trcrg );
     const int outsz = trcrg.nrSteps()+1;
-    const int icomp = 0;
 
     SeisTrc intrc;
     PtrMan<Array1D<float> > outputarr;
-    PtrMan<FloatMathFunction> intrcfunc;
-    PtrMan<ZAxisTransformSampler> sampler;
+    PtrMan<Array1D<float> > zvalsarr;
     float* outputptr = nullptr;
+    float* zvalsptr = nullptr;
     const bool standardstretch = !worker_;
     if ( standardstretch )
     {
-	auto* interpol =
-		new ValueSeriesInterpolator<float>( intrc.interpolator() );
-	interpol->udfval_ = udfval_;
-	intrc.setInterpolator( interpol );
-	intrcfunc = new SeisTrcFunction( intrc, icomp );
-
 	outputarr = new Array1DImpl<float>( outsz );
+	zvalsarr = new Array1DImpl<float>( outsz );
 	outputptr = outputarr->getData();
-	if ( !intrcfunc || !outputptr )
+	zvalsptr = zvalsarr->getData();
+	if ( !outputptr || !zvalsptr )
 	    return false;
-
-	const bool is2d = is2D( geomtype_ );
-	sampler = new ZAxisTransformSampler( *ztransform_, true, sd, is2d );
-	if ( is2d && seisreader_ && seisreader_->selData() )
-	    sampler->setLineName( Survey::GM().getName(
-					    seisreader_->selData()->geomID()));
     }
 
     /*TODOVEL: One should provide an array of t0 to stretchVelocity
@@ -272,22 +272,31 @@ bool SeisZAxisStretcher::doWork( od_int64, od_int64, int )
       Difficult to do here without access to EarthModel    */
     while ( shouldContinue() && getInputTrace(intrc) )
     {
+	const int nrcomps = intrc.nrComponents();
 	auto* outtrc = new SeisTrc( outsz );
+	outtrc->setNrComponents( nrcomps );
 	outtrc->info().sampling_ = sd;
 	outtrc->info().setTrcKey( intrc.info().trcKey() );
 	outtrc->info().coord_ = intrc.info().coord_;
 
 	if ( standardstretch )
-	    stretch( intrc, icomp, *intrcfunc, *sampler, outputptr, *outtrc );
+	{
+	    ztransform_->transformTrcBack( intrc.info().trcKey(), sd, outsz,
+					   zvalsptr );
+	    stretch( intrc, zvalsptr, outputptr, *outtrc );
+	}
 	else
 	{
-	    bool res = false;
-	    if ( autotransform_ )
-		res = selfStretchVelocity( intrc, icomp, *outtrc );
-	    if ( (autotransform_ && !res) || !autotransform_ )
-		res = stretchVelocity( intrc, icomp, *outtrc );
-	    if ( !res )
-		outtrc->setAll( mUdf(float), icomp );
+	    for ( int icomp=0; icomp<nrcomps; icomp++ )
+	    {
+		bool res = false;
+		if ( autotransform_ )
+		    res = selfStretchVelocity( intrc, icomp, *outtrc );
+		if ( (autotransform_ && !res) || !autotransform_ )
+		    res = stretchVelocity( intrc, icomp, *outtrc );
+		if ( !res )
+		    outtrc->setAll( mUdf(float), icomp );
+	    }
 	}
 
 	if ( !sequentialwriter_->submitTrace(outtrc,true) )
@@ -300,6 +309,48 @@ bool SeisZAxisStretcher::doWork( od_int64, od_int64, int )
 }
 
 
+bool SeisZAxisStretcher::doWorkBatched()
+{
+    const ZSampling trcrg = outcs_.zsamp_;
+    const SamplingData<float> sd( trcrg );
+    const int outsz = trcrg.nrSteps()+1;
+
+    Array2DImpl<float> zvals( batchsize_, outsz );
+    Array1DImpl<float> outputarr( outsz );
+    if ( !zvals.isOK() || !outputarr.isOK() )
+	return false;
+
+    float* outputptr = outputarr.getData();
+    SeisTrcBuf intrcs( true );
+    while ( shouldContinue() && getInputTraces(intrcs,batchsize_) )
+    {
+	const int nrtrcs = intrcs.size();
+	float* zvalsptr = zvals.getData();
+	for ( int itrc=0; itrc<nrtrcs; itrc++ )
+	    ztransform_->transformTrcBack( intrcs.get(itrc)->info().trcKey(),
+					   sd, outsz, zvalsptr+itrc*outsz );
+
+	for ( int itrc=0; itrc<nrtrcs; itrc++ )
+	{
+	    SeisTrc& intrc = *intrcs.get( itrc );
+	    auto* outtrc = new SeisTrc( outsz );
+	    outtrc->setNrComponents( intrc.nrComponents() );
+	    outtrc->info().sampling_ = sd;
+	    outtrc->info().setTrcKey( intrc.info().trcKey() );
+	    outtrc->info().coord_ = intrc.info().coord_;
+	    stretch( intrc, zvalsptr+itrc*outsz, outputptr, *outtrc );
+	    if ( !sequentialwriter_->submitTrace(outtrc,true) )
+		return false;
+	}
+
+	addToNrDone( nrtrcs );
+	intrcs.deepErase();
+    }
+
+    return true;
+}
+
+
 bool SeisZAxisStretcher::doFinish( bool success )
 {
     zdomaininfo_ = nullptr;
@@ -371,6 +422,71 @@ bool SeisZAxisStretcher::getInputTrace( SeisTrc& trc )
 }
 
 
+bool SeisZAxisStretcher::getInputTraces( SeisTrcBuf& trcs, int maxnrtrcs )
+{
+    Threads::MutexLocker lock( readerlock_ );
+    if ( waitforall_ )
+    {
+	nrwaiting_++;
+	if ( nrwaiting_==nrthreads_-1 )
+	    readerlock_.signal(true);
+
+	while ( shouldContinue() && waitforall_ )
+	    readerlock_.wait();
+
+	nrwaiting_--;
+    }
+
+    while ( trcs.size() < maxnrtrcs && shouldContinue() )
+    {
+	SeisTrc* trc = pendingtrc_;
+	pendingtrc_ = nullptr;
+	if ( !trc )
+	{
+	    if ( !seisreader_ )
+		break;
+
+	    trc = new SeisTrc;
+	    if ( !seisreader_->get(*trc) )
+	    {
+		delete trc;
+		deleteAndNullPtr( seisreader_ );
+		break;
+	    }
+	}
+
+	const TrcKey tk = trc->info().trcKey();
+	if ( !outcs_.hsamp_.includes(tk) )
+	    { delete trc; continue; }
+
+	if ( curhrg_.isEmpty() || !curhrg_.includes(tk) )
+	{
+	    if ( !trcs.isEmpty() )
+	    {
+		// Finish this tile before the transform chunk is replaced
+		pendingtrc_ = trc;
+		break;
+	    }
+
+	    waitforall_ = true;
+	    while ( shouldContinue() && nrwaiting_!=nrthreads_-1 )
+		readerlock_.wait();
+
+	    waitforall_ = false;
+	    readerlock_.signal( true );
+
+	    if ( !shouldContinue() || !loadTransformChunk(tk.inl()) )
+		{ delete trc; continue; }
+	}
+
+	sequentialwriter_->announceTrace( tk.position() );
+	trcs.add( trc );
+    }
+
+    return !trcs.isEmpty();
+}
+
+
 #define mMaxNrTrc	5000
 
 bool SeisZAxisStretcher::loadTransformChunk( int inl )
@@ -403,16 +519,22 @@ bool SeisZAxisStretcher::loadTransformChunk( int inl )
 }
 
 
-void SeisZAxisStretcher::stretch( const SeisTrc& inptrc, int icomp,
-				  const FloatMathFunction& intrcfunc,
-				  ZAxisTransformSampler& sampler,
+void SeisZAxisStretcher::stretch( SeisTrc& inptrc, const float* zvals,
 				  float* outputptr, SeisTrc& outtrc ) const
 {
-    sampler.setTrcKey( inptrc.info().trcKey() );
-    sampler.computeCache( Interval<int>( 0, outtrc.size()-1) );
-    reSample( intrcfunc, sampler, outputptr, outtrc.size() );
-    for ( int idx=0; idx<outtrc.size(); idx++ )
-	outtrc.set( idx, outputptr[idx], icomp );
+    auto* interpol =
+	    new ValueSeriesInterpolator<float>( inptrc.interpolator() );
+    interpol->udfval_ = udfval_;
+    inptrc.setInterpolator( interpol );
+
+    const int outsz = outtrc.size();
+    for ( int icomp=0; icomp<outtrc.nrComponents(); icomp++ )
+    {
+	const SeisTrcFunction intrcfunc( inptrc, icomp );
+	reSample( intrcfunc, zvals, outputptr, outsz );
+	for ( int idx=0; idx<outsz; idx++ )
+	    outtrc.set( idx, outputptr[idx], icomp );
+    }
 }
 
 
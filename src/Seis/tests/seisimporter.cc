@@ -0,0 +1,152 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "filepath.h"
+#include "iostrm.h"
+#include "moddepmgr.h"
+#include "seiscbvs.h"
+#include "seisimporter.h"
+#include "seisread.h"
+#include "seistrc.h"
+#include "seistrctr.h"
+#include "seiswrite.h"
+#include "survinfo.h"
+#include "testprog.h"
+
+static const int cNrInl = 5;
+static const int cNrCrl = 9;
+static const int cNrSamples = 20;
+
+
+static IOObj* getTmpIOObj( const char* fnm )
+{
+    const MultiID tmpid( 100010, IOObj::tmpID() );
+    auto* iostrm = new IOStream( "_tmp_seisimporter",
+				 DBKey(tmpid,SI().diskLocation()) );
+    iostrm->setGroup( mTranslGroupName(SeisTrc) );
+    iostrm->setTranslator( CBVSSeisTrcTranslator::translKey() );
+    iostrm->fileSpec().setFileName( fnm );
+    return iostrm;
+}
+
+
+static BinID getBinID( int iinl, int icrl )
+{
+    const TrcKeySampling& sitks = SI().sampling( false ).hsamp_;
+    return BinID( sitks.start_.inl() + iinl*sitks.step_.inl(),
+		  sitks.start_.crl() + icrl*sitks.step_.crl() );
+}
+
+
+/* Provides all positions of a small cube in a scrambled order */
+
+class ScrambledReader : public SeisImporter::Reader
+{
+public:
+
+const char* name() const override	{ return "Scrambled"; }
+const char* implName() const override	{ return "Test"; }
+int totalNr() const override		{ return cNrInl*cNrCrl; }
+
+bool fetch( SeisTrc& trc ) override
+{
+    const int nrtrcs = cNrInl*cNrCrl;
+    if ( curidx_ >= nrtrcs )
+	return false;
+
+    // 7 is coprime with the number of traces: each position once
+    const int posidx = (7*curidx_++) % nrtrcs;
+    const int iinl = posidx / cNrCrl;
+    const int icrl = posidx % cNrCrl;
+    trc.reSize( cNrSamples, false );
+    trc.info().sampling_.start_ = SI().zRange( false ).start_;
+    trc.info().sampling_.step_ = SI().zStep();
+    trc.info().setPos( getBinID(iinl,icrl) );
+    for ( int isamp=0; isamp<cNrSamples; isamp++ )
+	trc.set( isamp, float(posidx) + 0.01f*isamp, 0 );
+
+    return true;
+}
+
+protected:
+
+    int		curidx_ = 0;
+};
+
+
+static bool checkOutput( const IOObj& ioobj, const char* desc )
+{
+    SeisTrcReader rdr( ioobj );
+    mRunStandardTest( rdr.prepareWork(), BufferString("Open ",desc) );
+    SeisTrc trc;
+    int nrtrcs = 0;
+    bool sorted = true, samevals = true;
+    while ( rdr.get(trc) )
+    {
+	const int iinl = nrtrcs / cNrCrl;
+	const int icrl = nrtrcs % cNrCrl;
+	if ( trc.info().binID() != getBinID(iinl,icrl) )
+	    sorted = false;
+
+	for ( int isamp=0; isamp<cNrSamples; isamp++ )
+	{
+	    const float exp = float(nrtrcs) + 0.01f*isamp;
+	    if ( !mIsEqual(trc.get(isamp,0),exp,1e-4f) )
+		samevals = false;
+	}
+
+	nrtrcs++;
+    }
+
+    mRunStandardTest( nrtrcs == cNrInl*cNrCrl,
+		      BufferString("All traces in ",desc) );
+    mRunStandardTest( sorted, BufferString("Sorted ",desc) );
+    mRunStandardTest( samevals, BufferString("Trace values in ",desc) );
+    return true;
+}
+
+
+static bool runImport( const IOObj& ioobj, int maxnrtrcsinmem,
+		       const char* desc )
+{
+    SeisTrcWriter wrr( ioobj );
+    SeisImporter imp( new ScrambledReader, wrr, Seis::Vol );
+    imp.setSortInput( true, maxnrtrcsinmem );
+    mRunStandardTestWithError( imp.execute(), BufferString("Import ",desc),
+			       imp.uiMessage().getString() );
+    mRunStandardTest( wrr.close(), BufferString("Close ",desc) );
+    return true;
+}
+
+
+static bool testImport( int maxnrtrcsinmem, const char* desc )
+{
+    const BufferString fnm =
+		FilePath::getTempFullPath( "seisimporter", "cbvs" );
+    PtrMan<IOObj> ioobj = getTmpIOObj( fnm );
+    const bool res = runImport( *ioobj, maxnrtrcsinmem, desc ) &&
+		     checkOutput( *ioobj, desc );
+    ioobj->implRemove();
+    return res;
+}
+
+
+mLoad1Module("Seis")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    // In memory, in runs of 8 traces, and in runs of a single trace
+    return testImport( 1000, "sorted in memory" ) &&
+	   testImport( 8, "merged from runs" ) &&
+	   testImport( 1, "merged from single trace runs" );
+}
@@ -0,0 +1,199 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "filepath.h"
+#include "iostrm.h"
+#include "manobjectset.h"
+#include "moddepmgr.h"
+#include "seiscbvs.h"
+#include "seismerge.h"
+#include "seisread.h"
+#include "seistrc.h"
+#include "seistrctr.h"
+#include "seiswrite.h"
+#include "survinfo.h"
+#include "testprog.h"
+
+static const int cNrInputs = 3;
+static const int cNrSamples = 15;
+static const int cNrPositions = 45;
+
+
+static IOObj* getTmpIOObj( const char* nm )
+{
+    const BufferString fnm = FilePath::getTempFullPath( nm, "cbvs" );
+    const MultiID tmpid( 100010, IOObj::tmpID() );
+    auto* iostrm = new IOStream( BufferString("_tmp_",nm),
+				 DBKey(tmpid,SI().diskLocation()) );
+    iostrm->setGroup( mTranslGroupName(SeisTrc) );
+    iostrm->setTranslator( CBVSSeisTrcTranslator::translKey() );
+    iostrm->fileSpec().setFileName( fnm );
+    return iostrm;
+}
+
+
+static BinID getBinID( int iinl, int icrl )
+{
+    const TrcKeySampling& sitks = SI().sampling( false ).hsamp_;
+    return BinID( sitks.start_.inl() + iinl*sitks.step_.inl(),
+		  sitks.start_.crl() + icrl*sitks.step_.crl() );
+}
+
+
+/* The first two inputs overlap, the third one is next to them:
+
+   inl 0-3 x crl 0-5, inl 2-5 x crl 3-8, inl 6 x crl 0-2 */
+
+static bool isInInput( int inp, int iinl, int icrl )
+{
+    if ( inp == 0 )
+	return iinl <= 3 && icrl <= 5;
+    if ( inp == 1 )
+	return iinl >= 2 && iinl <= 5 && icrl >= 3;
+
+    return iinl == 6 && icrl <= 2;
+}
+
+
+static float getValue( int inp, int iinl, int icrl, int isamp )
+{
+    return float(100*inp + 10*iinl + icrl) + 0.01f*isamp;
+}
+
+
+static bool writeInput( const IOObj& ioobj, int inp )
+{
+    SeisTrcWriter wrr( ioobj );
+    SeisTrc trc( cNrSamples );
+    trc.info().sampling_.start_ = SI().zRange( false ).start_;
+    trc.info().sampling_.step_ = SI().zStep();
+    for ( int iinl=0; iinl<7; iinl++ )
+    {
+	for ( int icrl=0; icrl<9; icrl++ )
+	{
+	    if ( !isInInput(inp,iinl,icrl) )
+		continue;
+
+	    trc.info().setPos( getBinID(iinl,icrl) );
+	    for ( int isamp=0; isamp<cNrSamples; isamp++ )
+		trc.set( isamp, getValue(inp,iinl,icrl,isamp), 0 );
+
+	    mRunStandardTestWithError( wrr.put(trc), "Write an input trace",
+				       wrr.errMsg().getString() );
+	}
+    }
+
+    mRunStandardTest( wrr.close(), "Close an input writer" );
+    return true;
+}
+
+
+/* Stacked traces are the average of all inputs at the position, otherwise
+   the trace of the first input is kept */
+
+static bool checkOutput( const IOObj& ioobj, bool stack, const char* desc )
+{
+    SeisTrcReader rdr( ioobj );
+    mRunStandardTest( rdr.prepareWork(), BufferString("Open ",desc) );
+
+    SeisTrc trc;
+    int nrtrcs = 0;
+    bool allpos = true, samevals = true;
+    for ( int iinl=0; iinl<7; iinl++ )
+    {
+	for ( int icrl=0; icrl<9; icrl++ )
+	{
+	    TypeSet<int> inps;
+	    for ( int inp=0; inp<cNrInputs; inp++ )
+	    {
+		if ( isInInput(inp,iinl,icrl) )
+		    inps += inp;
+	    }
+
+	    if ( inps.isEmpty() )
+		continue;
+
+	    if ( !rdr.get(trc) || trc.info().binID() != getBinID(iinl,icrl) ||
+		 trc.size() != cNrSamples )
+		{ allpos = false; break; }
+
+	    nrtrcs++;
+	    const int nrused = stack ? inps.size() : 1;
+	    for ( int isamp=0; isamp<cNrSamples; isamp++ )
+	    {
+		float exp = 0.f;
+		for ( int idx=0; idx<nrused; idx++ )
+		    exp += getValue( inps[idx], iinl, icrl, isamp );
+
+		exp /= nrused;
+		if ( !mIsEqual(trc.get(isamp,0),exp,1e-3f) )
+		    samevals = false;
+	    }
+	}
+    }
+
+    mRunStandardTest( allpos && nrtrcs == cNrPositions && !rdr.get(trc),
+		      BufferString("All positions in order in ",desc) );
+    mRunStandardTest( samevals, BufferString("Trace values in ",desc) );
+    return true;
+}
+
+
+static bool testMerge( const BufferStringSet& infnms, bool stack,
+		       int lookahead, const char* desc )
+{
+    PtrMan<IOObj> outioobj = getTmpIOObj( "seismerge_out" );
+    bool res = false;
+    {
+	SeisParallelMerger mrgr( infnms, *outioobj );
+	mrgr.stacktrcs_ = stack;
+	mrgr.setLookAhead( lookahead );
+	mRunStandardTest( mrgr.totalNr() == cNrPositions,
+			  BufferString("Number of positions ",desc) );
+	mRunStandardTestWithError( mrgr.execute(), BufferString("Merge ",desc),
+				   mrgr.uiMessage().getString() );
+	res = mrgr.nrDone() == mrgr.totalNr();
+    }
+
+    mRunStandardTest( res, BufferString("All positions merged ",desc) );
+    res = checkOutput( *outioobj, stack, desc );
+    outioobj->implRemove();
+    return res;
+}
+
+
+mLoad1Module("Seis")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    ManagedObjectSet<IOObj> inioobjs;
+    BufferStringSet infnms;
+    bool res = true;
+    for ( int inp=0; inp<cNrInputs && res; inp++ )
+    {
+	IOObj* ioobj = getTmpIOObj( BufferString("seismerge_inp",inp) );
+	inioobjs += ioobj;
+	infnms.add( ioobj->mainFileName() );
+	res = writeInput( *ioobj, inp );
+    }
+
+    // A look-ahead of one trace decides on every position separately
+    res = res && testMerge( infnms, true, 64, "stacked" ) &&
+	  testMerge( infnms, true, 1, "stacked, one trace ahead" ) &&
+	  testMerge( infnms, false, 3, "not stacked" );
+
+    for ( auto* ioobj : inioobjs )
+	ioobj->implRemove();
+
+    return res;
+}
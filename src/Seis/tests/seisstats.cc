@@ -0,0 +1,169 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "file.h"
+#include "filepath.h"
+#include "iopar.h"
+#include "iostrm.h"
+#include "keystrs.h"
+#include "moddepmgr.h"
+#include "seiscbvs.h"
+#include "seisioobjinfo.h"
+#include "seisread.h"
+#include "seisstatscollector.h"
+#include "seistrc.h"
+#include "seistrctr.h"
+#include "seiswrite.h"
+#include "survinfo.h"
+#include "testprog.h"
+
+static const int cNrInl = 6;
+static const int cNrCrl = 8;
+static const int cNrSamples = 50;
+
+
+static bool isNullTrace( int iinl, int icrl )
+{
+    return (iinl+icrl) % 5 == 0;
+}
+
+
+static IOObj* getTmpIOObj( const char* fnm )
+{
+    const MultiID tmpid( 100010, IOObj::tmpID() );
+    auto* iostrm = new IOStream( "_tmp_seisstats",
+				 DBKey(tmpid,SI().diskLocation()) );
+    iostrm->setGroup( mTranslGroupName(SeisTrc) );
+    iostrm->setTranslator( CBVSSeisTrcTranslator::translKey() );
+    iostrm->fileSpec().setFileName( fnm );
+    return iostrm;
+}
+
+
+/* Some traces are null, the others have no zero samples */
+
+static bool writeCube( const IOObj& ioobj, int& nrnulltrcs )
+{
+    const TrcKeySampling& sitks = SI().sampling( false ).hsamp_;
+    SeisTrcWriter wrr( ioobj );
+    SeisTrc trc( cNrSamples );
+    trc.info().sampling_.start_ = SI().zRange( false ).start_;
+    trc.info().sampling_.step_ = SI().zStep();
+    nrnulltrcs = 0;
+    for ( int iinl=0; iinl<cNrInl; iinl++ )
+    {
+	for ( int icrl=0; icrl<cNrCrl; icrl++ )
+	{
+	    const bool isnull = isNullTrace( iinl, icrl );
+	    if ( isnull )
+		nrnulltrcs++;
+
+	    const BinID bid( sitks.start_.inl() + iinl*sitks.step_.inl(),
+			     sitks.start_.crl() + icrl*sitks.step_.crl() );
+	    trc.info().setPos( bid );
+	    for ( int isamp=0; isamp<cNrSamples; isamp++ )
+		trc.set( isamp, isnull ? 0.f
+				: float(iinl*cNrCrl+icrl+1) + 0.01f*isamp, 0 );
+
+	    mRunStandardTestWithError( wrr.put(trc), "Write a trace",
+				       wrr.errMsg().getString() );
+	}
+    }
+
+    mRunStandardTest( wrr.close(), "Close the writer" );
+    return true;
+}
+
+
+/* A sample of all positions must give the statistics of a sequential scan
+   of all non-null traces */
+
+static bool testAllSampled( const IOObj& ioobj, int nrnulltrcs )
+{
+    Seis::StatsCollector serial;
+    SeisTrcReader rdr( ioobj );
+    mRunStandardTest( rdr.prepareWork(), "Prepare the sequential reader" );
+    SeisTrc trc;
+    while ( rdr.get(trc) )
+    {
+	if ( !trc.isNull() )
+	    serial.useTrace( trc );
+    }
+
+    Seis::ParallelStatsCollector collector( ioobj );
+    collector.setNrSampledTraces( cNrInl*cNrCrl );
+    mRunStandardTestWithError( collector.execute(), "Collect statistics",
+			       collector.uiMessage().getString() );
+
+    const int nrtrcs = cNrInl*cNrCrl - nrnulltrcs;
+    const Seis::StatsCollector& res = collector.result();
+    mRunStandardTest( res.nrTracesUsed() == nrtrcs &&
+		      serial.nrTracesUsed() == nrtrcs,
+		      "Null traces skipped" );
+    mRunStandardTest( res.nrSamplesUsed() == serial.nrSamplesUsed(),
+		      "Number of samples" );
+
+    IOPar respar, serialpar;
+    mRunStandardTest( res.fillPar(respar) && serial.fillPar(serialpar),
+		      "Fill the statistics" );
+    const Interval<float> resrg = Seis::StatsCollector::getExtremes( respar );
+    const Interval<float> serialrg =
+			Seis::StatsCollector::getExtremes( serialpar );
+    mRunStandardTest( resrg.isEqual(serialrg,1e-5f),
+		      "Extremes as in a sequential scan" );
+    mRunStandardTest( resrg.start_ > 0.f, "No zeros from null traces" );
+
+    const SeisIOObjInfo info( ioobj );
+    IOPar statspar;
+    mRunStandardTest( info.getStats(statspar) &&
+	    statspar.find(sKey::Source()) ==
+	    Seis::ParallelStatsCollector::sKeyPartialScan(),
+	    "Partial scan written to the .stats file" );
+    return true;
+}
+
+
+static bool testDistribution( const IOObj& ioobj )
+{
+    FilePath statsfp( ioobj.mainFileName() );
+    statsfp.setExtension( sStatsFileExtension() );
+    File::remove( statsfp.fullPath() );
+    const SeisIOObjInfo info( ioobj );
+    mRunStandardTest( !info.haveStats(), "No .stats file" );
+
+    ConstRefMan<FloatDistrib> distrib = info.getDataDistribution();
+    mRunStandardTest( distrib && !distrib->isEmpty(),
+		      "Distribution from a partial scan" );
+    mRunStandardTest( info.haveStats(),
+		      "Distribution stored in the .stats file" );
+    return true;
+}
+
+
+mLoad1Module("Seis")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    const BufferString fnm = FilePath::getTempFullPath( "seisstats", "cbvs" );
+    PtrMan<IOObj> ioobj = getTmpIOObj( fnm );
+    int nrnulltrcs = 0;
+    const bool res = writeCube( *ioobj, nrnulltrcs ) &&
+		     testAllSampled( *ioobj, nrnulltrcs ) &&
+		     testDistribution( *ioobj );
+
+    FilePath statsfp( fnm );
+    statsfp.setExtension( sStatsFileExtension() );
+    File::remove( statsfp.fullPath() );
+    ioobj->implRemove();
+    return res;
+}
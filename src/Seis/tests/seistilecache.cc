@@ -0,0 +1,190 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "filepath.h"
+#include "iostrm.h"
+#include "moddepmgr.h"
+#include "seisbuf.h"
+#include "seiscbvs.h"
+#include "seistilecache.h"
+#include "seistrc.h"
+#include "seistrctr.h"
+#include "seiswrite.h"
+#include "survinfo.h"
+#include "testprog.h"
+
+static const int cNrInl = 12;
+static const int cNrCrl = 20;
+static const int cNrSamples = 40;
+
+
+static IOObj* getTmpIOObj( const char* fnm )
+{
+    const MultiID tmpid( 100010, IOObj::tmpID() );
+    auto* iostrm = new IOStream( "_tmp_seistilecache",
+				 DBKey(tmpid,SI().diskLocation()) );
+    iostrm->setGroup( mTranslGroupName(SeisTrc) );
+    iostrm->setTranslator( CBVSSeisTrcTranslator::translKey() );
+    iostrm->fileSpec().setFileName( fnm );
+    return iostrm;
+}
+
+
+static BinID getBinID( int iinl, int icrl )
+{
+    const TrcKeySampling& sitks = SI().sampling( false ).hsamp_;
+    return BinID( sitks.start_.inl() + iinl*sitks.step_.inl(),
+		  sitks.start_.crl() + icrl*sitks.step_.crl() );
+}
+
+
+static float getValue( int iinl, int icrl, int isamp )
+{
+    return float(100*iinl + icrl) + 0.01f*isamp;
+}
+
+
+static bool writeCube( const IOObj& ioobj )
+{
+    SeisTrcWriter wrr( ioobj );
+    SeisTrc trc( cNrSamples );
+    trc.info().sampling_.start_ = SI().zRange( false ).start_;
+    trc.info().sampling_.step_ = SI().zStep();
+    for ( int iinl=0; iinl<cNrInl; iinl++ )
+    {
+	for ( int icrl=0; icrl<cNrCrl; icrl++ )
+	{
+	    trc.info().setPos( getBinID(iinl,icrl) );
+	    for ( int isamp=0; isamp<cNrSamples; isamp++ )
+		trc.set( isamp, getValue(iinl,icrl,isamp), 0 );
+
+	    mRunStandardTestWithError( wrr.put(trc), "Write a trace",
+				       wrr.errMsg().getString() );
+	}
+    }
+
+    mRunStandardTest( wrr.close(), "Close the writer" );
+    return true;
+}
+
+
+/* A path over several tiles, with a repeated position and positions outside
+   the cube, that have no output trace */
+
+static void getPath( TrcKeySet& path, TypeSet<BinID>& expidxs )
+{
+    for ( int idx=0; idx<cNrCrl; idx++ )
+    {
+	const BinID idxs( (idx*(cNrInl-1))/(cNrCrl-1), idx );
+	path += TrcKey( getBinID(idxs.inl(),idxs.crl()) );
+	expidxs += idxs;
+    }
+
+    path += TrcKey( getBinID(3,5) );
+    expidxs += BinID( 3, 5 );
+    path += TrcKey( getBinID(cNrInl+3,2) );
+    path += TrcKey( getBinID(2,cNrCrl+9) );
+    path += TrcKey( getBinID(cNrInl-1,0) );
+    expidxs += BinID( cNrInl-1, 0 );
+}
+
+
+static bool isSame( const SeisTrcBuf& output, const TypeSet<BinID>& expidxs,
+		    int firstsamp, int nrsamps )
+{
+    if ( output.size() != expidxs.size() )
+	return false;
+
+    for ( int idx=0; idx<output.size(); idx++ )
+    {
+	const SeisTrc& trc = *output.get( idx );
+	const BinID& idxs = expidxs[idx];
+	if ( trc.info().binID() != getBinID(idxs.inl(),idxs.crl()) ||
+	     trc.size() != nrsamps )
+	    return false;
+
+	for ( int isamp=0; isamp<nrsamps; isamp++ )
+	{
+	    const float exp = getValue( idxs.inl(), idxs.crl(),
+					firstsamp+isamp );
+	    if ( !mIsEqual(trc.get(isamp,0),exp,1e-4f) )
+		return false;
+	}
+    }
+
+    return true;
+}
+
+
+static bool testRead( const IOObj& ioobj )
+{
+    Seis::TTC().clear();
+    TrcKeySet path;
+    TypeSet<BinID> expidxs;
+    getPath( path, expidxs );
+
+    SeisTrcBuf output( true );
+    Seis::PathTraceReader rdr( ioobj, path, output );
+    mRunStandardTestWithError( rdr.execute(), "Read the path",
+			       rdr.uiMessage().getString() );
+    mRunStandardTest( isSame(output,expidxs,0,cNrSamples),
+		      "Traces along the path" );
+    const od_int64 memusage = Seis::TTC().memoryUsage();
+    mRunStandardTest( memusage > 0, "Tiles cached" );
+
+    // Second read is served from the cache, in a single thread
+    SeisTrcBuf cachedoutput( true );
+    Seis::PathTraceReader cachedrdr( ioobj, path, cachedoutput );
+    mRunStandardTest( cachedrdr.executeParallel(false),
+		      "Read the path again" );
+    mRunStandardTest( isSame(cachedoutput,expidxs,0,cNrSamples),
+		      "Traces from the cache" );
+    mRunStandardTest( Seis::TTC().memoryUsage() == memusage,
+		      "No tiles added" );
+
+    const float zstart = SI().zRange( false ).start_;
+    const float zstep = SI().zStep();
+    const Interval<float> zrg( zstart + 5*zstep, zstart + 14*zstep );
+    SeisTrcBuf zoutput( true );
+    Seis::PathTraceReader zrdr( ioobj, path, zoutput );
+    zrdr.setZRange( zrg );
+    mRunStandardTest( zrdr.execute(), "Read the path in a Z range" );
+    mRunStandardTest( isSame(zoutput,expidxs,5,10), "Traces in a Z range" );
+
+    // Without a cache, a serial read gives the same traces as a parallel one
+    Seis::TTC().setMaxMemory( 0 );
+    mRunStandardTest( Seis::TTC().memoryUsage() == 0, "Cache emptied" );
+    SeisTrcBuf serialoutput( true );
+    Seis::PathTraceReader serialrdr( ioobj, path, serialoutput );
+    mRunStandardTest( serialrdr.executeParallel(false),
+		      "Read the path serially" );
+    mRunStandardTest( isSame(serialoutput,expidxs,0,cNrSamples),
+		      "Traces from a serial read" );
+    return true;
+}
+
+
+mLoad1Module("Seis")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    const od_int64 maxmem = Seis::TTC().maxMemory();
+    const BufferString fnm =
+		FilePath::getTempFullPath( "seistilecache", "cbvs" );
+    PtrMan<IOObj> ioobj = getTmpIOObj( fnm );
+    const bool res = writeCube( *ioobj ) && testRead( *ioobj );
+    Seis::TTC().clear();
+    Seis::TTC().setMaxMemory( maxmem );
+    ioobj->implRemove();
+    return res;
+}
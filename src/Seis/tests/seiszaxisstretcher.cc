@@ -0,0 +1,178 @@
+/*+
+________________________________________________________________________
+
+ Copyright:	(C) 1995-2022 dGB Beheer B.V.
+ License:	https://dgbes.com/licensing
+________________________________________________________________________
+
+-*/
+
+#include "batchprog.h"
+
+#include "filepath.h"
+#include "iostrm.h"
+#include "moddepmgr.h"
+#include "seiscbvs.h"
+#include "seisread.h"
+#include "seistrc.h"
+#include "seistrctr.h"
+#include "seiswrite.h"
+#include "seiszaxisstretcher.h"
+#include "survinfo.h"
+#include "testprog.h"
+#include "timedepthconv.h"
+#include "unitofmeasure.h"
+
+#include <math.h>
+
+static const int cNrInl = 4;
+static const int cNrCrl = 10;
+static const int cNrSamples = 120;
+static const int cNrComps = 2;
+
+
+static IOObj* getTmpIOObj( const char* nm )
+{
+    const BufferString fnm = FilePath::getTempFullPath( nm, "cbvs" );
+    const MultiID tmpid( 100010, IOObj::tmpID() );
+    auto* iostrm = new IOStream( BufferString("_tmp_",nm),
+				 DBKey(tmpid,SI().diskLocation()) );
+    iostrm->setGroup( mTranslGroupName(SeisTrc) );
+    iostrm->setTranslator( CBVSSeisTrcTranslator::translKey() );
+    iostrm->fileSpec().setFileName( fnm );
+    return iostrm;
+}
+
+
+/* Both components vary too fast for a linear interpolation to be close */
+
+static bool writeInput( const IOObj& ioobj, TrcKeyZSampling& tkzs )
+{
+    const TrcKeySampling& sitks = SI().sampling( false ).hsamp_;
+    tkzs.hsamp_.set( StepInterval<int>(sitks.start_.inl(),
+			sitks.start_.inl()+(cNrInl-1)*sitks.step_.inl(),
+			sitks.step_.inl()),
+		     StepInterval<int>(sitks.start_.crl(),
+			sitks.start_.crl()+(cNrCrl-1)*sitks.step_.crl(),
+			sitks.step_.crl()) );
+
+    SeisTrcWriter wrr( ioobj );
+    SeisTrc trc( cNrSamples );
+    trc.setNrComponents( cNrComps );
+    trc.info().sampling_.start_ = SI().zRange( false ).start_;
+    trc.info().sampling_.step_ = SI().zStep();
+    TrcKeySamplingIterator iter( tkzs.hsamp_ );
+    BinID bid;
+    int trcidx = 0;
+    while ( iter.next(bid) )
+    {
+	trc.info().setPos( bid );
+	for ( int isamp=0; isamp<cNrSamples; isamp++ )
+	{
+	    trc.set( isamp, sinf(0.7f*isamp + 0.1f*trcidx), 0 );
+	    trc.set( isamp, 10.f + cosf(1.3f*isamp) * (trcidx%3), 1 );
+	}
+
+	mRunStandardTestWithError( wrr.put(trc), "Write an input trace",
+				   wrr.errMsg().getString() );
+	trcidx++;
+    }
+
+    mRunStandardTest( wrr.close(), "Close the input writer" );
+    return true;
+}
+
+
+static bool runStretcher( const IOObj& inp, const IOObj& outp,
+			  const TrcKeyZSampling& outcs, ZAxisTransform& ztf,
+			  int batchsize, const char* desc )
+{
+    SeisZAxisStretcher stretcher( inp, outp, outcs, ztf, true );
+    mRunStandardTest( stretcher.isOK(), BufferString("Set up ",desc) );
+    stretcher.setBatchSize( batchsize );
+    mRunStandardTestWithError( stretcher.execute(), BufferString("Run ",desc),
+			       stretcher.uiMessage().getString() );
+    return true;
+}
+
+
+static bool isSame( float val1, float val2 )
+{
+    return mIsUdf(val1) ? mIsUdf(val2) : mIsEqual(val1,val2,1e-5f);
+}
+
+
+static bool compareOutput( const IOObj& ioobj1, const IOObj& ioobj2 )
+{
+    SeisTrcReader rdr1( ioobj1 ), rdr2( ioobj2 );
+    mRunStandardTest( rdr1.prepareWork() && rdr2.prepareWork(),
+		      "Open the outputs" );
+
+    SeisTrc trc1, trc2;
+    int nrtrcs = 0, nrdefined = 0;
+    bool same = true, allcomps = true;
+    while ( rdr1.get(trc1) )
+    {
+	if ( !rdr2.get(trc2) || trc1.info().binID() != trc2.info().binID() ||
+	     trc1.size() != trc2.size() ||
+	     trc1.nrComponents() != cNrComps ||
+	     trc2.nrComponents() != cNrComps )
+	    { same = false; break; }
+
+	for ( int icomp=0; icomp<cNrComps; icomp++ )
+	{
+	    for ( int isamp=0; isamp<trc1.size(); isamp++ )
+	    {
+		const float val = trc1.get( isamp, icomp );
+		if ( !isSame(val,trc2.get(isamp,icomp)) )
+		    same = false;
+		if ( !mIsUdf(val) )
+		    nrdefined++;
+		if ( icomp == 1 && !mIsUdf(val) && val < 5.f )
+		    allcomps = false;
+	    }
+	}
+
+	nrtrcs++;
+    }
+
+    mRunStandardTest( same && !rdr2.get(trc2),
+		      "Batched output same as one trace at a time" );
+    mRunStandardTest( nrtrcs == cNrInl*cNrCrl && nrdefined > 0,
+		      "All traces stretched" );
+    mRunStandardTest( allcomps, "All components stretched" );
+    return true;
+}
+
+
+mLoad1Module("Seis")
+
+bool BatchProgram::doWork( od_ostream& strm )
+{
+    mInitBatchTestProg();
+
+    PtrMan<IOObj> inp = getTmpIOObj( "zstretch_inp" );
+    PtrMan<IOObj> outp = getTmpIOObj( "zstretch_out" );
+    PtrMan<IOObj> batchedoutp = getTmpIOObj( "zstretch_batched" );
+    TrcKeyZSampling outcs;
+    bool res = writeInput( *inp, outcs );
+
+    const double v0 =
+		LinearVelTransform::velUnit()->getUserValueFromSI( 2500. );
+    RefMan<ZAxisTransform> ztf = new LinearT2DTransform( v0, 0.3 );
+    ztf->toZDomainInfo().fillPar( outp->pars() );
+    ztf->toZDomainInfo().fillPar( batchedoutp->pars() );
+    outcs.zsamp_ = ztf->getZInterval( false, false );
+    if ( outcs.zsamp_.nrSteps() > 149 )
+	outcs.zsamp_.stop_ = outcs.zsamp_.atIndex( 149 );
+
+    res = res && ztf->isOK() &&
+	  runStretcher( *inp, *outp, outcs, *ztf, 0, "one trace at a time" ) &&
+	  runStretcher( *inp, *batchedoutp, outcs, *ztf, 7, "in batches" ) &&
+	  compareOutput( *outp, *batchedoutp );
+
+    inp->implRemove();
+    outp->implRemove();
+    batchedoutp->implRemove();
+    return res;
+}
@@ -69,6 +69,10 @@ bool BatchProgram::doWork( od_ostream& strm )
     const UnitOfMeasure* srduom = UnitOfMeasure::surveyDefSRDStorageUnit();
     Vel::VolumeConverter conv( *inputioobj, *outputioobj, tks, veldesc,
 			       srd, srduom );
+    int bricksize = conv.brickSize();
+    if ( pars().get(Vel::VolumeConverter::sKeyBrickSize(),bricksize) )
+	conv.setBrickSize( bricksize );
+
     TextStreamProgressMeter progressmeter( strm );
     ((Task&)conv).setProgressMeter( &progressmeter );
 
@@ -16,6 +16,7 @@ ________________________________________________________________________
 #include "keystrs.h"
 #include "paralleltask.h"
 #include "posinfo2d.h"
+#include "settings.h"
 #include "survgeom2d.h"
 #include "survinfo.h"
 #include "veldesc.h"
@@ -24,6 +25,8 @@ ________________________________________________________________________
 namespace Vel
 {
 
+static const int cMaxNrWeightCells = 262144;
+
 GriddedFunction::GriddedFunction( GriddedSource& source )
     : Function(source)
 {}
@@ -46,13 +49,25 @@ bool GriddedFunction::moveTo( const BinID& bid )
     if ( !gridder_ )
 	return false;
 
-    if ( gridder_->allPointsAreRelevant() )
-	return true;
+    if ( gridder_->allPointsAreRelevant() && !velocityfunctions_.isEmpty() )
+    {
+	if ( needsGridderPoints() )
+	    return true;
+
+	mDynamicCastGet( GriddedSource&, gvs, source_ );
+	return gvs.getWeights( bid_, weights_, usedpoints_ );
+    }
 
     return fetchSources();
 }
 
 
+bool GriddedFunction::needsGridderPoints() const
+{
+    return gridder_ && gridder_->areWeightsValuesDependent();
+}
+
+
 void GriddedFunction::fetchPerfectFit( const BinID& bid )
 {
     mDynamicCastGet( GriddedSource&, gvs, source_ );
@@ -93,27 +108,25 @@ bool GriddedFunction::fetchSources()
     ObjectSet<const Function> velfuncs;
     TypeSet<int> velfuncsource;
 
-    const TypeSet<Coord>* gridderpoints = gridder_->getPoints();
+    if ( !gridder_ )
+	return false;
+
+    mDynamicCastGet( GriddedSource&, gvs, source_ );
+    const bool validpos = !mIsUdf(bid_.inl()) && !mIsUdf(bid_.crl());
+    if ( !gridder_->allPointsAreRelevant() && !validpos )
+	return false;
 
     TypeSet<double> weights;
     TypeSet<int> usedpoints;
-    if ( gridder_->allPointsAreRelevant() && gridderpoints )
-    {
-	const TypeSet<Coord>::size_type nrpoints = gridderpoints->size();
-	for ( TypeSet<Coord>::size_type idx=0; idx<nrpoints; idx++ )
-	    usedpoints += idx;
-    }
+    if ( validpos && !needsGridderPoints() )
+	gvs.getWeights( bid_, weights, usedpoints );
     else
     {
-	if ( mIsUdf(bid_.inl()) || mIsUdf(bid_.crl() ) )
-	    return false;
-
-	const Coord workpos = SI().transform( bid_ );
-	gridder_->getWeights(workpos,weights,usedpoints);
+	const int nrpoints = gvs.gridsourcecoords_.size();
+	for ( int idx=0; idx<nrpoints; idx++ )
+	    usedpoints += idx;
     }
 
-
-    mDynamicCastGet( GriddedSource&, gvs, source_ );
     const TypeSet<BinID>& binids = gvs.gridsourcebids_;
 
     if ( binids.isEmpty() ) return false;
@@ -143,6 +156,8 @@ bool GriddedFunction::fetchSources()
     deepUnRef( velocityfunctions_ );
     velocityfunctions_ = velfuncs;
     sources_ = velfuncsource;
+    weights_ = weights;
+    usedpoints_ = usedpoints;
 
     if ( gridvalues_.size()!=gvs.gridsourcecoords_.size() )
 	gridvalues_.setSize( gvs.gridsourcecoords_.size(), mUdf(float) );
@@ -168,7 +183,8 @@ void GriddedFunction::setGridder( const Gridder2D& ng )
     delete gridder_;
     gridder_ = ng.clone();
 
-    if ( ng.getPoints() )
+    // The weights come from the source, no need to triangulate again
+    if ( needsGridderPoints() && ng.getPoints() )
     {
 	//Hack to hope for a better randomization
 	for ( int idx=0; idx<3; idx++ )
@@ -228,6 +244,10 @@ ZSampling GriddedFunction::getAvailableZ() const
 bool GriddedFunction::computeVelocity( float z0, float dz, int nr,
 				       float* res ) const
 {
+    mDynamicCastGet( GriddedSource&, gvs, source_ );
+    if ( gvs.getCachedVelocity(bid_,z0,dz,nr,res) )
+	return true;
+
     const bool nogridding = directsource_ || (velocityfunctions_.size() == 1);
     const bool doinverse = nogridding ? false : getDesc().isVelocity();
     Coord workpos = Coord::udf();
@@ -242,18 +262,26 @@ bool GriddedFunction::computeVelocity( float z0, float dz, int nr,
     TypeSet<int> usedpoints;
     if ( !nogridding )
     {
-	if ( !gridder_ || !gridder_->getPoints() )
+	if ( !gridder_ )
 	    return false;
 
-	const TypeSet<Coord>& gridderpoints = *gridder_->getPoints();
-	if ( gridder_->areWeightsValuesDependent() )
+	if ( needsGridderPoints() )
 	{
+	    if ( !gridder_->getPoints() )
+		return false;
+
+	    const TypeSet<Coord>& gridderpoints = *gridder_->getPoints();
 	    const TypeSet<Coord>::size_type nrpoints = gridderpoints.size();
 	    for ( TypeSet<Coord>::size_type idx=0; idx<nrpoints; idx++ )
 		usedpoints += idx;
 	}
-	else if ( !gridder_->getWeights(workpos,weights,usedpoints) )
+	else if ( usedpoints_.isEmpty() )
 	    return false;
+	else
+	{
+	    weights = weights_;
+	    usedpoints = usedpoints_;
+	}
     }
 
     mDynamicCastGet(RadialBasisFunctionGridder2D*,rbfgridder,gridder_)
@@ -343,6 +371,7 @@ bool GriddedFunction::computeVelocity( float z0, float dz, int nr,
 	    res[idx] = val;
     }
 
+    gvs.addToCache( bid_, z0, dz, nr, res );
     return true;
 }
 
@@ -354,8 +383,11 @@ GriddedSource::GriddedSource( const Pos::GeomID& geomid )
     , gridder_(new TriangulatedGridder2D)
     , geomid_(geomid)
     , sourcepos_(0,false)
+    , weightcells_(1,false)
 {
     sourcepos_.setIs2D( geomid.is2D() );
+    weightcells_.setIs2D( geomid.is2D() );
+    Settings::common().get( sKeyMaxNrCachedFunctions(), maxnrcached_ );
     initGridder();
 }
 
@@ -398,6 +430,133 @@ FunctionSource& GriddedSource::setZDomain( const ZDomain::Info& )
 }
 
 
+const char* GriddedSource::sKeyMaxNrCachedFunctions()
+{
+    return "dTect.Gridded velocity.Max nr cached functions";
+}
+
+
+bool GriddedSource::getWeights( const BinID& bid, TypeSet<double>& weights,
+				TypeSet<int>& usedpoints )
+{
+    weights.setEmpty();
+    usedpoints.setEmpty();
+    Threads::Locker locker( weightslock_ );
+    const BinIDValueSet::SPos pos = weightcells_.find( bid );
+    if ( pos.isValid() )
+    {
+	const int cellidx = mNINT32( weightcells_.getVal(pos,0) );
+	const CellWeights& cell = *cellweights_.get( cellidx );
+	weights = cell.weights_;
+	usedpoints = cell.usedpoints_;
+	return !usedpoints.isEmpty();
+    }
+
+    const auto* geom = Survey::GM().getGeometry( geomid_ );
+    if ( !geom || !gridder_ || !gridder_->getPoints() )
+	return false;
+
+    // The source gridder is triangulated once, for all functions
+    gridder_->getWeights( geom->toCoord(bid), weights, usedpoints );
+    if ( cellweights_.size() >= cMaxNrWeightCells )
+    {
+	weightcells_.setEmpty();
+	cellweights_.erase();
+    }
+
+    auto* cell = new CellWeights;
+    cell->weights_ = weights;
+    cell->usedpoints_ = usedpoints;
+    weightcells_.add( bid, float(cellweights_.size()) );
+    cellweights_.add( cell );
+    return !usedpoints.isEmpty();
+}
+
+
+bool GriddedSource::getCachedVelocity( const BinID& bid, float z0, float dz,
+				       int sz, float* res )
+{
+    Threads::Locker locker( cachelock_ );
+    for ( int idx=0; idx<evaluated_.size(); idx++ )
+    {
+	const EvaluatedFunction& func = *evaluated_.get( idx );
+	if ( func.bid_!=bid || func.z0_!=z0 || func.dz_!=dz ||
+	     func.vels_.size()!=sz )
+	    continue;
+
+	OD::memCopy( res, func.vels_.arr(), sz*sizeof(float) );
+	stamps_[idx] = curstamp_++;
+	return true;
+    }
+
+    return false;
+}
+
+
+void GriddedSource::addToCache( const BinID& bid, float z0, float dz,
+				int sz, const float* vels )
+{
+    Threads::Locker locker( cachelock_ );
+    if ( maxnrcached_ < 1 )
+	return;
+
+    for ( const auto* func : evaluated_ )
+    {
+	if ( func->bid_==bid && func->z0_==z0 && func->dz_==dz &&
+	     func->vels_.size()==sz )
+	    return;
+    }
+
+    auto* func = new EvaluatedFunction;
+    func->bid_ = bid;
+    func->z0_ = z0;
+    func->dz_ = dz;
+    func->vels_.setSize( sz );
+    OD::memCopy( func->vels_.arr(), vels, sz*sizeof(float) );
+    evaluated_.add( func );
+    stamps_ += curstamp_++;
+    limitCacheSize();
+}
+
+
+void GriddedSource::limitCacheSize()
+{
+    while ( evaluated_.size() > maxnrcached_ && !evaluated_.isEmpty() )
+    {
+	int oldestidx = 0;
+	for ( int idx=1; idx<stamps_.size(); idx++ )
+	{
+	    if ( stamps_[idx] < stamps_[oldestidx] )
+		oldestidx = idx;
+	}
+
+	evaluated_.removeSingle( oldestidx );
+	stamps_.removeSingle( oldestidx );
+    }
+}
+
+
+void GriddedSource::setMaxNrCachedFunctions( int nr )
+{
+    Threads::Locker locker( cachelock_ );
+    maxnrcached_ = nr;
+    limitCacheSize();
+}
+
+
+void GriddedSource::clearCache()
+{
+    Threads::Locker weightslocker( weightslock_ );
+    weightcells_.setEmpty();
+    cellweights_.erase();
+    weightslocker.unlockNow();
+
+    Threads::Locker cachelocker( cachelock_ );
+    evaluated_.erase();
+    stamps_.erase();
+}
+
+
 
 class GridderSourceFilter : public ParallelTask
 {
@@ -523,6 +682,7 @@ bool GriddedSource::initGridder()
 
     gridder_->setGridArea( xrg, yrg );
 
+    clearCache();
     sourcepos_.setEmpty();
     gridsourcecoords_.erase();
     gridsourcebids_.erase();
@@ -544,7 +704,7 @@ bool GriddedSource::initGridder()
     for ( int idx=functions_.size()-1; idx>=0; idx-- )
     {
 	mDynamicCastGet( GriddedFunction*, func, functions_[idx] );
-	if ( func->getGridder() )
+	if ( func->needsGridderPoints() )
 	{
 	    //Hack to hope for a better randomization
             for ( int idy=0; idy<3; idy++ )
@@ -656,6 +816,7 @@ const ObjectSet<FunctionSource>& GriddedSource::getSources() const
 void GriddedSource::setLayerModel( const InterpolationLayerModel* mdl )
 {
     layermodel_ = mdl;
+    clearCache();
 }
 
 
@@ -13,6 +13,7 @@ ________________________________________________________________________
 #include "ioobj.h"
 #include "keystrs.h"
 #include "posinfo.h"
+#include "seisbuf.h"
 #include "seisioobjinfo.h"
 #include "seisread.h"
 #include "seisselectionimpl.h"
@@ -22,12 +23,14 @@ ________________________________________________________________________
 #include "timedepthconv.h"
 #include "uistrings.h"
 #include "veldesc.h"
+#include "zvalseriesimpl.h"
 
 namespace Vel
 {
 
 const char* VolumeConverter::sKeyInput() { return sKey::Input(); }
 const char* VolumeConverter::sKeyOutput() { return sKey::Output(); }
+const char* VolumeConverter::sKeyBrickSize() { return "Brick size"; }
 
 VolumeConverter::VolumeConverter( const IOObj& input, const IOObj& output,
 				  const TrcKeySampling& ranges,
@@ -54,6 +57,7 @@ VolumeConverter::~VolumeConverter()
 {
     delete &velinpdesc_;
     delete &veloutpdesc_;
+    delete worker_;
     delete reader_;
     delete writer_;
     delete sequentialwriter_;
@@ -142,6 +146,11 @@ bool VolumeConverter::doPrepare( int nrthreads )
     reader_->setSelData( new Seis::RangeSelData(tks_) );
 
     zdomaininfo_ = &reader_->zDomain();
+    delete worker_;
+    worker_ = new Worker( velinpdesc_, srd_, srduom_ );
+    if ( bricksize_ < 1 )
+	bricksize_ = 1;
+
     delete writer_;
     writer_ = new SeisTrcWriter( output_ );
     delete sequentialwriter_;
@@ -153,11 +162,11 @@ bool VolumeConverter::doPrepare( int nrthreads )
 
 bool VolumeConverter::doWork( od_int64, od_int64, int threadidx )
 {
-    char res = 1;
-    SeisTrc trc;
+    SeisTrcBuf trcs( true );
+    TypeSet<double> buf;
 
     lock_.lock();
-    res = getNewTrace( trc, threadidx );
+    char res = getNewTraces( trcs, threadidx );
     lock_.unLock();
 
     while ( res==1 )
@@ -165,23 +174,78 @@ bool VolumeConverter::doWork( od_int64, od_int64, int threadidx )
 	if ( !shouldContinue() )
 	    return false;
 
-	auto* outputtrc = new SeisTrc( trc );
-	outputtrc->updateVelocities( velinpdesc_, veloutpdesc_,
-				     *zdomaininfo_, srd_, srduom_ );
-	sequentialwriter_->submitTrace( outputtrc, true );
-	addToNrDone( 1 );
+	convertTraces( trcs, buf );
+	const int nrtrcs = trcs.size();
+	for ( int idx=0; idx<nrtrcs; idx++ )
+	    sequentialwriter_->submitTrace( trcs.get(idx), true );
+
+	// The writer took the traces over
+	trcs.setIsOwner( false );
+	trcs.erase();
+	trcs.setIsOwner( true );
+	addToNrDone( nrtrcs );
 
 	Threads::MutexLocker lock( lock_ );
-	res = getNewTrace( trc, threadidx );
+	res = getNewTraces( trcs, threadidx );
     }
 
     return res==0;
 }
 
 
+void VolumeConverter::convertTraces( SeisTrcBuf& trcs,
+				     TypeSet<double>& buf ) const
+{
+    const SeisTrc& firsttrc = *trcs.first();
+    const int sz = firsttrc.size();
+    const int nrcomps = firsttrc.nrComponents();
+    const SamplingData<float> sd = firsttrc.info().sampling_;
+    ObjectSet<SeisTrc> brick;
+    for ( int idx=0; idx<trcs.size(); idx++ )
+    {
+	SeisTrc* trc = trcs.get( idx );
+	if ( trc->size() == sz && trc->nrComponents() == nrcomps &&
+	     trc->info().sampling_ == sd )
+	    brick += trc;
+	else
+	    trc->updateVelocities( velinpdesc_, veloutpdesc_, *zdomaininfo_,
+				   srd_, srduom_ );
+    }
+
+    const int nrseries = brick.size() * nrcomps;
+    if ( nrseries < 1 || sz < 1 )
+	return;
+
+    buf.setSize( nrseries * sz );
+    double* vels = buf.arr();
+    for ( const auto* trc : brick )
+    {
+	for ( int icomp=0; icomp<nrcomps; icomp++ )
+	{
+	    for ( int isamp=0; isamp<sz; isamp++ )
+		*vels++ = trc->get( isamp, icomp );
+	}
+    }
+
+    const RegularZValues zvals( sd, sz, *zdomaininfo_ );
+    worker_->convertVelocities( buf.arr(), nrseries, zvals, veloutpdesc_ );
+
+    vels = buf.arr();
+    for ( auto* trc : brick )
+    {
+	for ( int icomp=0; icomp<nrcomps; icomp++ )
+	{
+	    for ( int isamp=0; isamp<sz; isamp++ )
+		trc->set( isamp, float(*vels++), icomp );
+	}
+    }
+}
+
+
 bool VolumeConverter::doFinish( bool success )
 {
     zdomaininfo_= nullptr;
+    deleteAndNullPtr( worker_ );
     deleteAndNullPtr( reader_ );
     if ( !sequentialwriter_->finishWrite() )
 	success = false;
@@ -216,7 +280,7 @@ char VolumeConverter::getNewTrace( SeisTrc& trc, int threadidx )
 	return 0;
 
     int res = 2;
-    while ( res==2 || !tks_.includes(trc.info().binID()) )
+    while ( res==2 || (res==1 && !tks_.includes(trc.info().binID())) )
 	res = reader_->get( trc.info() );
 
     if ( res==1 )
@@ -236,4 +300,22 @@ char VolumeConverter::getNewTrace( SeisTrc& trc, int threadidx )
     return mCast( char, res );
 }
 
+char VolumeConverter::getNewTraces( SeisTrcBuf& trcs, int threadidx )
+{
+    while ( trcs.size() < bricksize_ )
+    {
+	auto* trc = new SeisTrc;
+	const char res = getNewTrace( *trc, threadidx );
+	if ( res != 1 )
+	{
+	    delete trc;
+	    return res==0 && !trcs.isEmpty() ? 1 : res;
+	}
+
+	trcs.add( trc );
+    }
+
+    return 1;
+}
+
 } // namespace Vel
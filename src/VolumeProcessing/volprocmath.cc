@@ -9,6 +9,7 @@ ________________________________________________________________________
 
 #include "volprocmath.h"
 
+#include "arraynd.h"
 #include "keystrs.h"
 #include "mathformula.h"
 
@@ -95,6 +96,20 @@ bool Math::computeBinID( const BinID& bid, int )
     const int outputcrlidx = output->sampling().crlIdx( bid.crl() );
     const int outputzsz = output->sampling().nrZ();
 
+    const Array3D<float>& inparr = input->data();
+    Array3D<float>& outarr = output->data();
+    const float* inpptr = inparr.getData();
+    float* outptr = outarr.getData();
+    if ( inpptr && outptr && formula_->nrValues2Provide() == 1 )
+    {
+	const float* inptrc = inpptr +
+		inparr.info().getOffset( inputinlidx, inputcrlidx, 0 );
+	float* outtrc = outptr +
+		outarr.info().getOffset( outputinlidx, outputcrlidx, 0 );
+	if ( formula_->getValues(&inptrc,nullptr,outtrc,outputzsz) )
+	    return true;
+    }
+
     double inputvals[1];
     for ( int zidx=0; zidx<outputzsz; zidx++ )
     {
@@ -10,6 +10,7 @@ ________________________________________________________________________
 #include "welltiegeocalculator.h"
 
 #include "arrayndalgo.h"
+#include "crosscorrelator.h"
 #include "fourier.h"
 #include "fftfilter.h"
 #include "hilberttransform.h"
@@ -381,7 +382,16 @@ void WellTie::GeoCalculator::deconvolve( const float* inp,
 double WellTie::GeoCalculator::crossCorr( const float* seis, const float* synth,
 					  float* outp, int sz )
 {
-    genericCrossCorrelation( sz, 0, seis, sz, 0, synth, sz, -sz/2, outp );
+    // Lags -sz/2 to sz-sz/2-1, as genericCrossCorrelation would give
+    Fourier::CrossCorrelator correlator;
+    const int maxlag = sz/2;
+    TypeSet<float> xcorr( 2*maxlag+1, 0.f );
+    if ( correlator.setSize(sz,maxlag) && correlator.setReference(seis) &&
+	 correlator.correlate(synth,xcorr.arr()) )
+	OD::sysMemCopy( outp, xcorr.arr(), sz*sizeof(float) );
+    else
+	genericCrossCorrelation( sz, 0, seis, sz, 0, synth, sz, -sz/2, outp );
+
     LinStats2D ls2d; ls2d.use( seis, synth, sz );
     return ls2d.corrcoeff;
 }
@@ -39,6 +39,7 @@ ________________________________________________________________________
 #include "seispreload.h"
 #include "seisread.h"
 #include "seisselectionimpl.h"
+#include "seistilecache.h"
 #include "seistrc.h"
 #include "settingsaccess.h"
 #include "survinfo.h"
@@ -1038,6 +1039,8 @@ RefMan<RegularSeisDataPack> uiAttribPartServer::createOutputRM(
 	}
 
 	output = aem->getDataPackOutput( *process );
+	if ( output && success )
+	    aem->storeInResultCache( *output );
     }
 
     if ( output && !success )
@@ -1211,12 +1214,19 @@ RefMan<RandomSeisDataPack> uiAttribPartServer::createRdmTrcsOutputRM(
 
     snapToValidRandomTraces( trckeys, targetdesc.ptr() );
 
-    BinIDValueSet bidset( 2, false );
-    for ( const auto& tk : trckeys )
-	bidset.add( tk.position(), zrg.start_, zrg.stop_ );
-
     SeisTrcBuf output( true );
-    if ( !createOutput(bidset,output,knots,trckeys) || output.isEmpty() )
+    if ( !targetdesc || !readStoredTraces(*targetdesc,zrg,trckeys,output) )
+    {
+	BinIDValueSet bidset( 2, false );
+	for ( const auto& tk : trckeys )
+	    bidset.add( tk.position(), zrg.start_, zrg.stop_ );
+
+	output.deepErase();
+	if ( !createOutput(bidset,output,knots,trckeys) )
+	    return nullptr;
+    }
+
+    if ( output.isEmpty() )
 	return nullptr;
 
     RefMan<RandomSeisDataPack> newpack =
@@ -1411,6 +1421,28 @@ bool uiAttribPartServer::createOutput( const BinIDValueSet& bidset,
 }
 
 
+bool uiAttribPartServer::readStoredTraces( const Desc& targetdesc,
+					   const Interval<float>& zrg,
+					   const TrcKeySet& path,
+					   SeisTrcBuf& output )
+{
+    if ( !targetdesc.isStored() || targetdesc.isStoredInMem() ||
+	 targetdesc.is2D() || targetspecs_.size() != 1 )
+	return false;
+
+    PtrMan<IOObj> ioobj = IOM().get( targetdesc.getStoredID() );
+    if ( !ioobj )
+	return false;
+
+    MouseCursorChanger cursorchgr( MouseCursor::Wait );
+    Seis::PathTraceReader rdr( *ioobj, path, output,
+			       targetdesc.selectedOutput() );
+    rdr.setZRange( zrg );
+    // Let the attribute engine try when the store cannot be read this way
+    return rdr.execute() && !output.isEmpty();
+}
+
+
 class RegularSeisDataPackCreatorFor2D : public ParallelTask
 {
 public:
@@ -49,6 +49,9 @@ uiAGC::uiAGC( uiParent* p, AGC* sgagc )
     const float lowenergymute = processor_->getLowEnergyMute();
     lowenergymute_->setValue(
 	    mIsUdf(lowenergymute) ? mUdf(float) : lowenergymute*100 );
+    ignorezerosfld_ = new uiGenInput( this, tr("Zero samples in window"),
+	    BoolInpSpec(processor_->ignoreZeros(),tr("Ignore"),tr("Use")) );
+    ignorezerosfld_->attach( alignedBelow, lowenergymute_ );
 }
 
 
@@ -81,6 +84,8 @@ bool uiAGC::acceptOK( CallBacker* )
 	processor_->setLowEnergyMute( lowenergymute/100 );
     }
 
+    processor_->setIgnoreZeros( ignorezerosfld_->getBoolValue() );
+
     return true;
 }
 
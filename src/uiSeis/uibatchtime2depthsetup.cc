@@ -228,6 +228,8 @@ bool uiBatchTime2DepthSetup::fillPar()
     par.mergeComp( ztranspar, ProcessTime2Depth::sKeyZTransPar() );
     par.setYN( ProcessTime2Depth::sKeyIsTimeToDepth(),
 	       directionsel_->getBoolValue() );
+    par.set( ProcessTime2Depth::sKeyBatchSize(),
+	     ProcessTime2Depth::defBatchSize() );
 
     return true;
 }